@@ -0,0 +1,703 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/magic.h"
+#include "fossil/code/json.h"
+#include "fossil/code/app.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * squid-bench: reproducible microbenchmarks for the magic engine.
+ *
+ * Every input is generated from a fixed seed, so two runs on the same machine
+ * measure the same work. Each case is calibrated until one batch takes at
+ * least the minimum time, then timed over several batches; the median batch
+ * is reported as ns/op. Allocations are counted through the
+ * fossil_sys_memory_* wrappers and fossil_io_cstring_copy_safe when the
+ * linker supports --wrap.
+ */
+
+/* ==========================================================================
+ * Allocation Counting
+ * ========================================================================== */
+
+static unsigned long long bench_allocs = 0;
+
+#ifdef SQUID_BENCH_WRAP
+void *__real_fossil_sys_memory_calloc(size_t num, size_t size);
+void *__real_fossil_sys_memory_realloc(void *ptr, size_t size);
+cstring __real_fossil_io_cstring_copy_safe(ccstring str, size_t max_len);
+
+void *__wrap_fossil_sys_memory_calloc(size_t num, size_t size);
+void *__wrap_fossil_sys_memory_realloc(void *ptr, size_t size);
+cstring __wrap_fossil_io_cstring_copy_safe(ccstring str, size_t max_len);
+
+void *__wrap_fossil_sys_memory_calloc(size_t num, size_t size)
+{
+    __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+    return __real_fossil_sys_memory_calloc(num, size);
+}
+
+void *__wrap_fossil_sys_memory_realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+    return __real_fossil_sys_memory_realloc(ptr, size);
+}
+
+cstring __wrap_fossil_io_cstring_copy_safe(ccstring str, size_t max_len)
+{
+    __atomic_add_fetch(&bench_allocs, 1, __ATOMIC_RELAXED);
+    return __real_fossil_io_cstring_copy_safe(str, max_len);
+}
+
+static unsigned long long bench_alloc_count(void)
+{
+    return __atomic_load_n(&bench_allocs, __ATOMIC_RELAXED);
+}
+#define BENCH_COUNTS_ALLOCS 1
+#else
+static unsigned long long bench_alloc_count(void)
+{
+    return bench_allocs;
+}
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+/* ==========================================================================
+ * Clock and Inputs
+ * ========================================================================== */
+
+static unsigned long long bench_now_ns(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+static unsigned long long bench_rng = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long long bench_next(void)
+{
+    // xorshift64*: fixed seed, identical inputs on every platform
+    bench_rng ^= bench_rng >> 12;
+    bench_rng ^= bench_rng << 25;
+    bench_rng ^= bench_rng >> 27;
+    return bench_rng * 0x2545F4914F6CDD1DULL;
+}
+
+static const char *bench_syllables[] = {
+    "com", "mit", "pu", "sh", "pull", "stat", "us", "che", "ck", "out",
+    "re", "base", "mer", "ge", "lo", "g", "fe", "tch", "bra", "nch",
+    "in", "it", "de", "lete", "con", "fig", "ser", "vice", "pro", "cess"
+};
+
+// A command-like word of 2-4 syllables, optionally with a dash and a number
+static void bench_word(char *buf, size_t size)
+{
+    size_t n = 0;
+    int parts = 2 + (int)(bench_next() % 3);
+    buf[0] = '\0';
+    for (int i = 0; i < parts; i++)
+    {
+        const char *syl = bench_syllables[bench_next() % (sizeof(bench_syllables) / sizeof(bench_syllables[0]))];
+        int w = snprintf(buf + n, size - n, "%s", syl);
+        if (w < 0 || (size_t)w >= size - n)
+            return;
+        n += (size_t)w;
+    }
+    if (bench_next() % 4 == 0)
+        snprintf(buf + n, size - n, "-%u", (unsigned)(bench_next() % 1000));
+}
+
+// Introduce one typo: swap, drop or replace a character
+static void bench_typo(const char *src, char *buf, size_t size)
+{
+    snprintf(buf, size, "%s", src);
+    size_t len = strlen(buf);
+    if (len < 3)
+        return;
+    size_t at = 1 + (size_t)(bench_next() % (len - 2));
+    switch (bench_next() % 3)
+    {
+    case 0:
+    {
+        char c = buf[at];
+        buf[at] = buf[at + 1];
+        buf[at + 1] = c;
+        break;
+    }
+    case 1:
+        memmove(buf + at, buf + at + 1, len - at);
+        break;
+    default:
+        buf[at] = (char)('a' + bench_next() % 26);
+        break;
+    }
+}
+
+/* ==========================================================================
+ * Synthetic Filesystem
+ * ========================================================================== */
+
+#ifdef _WIN32
+#define bench_mkdir(path) _mkdir(path)
+#define bench_rmdir(path) _rmdir(path)
+#else
+#define bench_mkdir(path) mkdir(path, 0700)
+#define bench_rmdir(path) rmdir(path)
+#endif
+
+static char bench_root[512];
+
+static void bench_sleep_ms(unsigned long long ms)
+{
+#ifdef _WIN32
+    Sleep((DWORD)ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ms / 1000);
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static int bench_touch(const char *path, size_t bytes)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+        return -1;
+    for (size_t i = 0; i < bytes; i++)
+        fputc('a' + (int)(i % 26), fp);
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+static int bench_workdir(void)
+{
+    const char *tmp = getenv("TMPDIR");
+#ifdef _WIN32
+    if (!tmp)
+        tmp = getenv("TEMP");
+    if (!tmp)
+        tmp = ".";
+    snprintf(bench_root, sizeof(bench_root), "%s\\squid-bench-%lu", tmp, (unsigned long)GetCurrentProcessId());
+#else
+    if (!tmp)
+        tmp = "/tmp";
+    snprintf(bench_root, sizeof(bench_root), "%s/squid-bench-%ld", tmp, (long)getpid());
+#endif
+    return bench_mkdir(bench_root);
+}
+
+/*
+ * A flat directory of count command-like files: create, or remove when undo
+ * is set. The middle file's name is copied to pick so callers can misspell it.
+ */
+static int bench_flat_dir(const char *dir, int count, bool undo, char *pick, size_t pick_size)
+{
+    char path[768];
+    char word[64];
+    unsigned long long saved = bench_rng;
+    int rc = 0;
+
+    if (!undo && bench_mkdir(dir) != 0)
+        return -1;
+    bench_rng = 0xD1B54A32D192ED03ULL + (unsigned long long)count;
+    for (int i = 0; i < count; i++)
+    {
+        bench_word(word, sizeof(word));
+        snprintf(path, sizeof(path), "%s/%s_%d.txt", dir, word, i);
+        if (pick && i == count / 2)
+            snprintf(pick, pick_size, "%s_%d.txt", word, i);
+        if (undo)
+            remove(path);
+        else if (bench_touch(path, 0) != 0)
+            rc = -1;
+    }
+    bench_rng = saved;
+    if (undo)
+        bench_rmdir(dir);
+    return rc;
+}
+
+// A tree of fanout subdirectories per level and files_per_dir files in each
+static int bench_tree(const char *dir, int depth, int fanout, int files_per_dir, bool undo)
+{
+    static const char *exts[] = { ".c", ".h", ".md", ".txt", ".json", ".o" };
+    char path[768];
+    int rc = 0;
+
+    if (!undo && bench_mkdir(dir) != 0)
+        return -1;
+    for (int i = 0; i < files_per_dir; i++)
+    {
+        snprintf(path, sizeof(path), "%s/file%d%s", dir, i, exts[i % 6]);
+        if (undo)
+            remove(path);
+        else if (bench_touch(path, (size_t)(64 * (i % 8))) != 0)
+            rc = -1;
+    }
+    if (depth > 0)
+    {
+        for (int i = 0; i < fanout; i++)
+        {
+            snprintf(path, sizeof(path), "%s/dir%d", dir, i);
+            if (bench_tree(path, depth - 1, fanout, files_per_dir, undo) != 0)
+                rc = -1;
+        }
+    }
+    if (undo)
+        bench_rmdir(dir);
+    return rc;
+}
+
+/* ==========================================================================
+ * Benchmark Cases
+ * ========================================================================== */
+
+typedef struct
+{
+    const char **items;     // candidate names
+    char *storage;          // backing text for items
+    int count;
+    char input[64];         // typo'd member of items
+    fossil_ti_index_t index;
+} bench_candidates_t;
+
+typedef struct
+{
+    const char *name;
+    void (*run)(void *arg);
+    void *arg;
+    bool settled;           // inputs must be older than the danger cache's two-second guard
+} bench_case_t;
+
+typedef struct
+{
+    const char *name;
+    unsigned long long iterations;
+    double ns_per_op;
+    double min_ns_per_op;
+    double max_ns_per_op;
+    double allocs_per_op;
+} bench_result_t;
+
+static volatile long long bench_sink = 0;
+
+static const char *bench_long_a =
+    "the quick brown fox jumps over the lazy dog while the build server "
+    "recompiles every module in the tree after a configuration change";
+static const char *bench_long_b =
+    "a quick brown fox jumped over one lazy dog while our build servers "
+    "recompile each module in this tree after the configuration changed";
+
+static void run_levenshtein_short(void *arg)
+{
+    (void)arg;
+    bench_sink += fossil_it_magic_levenshtein_distance("comit", "commit");
+}
+
+static void run_levenshtein_long(void *arg)
+{
+    (void)arg;
+    bench_sink += fossil_it_magic_levenshtein_distance(bench_long_a, bench_long_b);
+}
+
+static void run_jaccard_short(void *arg)
+{
+    (void)arg;
+    bench_sink += fossil_it_magic_jaccard_index("git commit all", "commit all files");
+}
+
+static void run_jaccard_long(void *arg)
+{
+    (void)arg;
+    bench_sink += fossil_it_magic_jaccard_index(bench_long_a, bench_long_b);
+}
+
+static void run_similarity(void *arg)
+{
+    (void)arg;
+    bench_sink += (long long)(fossil_it_magic_similarity("stauts", "status") * 1000.0f);
+}
+
+static void run_suggest_command(void *arg)
+{
+    bench_candidates_t *c = (bench_candidates_t *)arg;
+    const char *best = fossil_it_magic_suggest_command(c->input, c->items, c->count, NULL);
+    bench_sink += best ? (long long)best[0] : 0;
+}
+
+static void run_index_suggest(void *arg)
+{
+    bench_candidates_t *c = (bench_candidates_t *)arg;
+    const char *best = fossil_it_magic_index_suggest(&c->index, c->input, -1, NULL);
+    bench_sink += best ? (long long)best[0] : 0;
+}
+
+typedef struct
+{
+    char dir[640];
+    char bad[96];           // misspelled entry name
+    int count;
+} bench_dir_t;
+
+static void run_path_suggest(void *arg)
+{
+    bench_dir_t *d = (bench_dir_t *)arg;
+    fossil_ti_path_suggestion_set_t out;
+    fossil_it_magic_path_suggest(d->bad, d->dir, &out);
+    bench_sink += out.count;
+}
+
+static void run_danger_analyze(void *arg)
+{
+    bench_dir_t *d = (bench_dir_t *)arg;
+    fossil_ti_danger_item_t out;
+    fossil_it_magic_danger_analyze(d->dir, &out);
+    bench_sink += (long long)out.level + out.contains_code;
+}
+
+// The same analysis with the directory-facts cache off: a full listing every time
+static void run_danger_analyze_uncached(void *arg)
+{
+    fossil_it_magic_danger_cache_enable(0);
+    run_danger_analyze(arg);
+    fossil_it_magic_danger_cache_enable(1);
+}
+
+static void run_danger_tree(void *arg)
+{
+    bench_dir_t *d = (bench_dir_t *)arg;
+    fossil_ti_danger_budget_t budget;
+    fossil_ti_danger_item_t out;
+    memset(&budget, 0, sizeof(budget));
+    budget.max_depth = -1;
+    budget.max_ms = 60000;
+    fossil_it_magic_danger_analyze_tree(d->dir, &budget, &out);
+    bench_sink += (long long)out.tree_files;
+}
+
+static void run_danger_tree_uncached(void *arg)
+{
+    fossil_it_magic_danger_cache_enable(0);
+    run_danger_tree(arg);
+    fossil_it_magic_danger_cache_enable(1);
+}
+
+static int bench_candidates_make(bench_candidates_t *c, int count)
+{
+    const size_t width = 48;
+    memset(c, 0, sizeof(*c));
+    c->items = (const char **)calloc((size_t)count, sizeof(*c->items));
+    c->storage = (char *)calloc((size_t)count, width);
+    if (!c->items || !c->storage)
+        return -1;
+    c->count = count;
+
+    bench_rng = 0x9E3779B97F4A7C15ULL + (unsigned long long)count;
+    fossil_it_magic_index_init(&c->index);
+    for (int i = 0; i < count; i++)
+    {
+        char *slot = c->storage + (size_t)i * width;
+        bench_word(slot, width);
+        c->items[i] = slot;
+        if (fossil_it_magic_index_add(&c->index, slot) != 0)
+            return -1;
+    }
+    bench_typo(c->items[(int)(bench_next() % (unsigned long long)count)], c->input, sizeof(c->input));
+    return 0;
+}
+
+static void bench_candidates_free(bench_candidates_t *c)
+{
+    fossil_it_magic_index_dispose(&c->index);
+    free(c->items);
+    free(c->storage);
+}
+
+/* ==========================================================================
+ * Runner
+ * ========================================================================== */
+
+static int bench_cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+#define BENCH_MAX_RUNS 15
+
+static void bench_measure(const bench_case_t *bc, unsigned long long min_ns, int runs, bench_result_t *out)
+{
+    unsigned long long n = 1;
+    double samples[BENCH_MAX_RUNS];
+
+    // warm caches and lazily built tables before calibrating
+    bc->run(bc->arg);
+
+    for (;;)
+    {
+        unsigned long long t0 = bench_now_ns();
+        for (unsigned long long i = 0; i < n; i++)
+            bc->run(bc->arg);
+        unsigned long long spent = bench_now_ns() - t0;
+        if (spent >= min_ns || n >= (1ULL << 30))
+            break;
+        // aim a little past the target so one more round usually suffices
+        unsigned long long next = spent > 0 ? (unsigned long long)((double)n * 1.2 * (double)min_ns / (double)spent) : n * 100;
+        n = next > n * 100 ? n * 100 : (next <= n ? n * 2 : next);
+    }
+
+    unsigned long long allocs = bench_alloc_count();
+    for (int r = 0; r < runs; r++)
+    {
+        unsigned long long t0 = bench_now_ns();
+        for (unsigned long long i = 0; i < n; i++)
+            bc->run(bc->arg);
+        samples[r] = (double)(bench_now_ns() - t0) / (double)n;
+    }
+    allocs = bench_alloc_count() - allocs;
+
+    qsort(samples, (size_t)runs, sizeof(samples[0]), bench_cmp_double);
+    out->name = bc->name;
+    out->iterations = n * (unsigned long long)runs;
+    out->ns_per_op = samples[runs / 2];
+    out->min_ns_per_op = samples[0];
+    out->max_ns_per_op = samples[runs - 1];
+    out->allocs_per_op = (double)allocs / (double)out->iterations;
+}
+
+static void bench_usage(void)
+{
+    fprintf(stderr,
+        "usage: squid-bench [--json] [--quick] [--runs N] [--filter TEXT]\n"
+        "  --json         print machine-readable results\n"
+        "  --quick        short calibration, for smoke runs\n"
+        "  --runs N       timed batches per case (default 5, max %d)\n"
+        "  --filter TEXT  only run cases whose name contains TEXT\n",
+        BENCH_MAX_RUNS);
+}
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    unsigned long long min_ns = 200000000ULL;
+    int runs = 5;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--quick") == 0)
+        {
+            min_ns = 10000000ULL;
+            runs = 3;
+        }
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+        {
+            runs = atoi(argv[++i]);
+            if (runs < 1 || runs > BENCH_MAX_RUNS)
+            {
+                bench_usage();
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            bench_usage();
+            return 2;
+        }
+    }
+
+    if (bench_workdir() != 0)
+    {
+        fprintf(stderr, "squid-bench: cannot create work directory %s\n", bench_root);
+        return 1;
+    }
+    // keep the directory-facts cache inside the work directory
+#ifdef _WIN32
+    _putenv_s("XDG_CACHE_HOME", bench_root);
+#else
+    setenv("XDG_CACHE_HOME", bench_root, 1);
+#endif
+
+    static const int candidate_counts[] = { 10, 1000, 100000 };
+    static const int dir_counts[] = { 1000, 10000 };
+    bench_candidates_t cands[3];
+    bench_dir_t dirs[2];
+    bench_dir_t tree;
+    int rc = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (bench_candidates_make(&cands[i], candidate_counts[i]) != 0)
+        {
+            fprintf(stderr, "squid-bench: out of memory\n");
+            return 1;
+        }
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        dirs[i].count = dir_counts[i];
+        snprintf(dirs[i].dir, sizeof(dirs[i].dir), "%s/flat%d", bench_root, dir_counts[i]);
+        char pick[96];
+        pick[0] = '\0';
+        if (bench_flat_dir(dirs[i].dir, dir_counts[i], false, pick, sizeof(pick)) != 0)
+            rc = 1;
+        bench_typo(pick, dirs[i].bad, sizeof(dirs[i].bad));
+    }
+    // 4 levels of 5 subdirectories, 8 files each: 781 dirs, 6248 files
+    tree.count = 0;
+    snprintf(tree.dir, sizeof(tree.dir), "%s/tree", bench_root);
+    tree.bad[0] = '\0';
+    if (bench_tree(tree.dir, 4, 5, 8, false) != 0)
+        rc = 1;
+    if (rc != 0)
+        fprintf(stderr, "squid-bench: could not generate every input under %s\n", bench_root);
+    unsigned long long generated = bench_now_ns();
+
+    const bench_case_t cases[] = {
+        { "levenshtein/short",                run_levenshtein_short,       NULL,      false },
+        { "levenshtein/long",                 run_levenshtein_long,        NULL,      false },
+        { "jaccard/short",                    run_jaccard_short,           NULL,      false },
+        { "jaccard/long",                     run_jaccard_long,            NULL,      false },
+        { "similarity",                       run_similarity,              NULL,      false },
+        { "suggest_command/10",               run_suggest_command,         &cands[0], false },
+        { "suggest_command/1000",             run_suggest_command,         &cands[1], false },
+        { "suggest_command/100000",           run_suggest_command,         &cands[2], false },
+        { "index_suggest/100000",             run_index_suggest,           &cands[2], false },
+        { "path_suggest/1000",                run_path_suggest,            &dirs[0],  false },
+        { "path_suggest/10000",               run_path_suggest,            &dirs[1],  false },
+        { "danger_analyze/dir",               run_danger_analyze,          &dirs[1],  true },
+        { "danger_analyze/dir/nocache",       run_danger_analyze_uncached, &dirs[1],  false },
+        { "danger_analyze_tree/7029",         run_danger_tree,             &tree,     true },
+        { "danger_analyze_tree/7029/nocache", run_danger_tree_uncached,    &tree,     false },
+    };
+    const int case_count = (int)(sizeof(cases) / sizeof(cases[0]));
+    bench_result_t results[sizeof(cases) / sizeof(cases[0])];
+    int done = 0;
+
+    if (!json)
+        printf("%-34s %12s %14s %12s\n", "case", "iterations", "ns/op", "allocs/op");
+    for (int i = 0; i < case_count; i++)
+    {
+        if (filter && !strstr(cases[i].name, filter))
+            continue;
+        if (cases[i].settled)
+        {
+            // let the cache accept the freshly generated directories
+            unsigned long long age = bench_now_ns() - generated;
+            if (age < 3000000000ULL)
+                bench_sleep_ms((3000000000ULL - age) / 1000000ULL);
+        }
+        bench_measure(&cases[i], min_ns, runs, &results[done]);
+        if (!json)
+        {
+            printf("%-34s %12llu %14.1f ", results[done].name, results[done].iterations, results[done].ns_per_op);
+            if (BENCH_COUNTS_ALLOCS)
+                printf("%12.2f\n", results[done].allocs_per_op);
+            else
+                printf("%12s\n", "n/a");
+            fflush(stdout);
+        }
+        done++;
+    }
+
+    if (json)
+    {
+        fossil_squid_json_t w;
+        fossil_squid_json_init(&w);
+        fossil_squid_json_object_begin(&w);
+        fossil_squid_json_field_string(&w, "suite", "squid-bench");
+        fossil_squid_json_field_string(&w, "version", FOSSIL_APP_VERSION);
+        fossil_squid_json_field_int(&w, "runs", runs);
+        fossil_squid_json_field_uint(&w, "min_batch_ns", min_ns);
+        fossil_squid_json_field_bool(&w, "allocations_counted", BENCH_COUNTS_ALLOCS != 0);
+        fossil_squid_json_key(&w, "results");
+        fossil_squid_json_array_begin(&w);
+        for (int i = 0; i < done; i++)
+        {
+            fossil_squid_json_object_begin(&w);
+            fossil_squid_json_field_string(&w, "name", results[i].name);
+            fossil_squid_json_field_uint(&w, "iterations", results[i].iterations);
+            fossil_squid_json_field_double(&w, "ns_per_op", results[i].ns_per_op, 1);
+            fossil_squid_json_field_double(&w, "min_ns_per_op", results[i].min_ns_per_op, 1);
+            fossil_squid_json_field_double(&w, "max_ns_per_op", results[i].max_ns_per_op, 1);
+            fossil_squid_json_key(&w, "allocs_per_op");
+            if (BENCH_COUNTS_ALLOCS)
+                fossil_squid_json_double(&w, results[i].allocs_per_op, 3);
+            else
+                fossil_squid_json_null(&w);
+            fossil_squid_json_object_end(&w);
+        }
+        fossil_squid_json_array_end(&w);
+        fossil_squid_json_object_end(&w);
+        if (fossil_squid_json_flush(&w) != 0)
+            rc = 1;
+        fossil_squid_json_dispose(&w);
+    }
+
+    for (int i = 0; i < 3; i++)
+        bench_candidates_free(&cands[i]);
+    for (int i = 0; i < 2; i++)
+        bench_flat_dir(dirs[i].dir, dirs[i].count, true, NULL, 0);
+    bench_tree(tree.dir, 4, 5, 8, true);
+    {
+        char cache[768];
+        snprintf(cache, sizeof(cache), "%s/squid/danger.cache", bench_root);
+        remove(cache);
+        snprintf(cache, sizeof(cache), "%s/squid", bench_root);
+        bench_rmdir(cache);
+    }
+    bench_rmdir(bench_root);
+    return rc;
+}
@@ -64,6 +64,16 @@ void show_commands(char *app_name)
     fossil_io_printf("{bright_black}    --signal <pid> <sig>  Send signal\n");
     fossil_io_printf("{bright_black}    --wait <pid> [--timeout <ms>]  Wait for process exit\n");
     fossil_io_printf("{bright_black}    --spawn <exe> [args...]  Start new process\n");
+    fossil_io_printf("{bright_black}    --top [--interval <ms>] [--count <n>]  Refreshing view of the busiest processes\n");
+    fossil_io_printf("{bright_black}    --tree                Show process hierarchy with subtree totals\n");
+    fossil_io_printf("{bright_black}    --subtree <pid>       Show one process and its descendants\n");
+    fossil_io_printf("{bright_black}    --sort <key>          Order by cpu, mem, vmem, threads or pid\n");
+    fossil_io_printf("{bright_black}    --limit <n>           Show at most n processes\n");
+    fossil_io_printf("{bright_black}    --match <pattern>     Filter by glob over name or command line\n");
+    fossil_io_printf("{bright_black}    --match-on <field>    Match any, name, exe or cmdline\n");
+    fossil_io_printf("{bright_black}    --regex               Treat --match as an extended regex\n");
+    fossil_io_printf("{bright_black}    --ignore-case         Ignore case in --match\n");
+    fossil_io_printf("{bright_black}    --json                Output in JSON format\n");
 
     fossil_io_printf("{cyan}  service          {reset}Manage system services\n");
     fossil_io_printf("{bright_black}    --list                Show services\n");
@@ -144,7 +154,8 @@ void show_commands(char *app_name)
     fossil_io_printf("{bright_black}    --json                Structured output\n");
 
     fossil_io_printf("{cyan}  ping             {reset}Test host reachability and latency\n");
-    fossil_io_printf("{bright_black}    --host <hostname>     Specify host to ping\n");
+    fossil_io_printf("{bright_black}    --host <hostname>     Specify host or CIDR to ping (repeatable)\n");
+    fossil_io_printf("{bright_black}    --hosts-file <path>   Read hosts from file, one per line\n");
     fossil_io_printf("{bright_black}    --count <n>           Number of ping requests\n");
     fossil_io_printf("{bright_black}    --timeout <ms>        Timeout per request\n");
     fossil_io_printf("{bright_black}    --interval <ms>       Interval between pings\n");
@@ -155,6 +166,7 @@ void show_commands(char *app_name)
     fossil_io_printf("{bright_black}    --tcp                 Use TCP scan\n");
     fossil_io_printf("{bright_black}    --udp                 Use UDP scan\n");
     fossil_io_printf("{bright_black}    --timeout <ms>        Timeout per port\n");
+    fossil_io_printf("{bright_black}    --concurrency <n>     Connects kept in flight\n");
     fossil_io_printf("{bright_black}    --json                Output results as JSON\n");
 
     fossil_io_printf("{cyan}  help             {reset}Display help for commands\n");
@@ -205,9 +217,6 @@ bool app_entry(int argc, char **argv)
             ccstring suggested = fossil_it_magic_suggest_command(argv[i], supported_commands, num_supported, &ti_reason);
             if (cnotnull(suggested))
             {
-                int jaccard = fossil_it_magic_jaccard_index(argv[i], suggested);
-                int edit_dist = fossil_it_magic_levenshtein_distance(argv[i], suggested);
-                float similarity = fossil_it_magic_similarity(argv[i], suggested);
                 fossil_io_printf(
                     "{yellow}Did you mean: {cyan}%s{yellow}?{reset}\n"
                     "  {bright_cyan}TI Reason:{reset} {magenta}%s{reset} "
@@ -219,9 +228,9 @@ bool app_entry(int argc, char **argv)
                     "{blue}ci:{reset} {yellow}%d{reset})\n",
                     suggested,
                     ti_reason.reason,
-                    edit_dist,
-                    similarity,
-                    jaccard,
+                    ti_reason.edit_distance,
+                    ti_reason.similarity,
+                    ti_reason.jaccard_index,
                     ti_reason.prefix_match,
                     ti_reason.suffix_match,
                     ti_reason.case_insensitive);
@@ -292,11 +301,12 @@ bool app_entry(int argc, char **argv)
         }
         else if (fossil_io_cstring_compare(argv[i], "process") == 0)
         {
-            bool show_all = false;
+            bool show_all = false, json = false, top = false, tree = false, match_regex = false, match_icase = false;
+            int top_interval_ms = 0, top_count = 0, subtree_pid = -1, limit = 0;
             int pid = -1, exists_pid = -1, info_pid = -1, env_pid = -1, exe_pid = -1, ppid_pid = -1, priority_pid = -1;
             int set_priority_pid = -1, set_priority_value = 0, suspend_pid = -1, resume_pid = -1, terminate_pid = -1, kill_pid = -1;
             int signal_pid = -1, signal_value = 0, wait_pid = -1, wait_timeout_ms = 0;
-            ccstring name_pattern = cnull, spawn_exe = cnull;
+            ccstring name_pattern = cnull, spawn_exe = cnull, sort_key = cnull, match_pattern = cnull, match_field = cnull;
             ccstring spawn_args_buf[32] = {0};
             int spawn_args_count = 0;
 
@@ -342,6 +352,30 @@ bool app_entry(int argc, char **argv)
                     wait_pid = atoi(argv[++j]);
                 else if (fossil_io_cstring_compare(argv[j], "--timeout") == 0 && j + 1 < argc)
                     wait_timeout_ms = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--top") == 0)
+                    top = true;
+                else if (fossil_io_cstring_compare(argv[j], "--interval") == 0 && j + 1 < argc)
+                    top_interval_ms = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--count") == 0 && j + 1 < argc)
+                    top_count = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--tree") == 0)
+                    tree = true;
+                else if (fossil_io_cstring_compare(argv[j], "--subtree") == 0 && j + 1 < argc)
+                    subtree_pid = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--sort") == 0 && j + 1 < argc)
+                    sort_key = argv[++j];
+                else if (fossil_io_cstring_compare(argv[j], "--limit") == 0 && j + 1 < argc)
+                    limit = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--match") == 0 && j + 1 < argc)
+                    match_pattern = argv[++j];
+                else if (fossil_io_cstring_compare(argv[j], "--match-on") == 0 && j + 1 < argc)
+                    match_field = argv[++j];
+                else if (fossil_io_cstring_compare(argv[j], "--regex") == 0)
+                    match_regex = true;
+                else if (fossil_io_cstring_compare(argv[j], "--ignore-case") == 0)
+                    match_icase = true;
+                else if (fossil_io_cstring_compare(argv[j], "--json") == 0)
+                    json = true;
                 else if (fossil_io_cstring_compare(argv[j], "--spawn") == 0 && j + 1 < argc)
                 {
                     spawn_exe = argv[++j];
@@ -360,7 +394,9 @@ bool app_entry(int argc, char **argv)
                 show_all, pid, name_pattern, exists_pid, info_pid, env_pid, exe_pid, ppid_pid, priority_pid,
                 set_priority_pid, set_priority_value, suspend_pid, resume_pid, terminate_pid, kill_pid,
                 signal_pid, signal_value, wait_pid, wait_timeout_ms, spawn_exe,
-                spawn_args_count > 0 ? (ccstring const *)spawn_args_buf : cnull);
+                spawn_args_count > 0 ? (ccstring const *)spawn_args_buf : cnull,
+                top, top_interval_ms, top_count, tree, subtree_pid, sort_key, limit,
+                match_pattern, match_field, match_regex, match_icase, json);
         }
         else if (fossil_io_cstring_compare(argv[i], "system") == 0)
         {
@@ -488,7 +524,7 @@ bool app_entry(int argc, char **argv)
         {
             bool system = false, arch = false, memory = false, endianness = false, power = false, cpu = false, gpu = false;
             bool storage = false, env = false, virtualization = false, uptime = false, network = false, process = false;
-            bool limits = false, time = false, hardware = false, display = false, all = false, json = false;
+            bool limits = false, time = false, hardware = false, display = false, all = false, no_cache = false, json = false;
             for (int j = i + 1; j < argc; j++)
             {
                 if (fossil_io_cstring_compare(argv[j], "--system") == 0)
@@ -527,15 +563,19 @@ bool app_entry(int argc, char **argv)
                     display = true;
                 else if (fossil_io_cstring_compare(argv[j], "--all") == 0)
                     all = true;
+                else if (fossil_io_cstring_compare(argv[j], "--no-cache") == 0)
+                    no_cache = true;
                 else if (fossil_io_cstring_compare(argv[j], "--json") == 0)
                     json = true;
                 i = j;
             }
-            fossil_squid_this(system, arch, memory, endianness, power, cpu, gpu, storage, env, virtualization, uptime, network, process, limits, time, hardware, display, all, json);
+            fossil_squid_this(system, arch, memory, endianness, power, cpu, gpu, storage, env, virtualization, uptime, network, process, limits, time, hardware, display, all, no_cache, json);
         }
         else if (fossil_io_cstring_compare(argv[i], "ping") == 0)
         {
-            ccstring host = cnull;
+            ccstring *hosts = (ccstring *)fossil_sys_memory_calloc((size_t)argc, sizeof(ccstring));
+            int host_count = 0;
+            ccstring hosts_file = cnull;
             int count = 4;
             int interval_ms = 1000;
             int timeout_ms = 1000;
@@ -544,8 +584,10 @@ bool app_entry(int argc, char **argv)
 
             for (int j = i + 1; j < argc; j++)
             {
-                if (fossil_io_cstring_compare(argv[j], "--host") == 0 && j + 1 < argc)
-                    host = argv[++j];
+                if (fossil_io_cstring_compare(argv[j], "--host") == 0 && j + 1 < argc && cnotnull(hosts))
+                    hosts[host_count++] = argv[++j];
+                else if (fossil_io_cstring_compare(argv[j], "--hosts-file") == 0 && j + 1 < argc)
+                    hosts_file = argv[++j];
                 else if (fossil_io_cstring_compare(argv[j], "--count") == 0 && j + 1 < argc)
                     count = atoi(argv[++j]);
                 else if (fossil_io_cstring_compare(argv[j], "--interval") == 0 && j + 1 < argc)
@@ -567,10 +609,11 @@ bool app_entry(int argc, char **argv)
                 i = j;
             }
 
-            if (cnotnull(host))
-                fossil_squid_ping(host, count, interval_ms, timeout_ms, ipv4, ipv6, tcp_port, stats_only, flood, json);
+            if (host_count > 0 || cnotnull(hosts_file))
+                fossil_squid_ping(hosts, host_count, hosts_file, count, interval_ms, timeout_ms, ipv4, ipv6, tcp_port, stats_only, flood, json);
             else
-                fossil_io_printf("{red}Error: --host is required for ping{reset}\n");
+                fossil_io_printf("{red}Error: --host or --hosts-file is required for ping{reset}\n");
+            fossil_sys_memory_free(hosts);
         }
         else if (fossil_io_cstring_compare(argv[i], "scan") == 0)
         {
@@ -578,6 +621,7 @@ bool app_entry(int argc, char **argv)
             ccstring ports = cnull;
             int top_n = 0;
             int timeout_ms = 1000;
+            int concurrency = 1024;
             bool tcp = false, udp = false, service = false, banner = false, open_only = false, json = false;
 
             for (int j = i + 1; j < argc; j++)
@@ -590,6 +634,8 @@ bool app_entry(int argc, char **argv)
                     top_n = atoi(argv[++j]);
                 else if (fossil_io_cstring_compare(argv[j], "--timeout") == 0 && j + 1 < argc)
                     timeout_ms = atoi(argv[++j]);
+                else if (fossil_io_cstring_compare(argv[j], "--concurrency") == 0 && j + 1 < argc)
+                    concurrency = atoi(argv[++j]);
                 else if (fossil_io_cstring_compare(argv[j], "--tcp") == 0)
                     tcp = true;
                 else if (fossil_io_cstring_compare(argv[j], "--udp") == 0)
@@ -606,7 +652,7 @@ bool app_entry(int argc, char **argv)
             }
 
             if (cnotnull(host))
-                fossil_squid_scan(host, ports, top_n, timeout_ms, tcp, udp, service, banner, open_only, json);
+                fossil_squid_scan(host, ports, top_n, timeout_ms, concurrency, tcp, udp, service, banner, open_only, json);
             else
                 fossil_io_printf("{red}Error: --host is required for scan{reset}\n");
         }
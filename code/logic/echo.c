@@ -23,6 +23,7 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/code/commands.h"
+#include "fossil/code/json.h"
 
 int fossil_squid_echo(
     ccstring text,
@@ -155,11 +156,35 @@ int fossil_squid_echo(
         }
     }
 
+    const char *env_val = NULL;
     if (env_key && *env_key) {
-        const char *env_val = fossil_sys_env_get(env_key);
+        env_val = fossil_sys_env_get(env_key);
         if (!env_val) {
             fossil_io_error("[%s] %s", "config.env", fossil_io_what("config.env"));
         }
+    }
+
+    if (json) {
+        /* color tags would corrupt the document, so JSON is always plain */
+        fossil_squid_json_t doc;
+        fossil_squid_json_init(&doc);
+        fossil_squid_json_object_begin(&doc);
+        if (env_key && *env_key) {
+            fossil_squid_json_key(&doc, "env");
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_string(&doc, "key", env_key);
+            fossil_squid_json_field_string(&doc, "value", env_val);
+            fossil_squid_json_object_end(&doc);
+        }
+        fossil_squid_json_field_string(&doc, "text", transformed);
+        fossil_squid_json_object_end(&doc);
+        int rc = fossil_squid_json_flush(&doc);
+        fossil_squid_json_dispose(&doc);
+        fossil_io_cstring_free(transformed);
+        return rc == 0 ? fossil_io_code("system.ok") : fossil_io_code("memory.alloc");
+    }
+
+    if (env_key && *env_key) {
         if (env_val) {
             if (color) {
                 fossil_io_printf("{cyan,bold}%s:{reset} %s ", env_key, env_val);
@@ -175,18 +200,10 @@ int fossil_squid_echo(
         }
     }
 
-    if (json) {
-        if (color) {
-            fossil_io_printf("{green}{bold}\"%s\"{reset}\n", transformed);
-        } else {
-            fossil_io_printf("\"%s\"\n", transformed);
-        }
+    if (color) {
+        fossil_io_printf("{yellow}%s{reset}\n", transformed);
     } else {
-        if (color) {
-            fossil_io_printf("{yellow}%s{reset}\n", transformed);
-        } else {
-            fossil_io_puts(transformed);
-        }
+        fossil_io_puts(transformed);
     }
 
     fossil_io_cstring_free(transformed);
@@ -28,6 +28,12 @@
 #include "common.h"
 #include "commands.h"
 #include "magic.h"
+#include "probe.h"
+#include "latency.h"
+#include "json.h"
+#include "task.h"
+#include "proctab.h"
+#include "procmatch.h"
 
 #define FOSSIL_APP_NAME "Squid Tool"
 #define FOSSIL_APP_VERSION "0.1.2"
@@ -64,6 +64,19 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual);
  * @param wait_timeout_ms Timeout in milliseconds for wait (optional, --timeout <ms>)
  * @param spawn_exe Start new process (--spawn <exe>)
  * @param spawn_args Arguments for spawned process (NULL-terminated array)
+ * @param top Refresh a view of the busiest processes (--top)
+ * @param top_interval_ms Milliseconds between refreshes, or 0 for 2000 (--interval <ms>)
+ * @param top_count Refreshes before exiting, or 0 to run until interrupted (--count <n>)
+ * @param tree Show every process as a hierarchy with subtree totals (--tree)
+ * @param subtree_pid Show only this process and its descendants (--subtree <pid>)
+ * @param sort_key Order rows by cpu, mem, vmem, threads or pid, or NULL for the view's default (--sort <key>)
+ * @param limit Show at most this many rows, or 0 for all (--limit <n>)
+ * @param match_pattern List processes matching this glob, or regex with match_regex (--match <pattern>);
+ *        --name, when also given, is applied first
+ * @param match_field Field --match tests: any, name, exe or cmdline, or NULL for any (--match-on <field>)
+ * @param match_regex Treat match_pattern as a POSIX extended regular expression (--regex)
+ * @param match_icase Ignore case in match_pattern (--ignore-case)
+ * @param json Output listings and lookups as a JSON document (--json)
  * @return 0 on success, non-zero on error
  */
 int fossil_squid_process(
@@ -87,7 +100,19 @@ int fossil_squid_process(
     int wait_pid,
     int wait_timeout_ms,
     ccstring spawn_exe,
-    ccstring const *spawn_args
+    ccstring const *spawn_args,
+    bool top,
+    int top_interval_ms,
+    int top_count,
+    bool tree,
+    int subtree_pid,
+    ccstring sort_key,
+    int limit,
+    ccstring match_pattern,
+    ccstring match_field,
+    bool match_regex,
+    bool match_icase,
+    bool json
 );
 
 /**
@@ -189,6 +214,10 @@ int fossil_squid_echo(
 
 /**
  * Display a comprehensive system profile with lookup features for each major host property.
+ * Selected sections are collected concurrently, each against its own deadline,
+ * and printed in canonical order; a section that misses its deadline is
+ * reported as timed out instead of stalling the profile. CPU, architecture,
+ * endianness and hardware are cached per boot and reused until reboot.
  * @param system Show OS, kernel, hostname, user, domain, platform
  * @param arch Show architecture, CPU, cores, threads, frequency
  * @param memory Show memory details (total, free, used, available, swap)
@@ -207,6 +236,7 @@ int fossil_squid_echo(
  * @param hardware Show hardware info (manufacturer, product, serial, BIOS)
  * @param display Show display info (count, resolution, refresh rate)
  * @param all Show all information
+ * @param no_cache Re-probe static sections instead of using the boot-scoped cache (--no-cache)
  * @param json Output in JSON format
  * @return 0 on success, non-zero on error
  */
@@ -228,11 +258,18 @@ int fossil_squid_this(bool system,
                          bool hardware,
                          bool display,
                          bool all,
+                         bool no_cache,
                          bool json);
 
 /**
- * Test reachability and latency to a host.
- * @param host Target hostname or IP (--host <addr>)
+ * Test reachability and latency to one or many hosts.
+ * Every target runs its own probe schedule from a single event loop, so a
+ * fleet sweep finishes in about one interval per round instead of one per host.
+ * Round-trip times are kept in a log-bucketed histogram per host and reported
+ * as min/max/mean/stddev/jitter plus p50/p90/p99/p99.9.
+ * @param hosts Target hostnames, IPs or CIDR blocks, IPv4 up to /16 and IPv6 up to /112 (--host <addr>, repeatable)
+ * @param host_count Number of entries in hosts
+ * @param hosts_file File with one host or CIDR per line (--hosts-file <path>)
  * @param count Number of packets to send (--count <n>)
  * @param interval_ms Delay between pings in milliseconds (--interval <ms>)
  * @param timeout_ms Timeout per packet in milliseconds (--timeout <ms>)
@@ -242,10 +279,12 @@ int fossil_squid_this(bool system,
  * @param stats_only Show summary statistics only (--stats)
  * @param flood Enable rapid ping mode (--flood)
  * @param json Output in JSON format (--json)
- * @return 0 on success, non-zero on error
+ * @return 0 if at least one host answered, non-zero otherwise
  */
 int fossil_squid_ping(
-    ccstring host,
+    ccstring const *hosts,
+    int host_count,
+    ccstring hosts_file,
     int count,
     int interval_ms,
     int timeout_ms,
@@ -259,10 +298,13 @@ int fossil_squid_ping(
 
 /**
  * Scan ports and detect services on a host.
+ * Ports that answer with a reset are reported closed; ports that stay silent
+ * until the deadline are reported filtered.
  * @param host Target hostname or IP (--host <addr>)
  * @param ports Port range string (e.g. "1-1024") (--ports <range>)
  * @param top_n Scan top N common ports (--top <n>)
  * @param timeout_ms Timeout per probe in milliseconds (--timeout <ms>)
+ * @param concurrency Maximum connects kept in flight (--concurrency <n>)
  * @param tcp Use TCP scanning (--tcp)
  * @param udp Use UDP scanning (--udp)
  * @param service Detect service types (--service)
@@ -276,6 +318,7 @@ int fossil_squid_scan(
     ccstring ports,
     int top_n,
     int timeout_ms,
+    int concurrency,
     bool tcp,
     bool udp,
     bool service,
@@ -0,0 +1,129 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_JSON_H
+#define FOSSIL_APP_JSON_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * JSON Writer Types
+ * ========================================================================== */
+
+/** Maximum nesting of objects and arrays. */
+#define FOSSIL_SQUID_JSON_MAX_DEPTH 32
+
+/**
+ * @brief Streaming JSON document writer.
+ *
+ * Values are appended to a growable buffer with commas and escaping handled
+ * by the writer; the finished document is written to stdout in one flush.
+ * Out-of-memory is sticky and reported by the flush.
+ */
+typedef struct fossil_squid_json_s {
+    char *buf;                                    /**< Document text */
+    size_t len;                                   /**< Bytes used */
+    size_t cap;                                   /**< Bytes allocated */
+    int depth;                                    /**< Current nesting level */
+    bool first[FOSSIL_SQUID_JSON_MAX_DEPTH];      /**< No member written yet at this level */
+    bool after_key;                               /**< A key is waiting for its value */
+    bool failed;                                  /**< Allocation or nesting error */
+} fossil_squid_json_t;
+
+/* ==========================================================================
+ * JSON Writer
+ * ========================================================================== */
+
+/** @brief Prepare an empty writer. */
+void fossil_squid_json_init(fossil_squid_json_t *w);
+
+/** @brief Release the writer's buffer. */
+void fossil_squid_json_dispose(fossil_squid_json_t *w);
+
+/** @brief Open an object (as a value, array element or document root). */
+void fossil_squid_json_object_begin(fossil_squid_json_t *w);
+
+/** @brief Close the innermost object. */
+void fossil_squid_json_object_end(fossil_squid_json_t *w);
+
+/** @brief Open an array. */
+void fossil_squid_json_array_begin(fossil_squid_json_t *w);
+
+/** @brief Close the innermost array. */
+void fossil_squid_json_array_end(fossil_squid_json_t *w);
+
+/** @brief Write an object member name; the next value belongs to it. */
+void fossil_squid_json_key(fossil_squid_json_t *w, const char *key);
+
+/** @brief Write an escaped string value, or null when value is NULL. */
+void fossil_squid_json_string(fossil_squid_json_t *w, const char *value);
+
+/** @brief Write at most len bytes of value as an escaped string. */
+void fossil_squid_json_string_n(fossil_squid_json_t *w, const char *value, size_t len);
+
+/** @brief Write a signed integer value. */
+void fossil_squid_json_int(fossil_squid_json_t *w, long long value);
+
+/** @brief Write an unsigned integer value. */
+void fossil_squid_json_uint(fossil_squid_json_t *w, unsigned long long value);
+
+/** @brief Write a number with fixed decimals; NaN and infinity become null. */
+void fossil_squid_json_double(fossil_squid_json_t *w, double value, int decimals);
+
+/** @brief Write true or false. */
+void fossil_squid_json_bool(fossil_squid_json_t *w, bool value);
+
+/** @brief Write null. */
+void fossil_squid_json_null(fossil_squid_json_t *w);
+
+/** @brief Shorthand for key + string. */
+void fossil_squid_json_field_string(fossil_squid_json_t *w, const char *key, const char *value);
+
+/** @brief Shorthand for key + signed integer. */
+void fossil_squid_json_field_int(fossil_squid_json_t *w, const char *key, long long value);
+
+/** @brief Shorthand for key + unsigned integer. */
+void fossil_squid_json_field_uint(fossil_squid_json_t *w, const char *key, unsigned long long value);
+
+/** @brief Shorthand for key + fixed-decimal number. */
+void fossil_squid_json_field_double(fossil_squid_json_t *w, const char *key, double value, int decimals);
+
+/** @brief Shorthand for key + boolean. */
+void fossil_squid_json_field_bool(fossil_squid_json_t *w, const char *key, bool value);
+
+/**
+ * @brief Write the document and a trailing newline to stdout, then reset.
+ * @return 0 on success, non-zero if the document is incomplete or failed
+ */
+int fossil_squid_json_flush(fossil_squid_json_t *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_JSON_H */
@@ -0,0 +1,109 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_LATENCY_H
+#define FOSSIL_APP_LATENCY_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * Latency Histogram Types
+ * ========================================================================== */
+
+/** Sub-buckets per power of two; 2^5 keeps every bucket within ~3% of its value. */
+#define FOSSIL_SQUID_LATENCY_SUB_BITS 5
+/** Values at or above 2^36 ns (~68 s) land in the last bucket. */
+#define FOSSIL_SQUID_LATENCY_MAX_BITS 36
+#define FOSSIL_SQUID_LATENCY_BUCKETS \
+    ((1 << FOSSIL_SQUID_LATENCY_SUB_BITS) * (FOSSIL_SQUID_LATENCY_MAX_BITS - FOSSIL_SQUID_LATENCY_SUB_BITS + 1))
+
+/**
+ * @brief Log-bucketed (HDR-style) histogram of nanosecond samples.
+ *
+ * Recording is O(1) and allocation free; percentiles are read back with a
+ * bounded relative error instead of keeping every sample.
+ */
+typedef struct fossil_squid_latency_s {
+    uint32_t buckets[FOSSIL_SQUID_LATENCY_BUCKETS]; /**< Sample counts per bucket */
+    uint64_t count;                                 /**< Number of samples */
+    uint64_t min_ns;                                /**< Smallest sample */
+    uint64_t max_ns;                                /**< Largest sample */
+    double mean_ns;                                 /**< Running mean (Welford) */
+    double m2;                                      /**< Running sum of squared deviations */
+    uint64_t last_ns;                               /**< Previous sample, for jitter */
+    double jitter_sum_ns;                           /**< Sum of |x[i] - x[i-1]| */
+} fossil_squid_latency_t;
+
+/**
+ * @brief Summary statistics derived from a histogram.
+ */
+typedef struct fossil_squid_latency_summary_s {
+    uint64_t count;     /**< Number of samples */
+    double min_ms;      /**< Fastest sample */
+    double max_ms;      /**< Slowest sample */
+    double mean_ms;     /**< Arithmetic mean */
+    double stddev_ms;   /**< Sample standard deviation */
+    double jitter_ms;   /**< Mean absolute difference of consecutive samples */
+    double p50_ms;      /**< Median */
+    double p90_ms;      /**< 90th percentile */
+    double p99_ms;      /**< 99th percentile */
+    double p999_ms;     /**< 99.9th percentile */
+} fossil_squid_latency_summary_t;
+
+/* ==========================================================================
+ * Latency Histogram
+ * ========================================================================== */
+
+/**
+ * @brief Clear all samples.
+ */
+void fossil_squid_latency_reset(fossil_squid_latency_t *h);
+
+/**
+ * @brief Record one sample in nanoseconds.
+ */
+void fossil_squid_latency_record(fossil_squid_latency_t *h, uint64_t ns);
+
+/**
+ * @brief Value at the given percentile (0.0 - 100.0), in nanoseconds.
+ *
+ * Returns the midpoint of the bucket holding that rank, clamped to the
+ * observed min/max, or 0 when the histogram is empty.
+ */
+uint64_t fossil_squid_latency_percentile(const fossil_squid_latency_t *h, double percentile);
+
+/**
+ * @brief Compute min/max/mean/stddev/jitter and p50/p90/p99/p99.9 in milliseconds.
+ */
+void fossil_squid_latency_summarize(const fossil_squid_latency_t *h, fossil_squid_latency_summary_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_LATENCY_H */
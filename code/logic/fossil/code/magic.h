@@ -39,7 +39,7 @@ extern "C" {
  * @brief A scored path suggestion result.
  */
 typedef struct fossil_ti_path_suggestion_s {
-    char  candidate_path[512];   /**< Valid filesystem path */
+    char  candidate_path[1024];  /**< Valid filesystem path */
     float similarity_score;      /**< 0.0 - 1.0 ("edit distance" ↔ "semantic similarity") */
     int   exists;                /**< Non-zero if path exists on disk */
 } fossil_ti_path_suggestion_t;
@@ -50,6 +50,7 @@ typedef struct fossil_ti_path_suggestion_s {
 typedef struct fossil_ti_path_suggestion_set_s {
     fossil_ti_path_suggestion_t list[16]; /**< Up to 16 ranked matches */
     int count;                             /**< Number of valid entries in list */
+    int source_index;                      /**< Argument these matches correct (reports only) */
 } fossil_ti_path_suggestion_set_t;
 
 /**
@@ -101,7 +102,7 @@ typedef struct fossil_ti_danger_item_s {
     fossil_ti_danger_level_t level;     /**< Danger level */
 
     int is_directory;                   /**< Non-zero if directory */
-    int contains_code;                  /**< Non-zero if contains code files (.c, .h, .cpp, .py, etc.) */
+    int contains_code;                  /**< Non-zero for a code file, a git checkout, or a walked tree holding either */
     int contains_vcs;                   /**< Non-zero if VCS detected (.git, .svn) */
     int contains_secrets;               /**< Non-zero if secret files detected (.env, .key, .pem) */
     int large_size;                     /**< Non-zero if large (> threshold) */
@@ -111,8 +112,28 @@ typedef struct fossil_ti_danger_item_s {
     int suspicious_extension;           /**< Non-zero if file has suspicious extension (.exe, .dll, etc.) */
     int recently_modified;              /**< Non-zero if modified in last 24 hours */
     int contains_suspicious_files;      /**< Non-zero if directory contains suspicious files */
+
+    /* Filled only by fossil_it_magic_danger_analyze_tree */
+    int tree_walked;                    /**< Non-zero if the fields below describe the whole tree */
+    int tree_truncated;                 /**< Non-zero if a budget, CRITICAL or an unreadable directory left the walk incomplete */
+    unsigned long long tree_bytes;      /**< Bytes in regular files under the path */
+    unsigned long long tree_files;      /**< Regular files seen */
+    unsigned long long tree_dirs;       /**< Directories seen, including the root */
+    long long newest_mtime;             /**< Newest modification time seen (Unix seconds) */
 } fossil_ti_danger_item_t;
 
+/**
+ * @brief Limits for a recursive danger walk; zero fields other than max_depth take the defaults.
+ */
+typedef struct fossil_ti_danger_budget_s {
+    int max_depth;                      /**< Levels below the root to descend (0 lists only the root, negative for no limit) */
+    long long max_entries;              /**< Entries examined before stopping (default 1000000) */
+    int max_ms;                         /**< Wall-clock budget in milliseconds (default 2000) */
+    int threads;                        /**< Worker threads (default one per online CPU, max 16) */
+    int scan_content;                   /**< Non-zero to look inside files for key material */
+    long long content_bytes;            /**< Bytes read from each file when scanning content (default 1 MiB) */
+} fossil_ti_danger_budget_t;
+
 /**
  * @brief Combined safety analysis for multi-target command operations.
  */
@@ -126,6 +147,32 @@ typedef struct fossil_ti_danger_report_s {
     int warning_required;                /**< Non-zero = display multi-line warning */
 } fossil_ti_danger_report_t;
 
+/**
+ * @brief Receives each batch result as soon as it is ready.
+ *
+ * Called from worker threads, one call at a time, in completion order.
+ *
+ * @param item Finished analysis
+ * @param index Position of the path in the input array
+ * @param user Pointer passed to fossil_it_magic_danger_batch
+ */
+typedef void (*fossil_ti_danger_item_fn)(const fossil_ti_danger_item_t *item, int index, void *user);
+
+/**
+ * @brief Unbounded multi-target analysis produced by fossil_it_magic_danger_batch.
+ */
+typedef struct fossil_ti_danger_batch_s {
+    fossil_ti_danger_item_t *items;      /**< One result per input path, in input order */
+    int *covered_by;                     /**< Input index of the path that already covers this one, or -1 */
+    int item_count;                      /**< Number of items */
+    int total_score;                     /**< Sum of level weights over items not covered by another */
+
+    fossil_ti_danger_level_t overall_level; /**< Max level across all items */
+
+    int block_recommended;               /**< Non-zero = halt unless --force present; set by a CRITICAL item */
+    int warning_required;                /**< Non-zero = display multi-line warning; set by a MEDIUM or worse item */
+} fossil_ti_danger_batch_t;
+
 /* ==========================================================================
  * TI Reasoning / AI Metadata
  * ========================================================================== */
@@ -142,9 +189,60 @@ typedef struct fossil_ti_reason_s {
     int         prefix_match;          /**< 1 if input is prefix of suggested */
     int         suffix_match;          /**< 1 if input is suffix of suggested */
     int         case_insensitive;      /**< 1 if match is case-insensitive */
+    int         exact_match;           /**< 1 if input equals suggested exactly */
+    float       similarity;            /**< 0.0 - 1.0 similarity before suggestion bonuses */
     const char *reason;                /**< Human-readable explanation */
 } fossil_ti_reason_t;
 
+#define FOSSIL_TI_TOKEN_SLOTS 64       /**< Token hash slots held inline; larger inputs spill to the heap */
+
+/**
+ * @brief Scoring state for one input, reused across every candidate.
+ *
+ * Holds the input length, the set of its lowercase alphanumeric tokens,
+ * as 64-bit hashes in an open-addressed table, and the case-folded match
+ * bitmasks of the edit distance kernel, so scoring a candidate only has to
+ * measure the candidate itself. Inputs of any length are accepted.
+ */
+typedef struct fossil_ti_score_ctx_s {
+    const char *input;                 /**< Input being matched (borrowed) */
+    int         input_len;             /**< strlen(input) */
+    uint64_t    peq[256];              /**< Per byte, bit i set where input[i] matches it; inputs of 1..64 only */
+    int         token_count;           /**< Distinct tokens in input */
+    int         token_capacity;        /**< Slots in the token table, a power of two */
+    uint64_t   *token_heap;            /**< Token table once spilled, NULL while token_slots is used */
+    uint64_t    token_slots[FOSSIL_TI_TOKEN_SLOTS]; /**< Inline token table, 0 = empty slot */
+} fossil_ti_score_ctx_t;
+
+/* ==========================================================================
+ * Candidate Index Types
+ * ========================================================================== */
+
+/**
+ * @brief One term in a candidate index (BK-tree node).
+ */
+typedef struct fossil_ti_bk_node_s {
+    const char *term;                  /**< Indexed candidate (borrowed) */
+    int         len;                   /**< strlen(term) */
+    uint64_t    mask;                  /**< Characters present in term, folded to 64 bits */
+    int         edge;                  /**< Edit distance to the parent term */
+    int         max_edge;              /**< Largest edge among children, 0 if none */
+    int         child;                 /**< First child node (smallest edge), -1 if none */
+    int         sibling;               /**< Next node under the same parent by edge, -1 if none */
+} fossil_ti_bk_node_t;
+
+/**
+ * @brief Reusable fuzzy-match index over a large candidate set.
+ *
+ * A BK-tree keyed by case-insensitive edit distance; lookups only score the
+ * candidates that can be within the search radius of the input.
+ */
+typedef struct fossil_ti_index_s {
+    fossil_ti_bk_node_t *nodes;        /**< Node storage, nodes[0] is the root */
+    int                  count;        /**< Number of valid nodes */
+    int                  capacity;     /**< Allocated nodes */
+} fossil_ti_index_t;
+
 /* ==========================================================================
  * Similarity Utilities
  * ========================================================================== */
@@ -153,8 +251,9 @@ typedef struct fossil_ti_reason_s {
  * @brief Compute Jaccard Index (token overlap) between two strings.
  *
  * This function splits both input strings into tokens (words), ignoring punctuation
- * and case. It then counts the number of matching tokens between the two sets,
- * and computes the Jaccard index as (matches / union of tokens), scaled to 0-100.
+ * and case, and hashes each distinct token into a small set. It then counts the
+ * tokens the two sets share and computes the Jaccard index as
+ * (intersection / union), scaled to 0-100. Strings of any length are accepted.
  * Used to measure token-level similarity, robust to word order and punctuation.
  */
 int fossil_it_magic_jaccard_index(const char *s1, const char *s2);
@@ -169,6 +268,19 @@ int fossil_it_magic_jaccard_index(const char *s1, const char *s2);
  */
 int fossil_it_magic_levenshtein_distance(const char *s1, const char *s2);
 
+/**
+ * @brief Compute Levenshtein distance, giving up once it exceeds a bound.
+ *
+ * Same metric as fossil_it_magic_levenshtein_distance. Strings up to 64 characters
+ * run a bit-parallel kernel; longer ones use a banded DP. When max_distance is
+ * non-negative, any distance above it is reported as max_distance + 1 and the
+ * computation stops as soon as that outcome is certain, so ranking loops can
+ * discard hopeless candidates cheaply. A negative max_distance means no bound.
+ *
+ * @return Distance (or max_distance + 1), INT_MAX if either string is NULL
+ */
+int fossil_it_magic_levenshtein_bounded(const char *s1, const char *s2, int max_distance);
+
 /**
  * @brief Compute a normalized similarity score (0.0 - 1.0) between two strings.
  *
@@ -183,6 +295,36 @@ float fossil_it_magic_similarity(const char *a, const char *b);
  * Command Suggestion
  * ========================================================================== */
 
+/**
+ * @brief Prepare a scoring context for an input string.
+ *
+ * Tokenizes and measures the input once; the context borrows input, which
+ * must outlive it. Release it with fossil_it_magic_score_dispose.
+ */
+void fossil_it_magic_score_init(fossil_ti_score_ctx_t *ctx, const char *input);
+
+/**
+ * @brief Release what a scoring context allocated for very long inputs.
+ *
+ * @param ctx Context to release; it must be re-initialized before reuse
+ */
+void fossil_it_magic_score_dispose(fossil_ti_score_ctx_t *ctx);
+
+/**
+ * @brief Score one candidate against a prepared input.
+ *
+ * Computes edit distance, Jaccard index, prefix/suffix/case flags and the
+ * similarity exactly once, and combines them into the suggestion confidence.
+ * Optionally fills out with the full breakdown and a reason string.
+ *
+ * @return Confidence score (0.0 - 1.0)
+ */
+float fossil_it_magic_score_candidate(
+    const fossil_ti_score_ctx_t *ctx,
+    const char *candidate,
+    fossil_ti_reason_t *out
+);
+
 /**
  * @brief Suggest the closest matching command from a list of candidates.
  *
@@ -204,6 +346,54 @@ const char *fossil_it_magic_suggest_command(
     fossil_ti_reason_t *out_reason
 );
 
+/* ==========================================================================
+ * Candidate Index
+ * ========================================================================== */
+
+/**
+ * @brief Initialize an empty candidate index.
+ */
+void fossil_it_magic_index_init(fossil_ti_index_t *index);
+
+/**
+ * @brief Release the storage held by a candidate index.
+ */
+void fossil_it_magic_index_dispose(fossil_ti_index_t *index);
+
+/**
+ * @brief Add a candidate to the index.
+ *
+ * The index borrows term, which must outlive it. Terms equal to one already
+ * indexed, ignoring case, are stored once.
+ *
+ * @return 0 on success, -1 on allocation failure or NULL arguments
+ */
+int fossil_it_magic_index_add(fossil_ti_index_t *index, const char *term);
+
+/**
+ * @brief Suggest the closest indexed candidate for an input.
+ *
+ * Visits only subtrees that can hold terms within max_distance edits of the
+ * input, then ranks those with the same scoring and 0.7 threshold as
+ * fossil_it_magic_suggest_command. A negative max_distance picks the default
+ * radius: one edit for inputs shorter than four characters, two otherwise
+ * (a swapped pair counts as two edits here).
+ *
+ * @param index Index built with fossil_it_magic_index_add
+ * @param input Input string to match
+ * @param max_distance Search radius in edits, or negative for the default
+ * @param out_reason Optional pointer to fossil_ti_reason_t for detailed scoring
+ * @return Pointer to best matching term, or NULL if none meets threshold. Also
+ *         NULL if the walk could not grow its stack; out_reason then has
+ *         edit_distance -1 and says so in reason.
+ */
+const char *fossil_it_magic_index_suggest(
+    const fossil_ti_index_t *index,
+    const char *input,
+    int max_distance,
+    fossil_ti_reason_t *out_reason
+);
+
 /* ==========================================================================
  * Path Auto-Correction
  * ========================================================================== */
@@ -211,9 +401,10 @@ const char *fossil_it_magic_suggest_command(
 /**
  * @brief Suggest paths based on similarity to a “bad” path.
  *
- * Scans the base directory, comparing each entry to the bad_path using fuzzy
- * similarity metrics. Collects up to 16 top-ranked suggestions, storing their
- * path, similarity score, and existence status in the output set.
+ * Streams every entry of the base directory, however large, comparing each
+ * to the bad_path using fuzzy similarity metrics. The 16 best are kept in a
+ * bounded heap (ties broken by name, so results do not depend on listing
+ * order) and written best-first with their path, score and existence status.
  * Used for typo correction and auto-completion of filesystem paths.
  *
  * @param bad_path The incorrect or misspelled path
@@ -226,6 +417,43 @@ void fossil_it_magic_path_suggest(
     fossil_ti_path_suggestion_set_t *out
 );
 
+/**
+ * @brief Correct a path segment by segment.
+ *
+ * Walks bad_path from its root. Segments that exist are kept as-is; a segment
+ * that does not is fuzzy-matched against its parent's entries, and the best
+ * few partial paths are carried forward (beam search) so a wrong early pick
+ * can still be recovered by later segments. Each directory is listed at most
+ * once and nothing is stat'ed, which keeps slow network filesystems cheap.
+ * Results are written best-first; the score is the product of per-segment
+ * scores. Only a path that exists exactly scores 1.0: every fuzzy segment
+ * scores below 0.99, so no correction ever ties or outranks an exact path.
+ *
+ * @param bad_path Path with one or more misspelled segments
+ * @param out Output suggestion set (filled by function)
+ */
+void fossil_it_magic_path_resolve(
+    const char *bad_path,
+    fossil_ti_path_suggestion_set_t *out
+);
+
+/**
+ * @brief Build path corrections for every argument that does not exist.
+ *
+ * Runs fossil_it_magic_path_resolve on each missing path, sharing one cache of
+ * directory listings across all of them. Up to 8 sets are filled; each records
+ * the index of the argument it corrects in source_index.
+ *
+ * @param paths Argument paths to check
+ * @param count Number of entries in paths
+ * @param report Output report (filled by function)
+ */
+void fossil_it_magic_path_report(
+    const char *const *paths,
+    int count,
+    fossil_ti_path_ai_report_t *report
+);
+
 /**
  * @brief Recover a token from a list of candidates.
  *
@@ -255,7 +483,13 @@ void fossil_it_magic_autorecovery_token(
  *
  * Inspects the given path for risk factors: code files, secrets, large size,
  * world-writable permissions, symlinks, suspicious extensions, recent modification,
- * and presence of suspicious files. Assigns a danger level based on cumulative score.
+ * and presence of suspicious files. For a directory, code, VCS, secret and
+ * suspicious-extension detection share a single pass over its entries. On
+ * POSIX the outcome of that pass is cached in $XDG_CACHE_HOME/squid/danger.cache
+ * keyed by device, inode, mtime and ctime, so an unchanged directory is not
+ * listed again; directories whose verdict depends on a subdirectory's contents
+ * are never cached, and fossil_it_magic_danger_cache_enable turns the cache
+ * off. Assigns a danger level based on cumulative score.
  * Used to warn or block risky filesystem operations.
  *
  * @param path Path to analyze
@@ -266,12 +500,68 @@ void fossil_it_magic_danger_analyze(
     fossil_ti_danger_item_t *out
 );
 
+/**
+ * @brief Turn the on-disk directory facts cache on or off.
+ *
+ * The cache is on by default. While it is off, analysis neither reads nor
+ * writes danger.cache, and a process that disables it before its first
+ * analysis never creates the file. Call before analysis starts on other
+ * threads.
+ *
+ * @param enabled Non-zero to use the cache
+ */
+void fossil_it_magic_danger_cache_enable(int enabled);
+
+/**
+ * @brief Look inside a file for key material.
+ *
+ * Maps up to max_bytes of the file and runs one multi-pattern pass for
+ * private key headers, AWS, Google, GitHub, Slack and Stripe credential
+ * formats, and password, secret, token and API-key assignments whose value
+ * looks random (Shannon entropy of at least 3.5 bits per character). Files
+ * with a NUL byte in their first 4 KiB are treated as binary and skipped.
+ *
+ * @param path File to scan
+ * @param max_bytes Bytes to examine from the start of the file, or 0 for 1 MiB
+ * @return 1 if key material was found, 0 if not, -1 if the file could not be
+ *         read or is not a regular file; a symlink is not followed and a FIFO
+ *         is refused without blocking
+ */
+int fossil_it_magic_secret_scan(const char *path, long long max_bytes);
+
+/**
+ * @brief Analyze a path and, for a directory, everything beneath it.
+ *
+ * Opt-in recursive form of fossil_it_magic_danger_analyze. The tree is walked
+ * by a work-stealing thread pool within the given depth, entry and time
+ * budgets, without following symlinks. Byte and file totals, code, VCS,
+ * secret and suspicious-extension hits and the newest mtime are aggregated
+ * into out, so large_size and recently_modified reflect the real tree. With
+ * scan_content set, regular files are also passed through
+ * fossil_it_magic_secret_scan. The walk stops as soon as the item reaches
+ * CRITICAL, since more evidence cannot change the verdict. Only the root's
+ * own analysis uses danger.cache: the walk must list every directory anyway
+ * to total its sizes and times, which the cache does not hold, so nested
+ * directories are neither looked up nor stored.
+ *
+ * @param path Path to analyze
+ * @param budget Walk limits, or NULL for the defaults (32 levels deep)
+ * @param out Output structure with analysis result
+ */
+void fossil_it_magic_danger_analyze_tree(
+    const char *path,
+    const fossil_ti_danger_budget_t *budget,
+    fossil_ti_danger_item_t *out
+);
+
 /**
  * @brief Analyze multiple paths for potential danger and summarize.
  *
  * Runs danger analysis on each path, aggregates the highest danger level and
  * total score. Sets flags to recommend blocking or warning, and provides a
  * summary reason string. Used for batch safety checks before executing commands.
+ * Only the first 8 paths are analyzed; see fossil_it_magic_danger_batch for
+ * larger sets.
  *
  * @param paths Array of paths to analyze
  * @param path_count Number of paths
@@ -283,6 +573,47 @@ void fossil_it_magic_danger_report(
     fossil_ti_danger_report_t *report
 );
 
+/**
+ * @brief Analyze any number of paths concurrently and summarize.
+ *
+ * Paths are spread over a pool of worker threads and each result is handed to
+ * on_item as soon as it completes. Repeated paths are analyzed once. With a
+ * budget, every path is walked recursively as by
+ * fossil_it_magic_danger_analyze_tree, except that a path lying inside
+ * another listed path only gets the flat analysis when the enclosing walk
+ * already covered its contents: that walk finished without hitting a budget,
+ * the path is within max_depth of it, and no symlink lies on the way down.
+ * Otherwise the nested path is walked after the enclosing one finishes.
+ * Overlap is decided on the paths as written, after removing "." segments
+ * and repeated or trailing slashes. Once every path is done the aggregate
+ * level is the worst item's, and the warning and block flags follow it
+ * alone, since a score summed over any number of targets would let enough
+ * LOW ones block. total_score counts each distinct target once.
+ *
+ * @param paths Array of paths to analyze
+ * @param path_count Number of paths
+ * @param budget Walk limits for recursive analysis, or NULL for flat analysis
+ * @param on_item Callback for each finished item, or NULL
+ * @param user Passed through to on_item
+ * @param batch Output; release with fossil_it_magic_danger_batch_dispose
+ * @return 0 on success, -1 if memory could not be allocated
+ */
+int fossil_it_magic_danger_batch(
+    const char *paths[],
+    int path_count,
+    const fossil_ti_danger_budget_t *budget,
+    fossil_ti_danger_item_fn on_item,
+    void *user,
+    fossil_ti_danger_batch_t *batch
+);
+
+/**
+ * @brief Release the arrays owned by a batch report.
+ *
+ * @param batch Batch to release; left zeroed
+ */
+void fossil_it_magic_danger_batch_dispose(fossil_ti_danger_batch_t *batch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,133 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_PROBE_H
+#define FOSSIL_APP_PROBE_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * Connect Probe Types
+ * ========================================================================== */
+
+/**
+ * @brief Outcome of a single non-blocking TCP connect attempt.
+ */
+typedef enum {
+    FOSSIL_SQUID_PROBE_PENDING = 0,   /**< Not started or still in flight */
+    FOSSIL_SQUID_PROBE_OPEN,          /**< Handshake completed */
+    FOSSIL_SQUID_PROBE_REFUSED,       /**< Peer answered with a reset */
+    FOSSIL_SQUID_PROBE_TIMEOUT,       /**< No answer before the deadline */
+    FOSSIL_SQUID_PROBE_ERROR          /**< Unreachable or local socket failure */
+} fossil_squid_probe_status_t;
+
+/**
+ * @brief A single connect target and its result.
+ *
+ * The caller fills ip/port (and optionally start_ns/user, and banner/banner_cap
+ * to capture the service's first bytes); the engine fills the rest.
+ */
+typedef struct fossil_squid_probe_s {
+    const char *ip;                      /**< Numeric IPv4/IPv6 address */
+    uint16_t port;                       /**< TCP port */
+    uint64_t start_ns;                   /**< Earliest launch, relative to run start */
+    void *user;                          /**< Caller data, untouched by the engine */
+    char *banner;                        /**< Caller buffer for the first bytes read, or NULL */
+    size_t banner_cap;                   /**< Bytes available in banner, including the terminator */
+
+    fossil_squid_probe_status_t status;  /**< Result of the attempt */
+    int error;                           /**< errno-style code for REFUSED/ERROR */
+    uint64_t rtt_ns;                     /**< Launch to completion, monotonic ns */
+    int fd;                              /**< Socket, valid only inside the callback */
+    size_t banner_len;                   /**< Bytes read into banner (NUL-terminated) */
+} fossil_squid_probe_t;
+
+/**
+ * @brief Tuning knobs for a probe run.
+ */
+typedef struct fossil_squid_probe_opts_s {
+    int concurrency;  /**< Max connects in flight (clamped to RLIMIT_NOFILE) */
+    int timeout_ms;   /**< Per-probe deadline measured from launch */
+    int banner_ms;    /**< How long an OPEN probe with a banner buffer waits for data (0 = no read) */
+} fossil_squid_probe_opts_t;
+
+/**
+ * @brief Completion callback, invoked once per probe on the engine thread.
+ *
+ * For OPEN probes the connected socket is still available in probe->fd and is
+ * closed by the engine after the callback returns; any banner has already
+ * been read.
+ */
+typedef void (*fossil_squid_probe_cb)(fossil_squid_probe_t *probe, void *ctx);
+
+/* ==========================================================================
+ * Connect Probe Engine
+ * ========================================================================== */
+
+/**
+ * @brief Monotonic clock in nanoseconds, used for deadlines and RTTs.
+ */
+uint64_t fossil_squid_probe_now_ns(void);
+
+/**
+ * @brief Run non-blocking TCP connects against every probe in the array.
+ *
+ * Keeps up to opts->concurrency connects in flight, multiplexed with epoll on
+ * Linux and poll() elsewhere, and enforces a per-probe deadline so filtered
+ * ports cost at most timeout_ms each instead of the kernel SYN retry budget.
+ * Probes are launched in array order, none before its start_ns offset, so
+ * start_ns must be non-decreasing across the array.
+ *
+ * Events that arrive while a callback holds the engine thread are collected
+ * before any deadline is judged, so a slow callback never turns a completed
+ * connect into a timeout. With opts->banner_ms set, OPEN probes that carry a
+ * banner buffer stay in the event loop until data arrives or banner_ms passes;
+ * the read never blocks other probes. The fd limit is raised for the run and
+ * restored before returning. On Windows probes run one at a time, each bounded
+ * by timeout_ms.
+ *
+ * @param probes Array of probes to run (status fields are overwritten)
+ * @param count Number of probes
+ * @param opts Concurrency and deadline settings (NULL for defaults)
+ * @param cb Optional completion callback
+ * @param ctx Context passed to cb
+ * @return 0 on success, non-zero if the engine could not start
+ */
+int fossil_squid_probe_run(
+    fossil_squid_probe_t *probes,
+    size_t count,
+    const fossil_squid_probe_opts_t *opts,
+    fossil_squid_probe_cb cb,
+    void *ctx
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_PROBE_H */
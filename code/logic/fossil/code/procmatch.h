@@ -0,0 +1,129 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_PROCMATCH_H
+#define FOSSIL_APP_PROCMATCH_H
+
+#include "proctab.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * Process Matcher Types
+ * ========================================================================== */
+
+/** Treat the pattern as a POSIX extended regular expression instead of a glob. */
+#define FOSSIL_SQUID_PROC_MATCH_REGEX 0x1u
+/** Ignore ASCII case. */
+#define FOSSIL_SQUID_PROC_MATCH_ICASE 0x2u
+
+/**
+ * @brief What a pattern is tested against.
+ */
+typedef enum fossil_squid_proc_field_e {
+    FOSSIL_SQUID_PROC_FIELD_ANY = 0,        /**< Name, then the command line if the name does not match */
+    FOSSIL_SQUID_PROC_FIELD_NAME,           /**< Short command name */
+    FOSSIL_SQUID_PROC_FIELD_EXE,            /**< Executable path */
+    FOSSIL_SQUID_PROC_FIELD_CMDLINE         /**< Arguments joined by spaces, first 128 KiB (the name, for kernel threads) */
+} fossil_squid_proc_field_t;
+
+/**
+ * @brief A compiled process pattern.
+ *
+ * Globs support *, ?, [set], [!set] and backslash escapes, and must match
+ * the whole field. Sets take ranges, [:class:] names, and [=c=] and [.c.]
+ * for single characters. Unlike fnmatch, '*' and '?' also match '/' and a
+ * leading '.', classes are ASCII whatever the locale, and a set that does
+ * not close, or names a longer collating element, is a literal '['.
+ * Regular expressions match anywhere unless anchored.
+ */
+typedef struct fossil_squid_proc_matcher_s {
+    fossil_squid_proc_field_t field;        /**< Field tested */
+    unsigned flags;                         /**< FOSSIL_SQUID_PROC_MATCH_* */
+    char *literal;                          /**< Text every match contains, checked before the pattern runs */
+    size_t literal_len;                     /**< Length of literal (0 when the pattern has none) */
+    size_t reads;                           /**< Command lines and executable paths read so far */
+
+    /* Internal */
+    char *pattern;                          /**< Copy of the pattern as given */
+    void *regex;                            /**< Compiled regular expression */
+    char *buf;                              /**< Last field read */
+    size_t buf_capacity;                    /**< Bytes allocated in buf */
+    int proc_fd;                            /**< /proc, or -1 */
+} fossil_squid_proc_matcher_t;
+
+/* ==========================================================================
+ * Process Matcher
+ * ========================================================================== */
+
+/**
+ * @brief Compile a pattern.
+ *
+ * @param m Matcher to fill
+ * @param pattern Glob, or regular expression with FOSSIL_SQUID_PROC_MATCH_REGEX
+ * @param field Field to test
+ * @param flags FOSSIL_SQUID_PROC_MATCH_* bits
+ * @return 0 on success, -1 if the pattern does not compile, regular
+ *         expressions are unavailable (Windows), or allocation fails
+ */
+int fossil_squid_proc_matcher_compile(fossil_squid_proc_matcher_t *m, const char *pattern,
+                                      fossil_squid_proc_field_t field, unsigned flags);
+
+/**
+ * @brief Test one process.
+ *
+ * Anything already in the entry is tried first: the name is tested before
+ * the command line is read, so FOSSIL_SQUID_PROC_FIELD_ANY only reads
+ * /proc/<pid>/cmdline for processes whose name is inconclusive. Every field
+ * is scanned for the pattern's required literal with a vector search before
+ * the glob or regular expression runs. Outside Linux the command line is
+ * not available and the executable path stands in for it.
+ *
+ * Not thread-safe: the field read is kept in the matcher's buffer.
+ *
+ * @return true if the process matches
+ */
+bool fossil_squid_proc_matcher_test(fossil_squid_proc_matcher_t *m, const fossil_squid_proc_t *p);
+
+/**
+ * @brief Release a compiled pattern.
+ */
+void fossil_squid_proc_matcher_dispose(fossil_squid_proc_matcher_t *m);
+
+/**
+ * @brief Look up a field by name.
+ *
+ * @param name One of "any", "name", "exe" or "cmdline"
+ * @param field Receives the field
+ * @return 0 on success, -1 if the name is unknown
+ */
+int fossil_squid_proc_field_parse(const char *name, fossil_squid_proc_field_t *field);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_PROCMATCH_H */
@@ -0,0 +1,306 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_PROCTAB_H
+#define FOSSIL_APP_PROCTAB_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * Process Table Types
+ * ========================================================================== */
+
+/** Longest process name kept, including the terminator. */
+#define FOSSIL_SQUID_PROC_NAME_MAX 64
+
+/**
+ * @brief One process as read from the kernel's process table.
+ */
+typedef struct fossil_squid_proc_s {
+    uint32_t pid;                           /**< Process ID */
+    uint32_t ppid;                          /**< Parent process ID */
+    char name[FOSSIL_SQUID_PROC_NAME_MAX];  /**< Short command name, control bytes replaced by '?' */
+    char state;                             /**< Scheduler state letter (R, S, D, Z, ...) */
+    uint32_t threads;                       /**< Thread count */
+    uint64_t rss_bytes;                     /**< Resident memory */
+    uint64_t vsize_bytes;                   /**< Virtual memory */
+    uint64_t cpu_ticks;                     /**< User plus system time, in clock ticks */
+    uint64_t start_ticks;                   /**< Start time after boot, in clock ticks */
+
+    /* Filled only by fossil_squid_proc_sample */
+    double cpu_percent;                     /**< CPU use over the last interval (100 = one core) */
+    int64_t rss_delta_bytes;                /**< Resident memory change over the last interval */
+} fossil_squid_proc_t;
+
+/**
+ * @brief Ranking used to pick which processes to show.
+ *
+ * Every key except PID ranks the largest value first; ties go to the lower
+ * pid.
+ */
+typedef enum fossil_squid_proc_sort_e {
+    FOSSIL_SQUID_PROC_SORT_PID = 0,         /**< Ascending pid (table order) */
+    FOSSIL_SQUID_PROC_SORT_CPU,             /**< CPU, then resident memory */
+    FOSSIL_SQUID_PROC_SORT_MEM,             /**< Resident memory */
+    FOSSIL_SQUID_PROC_SORT_VMEM,            /**< Virtual memory */
+    FOSSIL_SQUID_PROC_SORT_THREADS          /**< Thread count */
+} fossil_squid_proc_sort_t;
+
+/**
+ * @brief Predicate deciding whether a process takes part in a selection.
+ */
+typedef bool (*fossil_squid_proc_keep_fn)(const fossil_squid_proc_t *p, void *ctx);
+
+/**
+ * @brief Repeated process table sampler.
+ *
+ * Keeps the previous sample so CPU and memory can be reported as deltas. On
+ * Linux each known process keeps its /proc/<pid>/stat descriptor open, up to
+ * half the soft RLIMIT_NOFILE in force when the sampler is initialized, and
+ * later samples only re-read that one file. The sampler never changes the
+ * limit itself; a program that wants more descriptors held raises it first.
+ */
+typedef struct fossil_squid_proc_sampler_s {
+    fossil_squid_proc_t *procs;             /**< Latest sample, sorted by pid */
+    size_t count;                           /**< Entries in procs */
+    uint64_t samples;                       /**< Samples taken so far */
+    double interval_s;                      /**< Wall time the deltas cover (0 on the first sample) */
+    double cpu_total_percent;               /**< Whole-machine busy share over the interval */
+    double self_cpu_percent;                /**< This process's own CPU use over the interval */
+    uint32_t cpu_count;                     /**< Online CPUs */
+
+    /* Internal */
+    fossil_squid_proc_t *spare;             /**< Previous sample, reused as the next buffer */
+    int *fds;                               /**< Open stat descriptor per entry of procs, or -1 */
+    int *spare_fds;                         /**< Descriptors for spare */
+    uint32_t *pids;                         /**< Pids listed by the current sample */
+    size_t pid_capacity;                    /**< Entries allocated in pids */
+    size_t capacity;                        /**< Entries allocated in each other buffer */
+    size_t fds_open;                        /**< Descriptors currently held */
+    size_t fd_budget;                       /**< Descriptors the sampler may hold */
+    uint64_t last_ns;                       /**< Monotonic time of the previous sample */
+    uint64_t cpu_busy;                      /**< Machine busy ticks at the previous sample */
+    uint64_t cpu_all;                       /**< Machine total ticks at the previous sample */
+    uint64_t self_ns;                       /**< This process's CPU time at the previous sample */
+} fossil_squid_proc_sampler_t;
+
+/**
+ * @brief One-shot snapshot of the process table.
+ *
+ * Buffers are kept between collections, so a table that is collected
+ * repeatedly stops allocating once it has seen the largest process count.
+ */
+typedef struct fossil_squid_proc_table_s {
+    fossil_squid_proc_t *procs;             /**< Processes, sorted by pid */
+    size_t count;                           /**< Entries in procs */
+
+    /* Internal */
+    size_t capacity;                        /**< Entries allocated in procs */
+    uint32_t *pids;                         /**< Pids listed by the last collection */
+    size_t pid_capacity;                    /**< Entries allocated in pids */
+    uint64_t taken_ns;                      /**< Monotonic time the last collection started */
+} fossil_squid_proc_table_t;
+
+/**
+ * @brief Totals over a process and all of its descendants.
+ */
+typedef struct fossil_squid_proc_totals_s {
+    uint32_t processes;                     /**< Processes in the subtree, including its root */
+    uint64_t threads;                       /**< Threads across the subtree */
+    uint64_t rss_bytes;                     /**< Resident memory across the subtree */
+    double cpu_percent;                     /**< CPU across the subtree */
+} fossil_squid_proc_totals_t;
+
+/**
+ * @brief Parent/child index over a process table.
+ *
+ * All arrays are indexed by entry in the table's procs unless noted. A
+ * subtree occupies a contiguous run of order: the entry at position pos[i]
+ * followed by the rest of its totals[i].processes.
+ */
+typedef struct fossil_squid_proc_tree_s {
+    size_t count;                           /**< Entries indexed */
+    int32_t *parent;                        /**< Parent entry, or -1 for a root */
+    uint32_t *first_child;                  /**< children[first_child[i] .. first_child[i + 1]) are i's children (count + 1 entries) */
+    uint32_t *children;                     /**< Child entries grouped by parent, each group in pid order */
+    uint32_t *order;                        /**< Entries in depth-first preorder, roots in pid order */
+    uint32_t *depth;                        /**< Depth of each entry, 0 for a root */
+    uint32_t *pos;                          /**< Position of each entry in order */
+    fossil_squid_proc_totals_t *totals;     /**< Subtree totals of each entry */
+
+    /* Internal */
+    int32_t *slots;                         /**< Open-addressed pid to entry map */
+    size_t slot_mask;                       /**< Slot count minus one */
+} fossil_squid_proc_tree_t;
+
+/* ==========================================================================
+ * Process Table Snapshot
+ * ========================================================================== */
+
+/**
+ * @brief Prepare an empty table.
+ *
+ * @return 0 on success, -1 on NULL
+ */
+int fossil_squid_proc_table_init(fossil_squid_proc_table_t *t);
+
+/**
+ * @brief Release a table's buffers.
+ */
+void fossil_squid_proc_table_dispose(fossil_squid_proc_table_t *t);
+
+/**
+ * @brief Read every process into a table.
+ *
+ * On Linux the pids under /proc are split into chunks that worker threads
+ * claim in turn. Each process costs one open and one read of
+ * /proc/<pid>/stat into a buffer on the worker's stack, written straight to
+ * that pid's slot in procs, so the result comes out sorted without a merge
+ * and nothing is allocated per process. On Linux cpu_percent and
+ * rss_delta_bytes are zero until fossil_squid_proc_table_rate is given an
+ * earlier collection. Outside Linux the platform process list is used
+ * instead and cpu_percent is whatever it reports.
+ *
+ * @param t Table to fill (previous contents are replaced)
+ * @param threads Worker threads, or 0 for one per online CPU (max 16)
+ * @return 0 on success, -1 if the process table could not be read
+ */
+int fossil_squid_proc_collect(fossil_squid_proc_table_t *t, int threads);
+
+/**
+ * @brief Fill in per-interval rates from an earlier collection.
+ *
+ * Sets cpu_percent (100 = one core) and rss_delta_bytes of every process in
+ * t that is also in prev with the same start time, over the time between
+ * the two collections. Other entries are left as collected. Outside Linux
+ * only rss_delta_bytes is derived.
+ *
+ * @param t Later collection, updated in place
+ * @param prev Earlier collection
+ * @return 0 on success, -1 on NULL
+ */
+int fossil_squid_proc_table_rate(fossil_squid_proc_table_t *t, const fossil_squid_proc_table_t *prev);
+
+/* ==========================================================================
+ * Process Tree
+ * ========================================================================== */
+
+/**
+ * @brief Index a table by parent.
+ *
+ * Linear in the number of processes: pids are hashed once, children are
+ * grouped with a counting pass, and subtree totals are summed bottom-up over
+ * the preorder. A process whose parent is not in the table is a root; so is
+ * one caught in a parent cycle left by pid reuse.
+ *
+ * @param tree Index to fill (previous contents are released)
+ * @param t Table to index; it must not change while the index is in use
+ * @return 0 on success, -1 on allocation failure or NULL arguments
+ */
+int fossil_squid_proc_tree_build(fossil_squid_proc_tree_t *tree, const fossil_squid_proc_table_t *t);
+
+/**
+ * @brief Entry of a pid in an indexed table.
+ *
+ * @return Entry index, or -1 if the pid is not in the table
+ */
+int32_t fossil_squid_proc_tree_find(const fossil_squid_proc_tree_t *tree, const fossil_squid_proc_table_t *t, uint32_t pid);
+
+/**
+ * @brief Release a tree index.
+ */
+void fossil_squid_proc_tree_dispose(fossil_squid_proc_tree_t *tree);
+
+/* ==========================================================================
+ * Row Selection
+ * ========================================================================== */
+
+/**
+ * @brief Pick the best ranked processes, best first.
+ *
+ * Keeps a heap of at most limit entries whose root is the worst one held,
+ * so a process that cannot make the cut costs one comparison and the whole
+ * pass is O(n log limit) rather than a sort of every row. Ranking by pid
+ * needs no heap at all since tables are already in pid order.
+ *
+ * @param procs Processes to choose from, in ascending pid order
+ * @param count Entries in procs
+ * @param key Ranking to apply
+ * @param limit Most entries to return, or 0 for all of them
+ * @param keep Optional filter applied before ranking (NULL keeps everything)
+ * @param ctx Passed through to keep
+ * @param out Receives indexes into procs; must hold min(limit, count) entries, or count when limit is 0
+ * @return Number of indexes written to out
+ */
+size_t fossil_squid_proc_select(const fossil_squid_proc_t *procs, size_t count, fossil_squid_proc_sort_t key,
+                                size_t limit, fossil_squid_proc_keep_fn keep, void *ctx, uint32_t *out);
+
+/**
+ * @brief Look up a ranking by name.
+ *
+ * @param name One of "pid", "cpu", "mem", "vmem" or "threads"
+ * @param key Receives the ranking
+ * @return 0 on success, -1 if the name is unknown
+ */
+int fossil_squid_proc_sort_parse(const char *name, fossil_squid_proc_sort_t *key);
+
+/* ==========================================================================
+ * Process Table Sampler
+ * ========================================================================== */
+
+/**
+ * @brief Prepare an empty sampler.
+ *
+ * @return 0 on success, -1 on NULL
+ */
+int fossil_squid_proc_sampler_init(fossil_squid_proc_sampler_t *s);
+
+/**
+ * @brief Release a sampler's buffers and close its descriptors.
+ */
+void fossil_squid_proc_sampler_dispose(fossil_squid_proc_sampler_t *s);
+
+/**
+ * @brief Take one sample of every process.
+ *
+ * Lists the process table and reads each process's counters, matching them
+ * against the previous sample by pid and start time. cpu_percent and
+ * rss_delta_bytes are computed from the tick and memory differences since
+ * that sample; on the first sample, and for processes new since then, they
+ * are zero. Outside Linux the platform process list is used instead and
+ * cpu_percent is whatever it reports.
+ *
+ * @return 0 on success, -1 if the process table could not be read
+ */
+int fossil_squid_proc_sample(fossil_squid_proc_sampler_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_PROCTAB_H */
@@ -0,0 +1,112 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_APP_TASK_H
+#define FOSSIL_APP_TASK_H
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==========================================================================
+ * Deadline Task Types
+ * ========================================================================== */
+
+/**
+ * @brief Work run on a task's own thread; returns 0 on success.
+ *
+ * @param data The task's zeroed buffer from fossil_squid_tasks_add
+ */
+typedef int (*fossil_squid_task_fn)(void *data);
+
+/**
+ * @brief A set of tasks that each run on a detached thread.
+ *
+ * The set is reference counted: a task stuck in a hung call keeps it alive
+ * after the caller gives up on it, and whoever drops the last reference
+ * frees it, including every task's data buffer.
+ */
+typedef struct fossil_squid_tasks_s fossil_squid_tasks_t;
+
+/* ==========================================================================
+ * Deadline Tasks
+ * ========================================================================== */
+
+/**
+ * @brief Monotonic clock in milliseconds, the time base for task deadlines.
+ *
+ * Wall-clock steps (NTP, manual changes) neither shorten nor stretch a wait.
+ */
+uint64_t fossil_squid_tasks_now_ms(void);
+
+/**
+ * @brief Create an empty set with room for capacity tasks.
+ *
+ * @return The set, or NULL if allocation fails
+ */
+fossil_squid_tasks_t *fossil_squid_tasks_create(size_t capacity);
+
+/**
+ * @brief Add a task without starting it.
+ *
+ * @param tasks Set to add to
+ * @param fn Work to run
+ * @param size Bytes of zeroed data to hand to fn
+ * @return The task's data buffer, or NULL if the set is full or allocation fails
+ */
+void *fossil_squid_tasks_add(fossil_squid_tasks_t *tasks, fossil_squid_task_fn fn, size_t size);
+
+/**
+ * @brief Number of tasks added so far; task indexes run from 0 to count - 1.
+ */
+size_t fossil_squid_tasks_count(const fossil_squid_tasks_t *tasks);
+
+/**
+ * @brief Start a task on its own thread, or inline if no thread is available.
+ */
+void fossil_squid_tasks_start(fossil_squid_tasks_t *tasks, size_t index);
+
+/**
+ * @brief Wait for a task until an absolute deadline on the task clock.
+ *
+ * @param tasks Set holding the task
+ * @param index Task to wait for
+ * @param deadline_ms Give up at this fossil_squid_tasks_now_ms() value
+ * @param rc Receives the task's return value when it finished (may be NULL)
+ * @return true if the task finished, false if the deadline passed first
+ */
+bool fossil_squid_tasks_wait(fossil_squid_tasks_t *tasks, size_t index, uint64_t deadline_ms, int *rc);
+
+/**
+ * @brief Drop the caller's reference; tasks still running keep the set alive.
+ */
+void fossil_squid_tasks_release(fossil_squid_tasks_t *tasks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOSSIL_APP_TASK_H */
@@ -82,6 +82,19 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual)
             fossil_io_printf("  {cyan,bold}--signal <pid> <sig>{normal}        Send signal\n");
             fossil_io_printf("  {cyan,bold}--wait <pid> [--timeout <ms>]{normal} Wait for process exit\n");
             fossil_io_printf("  {cyan,bold}--spawn <exe> [args...]{normal}     Start new process\n");
+            fossil_io_printf("  {cyan,bold}--top{normal}                       Refreshing view of the busiest processes\n");
+            fossil_io_printf("  {cyan,bold}--interval <ms>{normal}             Delay between --top refreshes (default 2000)\n");
+            fossil_io_printf("  {cyan,bold}--count <n>{normal}                 Stop --top after n refreshes\n");
+            fossil_io_printf("  {cyan,bold}--tree{normal}                      Show process hierarchy with subtree totals\n");
+            fossil_io_printf("  {cyan,bold}--subtree <pid>{normal}             Show one process and its descendants\n");
+            fossil_io_printf("  {cyan,bold}--sort <key>{normal}                Order --all, --name and --top by cpu, mem, vmem, threads or pid\n");
+            fossil_io_printf("                              (listings measure CPU%% only for --sort cpu, else n/a)\n");
+            fossil_io_printf("  {cyan,bold}--limit <n>{normal}                 Show only the first n processes in that order\n");
+            fossil_io_printf("  {cyan,bold}--match <pattern>{normal}           Filter by glob (*, ?, [set]) over name, then command line\n");
+            fossil_io_printf("  {cyan,bold}--match-on <field>{normal}          Test --match against any, name, exe or cmdline\n");
+            fossil_io_printf("  {cyan,bold}--regex{normal}                     Treat --match as a POSIX extended regex\n");
+            fossil_io_printf("  {cyan,bold}--ignore-case{normal}               Ignore case in --match\n");
+            fossil_io_printf("  {cyan,bold}--json{normal}                      Output listings and lookups as JSON\n");
         }
         else if (fossil_io_cstring_equals(command, "service"))
         {
@@ -171,6 +184,7 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual)
             fossil_io_printf("  {cyan,bold}--hardware{normal}           Manufacturer, product, serial, BIOS\n");
             fossil_io_printf("  {cyan,bold}--display{normal}            Count, resolution, refresh rate\n");
             fossil_io_printf("  {cyan,bold}--all{normal}                Show everything\n");
+            fossil_io_printf("  {cyan,bold}--no-cache{normal}           Re-probe hardware facts instead of reading the per-boot cache\n");
             fossil_io_printf("  {cyan,bold}--json{normal}               Structured output\n");
         }
         else if (fossil_io_cstring_equals(command, "ping"))
@@ -178,11 +192,12 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual)
             fossil_io_printf("{blue,bold,underline}Usage:{normal} {green}ping [options]{normal}\n");
             fossil_io_printf("{blue,bold,underline}Description:{normal} Test host reachability and measure latency.\n");
             fossil_io_printf("{blue,bold,underline}Options:{normal}\n");
-            fossil_io_printf("  {cyan,bold}--host <hostname|ip>{normal}      Target host\n");
+            fossil_io_printf("  {cyan,bold}--host <hostname|ip|cidr>{normal} Target host, repeatable\n");
+            fossil_io_printf("  {cyan,bold}--hosts-file <path>{normal}       Hosts or CIDRs, one per line\n");
             fossil_io_printf("  {cyan,bold}--count <n>{normal}               Number of pings\n");
             fossil_io_printf("  {cyan,bold}--interval <ms>{normal}           Delay between pings\n");
             fossil_io_printf("  {cyan,bold}--tcp <port>{normal}              TCP-based ping\n");
-            fossil_io_printf("  {cyan,bold}--stats{normal}                   Show summary only\n");
+            fossil_io_printf("  {cyan,bold}--stats{normal}                   Show summary only (min/mean/max, jitter, p50-p99.9)\n");
             fossil_io_printf("  {cyan,bold}--timeout <ms>{normal}            Per-ping timeout\n");
         }
         else if (fossil_io_cstring_equals(command, "scan"))
@@ -195,6 +210,7 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual)
             fossil_io_printf("  {cyan,bold}--top <n>{normal}                 Scan top N ports only\n");
             fossil_io_printf("  {cyan,bold}--service{normal}                 Attempt service detection\n");
             fossil_io_printf("  {cyan,bold}--timeout <ms>{normal}            Per-port timeout\n");
+            fossil_io_printf("  {cyan,bold}--concurrency <n>{normal}         Connects kept in flight (default 1024)\n");
         }
         else if (fossil_io_cstring_equals(command, "help"))
         {
@@ -231,7 +247,7 @@ int fossil_squid_help(ccstring command, bool show_examples, bool full_manual)
             else if (fossil_io_cstring_equals(command, "help"))
                 fossil_io_printf("  {cyan,bold}squid help --command process{normal}\n");
             else if (fossil_io_cstring_equals(command, "ping"))
-                fossil_io_printf("  {cyan,bold}squid ping --host example.com --count 4{normal}\n");
+                fossil_io_printf("  {cyan,bold}squid ping --host example.com --host 10.0.0.0/24 --count 4{normal}\n");
             else if (fossil_io_cstring_equals(command, "scan"))
                 fossil_io_printf("  {cyan,bold}squid scan --host 192.168.1.1 --ports 1-1024 --service{normal}\n");
         }
@@ -0,0 +1,344 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/json.h"
+
+/*=============================================================================
+SQUID JSON WRITER
+=============================================================================*/
+
+#define SQUID_JSON_INITIAL_CAP 1024
+
+static bool squid_json_reserve(fossil_squid_json_t *w, size_t extra)
+{
+    if (w->failed)
+        return false;
+    if (w->len + extra <= w->cap)
+        return true;
+
+    size_t cap = w->cap ? w->cap : SQUID_JSON_INITIAL_CAP;
+    while (cap < w->len + extra)
+        cap *= 2;
+
+    char *grown = (char *)fossil_sys_memory_realloc(w->buf, cap);
+    if (!grown)
+    {
+        w->failed = true;
+        return false;
+    }
+    w->buf = grown;
+    w->cap = cap;
+    return true;
+}
+
+static void squid_json_raw(fossil_squid_json_t *w, const char *s, size_t n)
+{
+    if (!squid_json_reserve(w, n))
+        return;
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void squid_json_char(fossil_squid_json_t *w, char c)
+{
+    if (!squid_json_reserve(w, 1))
+        return;
+    w->buf[w->len++] = c;
+}
+
+/* comma handling shared by every value and key */
+static void squid_json_separate(fossil_squid_json_t *w)
+{
+    if (w->after_key)
+    {
+        w->after_key = false;
+        return;
+    }
+    if (w->depth > 0)
+    {
+        if (!w->first[w->depth - 1])
+            squid_json_char(w, ',');
+        w->first[w->depth - 1] = false;
+    }
+}
+
+/* length of a valid UTF-8 sequence at s, or 0 if malformed */
+static size_t squid_json_utf8_len(const unsigned char *s, size_t avail)
+{
+    size_t n;
+    unsigned int cp;
+
+    if (s[0] >= 0xC2 && s[0] <= 0xDF) { n = 2; cp = s[0] & 0x1Fu; }
+    else if ((s[0] & 0xF0) == 0xE0) { n = 3; cp = s[0] & 0x0Fu; }
+    else if (s[0] >= 0xF0 && s[0] <= 0xF4) { n = 4; cp = s[0] & 0x07u; }
+    else return 0;
+
+    if (avail < n)
+        return 0;
+    for (size_t i = 1; i < n; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+        cp = (cp << 6) | (s[i] & 0x3Fu);
+    }
+    /* reject overlongs, surrogates and values past U+10FFFF */
+    if ((n == 3 && cp < 0x800) || (n == 4 && (cp < 0x10000 || cp > 0x10FFFF)) ||
+        (cp >= 0xD800 && cp <= 0xDFFF))
+        return 0;
+    return n;
+}
+
+static void squid_json_escaped(fossil_squid_json_t *w, const char *value, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *s = (const unsigned char *)value;
+
+    squid_json_char(w, '"');
+    size_t run = 0;
+    for (size_t i = 0; i < len; )
+    {
+        unsigned char c = s[i];
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80)
+        {
+            run++;
+            i++;
+            continue;
+        }
+
+        squid_json_raw(w, (const char *)s + i - run, run);
+        run = 0;
+
+        if (c >= 0x80)
+        {
+            size_t n = squid_json_utf8_len(s + i, len - i);
+            if (n > 0)
+            {
+                squid_json_raw(w, (const char *)s + i, n);
+                i += n;
+            }
+            else
+            {
+                squid_json_raw(w, "\\ufffd", 6);
+                i++;
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+            case '"':  squid_json_raw(w, "\\\"", 2); break;
+            case '\\': squid_json_raw(w, "\\\\", 2); break;
+            case '\n': squid_json_raw(w, "\\n", 2); break;
+            case '\r': squid_json_raw(w, "\\r", 2); break;
+            case '\t': squid_json_raw(w, "\\t", 2); break;
+            case '\b': squid_json_raw(w, "\\b", 2); break;
+            case '\f': squid_json_raw(w, "\\f", 2); break;
+            default:
+            {
+                char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+                squid_json_raw(w, u, sizeof(u));
+                break;
+            }
+        }
+        i++;
+    }
+    squid_json_raw(w, (const char *)s + len - run, run);
+    squid_json_char(w, '"');
+}
+
+static void squid_json_open(fossil_squid_json_t *w, char c)
+{
+    squid_json_separate(w);
+    if (w->depth >= FOSSIL_SQUID_JSON_MAX_DEPTH)
+    {
+        w->failed = true;
+        return;
+    }
+    squid_json_char(w, c);
+    w->first[w->depth++] = true;
+}
+
+static void squid_json_close(fossil_squid_json_t *w, char c)
+{
+    if (w->depth == 0 || w->after_key)
+    {
+        w->failed = true;
+        return;
+    }
+    w->depth--;
+    squid_json_char(w, c);
+}
+
+void fossil_squid_json_init(fossil_squid_json_t *w)
+{
+    if (!w)
+        return;
+    memset(w, 0, sizeof(*w));
+}
+
+void fossil_squid_json_dispose(fossil_squid_json_t *w)
+{
+    if (!w)
+        return;
+    fossil_sys_memory_free(w->buf);
+    memset(w, 0, sizeof(*w));
+}
+
+void fossil_squid_json_object_begin(fossil_squid_json_t *w) { squid_json_open(w, '{'); }
+void fossil_squid_json_object_end(fossil_squid_json_t *w) { squid_json_close(w, '}'); }
+void fossil_squid_json_array_begin(fossil_squid_json_t *w) { squid_json_open(w, '['); }
+void fossil_squid_json_array_end(fossil_squid_json_t *w) { squid_json_close(w, ']'); }
+
+void fossil_squid_json_key(fossil_squid_json_t *w, const char *key)
+{
+    squid_json_separate(w);
+    squid_json_escaped(w, key ? key : "", key ? strlen(key) : 0);
+    squid_json_char(w, ':');
+    w->after_key = true;
+}
+
+void fossil_squid_json_string(fossil_squid_json_t *w, const char *value)
+{
+    if (!value)
+    {
+        fossil_squid_json_null(w);
+        return;
+    }
+    squid_json_separate(w);
+    squid_json_escaped(w, value, strlen(value));
+}
+
+void fossil_squid_json_string_n(fossil_squid_json_t *w, const char *value, size_t len)
+{
+    if (!value)
+    {
+        fossil_squid_json_null(w);
+        return;
+    }
+    const char *nul = (const char *)memchr(value, '\0', len);
+    squid_json_separate(w);
+    squid_json_escaped(w, value, nul ? (size_t)(nul - value) : len);
+}
+
+void fossil_squid_json_int(fossil_squid_json_t *w, long long value)
+{
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%lld", value);
+    squid_json_separate(w);
+    squid_json_raw(w, tmp, (size_t)n);
+}
+
+void fossil_squid_json_uint(fossil_squid_json_t *w, unsigned long long value)
+{
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%llu", value);
+    squid_json_separate(w);
+    squid_json_raw(w, tmp, (size_t)n);
+}
+
+void fossil_squid_json_double(fossil_squid_json_t *w, double value, int decimals)
+{
+    if (isnan(value) || isinf(value))
+    {
+        fossil_squid_json_null(w);
+        return;
+    }
+
+    char tmp[64];
+    int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals < 0 ? 0 : decimals, value);
+    if (n < 0 || (size_t)n >= sizeof(tmp))
+        n = snprintf(tmp, sizeof(tmp), "%g", value);
+    squid_json_separate(w);
+    squid_json_raw(w, tmp, (size_t)n);
+}
+
+void fossil_squid_json_bool(fossil_squid_json_t *w, bool value)
+{
+    squid_json_separate(w);
+    if (value)
+        squid_json_raw(w, "true", 4);
+    else
+        squid_json_raw(w, "false", 5);
+}
+
+void fossil_squid_json_null(fossil_squid_json_t *w)
+{
+    squid_json_separate(w);
+    squid_json_raw(w, "null", 4);
+}
+
+void fossil_squid_json_field_string(fossil_squid_json_t *w, const char *key, const char *value)
+{
+    fossil_squid_json_key(w, key);
+    fossil_squid_json_string(w, value);
+}
+
+void fossil_squid_json_field_int(fossil_squid_json_t *w, const char *key, long long value)
+{
+    fossil_squid_json_key(w, key);
+    fossil_squid_json_int(w, value);
+}
+
+void fossil_squid_json_field_uint(fossil_squid_json_t *w, const char *key, unsigned long long value)
+{
+    fossil_squid_json_key(w, key);
+    fossil_squid_json_uint(w, value);
+}
+
+void fossil_squid_json_field_double(fossil_squid_json_t *w, const char *key, double value, int decimals)
+{
+    fossil_squid_json_key(w, key);
+    fossil_squid_json_double(w, value, decimals);
+}
+
+void fossil_squid_json_field_bool(fossil_squid_json_t *w, const char *key, bool value)
+{
+    fossil_squid_json_key(w, key);
+    fossil_squid_json_bool(w, value);
+}
+
+int fossil_squid_json_flush(fossil_squid_json_t *w)
+{
+    if (!w)
+        return -1;
+
+    int rc = (w->failed || w->depth != 0 || w->after_key) ? -1 : 0;
+    if (rc == 0 && w->len > 0)
+    {
+        squid_json_char(w, '\n');
+        /* anything printed earlier must land before the document */
+        fflush(stdout);
+        if (w->failed || fwrite(w->buf, 1, w->len, stdout) != w->len || fflush(stdout) != 0)
+            rc = -1;
+    }
+
+    bool failed = w->failed;
+    w->len = 0;
+    w->depth = 0;
+    w->after_key = false;
+    w->failed = false;
+    if (failed)
+        rc = -1;
+    return rc;
+}
@@ -0,0 +1,152 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/latency.h"
+
+/*=============================================================================
+SQUID LATENCY HISTOGRAM
+=============================================================================*/
+
+#define SQUID_LATENCY_SUB_COUNT (1u << FOSSIL_SQUID_LATENCY_SUB_BITS)
+
+static int squid_latency_msb(uint64_t v)
+{
+    int bit = 0;
+    while (v >>= 1)
+        bit++;
+    return bit;
+}
+
+/* bucket layout: [0, 2^S) is linear, then 2^S sub-buckets per power of two */
+static size_t squid_latency_index(uint64_t ns)
+{
+    if (ns < SQUID_LATENCY_SUB_COUNT)
+        return (size_t)ns;
+
+    int msb = squid_latency_msb(ns);
+    if (msb >= FOSSIL_SQUID_LATENCY_MAX_BITS)
+        return FOSSIL_SQUID_LATENCY_BUCKETS - 1;
+
+    int shift = msb - FOSSIL_SQUID_LATENCY_SUB_BITS;
+    size_t sub = (size_t)((ns >> shift) & (SQUID_LATENCY_SUB_COUNT - 1));
+    return (size_t)(shift + 1) * SQUID_LATENCY_SUB_COUNT + sub;
+}
+
+static void squid_latency_bounds(size_t idx, uint64_t *lo, uint64_t *hi)
+{
+    if (idx < SQUID_LATENCY_SUB_COUNT)
+    {
+        *lo = idx;
+        *hi = idx;
+        return;
+    }
+
+    int shift = (int)(idx / SQUID_LATENCY_SUB_COUNT) - 1;
+    uint64_t sub = (uint64_t)(idx % SQUID_LATENCY_SUB_COUNT) | SQUID_LATENCY_SUB_COUNT;
+    *lo = sub << shift;
+    *hi = ((sub + 1) << shift) - 1;
+}
+
+void fossil_squid_latency_reset(fossil_squid_latency_t *h)
+{
+    if (!h)
+        return;
+    memset(h, 0, sizeof(*h));
+}
+
+void fossil_squid_latency_record(fossil_squid_latency_t *h, uint64_t ns)
+{
+    if (!h)
+        return;
+
+    h->buckets[squid_latency_index(ns)]++;
+
+    if (h->count == 0 || ns < h->min_ns)
+        h->min_ns = ns;
+    if (ns > h->max_ns)
+        h->max_ns = ns;
+
+    if (h->count > 0)
+        h->jitter_sum_ns += (double)(ns > h->last_ns ? ns - h->last_ns : h->last_ns - ns);
+    h->last_ns = ns;
+
+    h->count++;
+    double delta = (double)ns - h->mean_ns;
+    h->mean_ns += delta / (double)h->count;
+    h->m2 += delta * ((double)ns - h->mean_ns);
+}
+
+uint64_t fossil_squid_latency_percentile(const fossil_squid_latency_t *h, double percentile)
+{
+    if (!h || h->count == 0)
+        return 0;
+
+    if (percentile <= 0.0)
+        return h->min_ns;
+    if (percentile >= 100.0)
+        return h->max_ns;
+
+    uint64_t rank = (uint64_t)ceil(percentile / 100.0 * (double)h->count);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < FOSSIL_SQUID_LATENCY_BUCKETS; ++i)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t lo, hi;
+            squid_latency_bounds(i, &lo, &hi);
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (mid < h->min_ns)
+                mid = h->min_ns;
+            if (mid > h->max_ns)
+                mid = h->max_ns;
+            return mid;
+        }
+    }
+    return h->max_ns;
+}
+
+void fossil_squid_latency_summarize(const fossil_squid_latency_t *h, fossil_squid_latency_summary_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (!h || h->count == 0)
+        return;
+
+    const double ms = 1000000.0;
+    out->count = h->count;
+    out->min_ms = (double)h->min_ns / ms;
+    out->max_ms = (double)h->max_ns / ms;
+    out->mean_ms = h->mean_ns / ms;
+    out->stddev_ms = h->count > 1 ? sqrt(h->m2 / (double)(h->count - 1)) / ms : 0.0;
+    out->jitter_ms = h->count > 1 ? (h->jitter_sum_ns / (double)(h->count - 1)) / ms : 0.0;
+    out->p50_ms = (double)fossil_squid_latency_percentile(h, 50.0) / ms;
+    out->p90_ms = (double)fossil_squid_latency_percentile(h, 90.0) / ms;
+    out->p99_ms = (double)fossil_squid_latency_percentile(h, 99.0) / ms;
+    out->p999_ms = (double)fossil_squid_latency_percentile(h, 99.9) / ms;
+}
@@ -24,303 +24,786 @@
  */
 #include "fossil/code/magic.h"
 #include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 /* Remove enum redefining PATH_MAX, rely on limits.h definition */
 
-#define DP(i, j) dp[(i) * (len2 + 1) + (j)]
+/* Longest pattern the bit-parallel kernel handles in one machine word */
+#define FOSSIL_IT_MAGIC_LEV_WORD 64
+/* Rows up to this width run the banded fallback on the stack */
+#define FOSSIL_IT_MAGIC_LEV_STACK 256
+/* Longest entry name any filesystem hands back: 255 UTF-16 units are up to 765 bytes of UTF-8 */
+#define FOSSIL_IT_MAGIC_NAME_MAX 768
+/* Entries scoring below this are never offered as path corrections */
+#define FOSSIL_IT_MAGIC_PATH_MIN 0.18f
+/* Highest raw entry score: full similarity plus both affix bonuses */
+#define FOSSIL_IT_MAGIC_PATH_RAW_MAX 1.17f
+/* Ceiling for a fuzzy segment in a resolved path, so only an exact path scores 1.0 */
+#define FOSSIL_IT_MAGIC_PATH_FUZZY_MAX 0.99f
+/* Partial paths carried between segments, and fuzzy picks per directory */
+#define FOSSIL_IT_MAGIC_BEAM 4
+/* Directory listings kept by one resolve or report call */
+#define FOSSIL_IT_MAGIC_DIR_CACHE 32
 
 /* ==========================================================================
  * Static Helpers (internal)
  * ========================================================================== */
 
-static int fossil_it_magic_is_code_file(ccstring path)
+/*
+ * Streaming directory iterator: yields one entry name at a time straight from
+ * readdir / FindNextFile, so callers see every entry of arbitrarily large
+ * directories without materializing a listing. "." and ".." are skipped.
+ */
+typedef struct
 {
-    ccstring ext = strrchr(path, '.');
-    if (!cnotnull(ext))
-        return 0;
+#ifdef _WIN32
+    HANDLE find;
+    WIN32_FIND_DATAA data;
+    bool pending;
+    char current[MAX_PATH]; // data is overwritten by the read-ahead
+#else
+    DIR *dir;
+#endif
+    ccstring name; // valid until the next call
+    i32 is_dir;    // 1, 0, or -1 when the listing did not say
+    i32 is_link;   // 1, 0, or -1 when the listing did not say
+} fossil_it_magic_dir_iter_t;
+
+static bool fossil_it_magic_dir_open(fossil_it_magic_dir_iter_t *it, ccstring path)
+{
+    it->name = cnull;
+    it->is_dir = -1;
+    it->is_link = -1;
+#ifdef _WIN32
+    char pattern[FOSSIL_FILESYS_MAX_PATH];
+    int n = snprintf(pattern, sizeof(pattern), "%s\\*", path);
+    if (n < 0 || (size_t)n >= sizeof(pattern))
+        return false;
+    it->find = FindFirstFileA(pattern, &it->data);
+    it->pending = (it->find != INVALID_HANDLE_VALUE);
+    return it->pending;
+#else
+    it->dir = opendir(path);
+    return cnotnull(it->dir);
+#endif
+}
 
-    static ccstring code_exts[] = {
-        ".c", ".h", ".cpp", ".hpp", ".cc", ".cxx", ".hxx", ".hh",
-        ".py", ".pyw", ".ipynb", ".pyc", ".pyo", ".pyd",
-        ".java", ".class", ".jar", ".jad", ".jmod",
-        ".cs", ".vb", ".fs",
-        ".go", ".mod", ".sum",
-        ".rs", ".rlib", ".toml",
-        ".js", ".jsx", ".mjs", ".cjs",
-        ".ts", ".tsx",
-        ".php", ".phtml", ".php3", ".php4", ".php5", ".phps",
-        ".rb", ".erb", ".rake", ".gemspec",
-        ".pl", ".pm", ".pod", ".t",
-        ".swift",
-        ".kt", ".kts",
-        ".scala", ".sc",
-        ".sh", ".bash", ".zsh", ".csh", ".tcsh", ".ksh",
-        ".bat", ".cmd", ".ps1", ".psm1",
-        ".lua",
-        ".sql", ".sqlite", ".db",
-        ".html", ".htm", ".xhtml",
-        ".css", ".scss", ".less",
-        ".xml", ".xsd", ".xslt",
-        ".json", ".yaml", ".yml",
-        ".dart",
-        ".groovy", ".gradle",
-        ".r", ".R", ".Rmd",
-        ".m", ".mm",
-        ".asm", ".s", ".S",
-        ".v", ".vh", ".sv", ".vhd", ".vhdl",
-        ".coffee",
-        ".clj", ".cljs", ".cljc", ".edn",
-        ".hs", ".lhs", ".ghc",
-        ".ml", ".mli", ".ocaml",
-        ".ada", ".adb", ".ads",
-        ".for", ".f90", ".f95", ".f03", ".f08", ".f", ".f77",
-        ".pro", ".pl", ".tcl",
-        ".tex", ".sty", ".cls",
-        ".nim",
-        ".cr",
-        ".ex", ".exs",
-        ".elm",
-        ".erl", ".hrl",
-        ".lisp", ".el", ".scm", ".cl", ".lsp",
-        ".pas", ".pp", ".p",
-        ".d",
-        ".vala",
-        ".vbs",
-        ".awk",
-        ".ps",
-        ".raku", ".pl6", ".pm6",
-        ".sol",
-        ".cmake",
-        ".build", ".options",
-        ".dockerfile",
-        ".ini", ".conf", ".cfg",
-        ".toml",
-        ".tsx",
-        ".sln", ".vcxproj", ".csproj",
-        ".xcodeproj", ".xcworkspace",
-        ".bazel", ".bzl", "BUILD", "WORKSPACE",
-        ".ninja",
-        ".gitignore", ".gitattributes", ".editorconfig", ".env"};
-    static const i32 code_exts_count = (i32)(sizeof(code_exts) / sizeof(code_exts[0]));
-
-    for (i32 i = 0; i < code_exts_count; i++)
-    {
-        if (fossil_io_cstring_case_compare(ext, code_exts[i]) == 0)
-            return 1;
+static bool fossil_it_magic_dir_next(fossil_it_magic_dir_iter_t *it)
+{
+    for (;;)
+    {
+#ifdef _WIN32
+        if (!it->pending)
+            return false;
+        memcpy(it->current, it->data.cFileName, sizeof(it->current));
+        it->name = it->current;
+        it->is_dir = (it->data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? 1 : 0;
+        it->is_link = (it->data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) ? 1 : 0;
+        it->pending = FindNextFileA(it->find, &it->data) != 0;
+#else
+        struct dirent *ent = readdir(it->dir);
+        if (!cnotnull(ent))
+            return false;
+        it->name = ent->d_name;
+#ifdef DT_DIR
+        it->is_dir = (ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK) ? -1 : (ent->d_type == DT_DIR);
+        it->is_link = (ent->d_type == DT_UNKNOWN) ? -1 : (ent->d_type == DT_LNK);
+#endif
+#endif
+        if (strcmp(it->name, ".") != 0 && strcmp(it->name, "..") != 0)
+            return true;
+    }
+}
+
+static void fossil_it_magic_dir_close(fossil_it_magic_dir_iter_t *it)
+{
+#ifdef _WIN32
+    if (it->find != INVALID_HANDLE_VALUE)
+        FindClose(it->find);
+    it->find = INVALID_HANDLE_VALUE;
+#else
+    if (cnotnull(it->dir))
+        closedir(it->dir);
+    it->dir = cnull;
+#endif
+}
+
+/*
+ * Entry classifier. Every name examined by danger analysis is matched against
+ * the code, suspicious, secret, VCS and special-name lists; a recursive walk
+ * does that for every file it sees. Rather than scanning each list with a
+ * string compare, all of them are loaded once into two small open-addressed
+ * hash tables, one keyed by lowercased extension and one by exact name, whose
+ * slots carry a class bitmask. Classifying an entry is then one hash and
+ * usually one probe per table.
+ */
+enum
+{
+    FOSSIL_IT_MAGIC_CLASS_CODE = 1 << 0,       // source, build or project file
+    FOSSIL_IT_MAGIC_CLASS_DANGER = 1 << 1,     // executable or script extension
+    FOSSIL_IT_MAGIC_CLASS_SECRET = 1 << 2,     // well-known credential file name
+    FOSSIL_IT_MAGIC_CLASS_SECRET_DIR = 1 << 3, // directory holding a well-known credential file
+    FOSSIL_IT_MAGIC_CLASS_VCS_DIR = 1 << 4,    // version control metadata directory
+    FOSSIL_IT_MAGIC_CLASS_VCS_FILE = 1 << 5    // version control metadata file
+};
+
+static ccstring fossil_it_magic_code_exts[] = {
+    ".c", ".h", ".cpp", ".hpp", ".cc", ".cxx", ".hxx", ".hh",
+    ".py", ".pyw", ".ipynb", ".pyc", ".pyo", ".pyd",
+    ".java", ".class", ".jar", ".jad", ".jmod",
+    ".cs", ".vb", ".fs",
+    ".go", ".mod", ".sum",
+    ".rs", ".rlib", ".toml",
+    ".js", ".jsx", ".mjs", ".cjs",
+    ".ts", ".tsx",
+    ".php", ".phtml", ".php3", ".php4", ".php5", ".phps",
+    ".rb", ".erb", ".rake", ".gemspec",
+    ".pl", ".pm", ".pod", ".t",
+    ".swift",
+    ".kt", ".kts",
+    ".scala", ".sc",
+    ".sh", ".bash", ".zsh", ".csh", ".tcsh", ".ksh",
+    ".bat", ".cmd", ".ps1", ".psm1",
+    ".lua",
+    ".sql", ".sqlite", ".db",
+    ".html", ".htm", ".xhtml",
+    ".css", ".scss", ".less",
+    ".xml", ".xsd", ".xslt",
+    ".json", ".yaml", ".yml",
+    ".dart",
+    ".groovy", ".gradle",
+    ".r", ".R", ".Rmd",
+    ".m", ".mm",
+    ".asm", ".s", ".S",
+    ".v", ".vh", ".sv", ".vhd", ".vhdl",
+    ".coffee",
+    ".clj", ".cljs", ".cljc", ".edn",
+    ".hs", ".lhs", ".ghc",
+    ".ml", ".mli", ".ocaml",
+    ".ada", ".adb", ".ads",
+    ".for", ".f90", ".f95", ".f03", ".f08", ".f", ".f77",
+    ".pro", ".pl", ".tcl",
+    ".tex", ".sty", ".cls",
+    ".nim",
+    ".cr",
+    ".ex", ".exs",
+    ".elm",
+    ".erl", ".hrl",
+    ".lisp", ".el", ".scm", ".cl", ".lsp",
+    ".pas", ".pp", ".p",
+    ".d",
+    ".vala",
+    ".vbs",
+    ".awk",
+    ".ps",
+    ".raku", ".pl6", ".pm6",
+    ".sol",
+    ".cmake",
+    ".build", ".options",
+    ".dockerfile",
+    ".ini", ".conf", ".cfg",
+    ".toml",
+    ".tsx",
+    ".sln", ".vcxproj", ".csproj",
+    ".xcodeproj", ".xcworkspace",
+    ".bazel", ".bzl",
+    ".ninja",
+    ".gitignore", ".gitattributes", ".editorconfig", ".env"};
+
+static ccstring fossil_it_magic_special_names[] = {
+    "Makefile", "CMakeLists.txt", "Dockerfile", "BUILD", "WORKSPACE", "SConstruct", "Rakefile", "Gemfile", "meson.build"};
+
+static ccstring fossil_it_magic_secret_files[] = {
+    ".env", "secret.key", "id_rsa", "id_dsa", "id_ed25519", "id_ecdsa",
+    "private.pem", "private.key", "server.key", "client.key", "jwt.key",
+    "credentials.json", "credentials.yml", "config.yml", "config.yaml",
+    "secrets.yml", "secrets.yaml", "passwords.txt", "password.txt",
+    "passwd", "shadow", "auth.json", "auth.yaml", "auth.yml",
+    "api_key.txt", "api_keys.txt", "apikey.txt", "apikeys.txt",
+    "token.txt", "tokens.txt", "access_token.txt", "refresh_token.txt",
+    "vault.json", "vault.yml", "vault.yaml", "db_password.txt",
+    "db_secrets.txt", "db_credentials.txt", "ssh_config", "pgpass",
+    ".docker_secret", ".aws/credentials", ".npmrc", ".netrc",
+    ".gcp_secret.json", ".azure_secret.json", ".git-credentials",
+    ".pypirc", ".gem/credentials", "firebase.json", "firebase.key",
+    "service-account.json", "service_account.json", "client_secret.json",
+    "client_secrets.json", "google_api_key.txt", "azure_api_key.txt",
+    "aws_secret_access_key.txt", "aws_access_key_id.txt"};
+
+static ccstring fossil_it_magic_danger_exts[] = {
+    ".exe", ".dll", ".bin", ".sh", ".bat", ".cmd", ".scr", ".pif", ".com", ".js", ".vbs", ".elf"};
+
+// Keys longer than this are never in a table, so lookups reject them before hashing
+#define FOSSIL_IT_MAGIC_CLASS_KEY 32
+// Power-of-two slot counts, kept at or below a quarter full
+#define FOSSIL_IT_MAGIC_EXT_SLOTS 1024
+#define FOSSIL_IT_MAGIC_NAME_SLOTS 256
+
+typedef struct
+{
+    char key[FOSSIL_IT_MAGIC_CLASS_KEY];
+    u8 len; // 0 marks an empty slot
+    u8 mask;
+} fossil_it_magic_class_slot_t;
+
+static fossil_it_magic_class_slot_t fossil_it_magic_ext_table[FOSSIL_IT_MAGIC_EXT_SLOTS];
+static fossil_it_magic_class_slot_t fossil_it_magic_name_table[FOSSIL_IT_MAGIC_NAME_SLOTS];
+
+static u32 fossil_it_magic_class_hash(ccstring key, size_t len)
+{
+    u32 h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (u8)key[i]) * 16777619u;
+    return h;
+}
+
+static fossil_it_magic_class_slot_t *fossil_it_magic_class_find(
+    fossil_it_magic_class_slot_t *table, size_t slots, ccstring key, size_t len)
+{
+    size_t i = fossil_it_magic_class_hash(key, len) & (slots - 1);
+    while (table[i].len && (table[i].len != len || memcmp(table[i].key, key, len) != 0))
+        i = (i + 1) & (slots - 1);
+    return &table[i];
+}
+
+static void fossil_it_magic_class_put(
+    fossil_it_magic_class_slot_t *table, size_t slots, ccstring key, size_t len, u8 mask)
+{
+    if (len == 0 || len >= FOSSIL_IT_MAGIC_CLASS_KEY)
+        return;
+    fossil_it_magic_class_slot_t *slot = fossil_it_magic_class_find(table, slots, key, len);
+    if (!slot->len)
+    {
+        memcpy(slot->key, key, len);
+        slot->len = (u8)len;
+    }
+    slot->mask |= mask;
+}
+
+// Lowercases the extension of a list entry (".CPP" -> "cpp") into buf
+static size_t fossil_it_magic_ext_key(ccstring ext, char buf[FOSSIL_IT_MAGIC_CLASS_KEY])
+{
+    size_t len = 0;
+    while (ext[len])
+    {
+        if (len + 1 >= FOSSIL_IT_MAGIC_CLASS_KEY)
+            return 0;
+        buf[len] = (char)tolower((u8)ext[len]);
+        len++;
     }
+    return len;
+}
+
+static void fossil_it_magic_class_put_exts(ccstring *exts, size_t count, u8 mask)
+{
+    char key[FOSSIL_IT_MAGIC_CLASS_KEY];
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t len = fossil_it_magic_ext_key(exts[i] + 1, key);
+        fossil_it_magic_class_put(fossil_it_magic_ext_table, FOSSIL_IT_MAGIC_EXT_SLOTS, key, len, mask);
+    }
+}
+
+static void fossil_it_magic_class_build(void)
+{
+    fossil_it_magic_class_put_exts(fossil_it_magic_code_exts,
+                                   sizeof(fossil_it_magic_code_exts) / sizeof(fossil_it_magic_code_exts[0]),
+                                   FOSSIL_IT_MAGIC_CLASS_CODE);
+    fossil_it_magic_class_put_exts(fossil_it_magic_danger_exts,
+                                   sizeof(fossil_it_magic_danger_exts) / sizeof(fossil_it_magic_danger_exts[0]),
+                                   FOSSIL_IT_MAGIC_CLASS_DANGER);
+
+    for (size_t i = 0; i < sizeof(fossil_it_magic_special_names) / sizeof(fossil_it_magic_special_names[0]); i++)
+    {
+        ccstring name = fossil_it_magic_special_names[i];
+        fossil_it_magic_class_put(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS,
+                                  name, strlen(name), FOSSIL_IT_MAGIC_CLASS_CODE);
+    }
+    for (size_t i = 0; i < sizeof(fossil_it_magic_secret_files) / sizeof(fossil_it_magic_secret_files[0]); i++)
+    {
+        // ".aws/credentials" marks ".aws" as a directory worth looking inside
+        ccstring name = fossil_it_magic_secret_files[i];
+        ccstring slash = strchr(name, '/');
+        if (cnotnull(slash))
+            fossil_it_magic_class_put(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS,
+                                      name, (size_t)(slash - name), FOSSIL_IT_MAGIC_CLASS_SECRET_DIR);
+        else
+            fossil_it_magic_class_put(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS,
+                                      name, strlen(name), FOSSIL_IT_MAGIC_CLASS_SECRET);
+    }
+
+    static ccstring vcs_dirs[] = {".git", ".svn", ".hg"};
+    for (size_t i = 0; i < sizeof(vcs_dirs) / sizeof(vcs_dirs[0]); i++)
+        fossil_it_magic_class_put(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS,
+                                  vcs_dirs[i], strlen(vcs_dirs[i]), FOSSIL_IT_MAGIC_CLASS_VCS_DIR);
+    fossil_it_magic_class_put(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS,
+                              ".gitignore", strlen(".gitignore"), FOSSIL_IT_MAGIC_CLASS_VCS_FILE);
+}
+
+#ifdef _WIN32
+static INIT_ONCE fossil_it_magic_class_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK fossil_it_magic_class_build_once(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    (void)once;
+    (void)param;
+    (void)context;
+    fossil_it_magic_class_build();
+    return TRUE;
+}
+#else
+static pthread_once_t fossil_it_magic_class_once = PTHREAD_ONCE_INIT;
+#endif
+
+/*
+ * Returns the FOSSIL_IT_MAGIC_CLASS_* bits for a file name or path: the base
+ * name is looked up exactly, its extension case-insensitively.
+ */
+static i32 fossil_it_magic_classify(ccstring path)
+{
+#ifdef _WIN32
+    InitOnceExecuteOnce(&fossil_it_magic_class_once, fossil_it_magic_class_build_once, cnull, cnull);
+#else
+    pthread_once(&fossil_it_magic_class_once, fossil_it_magic_class_build);
+#endif
 
-    static ccstring special_names[] = {
-        "Makefile", "CMakeLists.txt", "Dockerfile", "BUILD", "WORKSPACE", "SConstruct", "Rakefile", "Gemfile", "meson.build"};
     ccstring base = strrchr(path, '/');
     base = cnotnull(base) ? base + 1 : path;
-    for (i32 i = 0; i < (i32)(sizeof(special_names) / sizeof(special_names[0])); i++)
+
+    i32 mask = 0;
+    size_t len = strlen(base);
+    if (len < FOSSIL_IT_MAGIC_CLASS_KEY)
+        mask |= fossil_it_magic_class_find(fossil_it_magic_name_table, FOSSIL_IT_MAGIC_NAME_SLOTS, base, len)->mask;
+
+    ccstring ext = strrchr(base, '.');
+    if (cnotnull(ext))
     {
-        if (fossil_io_cstring_compare(base, special_names[i]) == 0)
-            return 1;
+        char key[FOSSIL_IT_MAGIC_CLASS_KEY];
+        size_t ext_len = fossil_it_magic_ext_key(ext + 1, key);
+        if (ext_len)
+            mask |= fossil_it_magic_class_find(fossil_it_magic_ext_table, FOSSIL_IT_MAGIC_EXT_SLOTS, key, ext_len)->mask;
     }
-    return 0;
+    return mask;
 }
 
-static int fossil_it_magic_contains_git(ccstring path)
+// Matches one directory entry against the secret file names; nested ones need a single stat
+static int fossil_it_magic_is_secret_entry(ccstring dir, ccstring name, i32 cls, i32 is_dir)
 {
-    fossil_io_filesys_obj_t entries[32];
-    size_t count = 0;
-    if (fossil_io_filesys_dir_list(path, entries, 32, &count) != 0)
+    if ((cls & FOSSIL_IT_MAGIC_CLASS_SECRET) && is_dir != 1)
+        return 1;
+    if (fossil_io_cstring_icontains(name, "password") ||
+        fossil_io_cstring_icontains(name, "secret"))
+        return 1;
+    if (!(cls & FOSSIL_IT_MAGIC_CLASS_SECRET_DIR) || is_dir == 0)
         return 0;
 
-    for (size_t i = 0; i < count; ++i)
+    size_t name_len = strlen(name);
+    for (i32 i = 0; i < (i32)(sizeof(fossil_it_magic_secret_files) / sizeof(fossil_it_magic_secret_files[0])); i++)
     {
-        const fossil_io_filesys_obj_t *ent = &entries[i];
-        if (fossil_io_cstring_equals(ent->path, ".git") && ent->type == FOSSIL_FILESYS_TYPE_DIR)
-            return 1;
-        if (fossil_io_cstring_equals(ent->path, ".gitignore") &&
-            (ent->type == FOSSIL_FILESYS_TYPE_FILE || ent->type == FOSSIL_FILESYS_TYPE_LINK))
+        ccstring secret = fossil_it_magic_secret_files[i];
+        if (strncmp(secret, name, name_len) != 0 || secret[name_len] != '/')
+            continue;
+        char candidate[FOSSIL_FILESYS_MAX_PATH];
+        int n = snprintf(candidate, sizeof(candidate), "%s/%s", dir, secret);
+        fossil_io_filesys_obj_t obj;
+        if (n > 0 && (size_t)n < sizeof(candidate) &&
+            fossil_io_filesys_stat(candidate, &obj) == 0 && obj.type == FOSSIL_FILESYS_TYPE_FILE)
             return 1;
     }
     return 0;
 }
 
-static int fossil_it_magic_contains_secret(ccstring path)
-{
-    static ccstring secret_files[] = {
-        ".env", "secret.key", "id_rsa", "id_dsa", "id_ed25519", "id_ecdsa",
-        "private.pem", "private.key", "server.key", "client.key", "jwt.key",
-        "credentials.json", "credentials.yml", "config.yml", "config.yaml",
-        "secrets.yml", "secrets.yaml", "passwords.txt", "password.txt",
-        "passwd", "shadow", "auth.json", "auth.yaml", "auth.yml",
-        "api_key.txt", "api_keys.txt", "apikey.txt", "apikeys.txt",
-        "token.txt", "tokens.txt", "access_token.txt", "refresh_token.txt",
-        "vault.json", "vault.yml", "vault.yaml", "db_password.txt",
-        "db_secrets.txt", "db_credentials.txt", "ssh_config", "pgpass",
-        ".docker_secret", ".aws/credentials", ".npmrc", ".netrc",
-        ".gcp_secret.json", ".azure_secret.json", ".git-credentials",
-        ".pypirc", ".gem/credentials", "firebase.json", "firebase.key",
-        "service-account.json", "service_account.json", "client_secret.json",
-        "client_secrets.json", "google_api_key.txt", "azure_api_key.txt",
-        "aws_secret_access_key.txt", "aws_access_key_id.txt"};
-    static const i32 secret_count = (i32)(sizeof(secret_files) / sizeof(secret_files[0]));
-    char candidate[FOSSIL_FILESYS_MAX_PATH];
-
-    for (i32 i = 0; i < secret_count; i++)
-    {
-        // Compose candidate path using io_filesys_ API
-        int rc = fossil_io_filesys_abspath(path, candidate, sizeof(candidate));
-        if (rc != 0)
-            continue;
-        size_t len = strlen(candidate);
-        if (len + 1 + strlen(secret_files[i]) < sizeof(candidate))
-        {
-            if (candidate[len - 1] != '/' && candidate[len - 1] != '\\')
-                strncat(candidate, "/", sizeof(candidate) - strlen(candidate) - 1);
-            strncat(candidate, secret_files[i], sizeof(candidate) - strlen(candidate) - 1);
-            fossil_io_filesys_obj_t obj;
-            if (fossil_io_filesys_stat(candidate, &obj) == 0 && obj.type == FOSSIL_FILESYS_TYPE_FILE)
-                return 1;
-            // Remove appended secret file for next iteration
-            candidate[len] = '\0';
-        }
+/*
+ * Everything danger analysis wants to know about a directory's entries,
+ * gathered from one pass over the listing. The walk stops early once every
+ * detector has fired.
+ */
+typedef struct
+{
+    int contains_code;
+    int contains_vcs;
+    int contains_git;
+    int contains_secrets;
+    int contains_suspicious_files;
+    int looked_inside; // a subdirectory's contents decided something
+} fossil_it_magic_dir_facts_t;
+
+// Runs every detector over one entry; is_dir is 1, 0, or -1 when unknown
+static void fossil_it_magic_note_entry(
+    fossil_it_magic_dir_facts_t *facts, ccstring dir, ccstring name, i32 is_dir)
+{
+    i32 cls = fossil_it_magic_classify(name);
+
+    if ((cls & FOSSIL_IT_MAGIC_CLASS_VCS_DIR && is_dir != 0) ||
+        (cls & FOSSIL_IT_MAGIC_CLASS_VCS_FILE && is_dir != 1))
+    {
+        facts->contains_vcs = 1;
+        // .git and .gitignore mark a checkout; .svn and .hg do not count as code
+        if (strncmp(name, ".git", 4) == 0)
+            facts->contains_git = 1;
     }
 
-    fossil_io_filesys_obj_t entries[32];
-    size_t count = 0;
-    if (fossil_io_filesys_dir_list(path, entries, 32, &count) != 0)
-        return 0;
+    if (is_dir != 1)
+    {
+        if (cls & FOSSIL_IT_MAGIC_CLASS_CODE)
+            facts->contains_code = 1;
+        if (cls & FOSSIL_IT_MAGIC_CLASS_DANGER)
+            facts->contains_suspicious_files = 1;
+    }
 
-    for (size_t i = 0; i < count; ++i)
+    if (!facts->contains_secrets)
     {
-        ccstring name = entries[i].path;
-        // Only check the basename, not the full path
-        char basename[FOSSIL_FILESYS_MAX_PATH];
-        if (fossil_io_filesys_basename(name, basename, sizeof(basename)) == 0)
-        {
-            if (fossil_io_cstring_icontains(basename, "password") ||
-                fossil_io_cstring_icontains(basename, "secret"))
-                return 1;
-        }
+        // ".aws" and the like are only a hit if the credential file inside exists
+        if ((cls & FOSSIL_IT_MAGIC_CLASS_SECRET_DIR) && is_dir != 0)
+            facts->looked_inside = 1;
+        if (fossil_it_magic_is_secret_entry(dir, name, cls, is_dir))
+            facts->contains_secrets = 1;
     }
-    return 0;
+}
+
+static void fossil_it_magic_scan_dir(ccstring path, fossil_it_magic_dir_facts_t *facts)
+{
+    memset(facts, 0, sizeof(*facts));
+
+    fossil_it_magic_dir_iter_t it;
+    if (!fossil_it_magic_dir_open(&it, path))
+        return;
+
+    while (fossil_it_magic_dir_next(&it))
+    {
+        fossil_it_magic_note_entry(facts, path, it.name, it.is_dir);
+        if (facts->contains_vcs && facts->contains_git &&
+            facts->contains_secrets && facts->contains_suspicious_files)
+            break;
+    }
+    fossil_it_magic_dir_close(&it);
+
+    // A directory counts as code only when it is a git checkout; source files
+    // at its top level do not raise its score
+    facts->contains_code = facts->contains_git;
 }
 
 /* ==========================================================================
  * Similarity Utilities
  * ========================================================================== */
 
-// Advanced Jaccard index: token-based, case-insensitive, ignores punctuation
-int fossil_it_magic_jaccard_index(ccstring s1, ccstring s2)
+/*
+ * Token sets. A string's lowercase alphanumeric tokens are interned as 64-bit
+ * FNV-1a hashes in an open-addressed table (0 marks an empty slot) that starts
+ * in caller-provided storage and moves to the heap once it is three quarters
+ * full, so tokens of any length and count are kept. Jaccard then costs one
+ * probe per distinct candidate token.
+ */
+typedef struct
 {
-    if (!cnotnull(s1) || !cnotnull(s2))
-        return 0;
+    u64 *slots;
+    u64 *heap; // slots once spilled, else NULL
+    i32 capacity;
+    i32 count;
+} fossil_it_magic_token_set_t;
+
+static void fossil_it_magic_token_set_init(fossil_it_magic_token_set_t *set, u64 *storage, i32 capacity)
+{
+    memset(storage, 0, (size_t)capacity * sizeof(*storage));
+    set->slots = storage;
+    set->heap = cnull;
+    set->capacity = capacity;
+    set->count = 0;
+}
 
-    char tokens1[32][32], tokens2[32][32];
-    i32 count1 = 0, count2 = 0;
+static bool fossil_it_magic_token_set_has(const u64 *slots, i32 capacity, u64 h)
+{
+    size_t mask = (size_t)capacity - 1;
+    for (size_t i = (size_t)h & mask; slots[i]; i = (i + 1) & mask)
+        if (slots[i] == h)
+            return true;
+    return false;
+}
 
-    ccstring p = s1;
-    while (*p && count1 < 32)
+static void fossil_it_magic_token_set_add(fossil_it_magic_token_set_t *set, u64 h)
+{
+    if ((set->count + 1) * 4 > set->capacity * 3)
     {
-        while (*p && !isalnum((unsigned char)*p))
-            p++;
-        i32 i = 0;
-        while (*p && isalnum((unsigned char)*p) && i < 31)
-            tokens1[count1][i++] = tolower((unsigned char)*p++);
-        if (i)
+        i32 capacity = set->capacity * 2;
+        u64 *grown = (u64 *)fossil_sys_memory_calloc((size_t)capacity, sizeof(*grown));
+        if (!cnotnull(grown))
+            return; // keep scoring with the tokens held so far
+        for (i32 i = 0; i < set->capacity; i++)
         {
-            tokens1[count1][i] = 0;
-            count1++;
+            if (!set->slots[i])
+                continue;
+            size_t j = (size_t)set->slots[i] & (size_t)(capacity - 1);
+            while (grown[j])
+                j = (j + 1) & (size_t)(capacity - 1);
+            grown[j] = set->slots[i];
         }
+        if (cnotnull(set->heap))
+            fossil_sys_memory_free(set->heap);
+        set->slots = set->heap = grown;
+        set->capacity = capacity;
     }
-    p = s2;
-    while (*p && count2 < 32)
+
+    size_t mask = (size_t)set->capacity - 1;
+    size_t i = (size_t)h & mask;
+    while (set->slots[i])
+    {
+        if (set->slots[i] == h)
+            return;
+        i = (i + 1) & mask;
+    }
+    set->slots[i] = h;
+    set->count++;
+}
+
+static void fossil_it_magic_tokenize(ccstring s, fossil_it_magic_token_set_t *set)
+{
+    const u8 *p = (const u8 *)s;
+    while (*p)
     {
-        while (*p && !isalnum((unsigned char)*p))
+        while (*p && !isalnum(*p))
             p++;
-        i32 i = 0;
-        while (*p && isalnum((unsigned char)*p) && i < 31)
-            tokens2[count2][i++] = tolower((unsigned char)*p++);
-        if (i)
-        {
-            tokens2[count2][i] = 0;
-            count2++;
-        }
+        if (!*p)
+            break;
+        u64 h = 14695981039346656037ULL;
+        while (*p && isalnum(*p))
+            h = (h ^ (u64)tolower(*p++)) * 1099511628211ULL;
+        fossil_it_magic_token_set_add(set, h ? h : 1);
     }
+}
 
+static i32 fossil_it_magic_jaccard_tokens(const fossil_ti_score_ctx_t *ctx, const fossil_it_magic_token_set_t *set)
+{
+    const u64 *slots = cnotnull(ctx->token_heap) ? ctx->token_heap : ctx->token_slots;
     i32 match = 0;
-    i32 used[32] = {0};
-    for (i32 i = 0; i < count1; i++)
+    for (i32 i = 0; i < set->capacity; i++)
+        if (set->slots[i] && fossil_it_magic_token_set_has(slots, ctx->token_capacity, set->slots[i]))
+            match++;
+    i32 total = ctx->token_count + set->count - match;
+    return total ? (100 * match / total) : 0;
+}
+
+// Jaccard of ctx's input against s, tokenizing s into a stack table first
+static i32 fossil_it_magic_jaccard_ctx(const fossil_ti_score_ctx_t *ctx, ccstring s)
+{
+    u64 storage[FOSSIL_TI_TOKEN_SLOTS];
+    fossil_it_magic_token_set_t set;
+    fossil_it_magic_token_set_init(&set, storage, FOSSIL_TI_TOKEN_SLOTS);
+    fossil_it_magic_tokenize(s, &set);
+    i32 jaccard = fossil_it_magic_jaccard_tokens(ctx, &set);
+    if (cnotnull(set.heap))
+        fossil_sys_memory_free(set.heap);
+    return jaccard;
+}
+
+// Advanced Jaccard index: token-based, case-insensitive, ignores punctuation
+int fossil_it_magic_jaccard_index(ccstring s1, ccstring s2)
+{
+    if (!cnotnull(s1) || !cnotnull(s2))
+        return 0;
+
+    fossil_ti_score_ctx_t ctx;
+    fossil_it_magic_score_init(&ctx, s1);
+    i32 jaccard = fossil_it_magic_jaccard_ctx(&ctx, s2);
+    fossil_it_magic_score_dispose(&ctx);
+    return jaccard;
+}
+
+/*
+ * Myers/Hyyro bit-vector edit distance, optionally with adjacent
+ * transpositions (OSA). Column deltas of the DP matrix for the pattern are
+ * kept as bit vectors, so each text character costs a handful of word
+ * operations. The pattern must be 1..64 characters and is prepared once, so
+ * one input can be measured against many texts. Matching is case-insensitive.
+ */
+typedef struct
+{
+    uint64_t peq[256]; // per byte, bit i set where pattern[i] matches it
+    i32 len;
+} fossil_it_magic_pattern_t;
+
+static void fossil_it_magic_peq_init(uint64_t peq[256], ccstring s, i32 m)
+{
+    memset(peq, 0, 256 * sizeof(peq[0]));
+    for (i32 i = 0; i < m; i++)
+        peq[tolower((unsigned char)s[i])] |= (uint64_t)1 << i;
+}
+
+static void fossil_it_magic_pattern_init(fossil_it_magic_pattern_t *pat, ccstring s, i32 m)
+{
+    fossil_it_magic_peq_init(pat->peq, s, m);
+    pat->len = m;
+}
+
+static i32 fossil_it_magic_lev_bitparallel(
+    const uint64_t *peq, i32 m, ccstring text, i32 n, i32 max, bool transpose)
+{
+    const uint64_t last = (uint64_t)1 << (m - 1);
+    uint64_t vp = ~(uint64_t)0, vn = 0, d0 = 0, pm_prev = 0;
+    i32 score = m;
+
+    for (i32 j = 0; j < n; j++)
+    {
+        uint64_t pm = peq[tolower((unsigned char)text[j])];
+        uint64_t tr = transpose ? (((~d0) & pm) << 1) & pm_prev : 0;
+        d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        if (hp & last)
+            score++;
+        else if (hn & last)
+            score--;
+        uint64_t x = (hp << 1) | 1;
+        vn = x & d0;
+        vp = (hn << 1) | ~(x | d0);
+        pm_prev = pm;
+
+        // The last row can drop by at most one per remaining column
+        if (max >= 0 && score - (n - 1 - j) > max)
+            return max + 1;
+    }
+    return (max >= 0 && score > max) ? max + 1 : score;
+}
+
+/*
+ * Banded edit distance for patterns too long for one word. Only cells within
+ * max of the diagonal are filled, using three rolling rows over the shorter
+ * string (cols), and the walk stops once two consecutive rows exceed max.
+ */
+static i32 fossil_it_magic_lev_banded(
+    ccstring rows, i32 m, ccstring cols, i32 n, i32 max, bool transpose)
+{
+    const i32 band = (max >= 0) ? max : (m > n ? m : n);
+    const i32 far = band + 1;
+    i32 stack_buf[3 * (FOSSIL_IT_MAGIC_LEV_STACK + 1)];
+    i32 *buf = stack_buf;
+
+    if (n + 1 > FOSSIL_IT_MAGIC_LEV_STACK + 1)
+    {
+        buf = (i32 *)fossil_sys_memory_calloc((size_t)3 * (size_t)(n + 1), sizeof(i32));
+        if (!cnotnull(buf))
+            return INT_MAX;
+    }
+
+    i32 *pp = buf, *prev = buf + (n + 1), *cur = buf + 2 * (n + 1);
+    i32 hi = n < band ? n : band;
+    for (i32 j = 0; j <= hi; j++)
+        prev[j] = j;
+    if (hi < n)
+        prev[hi + 1] = far;
+
+    i32 result = -1;
+    i32 prev_min = 0;
+    for (i32 i = 1; i <= m && result < 0; i++)
     {
-        for (i32 j = 0; j < count2; j++)
+        i32 lo = i - band > 1 ? i - band : 1;
+        hi = i + band < n ? i + band : n;
+        i32 ci = tolower((unsigned char)rows[i - 1]);
+        i32 row_min = INT_MAX;
+
+        cur[lo - 1] = (lo == 1) ? i : far;
+        for (i32 j = lo; j <= hi; j++)
         {
-            if (!used[j] && fossil_io_cstring_compare(tokens1[i], tokens2[j]) == 0)
-            {
-                match++;
-                used[j] = 1;
-                break;
-            }
+            i32 cj = tolower((unsigned char)cols[j - 1]);
+            i32 cost = (ci == cj) ? 0 : 1;
+            i32 best = prev[j - 1] + cost;
+            if (prev[j] + 1 < best)
+                best = prev[j] + 1;
+            if (cur[j - 1] + 1 < best)
+                best = cur[j - 1] + 1;
+            if (transpose && i > 1 && j > 1 &&
+                ci == tolower((unsigned char)cols[j - 2]) &&
+                tolower((unsigned char)rows[i - 2]) == cj &&
+                pp[j - 2] + 1 < best)
+                best = pp[j - 2] + 1;
+            if (best > far)
+                best = far;
+            cur[j] = best;
+            if (best < row_min)
+                row_min = best;
         }
+        if (hi < n)
+            cur[hi + 1] = far;
+
+        if (max >= 0 && row_min > max && prev_min > max)
+            result = max + 1;
+        prev_min = row_min;
+
+        i32 *tmp = pp;
+        pp = prev;
+        prev = cur;
+        cur = tmp;
     }
-    i32 total = count1 + count2 - match;
-    return total ? (100 * match / total) : 0;
+
+    if (result < 0)
+        result = prev[n];
+    if (buf != stack_buf)
+        fossil_sys_memory_free(buf);
+    return (max >= 0 && result > max) ? max + 1 : result;
 }
 
 // Advanced Levenshtein: case-insensitive, transpositions (Damerau-Levenshtein)
-int fossil_it_magic_levenshtein_distance(ccstring s1, ccstring s2)
+int fossil_it_magic_levenshtein_bounded(ccstring s1, ccstring s2, int max_distance)
 {
     if (!cnotnull(s1) || !cnotnull(s2))
         return INT_MAX;
     i32 len1 = (i32)strlen(s1), len2 = (i32)strlen(s2);
 
-    i32 *dp = (i32 *)fossil_sys_memory_calloc((size_t)(len1 + 2) * (size_t)(len2 + 2), sizeof(i32));
-    if (!cnotnull(dp))
-        return INT_MAX;
-
-    for (i32 j = 0; j <= len2; j++)
-        dp[(0) * (len2 + 2) + (j)] = j;
-
-    for (i32 i = 1; i <= len1; i++)
+    // Distance is symmetric; run the kernels over the shorter string
+    if (len1 > len2)
     {
-        for (i32 j = 1; j <= len2; j++)
-        {
-            i32 cost = (tolower((unsigned char)s1[i - 1]) == tolower((unsigned char)s2[j - 1])) ? 0 : 1;
-            i32 del = DP(i - 1, j) + 1;
-            i32 ins = DP(i, j - 1) + 1;
-            i32 sub = DP(i - 1, j - 1) + cost;
-            i32 min = del < ins ? del : ins;
-            min = (min < sub) ? min : sub;
-            DP(i, j) = min;
+        ccstring ts = s1;
+        s1 = s2;
+        s2 = ts;
+        i32 tl = len1;
+        len1 = len2;
+        len2 = tl;
+    }
 
-            if (i > 1 && j > 1 &&
-                tolower((unsigned char)s1[i - 1]) == tolower((unsigned char)s2[j - 2]) &&
-                tolower((unsigned char)s1[i - 2]) == tolower((unsigned char)s2[j - 1]))
-            {
-                DP(i, j) = DP(i, j) < (DP(i - 2, j - 2) + cost) ? DP(i, j) : (DP(i - 2, j - 2) + cost);
-            }
-        }
+    if (max_distance >= 0 && len2 - len1 > max_distance)
+        return max_distance + 1;
+    if (len1 == 0)
+        return len2;
+    if (len1 <= FOSSIL_IT_MAGIC_LEV_WORD)
+    {
+        fossil_it_magic_pattern_t pat;
+        fossil_it_magic_pattern_init(&pat, s1, len1);
+        return fossil_it_magic_lev_bitparallel(pat.peq, pat.len, s2, len2, max_distance, true);
     }
+    return fossil_it_magic_lev_banded(s2, len2, s1, len1, max_distance, true);
+}
 
-    i32 result = DP(len1, len2);
-    fossil_sys_memory_free(dp);
-#undef DP
-    return result;
+int fossil_it_magic_levenshtein_distance(ccstring s1, ccstring s2)
+{
+    return fossil_it_magic_levenshtein_bounded(s1, s2, -1);
 }
 
-f32 fossil_it_magic_similarity(ccstring a, ccstring b)
+// Edit distance normalized by length, plus token overlap and affix bonuses
+static f32 fossil_it_magic_similarity_from(
+    i32 dist, i32 len_a, i32 len_b, i32 jaccard, i32 case_prefix, i32 suffix)
 {
-    if (!cnotnull(a) || !cnotnull(b))
-        return 0.0f;
-    i32 len_a = (i32)strlen(a), len_b = (i32)strlen(b);
     if (len_a == 0 && len_b == 0)
         return 1.0f;
 
-    i32 dist = fossil_it_magic_levenshtein_distance(a, b);
     i32 max_len = len_a > len_b ? len_a : len_b;
     f32 sim = 1.0f - ((f32)dist / (f32)max_len);
-
-    i32 jaccard = fossil_it_magic_jaccard_index(a, b);
     sim += jaccard / 200.0f;
 
-    if (fossil_io_cstring_case_starts_with(a, b))
+    if (case_prefix)
         sim += 0.10f;
-    if (len_a <= len_b &&
-        fossil_io_cstring_case_ends_with(b, a))
+    if (suffix)
         sim += 0.07f;
 
     if (sim > 1.0f)
@@ -330,10 +813,224 @@ f32 fossil_it_magic_similarity(ccstring a, ccstring b)
     return sim;
 }
 
+static ccstring fossil_it_magic_reason_text(const fossil_ti_reason_t *r)
+{
+    f32 score = r->confidence_score;
+    return (score >= 0.99f) ? "Exact match"
+         : (score >= 0.95f) ? "Strong semantic match"
+         : (score >= 0.90f) ? "Strong semantic and token match"
+         : (score >= 0.85f) ? "High semantic and token similarity"
+         : (score >= 0.80f) ? "Good semantic similarity"
+         : (score >= 0.75f) ? "Moderate semantic similarity"
+         : (score >= 0.70f) ? "Close semantic match"
+         : r->prefix_match && r->suffix_match ? "Prefix and suffix match"
+         : r->prefix_match ? "Prefix match"
+         : r->suffix_match ? "Suffix match"
+         : r->case_insensitive ? "Case-insensitive match"
+         : (r->jaccard_index >= 50) ? "Token overlap match"
+                                    : "Low confidence match";
+}
+
+f32 fossil_it_magic_similarity(ccstring a, ccstring b)
+{
+    if (!cnotnull(a) || !cnotnull(b))
+        return 0.0f;
+
+    fossil_ti_score_ctx_t ctx;
+    fossil_ti_reason_t reason;
+    fossil_it_magic_score_init(&ctx, a);
+    fossil_it_magic_score_candidate(&ctx, b, &reason);
+    fossil_it_magic_score_dispose(&ctx);
+    return reason.similarity;
+}
+
 /* ==========================================================================
  * Command Suggestion
  * ========================================================================== */
 
+void fossil_it_magic_score_init(fossil_ti_score_ctx_t *ctx, ccstring input)
+{
+    if (!cnotnull(ctx))
+        return;
+    ctx->input = input;
+    ctx->input_len = cnotnull(input) ? (i32)strlen(input) : 0;
+    if (ctx->input_len > 0 && ctx->input_len <= FOSSIL_IT_MAGIC_LEV_WORD)
+        fossil_it_magic_peq_init(ctx->peq, input, ctx->input_len);
+
+    fossil_it_magic_token_set_t set;
+    fossil_it_magic_token_set_init(&set, ctx->token_slots, FOSSIL_TI_TOKEN_SLOTS);
+    if (cnotnull(input))
+        fossil_it_magic_tokenize(input, &set);
+    ctx->token_count = set.count;
+    ctx->token_capacity = set.capacity;
+    ctx->token_heap = set.heap;
+}
+
+void fossil_it_magic_score_dispose(fossil_ti_score_ctx_t *ctx)
+{
+    if (!cnotnull(ctx))
+        return;
+    if (cnotnull(ctx->token_heap))
+        fossil_sys_memory_free(ctx->token_heap);
+    ctx->token_heap = cnull;
+    ctx->token_count = 0;
+    ctx->token_capacity = 0;
+}
+
+/*
+ * Everything in a score except the edit distance is cheap to measure, and the
+ * score only falls as the distance grows. So once those parts are known, the
+ * largest distance that still reaches a caller's minimum rank bounds the
+ * distance kernel, and a candidate that cannot reach it stops early.
+ */
+typedef struct
+{
+    i32 cand_len;
+    i32 jaccard;
+    i32 case_prefix;
+    i32 prefix;
+    i32 suffix;
+    i32 icase;
+    i32 exact;
+} fossil_it_magic_facts_t;
+
+static f32 fossil_it_magic_confidence_from(const fossil_it_magic_facts_t *f, f32 similarity)
+{
+    f32 score = similarity;
+    if (f->prefix)
+        score += 0.15f;
+    if (f->suffix)
+        score += 0.10f;
+    if (f->icase)
+        score += 0.05f;
+    if (f->exact)
+        score += 0.20f;
+    score += f->jaccard / 200.0f;
+    if (score > 1.0f)
+        score = 1.0f;
+    if (score < 0.0f)
+        score = 0.0f;
+    return score;
+}
+
+// Suggestion confidence, or for path_rank the similarity plus affix bonuses used on directory entries
+static f32 fossil_it_magic_rank_at(
+    const fossil_ti_score_ctx_t *ctx, const fossil_it_magic_facts_t *f, i32 dist, bool path_rank)
+{
+    f32 sim = fossil_it_magic_similarity_from(
+        dist, ctx->input_len, f->cand_len, f->jaccard, f->case_prefix, f->suffix);
+    if (!path_rank)
+        return fossil_it_magic_confidence_from(f, sim);
+    if (f->case_prefix)
+        sim += 0.10f;
+    if (f->suffix)
+        sim += 0.07f;
+    return sim;
+}
+
+static i32 fossil_it_magic_distance_within(const fossil_ti_score_ctx_t *ctx, ccstring candidate, i32 cand_len, i32 max)
+{
+    if (ctx->input_len == 0)
+        return cand_len;
+    if (cand_len == 0)
+        return ctx->input_len;
+    if (ctx->input_len <= FOSSIL_IT_MAGIC_LEV_WORD)
+        return fossil_it_magic_lev_bitparallel(ctx->peq, ctx->input_len, candidate, cand_len, max, true);
+    return fossil_it_magic_levenshtein_bounded(ctx->input, candidate, max);
+}
+
+/*
+ * Scores a candidate whose rank only matters if it reaches min_rank. One at or
+ * above it gets its exact distance and rank; one below may stop early and
+ * report a lower bound on its distance, which still ranks below min_rank.
+ */
+static f32 fossil_it_magic_score_within(
+    const fossil_ti_score_ctx_t *ctx, ccstring candidate, bool path_rank, f32 min_rank,
+    fossil_ti_reason_t *out)
+{
+    fossil_ti_reason_t r = {0};
+    r.edit_distance = INT_MAX;
+    if (!cnotnull(ctx) || !cnotnull(ctx->input) || !cnotnull(candidate))
+    {
+        if (cnotnull(out))
+            *out = r;
+        return 0.0f;
+    }
+
+    ccstring input = ctx->input;
+    fossil_it_magic_facts_t f;
+    f.cand_len = (i32)strlen(candidate);
+    f.jaccard = fossil_it_magic_jaccard_ctx(ctx, candidate);
+    f.case_prefix = fossil_io_cstring_case_starts_with(input, candidate) ? 1 : 0;
+    f.prefix = (f.case_prefix && fossil_io_cstring_starts_with(input, candidate)) ? 1 : 0;
+    f.suffix = (ctx->input_len <= f.cand_len &&
+                fossil_io_cstring_case_ends_with(candidate, input))
+                   ? 1
+                   : 0;
+    f.icase = fossil_io_cstring_iequals(input, candidate) ? 1 : 0;
+    f.exact = (f.icase && fossil_io_cstring_equals(input, candidate)) ? 1 : 0;
+
+    // The length gap is a lower bound on the distance; search up to the longer length
+    i32 lo = abs(ctx->input_len - f.cand_len);
+    i32 hi = ctx->input_len > f.cand_len ? ctx->input_len : f.cand_len;
+    if (fossil_it_magic_rank_at(ctx, &f, lo, path_rank) < min_rank)
+    {
+        r.edit_distance = lo;
+    }
+    else
+    {
+        i32 max = -1;
+        if (fossil_it_magic_rank_at(ctx, &f, hi, path_rank) < min_rank)
+        {
+            // Largest distance still reaching min_rank: rank(lo) >= min_rank > rank(hi)
+            while (hi - lo > 1)
+            {
+                i32 mid = lo + (hi - lo) / 2;
+                if (fossil_it_magic_rank_at(ctx, &f, mid, path_rank) >= min_rank)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            max = lo;
+        }
+        r.edit_distance = fossil_it_magic_distance_within(ctx, candidate, f.cand_len, max);
+    }
+
+    r.input = input;
+    r.suggested = candidate;
+    r.jaccard_index = f.jaccard;
+    r.prefix_match = f.prefix;
+    r.suffix_match = f.suffix;
+    r.case_insensitive = f.icase;
+    r.exact_match = f.exact;
+    r.similarity = fossil_it_magic_similarity_from(
+        r.edit_distance, ctx->input_len, f.cand_len, f.jaccard, f.case_prefix, f.suffix);
+    r.confidence_score = fossil_it_magic_confidence_from(&f, r.similarity);
+    r.reason = fossil_it_magic_reason_text(&r);
+    if (cnotnull(out))
+        *out = r;
+    return path_rank ? fossil_it_magic_rank_at(ctx, &f, r.edit_distance, true) : r.confidence_score;
+}
+
+f32 fossil_it_magic_score_candidate(
+    const fossil_ti_score_ctx_t *ctx,
+    ccstring candidate,
+    fossil_ti_reason_t *out)
+{
+    return fossil_it_magic_score_within(ctx, candidate, false, -1.0f, out);
+}
+
+// Ranking shared by every suggestion path: exact hits win, then score, distance, prefix
+static bool fossil_it_magic_is_better(const fossil_ti_reason_t *r, const fossil_ti_reason_t *best)
+{
+    f32 score = r->confidence_score;
+    return r->exact_match ||
+           score > best->confidence_score ||
+           (score == best->confidence_score && r->edit_distance < best->edit_distance) ||
+           (score == best->confidence_score && r->edit_distance == best->edit_distance &&
+            r->prefix_match > best->prefix_match);
+}
+
 ccstring fossil_it_magic_suggest_command(
     ccstring input,
     ccstring *commands,
@@ -343,190 +1040,706 @@ ccstring fossil_it_magic_suggest_command(
     if (!cnotnull(input) || !cnotnull(commands) || num_commands <= 0)
         return cnull;
 
+    fossil_ti_score_ctx_t ctx;
+    fossil_it_magic_score_init(&ctx, input);
+
     ccstring best_match = cnull;
-    f32 best_score = 0.0f;
-    i32 best_distance = INT_MAX;
-    i32 best_jaccard = 0;
-    i32 best_prefix = 0;
-    i32 best_suffix = 0;
-    i32 best_case_insensitive = 0;
+    fossil_ti_reason_t best = {0};
+    best.edit_distance = INT_MAX;
 
     for (i32 i = 0; i < num_commands; i++)
     {
         if (!cnotnull(commands[i]))
             continue;
 
-        i32 distance = fossil_it_magic_levenshtein_distance(input, commands[i]);
-        i32 jaccard = fossil_it_magic_jaccard_index(input, commands[i]);
-        i32 prefix = fossil_io_cstring_starts_with(input, commands[i]);
-        i32 suffix = (strlen(input) <= strlen(commands[i]) &&
-                      fossil_io_cstring_case_ends_with(commands[i], input))
-                         ? 1
-                         : 0;
-        i32 case_insensitive = fossil_io_cstring_iequals(input, commands[i]);
-        i32 exact = fossil_io_cstring_equals(input, commands[i]);
-
-        f32 sim = fossil_it_magic_similarity(input, commands[i]);
-        f32 score = sim;
-
-        if (prefix)
-            score += 0.15f;
-        if (suffix)
-            score += 0.10f;
-        if (case_insensitive)
-            score += 0.05f;
-        if (exact)
-            score += 0.20f;
-        score += jaccard / 200.0f;
-        if (score > 1.0f)
-            score = 1.0f;
-        if (score < 0.0f)
-            score = 0.0f;
-
-        if (exact ||
-            score > best_score ||
-            (score == best_score && distance < best_distance) ||
-            (score == best_score && distance == best_distance && prefix > best_prefix))
+        // Only a candidate reaching the best score so far can replace it
+        fossil_ti_reason_t r;
+        f32 min_rank = cnotnull(best_match) ? best.confidence_score : -1.0f;
+        fossil_it_magic_score_within(&ctx, commands[i], false, min_rank, &r);
+
+        if (fossil_it_magic_is_better(&r, &best))
         {
             best_match = commands[i];
-            best_score = score;
-            best_distance = distance;
-            best_jaccard = jaccard;
-            best_prefix = prefix;
-            best_suffix = suffix;
-            best_case_insensitive = case_insensitive;
+            best = r;
         }
     }
+    fossil_it_magic_score_dispose(&ctx);
 
     if (!cnotnull(best_match))
         return cnull;
 
     if (cnotnull(out_reason))
-    {
-        out_reason->input = input;
-        out_reason->suggested = best_match;
-        out_reason->edit_distance = best_distance;
-        out_reason->confidence_score = best_score;
-        out_reason->jaccard_index = best_jaccard;
-        out_reason->prefix_match = best_prefix;
-        out_reason->suffix_match = best_suffix;
-        out_reason->case_insensitive = best_case_insensitive;
-        out_reason->reason = (best_score >= 0.99f) ? "Exact match" : (best_score >= 0.95f)    ? "Strong semantic match"
-                                                                 : (best_score >= 0.90f)      ? "Strong semantic and token match"
-                                                                 : (best_score >= 0.85f)      ? "High semantic and token similarity"
-                                                                 : (best_score >= 0.80f)      ? "Good semantic similarity"
-                                                                 : (best_score >= 0.75f)      ? "Moderate semantic similarity"
-                                                                 : (best_score >= 0.70f)      ? "Close semantic match"
-                                                                 : best_prefix && best_suffix ? "Prefix and suffix match"
-                                                                 : best_prefix                ? "Prefix match"
-                                                                 : best_suffix                ? "Suffix match"
-                                                                 : best_case_insensitive      ? "Case-insensitive match"
-                                                                 : (best_jaccard >= 50)       ? "Token overlap match"
-                                                                                              : "Low confidence match";
-    }
-
-    return (best_score >= 0.7f) ? best_match : cnull;
+        *out_reason = best;
+
+    return (best.confidence_score >= 0.7f) ? best_match : cnull;
 }
 
 /* ==========================================================================
- * Path Auto-Correction
+ * Candidate Index
  * ========================================================================== */
 
-void fossil_it_magic_path_suggest(
-    ccstring bad_path,
-    ccstring base_dir,
-    fossil_ti_path_suggestion_set_t *out)
+/*
+ * The tree is keyed by plain Levenshtein: it is a true metric, which the
+ * pruning below relies on, while OSA transpositions are not. A swapped pair
+ * costs two plain edits, which the default search radius allows for. The
+ * folded character set and length give a cheap lower bound, so most leaves
+ * are rejected without reading their term.
+ */
+// Each edit changes at most two bits of the folded character set
+static uint64_t fossil_it_magic_char_mask(ccstring s)
 {
-    out->count = 0;
-    fossil_io_filesys_obj_t entries[64];
-    size_t entry_count = 0;
-    if (fossil_io_filesys_dir_list(base_dir, entries, 64, &entry_count) != 0)
-        return;
+    uint64_t mask = 0;
+    for (; *s; s++)
+        mask |= (uint64_t)1 << (tolower((unsigned char)*s) & 63);
+    return mask;
+}
 
-    struct
-    {
-        char name[FOSSIL_FILESYS_MAX_PATH];
-        f32 score;
-        int exists;
-    } candidates[32];
+static i32 fossil_it_magic_popcount(uint64_t v)
+{
+    i32 n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+}
 
-    f32 best_score = 0.0f;
-    i32 idx = 0;
+static i32 fossil_it_magic_index_distance(
+    const uint64_t *peq, ccstring input, i32 input_len, uint64_t input_mask,
+    const fossil_ti_bk_node_t *node, i32 max)
+{
+    if (input_len == 0)
+        return node->len;
+    if (node->len == 0)
+        return input_len;
+    if (max >= 0 &&
+        (abs(node->len - input_len) > max ||
+         (fossil_it_magic_popcount(node->mask ^ input_mask) + 1) / 2 > max))
+        return max + 1;
+    if (input_len <= FOSSIL_IT_MAGIC_LEV_WORD)
+        return fossil_it_magic_lev_bitparallel(peq, input_len, node->term, node->len, max, false);
+    return fossil_it_magic_lev_banded(node->term, node->len, input, input_len, max, false);
+}
 
-    for (size_t i = 0; i < entry_count && idx < 32; ++i)
-    {
-        ccstring entry_name = entries[i].path;
-        char basename[FOSSIL_FILESYS_MAX_PATH];
-        if (fossil_io_filesys_basename(entry_name, basename, sizeof(basename)) != 0)
-            continue;
-        if (!strcmp(basename, ".") || !strcmp(basename, ".."))
-            continue;
+void fossil_it_magic_index_init(fossil_ti_index_t *index)
+{
+    if (!cnotnull(index))
+        return;
+    index->nodes = cnull;
+    index->count = 0;
+    index->capacity = 0;
+}
 
-        f32 score = fossil_it_magic_similarity(bad_path, basename);
+void fossil_it_magic_index_dispose(fossil_ti_index_t *index)
+{
+    if (!cnotnull(index))
+        return;
+    if (cnotnull(index->nodes))
+        fossil_sys_memory_free(index->nodes);
+    fossil_it_magic_index_init(index);
+}
 
-        if (fossil_io_cstring_case_starts_with(bad_path, basename))
-            score += 0.10f;
-        if (strlen(bad_path) <= strlen(basename) &&
-            fossil_io_cstring_case_ends_with(basename, bad_path))
-            score += 0.07f;
+int fossil_it_magic_index_add(fossil_ti_index_t *index, ccstring term)
+{
+    if (!cnotnull(index) || !cnotnull(term))
+        return -1;
 
-        if (score < 0.18f)
-            continue;
+    if (index->count == index->capacity)
+    {
+        i32 cap = index->capacity ? index->capacity * 2 : 64;
+        fossil_ti_bk_node_t *grown = (fossil_ti_bk_node_t *)fossil_sys_memory_realloc(
+            index->nodes, (size_t)cap * sizeof(*grown));
+        if (!cnotnull(grown))
+            return -1;
+        index->nodes = grown;
+        index->capacity = cap;
+    }
+
+    i32 len = (i32)strlen(term);
+    uint64_t mask = fossil_it_magic_char_mask(term);
+    fossil_ti_bk_node_t node = {term, len, mask, 0, 0, -1, -1};
+    if (index->count == 0)
+    {
+        index->nodes[index->count++] = node;
+        return 0;
+    }
+
+    fossil_it_magic_pattern_t pat;
+    if (len > 0 && len <= FOSSIL_IT_MAGIC_LEV_WORD)
+        fossil_it_magic_pattern_init(&pat, term, len);
+
+    i32 at = 0;
+    for (;;)
+    {
+        i32 d = fossil_it_magic_index_distance(pat.peq, term, len, mask, &index->nodes[at], -1);
+        if (d == 0)
+            return 0; // already indexed, ignoring case
+
+        // Children stay sorted by edge so lookups can stop past their window
+        i32 *link = &index->nodes[at].child;
+        while (*link >= 0 && index->nodes[*link].edge < d)
+            link = &index->nodes[*link].sibling;
+        if (*link < 0 || index->nodes[*link].edge != d)
+        {
+            node.edge = d;
+            node.sibling = *link;
+            *link = index->count;
+            if (d > index->nodes[at].max_edge)
+                index->nodes[at].max_edge = d;
+            index->nodes[index->count++] = node;
+            return 0;
+        }
+        at = *link;
+    }
+}
+
+ccstring fossil_it_magic_index_suggest(
+    const fossil_ti_index_t *index,
+    ccstring input,
+    i32 max_distance,
+    fossil_ti_reason_t *out_reason)
+{
+    if (!cnotnull(index) || !cnotnull(input) || index->count == 0)
+        return cnull;
+
+    fossil_ti_score_ctx_t ctx;
+    fossil_it_magic_score_init(&ctx, input);
+    const i32 radius = (max_distance >= 0) ? max_distance : (ctx.input_len < 4 ? 1 : 2);
+
+    const uint64_t mask = fossil_it_magic_char_mask(input);
+
+    ccstring best_match = cnull;
+    fossil_ti_reason_t best = {0};
+    best.edit_distance = INT_MAX;
+
+    // Depth-first walk; the pending list only spills to the heap on deep trees
+    i32 stack_buf[256];
+    i32 *stack = stack_buf;
+    i32 stack_cap = (i32)(sizeof(stack_buf) / sizeof(stack_buf[0]));
+    i32 top = 0;
+    bool truncated = false;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const fossil_ti_bk_node_t *node = &index->nodes[stack[--top]];
+
+        // Past max_edge + radius neither this term nor any child can match
+        i32 cap = node->max_edge + radius;
+        i32 d = fossil_it_magic_index_distance(ctx.peq, input, ctx.input_len, mask, node, cap);
+        if (d > cap)
+            continue;
 
-        // Compose candidate path
-        char candidate_path[FOSSIL_FILESYS_MAX_PATH];
-        size_t base_len = strlen(base_dir);
-        if (base_len > 0 && (base_dir[base_len - 1] == '/' || base_dir[base_len - 1] == '\\')) {
-            int n = snprintf(candidate_path, sizeof(candidate_path), "%s%s", base_dir, basename);
-            if (n < 0 || (size_t)n >= sizeof(candidate_path)) {
-                candidate_path[sizeof(candidate_path) - 1] = cterm;
+        if (d <= radius)
+        {
+            fossil_ti_reason_t r;
+            f32 min_rank = cnotnull(best_match) ? best.confidence_score : -1.0f;
+            fossil_it_magic_score_within(&ctx, node->term, false, min_rank, &r);
+            if (fossil_it_magic_is_better(&r, &best))
+            {
+                best_match = node->term;
+                best = r;
             }
-        } else {
-            int n = snprintf(candidate_path, sizeof(candidate_path), "%s/%s", base_dir, basename);
-            if (n < 0 || (size_t)n >= sizeof(candidate_path)) {
-                candidate_path[sizeof(candidate_path) - 1] = cterm;
+        }
+
+        // Triangle inequality: only subtrees at edge d +/- radius can hold matches
+        for (i32 c = node->child; c >= 0; c = index->nodes[c].sibling)
+        {
+            i32 edge = index->nodes[c].edge;
+            if (edge < d - radius)
+                continue;
+            if (edge > d + radius)
+                break;
+            if (top == stack_cap)
+            {
+                i32 grown_cap = stack_cap * 2;
+                i32 *grown = (i32 *)fossil_sys_memory_realloc(
+                    (stack == stack_buf) ? cnull : stack, (size_t)grown_cap * sizeof(i32));
+                if (!cnotnull(grown))
+                {
+                    // A partial walk could miss the best term, so give no answer at all
+                    truncated = true;
+                    top = 0;
+                    break;
+                }
+                if (stack == stack_buf)
+                    memcpy(grown, stack_buf, sizeof(stack_buf));
+                stack = grown;
+                stack_cap = grown_cap;
             }
+            stack[top++] = c;
         }
+    }
 
-        strncpy(candidates[idx].name, candidate_path, sizeof(candidates[idx].name) - 1);
-        candidates[idx].name[sizeof(candidates[idx].name) - 1] = cterm;
+    if (stack != stack_buf)
+        fossil_sys_memory_free(stack);
+    fossil_it_magic_score_dispose(&ctx);
 
-        candidates[idx].exists = (fossil_io_filesys_exists(candidate_path) > 0);
-        candidates[idx].score = score;
-        if (score > best_score)
+    if (truncated)
+    {
+        if (cnotnull(out_reason))
         {
-            best_score = score;
+            memset(out_reason, 0, sizeof(*out_reason));
+            out_reason->input = input;
+            out_reason->edit_distance = -1;
+            out_reason->reason = "out of memory while searching the index";
+        }
+        return cnull;
+    }
+
+    if (!cnotnull(best_match))
+        return cnull;
+
+    if (cnotnull(out_reason))
+        *out_reason = best;
+
+    return (best.confidence_score >= 0.7f) ? best_match : cnull;
+}
+
+/* ==========================================================================
+ * Path Auto-Correction
+ * ========================================================================== */
+
+typedef struct
+{
+    f32 score;
+    i32 slot; // index into the name pool, never moved
+} fossil_it_magic_ranked_t;
+
+typedef struct
+{
+    fossil_it_magic_ranked_t heap[16]; // min-heap: heap[0] is the weakest kept
+    char names[16][FOSSIL_IT_MAGIC_NAME_MAX];
+    i32 count;
+} fossil_it_magic_topk_t;
+
+// Lower score loses; equal scores fall back to name order, independent of readdir order
+static bool fossil_it_magic_topk_weaker(
+    const fossil_it_magic_topk_t *k, fossil_it_magic_ranked_t a, fossil_it_magic_ranked_t b)
+{
+    if (a.score != b.score)
+        return a.score < b.score;
+    return strcmp(k->names[a.slot], k->names[b.slot]) > 0;
+}
+
+static void fossil_it_magic_topk_sift_down(fossil_it_magic_topk_t *k, i32 i)
+{
+    for (;;)
+    {
+        i32 l = 2 * i + 1, r = l + 1, m = i;
+        if (l < k->count && fossil_it_magic_topk_weaker(k, k->heap[l], k->heap[m]))
+            m = l;
+        if (r < k->count && fossil_it_magic_topk_weaker(k, k->heap[r], k->heap[m]))
+            m = r;
+        if (m == i)
+            return;
+        fossil_it_magic_ranked_t t = k->heap[i];
+        k->heap[i] = k->heap[m];
+        k->heap[m] = t;
+        i = m;
+    }
+}
+
+static void fossil_it_magic_topk_offer(fossil_it_magic_topk_t *k, i32 cap, ccstring name, f32 score)
+{
+    size_t len = strlen(name);
+    if (len >= FOSSIL_IT_MAGIC_NAME_MAX)
+        return;
+
+    if (k->count < cap)
+    {
+        i32 i = k->count++;
+        memcpy(k->names[i], name, len + 1);
+        k->heap[i].score = score;
+        k->heap[i].slot = i;
+        while (i > 0)
+        {
+            i32 parent = (i - 1) / 2;
+            if (!fossil_it_magic_topk_weaker(k, k->heap[i], k->heap[parent]))
+                break;
+            fossil_it_magic_ranked_t t = k->heap[i];
+            k->heap[i] = k->heap[parent];
+            k->heap[parent] = t;
+            i = parent;
         }
-        idx++;
+        return;
+    }
+
+    // Full: only a candidate beating the weakest kept one costs a name copy
+    if (score < k->heap[0].score ||
+        (score == k->heap[0].score && strcmp(name, k->names[k->heap[0].slot]) >= 0))
+        return;
+    memcpy(k->names[k->heap[0].slot], name, len + 1);
+    k->heap[0].score = score;
+    fossil_it_magic_topk_sift_down(k, 0);
+}
+
+// Similarity plus affix bonuses for one directory entry against a misspelled name
+static f32 fossil_it_magic_path_score(const fossil_ti_score_ctx_t *ctx, ccstring name, f32 min_rank)
+{
+    return fossil_it_magic_score_within(ctx, name, true, min_rank, cnull);
+}
+
+// Least score a new name needs to be kept: the weakest held once the list is full
+static f32 fossil_it_magic_topk_floor(const fossil_it_magic_topk_t *k, i32 cap)
+{
+    return (k->count < cap) ? FOSSIL_IT_MAGIC_PATH_MIN : k->heap[0].score;
+}
+
+void fossil_it_magic_path_suggest(
+    ccstring bad_path,
+    ccstring base_dir,
+    fossil_ti_path_suggestion_set_t *out)
+{
+    out->count = 0;
+    out->source_index = 0;
+    if (!cnotnull(bad_path) || !cnotnull(base_dir))
+        return;
+
+    fossil_it_magic_dir_iter_t it;
+    if (!fossil_it_magic_dir_open(&it, base_dir))
+        return;
+
+    const i32 cap = (i32)(sizeof(out->list) / sizeof(out->list[0]));
+    fossil_it_magic_topk_t top;
+    top.count = 0;
+
+    fossil_ti_score_ctx_t ctx;
+    fossil_it_magic_score_init(&ctx, bad_path);
+
+    size_t base_len = strlen(base_dir);
+    ccstring sep = (base_len > 0 && (base_dir[base_len - 1] == '/' || base_dir[base_len - 1] == '\\')) ? "" : "/";
+    const size_t prefix_len = base_len + strlen(sep);
+
+    while (fossil_it_magic_dir_next(&it))
+    {
+        // A name whose full path cannot be returned must not take a slot from one that can
+        if (prefix_len + strlen(it.name) >= sizeof(out->list[0].candidate_path))
+            continue;
+
+        f32 score = fossil_it_magic_path_score(&ctx, it.name, fossil_it_magic_topk_floor(&top, cap));
+        if (score < FOSSIL_IT_MAGIC_PATH_MIN)
+            continue;
+
+        fossil_it_magic_topk_offer(&top, cap, it.name, score);
+    }
+    fossil_it_magic_dir_close(&it);
+    fossil_it_magic_score_dispose(&ctx);
+
+    // Drain the min-heap back to front for a best-first list
+    fossil_it_magic_ranked_t ranked[16];
+    i32 n = top.count;
+    for (i32 i = n - 1; i >= 0; i--)
+    {
+        ranked[i] = top.heap[0];
+        top.heap[0] = top.heap[--top.count];
+        fossil_it_magic_topk_sift_down(&top, 0);
+    }
+
+    for (i32 i = 0; i < n; i++)
+    {
+        fossil_ti_path_suggestion_t *dst = &out->list[out->count];
+        int w = snprintf(dst->candidate_path, sizeof(dst->candidate_path), "%s%s%s",
+                         base_dir, sep, top.names[ranked[i].slot]);
+        if (w < 0 || (size_t)w >= sizeof(dst->candidate_path))
+            continue;
+        dst->similarity_score = ranked[i].score;
+        dst->exists = 1; // it came out of the listing; no stat needed
+        out->count++;
+    }
+}
+
+/*
+ * Directory listing cache shared by every beam item and every argument of a
+ * report: each directory is read once, names packed into one arena as
+ * "<kind><name>\0" where kind is 'd', 'f' or '?' (listing did not say).
+ */
+typedef struct
+{
+    char path[FOSSIL_FILESYS_MAX_PATH];
+    char *arena;
+    size_t used;
+    size_t cap;
+    bool ok;
+} fossil_it_magic_listing_t;
+
+typedef struct
+{
+    fossil_it_magic_listing_t dirs[FOSSIL_IT_MAGIC_DIR_CACHE];
+    i32 count;
+    i32 next_evict;
+} fossil_it_magic_dir_cache_t;
+
+static void fossil_it_magic_dir_cache_dispose(fossil_it_magic_dir_cache_t *cache)
+{
+    for (i32 i = 0; i < cache->count; i++)
+    {
+        if (cnotnull(cache->dirs[i].arena))
+            fossil_sys_memory_free(cache->dirs[i].arena);
+    }
+    cache->count = 0;
+    cache->next_evict = 0;
+}
+
+static bool fossil_it_magic_listing_push(fossil_it_magic_listing_t *l, char kind, ccstring name)
+{
+    size_t len = strlen(name) + 2;
+    if (l->used + len > l->cap)
+    {
+        size_t cap = l->cap ? l->cap * 2 : 4096;
+        while (cap < l->used + len)
+            cap *= 2;
+        char *grown = (char *)fossil_sys_memory_realloc(l->arena, cap);
+        if (!cnotnull(grown))
+            return false;
+        l->arena = grown;
+        l->cap = cap;
+    }
+    l->arena[l->used] = kind;
+    memcpy(l->arena + l->used + 1, name, len - 1);
+    l->used += len;
+    return true;
+}
+
+static const fossil_it_magic_listing_t *fossil_it_magic_dir_cache_get(
+    fossil_it_magic_dir_cache_t *cache, ccstring dir)
+{
+    for (i32 i = 0; i < cache->count; i++)
+    {
+        if (strcmp(cache->dirs[i].path, dir) == 0)
+            return &cache->dirs[i];
     }
+    if (strlen(dir) >= sizeof(cache->dirs[0].path))
+        return cnull;
+
+    fossil_it_magic_listing_t *l;
+    if (cache->count < FOSSIL_IT_MAGIC_DIR_CACHE)
+    {
+        l = &cache->dirs[cache->count++];
+    }
+    else
+    {
+        l = &cache->dirs[cache->next_evict];
+        cache->next_evict = (cache->next_evict + 1) % FOSSIL_IT_MAGIC_DIR_CACHE;
+        if (cnotnull(l->arena))
+            fossil_sys_memory_free(l->arena);
+    }
+    strcpy(l->path, dir);
+    l->arena = cnull;
+    l->used = 0;
+    l->cap = 0;
+
+    // Negative results are cached too: a missing parent is only probed once
+    fossil_it_magic_dir_iter_t it;
+    l->ok = fossil_it_magic_dir_open(&it, dir);
+    if (!l->ok)
+        return l;
+    while (fossil_it_magic_dir_next(&it))
+    {
+        char kind = it.is_dir < 0 ? '?' : (it.is_dir ? 'd' : 'f');
+        if (!fossil_it_magic_listing_push(l, kind, it.name))
+            break;
+    }
+    fossil_it_magic_dir_close(&it);
+    return l;
+}
+
+typedef struct
+{
+    char path[sizeof(((fossil_ti_path_suggestion_t *)0)->candidate_path)];
+    f32 score;
+} fossil_it_magic_beam_t;
+
+static bool fossil_it_magic_path_join(char *dst, size_t size, ccstring prefix, ccstring name)
+{
+    size_t len = strlen(prefix);
+    ccstring sep = (len == 0 || prefix[len - 1] == '/' || prefix[len - 1] == '\\') ? "" : "/";
+    int n = snprintf(dst, size, "%s%s%s", prefix, sep, name);
+    return n >= 0 && (size_t)n < size;
+}
+
+// Insert into a beam kept sorted best-first, dropping the weakest when full
+static void fossil_it_magic_beam_offer(
+    fossil_it_magic_beam_t *beam, i32 *count, i32 cap, ccstring prefix, ccstring name, f32 score)
+{
+    if (*count == cap && score <= beam[cap - 1].score)
+        return;
+    fossil_it_magic_beam_t item;
+    if (!fossil_it_magic_path_join(item.path, sizeof(item.path), prefix, name))
+        return;
+    item.score = score;
+    for (i32 i = 0; i < *count; i++)
+    {
+        if (strcmp(beam[i].path, item.path) == 0)
+            return;
+    }
+
+    i32 at = (*count < cap) ? (*count)++ : cap - 1;
+    while (at > 0 && beam[at - 1].score < score)
+    {
+        beam[at] = beam[at - 1];
+        at--;
+    }
+    beam[at] = item;
+}
+
+static void fossil_it_magic_path_resolve_cached(
+    fossil_it_magic_dir_cache_t *cache,
+    ccstring bad_path,
+    fossil_ti_path_suggestion_set_t *out)
+{
+    out->count = 0;
+    if (!cnotnull(bad_path) || !*bad_path)
+        return;
 
-    // Sort by score descending
-    for (i32 i = 0; i < idx - 1; i++)
+    fossil_it_magic_beam_t beam[FOSSIL_IT_MAGIC_BEAM];
+    fossil_it_magic_beam_t next[FOSSIL_IT_MAGIC_BEAM];
+    i32 beam_count = 1;
+    beam[0].score = 1.0f;
+    beam[0].path[0] = cterm;
+
+    // Root: "/", "X:/" or nothing for a relative path
+    ccstring p = bad_path;
+    if (*p == '/' || *p == '\\')
+    {
+        strcpy(beam[0].path, "/");
+        p++;
+    }
+    else if (isalpha((unsigned char)p[0]) && p[1] == ':' && (p[2] == '/' || p[2] == '\\'))
+    {
+        snprintf(beam[0].path, sizeof(beam[0].path), "%c:/", p[0]);
+        p += 3;
+    }
+
+    while (*p)
     {
-        for (i32 j = i + 1; j < idx; j++)
+        char seg[FOSSIL_IT_MAGIC_NAME_MAX];
+        size_t len = strcspn(p, "/\\");
+        ccstring rest = p + len;
+        while (*rest == '/' || *rest == '\\')
+            rest++;
+        bool last = (*rest == cterm);
+        if (len == 0 || len >= sizeof(seg))
+        {
+            if (len != 0)
+                return; // no entry can have a name this long
+            p = rest;
+            continue;
+        }
+        memcpy(seg, p, len);
+        seg[len] = cterm;
+        p = rest;
+
+        i32 next_count = 0;
+        bool literal = (strcmp(seg, ".") == 0 || strcmp(seg, "..") == 0);
+        fossil_ti_score_ctx_t ctx;
+        fossil_it_magic_score_init(&ctx, seg);
+
+        for (i32 b = 0; b < beam_count; b++)
         {
-            if (candidates[j].score > candidates[i].score)
+            if (literal)
             {
-                struct
-                {
-                    char name[FOSSIL_FILESYS_MAX_PATH];
-                    f32 score;
-                    int exists;
-                } tmp;
-                memcpy(&tmp, &candidates[i], sizeof(tmp));
-                memcpy(&candidates[i], &candidates[j], sizeof(tmp));
-                memcpy(&candidates[j], &tmp, sizeof(tmp));
+                fossil_it_magic_beam_offer(next, &next_count, FOSSIL_IT_MAGIC_BEAM,
+                                           beam[b].path, seg, beam[b].score);
+                continue;
+            }
+
+            const fossil_it_magic_listing_t *l =
+                fossil_it_magic_dir_cache_get(cache, beam[b].path[0] ? beam[b].path : ".");
+            if (!cnotnull(l) || !l->ok)
+                continue;
+
+            // An exact hit keeps this branch unchanged; otherwise fuzzy-match the entries
+            bool exact = false;
+            for (size_t at = 0; at < l->used && !exact; at += strlen(l->arena + at + 1) + 2)
+                exact = strcmp(l->arena + at + 1, seg) == 0;
+            if (exact)
+            {
+                fossil_it_magic_beam_offer(next, &next_count, FOSSIL_IT_MAGIC_BEAM,
+                                           beam[b].path, seg, beam[b].score);
+                continue;
+            }
+
+            fossil_it_magic_topk_t top;
+            top.count = 0;
+            for (size_t at = 0; at < l->used; at += strlen(l->arena + at + 1) + 2)
+            {
+                ccstring name = l->arena + at + 1;
+                if (!last && l->arena[at] == 'f')
+                    continue; // only directories can hold the remaining segments
+                f32 score = fossil_it_magic_path_score(
+                    &ctx, name, fossil_it_magic_topk_floor(&top, FOSSIL_IT_MAGIC_BEAM));
+                if (score >= FOSSIL_IT_MAGIC_PATH_MIN)
+                    fossil_it_magic_topk_offer(&top, FOSSIL_IT_MAGIC_BEAM, name, score);
+            }
+            for (i32 k = 0; k < top.count; k++)
+            {
+                // Scale rather than clamp: fuzzy picks keep their order and never tie an exact branch
+                f32 score = top.heap[k].score * (FOSSIL_IT_MAGIC_PATH_FUZZY_MAX / FOSSIL_IT_MAGIC_PATH_RAW_MAX);
+                if (score > FOSSIL_IT_MAGIC_PATH_FUZZY_MAX)
+                    score = FOSSIL_IT_MAGIC_PATH_FUZZY_MAX;
+                fossil_it_magic_beam_offer(next, &next_count, FOSSIL_IT_MAGIC_BEAM,
+                                           beam[b].path, top.names[top.heap[k].slot],
+                                           beam[b].score * score);
             }
         }
+        fossil_it_magic_score_dispose(&ctx);
+
+        if (next_count == 0)
+            return;
+        memcpy(beam, next, sizeof(next[0]) * (size_t)next_count);
+        beam_count = next_count;
     }
-    for (i32 i = 0; i < idx; i++)
+
+    for (i32 i = 0; i < beam_count; i++)
     {
-        strncpy(out->list[out->count].candidate_path, candidates[i].name, sizeof(out->list[out->count].candidate_path) - 1);
-        out->list[out->count].candidate_path[sizeof(out->list[out->count].candidate_path) - 1] = cterm;
-        out->list[out->count].similarity_score = candidates[i].score;
-        out->list[out->count].exists = candidates[i].exists;
-        out->count++;
+        fossil_ti_path_suggestion_t *dst = &out->list[out->count++];
+        memcpy(dst->candidate_path, beam[i].path, sizeof(dst->candidate_path));
+        dst->similarity_score = beam[i].score;
+        dst->exists = 1; // every segment came out of a listing
+    }
+}
+
+void fossil_it_magic_path_resolve(ccstring bad_path, fossil_ti_path_suggestion_set_t *out)
+{
+    if (!cnotnull(out))
+        return;
+    fossil_it_magic_dir_cache_t *cache =
+        (fossil_it_magic_dir_cache_t *)fossil_sys_memory_calloc(1, sizeof(*cache));
+    out->count = 0;
+    out->source_index = 0;
+    if (!cnotnull(cache))
+        return;
+    fossil_it_magic_path_resolve_cached(cache, bad_path, out);
+    fossil_it_magic_dir_cache_dispose(cache);
+    fossil_sys_memory_free(cache);
+}
+
+void fossil_it_magic_path_report(ccstring const *paths, i32 count, fossil_ti_path_ai_report_t *report)
+{
+    if (!cnotnull(report))
+        return;
+    report->set_count = 0;
+    if (!cnotnull(paths) || count <= 0)
+        return;
+
+    fossil_it_magic_dir_cache_t *cache =
+        (fossil_it_magic_dir_cache_t *)fossil_sys_memory_calloc(1, sizeof(*cache));
+    if (!cnotnull(cache))
+        return;
+
+    const i32 max_sets = (i32)(sizeof(report->sets) / sizeof(report->sets[0]));
+    for (i32 i = 0; i < count && report->set_count < max_sets; i++)
+    {
+        if (!cnotnull(paths[i]) || fossil_io_filesys_exists(paths[i]) > 0)
+            continue;
+        fossil_ti_path_suggestion_set_t *set = &report->sets[report->set_count];
+        fossil_it_magic_path_resolve_cached(cache, paths[i], set);
+        set->source_index = i;
+        if (set->count > 0)
+            report->set_count++;
     }
+
+    fossil_it_magic_dir_cache_dispose(cache);
+    fossil_sys_memory_free(cache);
 }
 
 void fossil_it_magic_autorecovery_token(
@@ -539,15 +1752,13 @@ void fossil_it_magic_autorecovery_token(
     i32 best_idx = -1;
     f32 second_best_score = 0.0f;
     i32 second_best_idx = -1;
+    fossil_ti_score_ctx_t ctx;
+    fossil_it_magic_score_init(&ctx, token);
 
     for (i32 i = 0; i < candidate_count; i++)
     {
-        f32 score = fossil_it_magic_similarity(token, candidates[i]);
-        if (fossil_io_cstring_case_starts_with(token, candidates[i]))
-            score += 0.10f;
-        if (strlen(token) <= strlen(candidates[i]) &&
-            fossil_io_cstring_case_ends_with(candidates[i], token))
-            score += 0.07f;
+        // Below the runner-up a candidate changes nothing, so it may stop early
+        f32 score = fossil_it_magic_path_score(&ctx, candidates[i], second_best_score);
 
         if (score > best_score)
         {
@@ -562,6 +1773,7 @@ void fossil_it_magic_autorecovery_token(
             second_best_idx = i;
         }
     }
+    fossil_it_magic_score_dispose(&ctx);
 
     // Use safe string copy for all output fields
     cstring orig = fossil_io_cstring_copy_safe(token, sizeof(out->original_token) - 1);
@@ -621,36 +1833,698 @@ void fossil_it_magic_autorecovery_token(
  * Danger Detection
  * ========================================================================== */
 
-void fossil_it_magic_danger_analyze(
-    ccstring path,
-    fossil_ti_danger_item_t *out)
+/* Score at which an item is CRITICAL; recursive walks stop once it is reached */
+#define FOSSIL_IT_MAGIC_DANGER_CRITICAL 8
+
+static i32 fossil_it_magic_danger_score(const fossil_ti_danger_item_t *out)
 {
-    fossil_sys_memory_zero(out, sizeof(*out));
-    // Use safe copy for target_path
-    cstring safe_path = fossil_io_cstring_copy_safe(path, sizeof(out->target_path) - 1);
-    strncpy(out->target_path, safe_path ? safe_path : "", sizeof(out->target_path) - 1);
-    out->target_path[sizeof(out->target_path) - 1] = cterm;
-    if (safe_path)
-        fossil_io_cstring_free_safe(&safe_path);
+    i32 score = 0;
+    if (out->contains_code)
+        score += 3;
+    if (out->contains_secrets)
+        score += 5;
+    if (out->large_size)
+        score += 2;
+    if (out->world_writable)
+        score += 2;
+    if (out->is_symlink)
+        score += 1;
+    if (out->suspicious_extension)
+        score += 2;
+    if (out->recently_modified)
+        score += 1;
+    if (out->contains_suspicious_files)
+        score += 2;
+    return score;
+}
 
-    fossil_io_filesys_obj_t obj;
-    int stat_ok = (fossil_io_filesys_stat(path, &obj) == 0);
+static fossil_ti_danger_level_t fossil_it_magic_danger_level(i32 score)
+{
+    if (score >= FOSSIL_IT_MAGIC_DANGER_CRITICAL)
+        return FOSSIL_TI_DANGER_CRITICAL;
+    else if (score >= 5)
+        return FOSSIL_TI_DANGER_HIGH;
+    else if (score >= 3)
+        return FOSSIL_TI_DANGER_MEDIUM;
+    else if (score >= 1)
+        return FOSSIL_TI_DANGER_LOW;
+    return FOSSIL_TI_DANGER_NONE;
+}
 
-    out->is_directory = (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_DIR);
-    out->is_symlink = (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_LINK);
+/*
+ * Content secret scan. Every pattern is compiled into one Aho-Corasick
+ * automaton, stored as a full transition table over byte classes: each byte
+ * that occurs in some pattern gets its own class, upper and lower case
+ * sharing one, and every other byte falls into class 0. A scan is then a
+ * table lookup per input byte. Matching is case-insensitive; patterns marked
+ * exact are rechecked against the original bytes, and the prefix and keyword
+ * patterns must also pass a validator on the text that follows them.
+ */
+#define FOSSIL_IT_MAGIC_AC_STATES 320
+#define FOSSIL_IT_MAGIC_AC_CLASSES 48
+#define FOSSIL_IT_MAGIC_SCAN_BYTES (1024 * 1024)
+#define FOSSIL_IT_MAGIC_SCAN_PROBE 4096
 
-    if (stat_ok) {
-        out->writable = obj.perms.write;
-        out->world_writable = (obj.mode & 0002) != 0;
-    } else {
-        out->writable = 0;
-        out->world_writable = 0;
+enum
+{
+    FOSSIL_IT_MAGIC_SECRET_HIT,     // the pattern alone is proof
+    FOSSIL_IT_MAGIC_SECRET_AWS,     // AKIA/ASIA + 16 upper-case alphanumerics
+    FOSSIL_IT_MAGIC_SECRET_GOOGLE,  // AIza + 35 URL-safe characters
+    FOSSIL_IT_MAGIC_SECRET_GITHUB,  // gh?_ + 36 alphanumerics
+    FOSSIL_IT_MAGIC_SECRET_TOKEN,   // prefix + at least 20 token characters
+    FOSSIL_IT_MAGIC_SECRET_KEYWORD  // name, then = or :, then a random-looking value
+};
+
+typedef struct
+{
+    ccstring text;
+    u8 kind;
+    bool exact; // case must match as written
+} fossil_it_magic_secret_pattern_t;
+
+// Split literals keep this source file from matching its own key-header patterns
+static const fossil_it_magic_secret_pattern_t fossil_it_magic_secret_patterns[] = {
+    {"PRIVATE KEY" "-----", FOSSIL_IT_MAGIC_SECRET_HIT, true},
+    {"PRIVATE KEY BLOCK" "-----", FOSSIL_IT_MAGIC_SECRET_HIT, true},
+    {"\"private_key_id\"", FOSSIL_IT_MAGIC_SECRET_HIT, false},
+    {"AKIA", FOSSIL_IT_MAGIC_SECRET_AWS, true},
+    {"ASIA", FOSSIL_IT_MAGIC_SECRET_AWS, true},
+    {"AIza", FOSSIL_IT_MAGIC_SECRET_GOOGLE, true},
+    {"ghp_", FOSSIL_IT_MAGIC_SECRET_GITHUB, true},
+    {"gho_", FOSSIL_IT_MAGIC_SECRET_GITHUB, true},
+    {"ghu_", FOSSIL_IT_MAGIC_SECRET_GITHUB, true},
+    {"ghs_", FOSSIL_IT_MAGIC_SECRET_GITHUB, true},
+    {"ghr_", FOSSIL_IT_MAGIC_SECRET_GITHUB, true},
+    {"github_pat_", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"xoxb-", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"xoxp-", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"xoxa-", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"sk_live_", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"rk_live_", FOSSIL_IT_MAGIC_SECRET_TOKEN, true},
+    {"password", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"passwd", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"secret", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"token", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"api_key", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"apikey", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false},
+    {"access_key", FOSSIL_IT_MAGIC_SECRET_KEYWORD, false}};
+
+#define FOSSIL_IT_MAGIC_SECRET_PATTERNS \
+    (sizeof(fossil_it_magic_secret_patterns) / sizeof(fossil_it_magic_secret_patterns[0]))
+
+_Static_assert(FOSSIL_IT_MAGIC_SECRET_PATTERNS <= 32, "each pattern needs its own bit of the u32 output mask");
+_Static_assert(FOSSIL_IT_MAGIC_AC_STATES <= UINT16_MAX + 1, "states are numbered in u16");
+_Static_assert(FOSSIL_IT_MAGIC_AC_CLASSES <= UINT8_MAX + 1, "byte classes are numbered in u8");
+
+static u8 fossil_it_magic_ac_class[256];
+static u16 fossil_it_magic_ac_next[FOSSIL_IT_MAGIC_AC_STATES][FOSSIL_IT_MAGIC_AC_CLASSES];
+static u32 fossil_it_magic_ac_out[FOSSIL_IT_MAGIC_AC_STATES]; // bit i: pattern i ends here
+static bool fossil_it_magic_ac_ready = false;
+
+// The table sizes are fixed; a pattern list that outgrows them leaves the scan unusable rather than overrunning
+static void fossil_it_magic_ac_build(void)
+{
+    u8 classes = 1;
+    for (size_t p = 0; p < FOSSIL_IT_MAGIC_SECRET_PATTERNS; p++)
+    {
+        for (ccstring c = fossil_it_magic_secret_patterns[p].text; *c; c++)
+        {
+            u8 lower = (u8)tolower((u8)*c);
+            if (!fossil_it_magic_ac_class[lower])
+            {
+                if (classes == FOSSIL_IT_MAGIC_AC_CLASSES)
+                    return;
+                fossil_it_magic_ac_class[lower] = classes;
+                fossil_it_magic_ac_class[(u8)toupper(lower)] = classes;
+                classes++;
+            }
+        }
     }
 
-    // Code/secrets detection
-    out->contains_code = out->is_directory ? fossil_it_magic_contains_git(path) : fossil_it_magic_is_code_file(path);
-    out->contains_secrets = out->is_directory ? fossil_it_magic_contains_secret(path) : 0;
-
+    // Trie, with 0 standing for "no edge" since nothing points back at the root
+    u16 states = 1;
+    for (size_t p = 0; p < FOSSIL_IT_MAGIC_SECRET_PATTERNS; p++)
+    {
+        u16 s = 0;
+        for (ccstring c = fossil_it_magic_secret_patterns[p].text; *c; c++)
+        {
+            u8 k = fossil_it_magic_ac_class[(u8)*c];
+            if (!fossil_it_magic_ac_next[s][k])
+            {
+                if (states == FOSSIL_IT_MAGIC_AC_STATES)
+                    return;
+                fossil_it_magic_ac_next[s][k] = states++;
+            }
+            s = fossil_it_magic_ac_next[s][k];
+        }
+        fossil_it_magic_ac_out[s] |= 1u << p;
+    }
+
+    // Breadth-first: fill the missing edges from each state's failure link
+    u16 fail[FOSSIL_IT_MAGIC_AC_STATES] = {0};
+    u16 queue[FOSSIL_IT_MAGIC_AC_STATES];
+    size_t head = 0, tail = 0;
+    for (u8 k = 0; k < classes; k++)
+        if (fossil_it_magic_ac_next[0][k])
+            queue[tail++] = fossil_it_magic_ac_next[0][k];
+    while (head < tail)
+    {
+        u16 s = queue[head++];
+        fossil_it_magic_ac_out[s] |= fossil_it_magic_ac_out[fail[s]];
+        for (u8 k = 0; k < classes; k++)
+        {
+            u16 t = fossil_it_magic_ac_next[s][k];
+            if (t)
+            {
+                fail[t] = fossil_it_magic_ac_next[fail[s]][k];
+                queue[tail++] = t;
+            }
+            else
+                fossil_it_magic_ac_next[s][k] = fossil_it_magic_ac_next[fail[s]][k];
+        }
+    }
+    fossil_it_magic_ac_ready = true;
+}
+
+#ifdef _WIN32
+static INIT_ONCE fossil_it_magic_ac_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK fossil_it_magic_ac_build_once(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    (void)once;
+    (void)param;
+    (void)context;
+    fossil_it_magic_ac_build();
+    return TRUE;
+}
+#else
+static pthread_once_t fossil_it_magic_ac_once = PTHREAD_ONCE_INIT;
+#endif
+
+// Length of the run starting at p whose bytes all satisfy the given character set
+static size_t fossil_it_magic_span(const u8 *p, const u8 *end, ccstring extra, bool upper_only)
+{
+    size_t n = 0;
+    while (p + n < end)
+    {
+        u8 c = p[n];
+        bool ok = upper_only ? (isupper(c) || isdigit(c)) : (isalnum(c) || (c && strchr(extra, c)));
+        if (!ok)
+            break;
+        n++;
+    }
+    return n;
+}
+
+static f32 fossil_it_magic_entropy(const u8 *p, size_t n)
+{
+    u32 counts[256] = {0};
+    for (size_t i = 0; i < n; i++)
+        counts[p[i]]++;
+    f32 bits = 0.0f;
+    for (size_t c = 0; c < 256; c++)
+    {
+        if (!counts[c])
+            continue;
+        f32 q = (f32)counts[c] / (f32)n;
+        bits -= q * log2f(q);
+    }
+    return bits;
+}
+
+// Checks the bytes after a match of pattern id; start is where the match began
+static bool fossil_it_magic_secret_confirm(size_t id, const u8 *buf, const u8 *end, const u8 *start)
+{
+    const fossil_it_magic_secret_pattern_t *pat = &fossil_it_magic_secret_patterns[id];
+    size_t len = strlen(pat->text);
+    if (pat->exact && memcmp(start, pat->text, len) != 0)
+        return false;
+    const u8 *after = start + len;
+    bool bounded = (start == buf || !isalnum(start[-1]));
+
+    switch (pat->kind)
+    {
+    case FOSSIL_IT_MAGIC_SECRET_HIT:
+        return true;
+    case FOSSIL_IT_MAGIC_SECRET_AWS:
+        return bounded && fossil_it_magic_span(after, end, "", true) == 16;
+    case FOSSIL_IT_MAGIC_SECRET_GOOGLE:
+        return bounded && fossil_it_magic_span(after, end, "_-", false) == 35;
+    case FOSSIL_IT_MAGIC_SECRET_GITHUB:
+        return bounded && fossil_it_magic_span(after, end, "", false) == 36;
+    case FOSSIL_IT_MAGIC_SECRET_TOKEN:
+        return bounded && fossil_it_magic_span(after, end, "_-", false) >= 20;
+    case FOSSIL_IT_MAGIC_SECRET_KEYWORD:
+    {
+        // NAME = value, "name": "value", name: value and similar
+        const u8 *p = after;
+        while (p < end && (isalnum(*p) || *p == '_' || *p == '-'))
+            p++;
+        while (p < end && (*p == '"' || *p == '\'' || *p == ' ' || *p == '\t'))
+            p++;
+        if (p + 1 < end && *p == ':' && p[1] == '=')
+            p++;
+        if (p >= end || (*p != '=' && *p != ':') || (p + 1 < end && p[1] == *p))
+            return false; // "==" and "::" are code, not assignments
+        p++;
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        // A quoted value runs to its closing quote, a bare one to whitespace or a separator
+        u8 quote = (p < end && (*p == '"' || *p == '\'')) ? *p++ : 0;
+        size_t n = 0;
+        while (p + n < end && n <= 256 && p[n] != '\n' && p[n] != '\r' &&
+               (quote ? p[n] != quote : !isspace(p[n]) && p[n] != ',' && p[n] != ';' && p[n] != '#'))
+            n++;
+        if (n < 16 || n > 256)
+            return false;
+        // Generated credentials mix letters and digits; prose and expressions do not look like them
+        bool letter = false, digit = false;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (isspace(p[i]) || strchr("()[]{}<>", p[i]))
+                return false;
+            letter |= isalpha(p[i]) != 0;
+            digit |= isdigit(p[i]) != 0;
+        }
+        return letter && digit && fossil_it_magic_entropy(p, n) >= 3.5f;
+    }
+    default:
+        return false;
+    }
+}
+
+static bool fossil_it_magic_secret_scan_buffer(const u8 *buf, size_t len)
+{
+    size_t probe = len < FOSSIL_IT_MAGIC_SCAN_PROBE ? len : FOSSIL_IT_MAGIC_SCAN_PROBE;
+    if (memchr(buf, 0, probe))
+        return false; // binary
+
+    const u8 *end = buf + len;
+    u16 s = 0;
+    for (const u8 *p = buf; p < end; p++)
+    {
+        s = fossil_it_magic_ac_next[s][fossil_it_magic_ac_class[*p]];
+        u32 out = fossil_it_magic_ac_out[s];
+        while (out)
+        {
+            size_t id = 0;
+            while (!(out & (1u << id)))
+                id++;
+            out &= ~(1u << id);
+            const u8 *start = p + 1 - strlen(fossil_it_magic_secret_patterns[id].text);
+            if (fossil_it_magic_secret_confirm(id, buf, end, start))
+                return true;
+        }
+    }
+    return false;
+}
+
+int fossil_it_magic_secret_scan(ccstring path, long long max_bytes)
+{
+#ifdef _WIN32
+    InitOnceExecuteOnce(&fossil_it_magic_ac_once, fossil_it_magic_ac_build_once, cnull, cnull);
+#else
+    pthread_once(&fossil_it_magic_ac_once, fossil_it_magic_ac_build);
+#endif
+    if (!fossil_it_magic_ac_ready)
+        return -1;
+    size_t budget = max_bytes > 0 ? (size_t)max_bytes : FOSSIL_IT_MAGIC_SCAN_BYTES;
+
+#ifdef _WIN32
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return -1;
+    u8 *buf = (u8 *)fossil_sys_memory_calloc(budget, 1);
+    if (!cnotnull(buf))
+    {
+        fclose(fp);
+        return -1;
+    }
+    size_t len = fread(buf, 1, budget, fp);
+    fclose(fp);
+    int found = fossil_it_magic_secret_scan_buffer(buf, len) ? 1 : 0;
+    fossil_sys_memory_free(buf);
+    return found;
+#else
+    // Non-blocking so a FIFO or device cannot stall the open; only regular files are read
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return -1;
+    }
+    size_t len = (u64)st.st_size < (u64)budget ? (size_t)st.st_size : budget;
+    if (len == 0)
+    {
+        close(fd);
+        return 0;
+    }
+    void *map = mmap(cnull, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+    int found = fossil_it_magic_secret_scan_buffer((const u8 *)map, len) ? 1 : 0;
+    munmap(map, len);
+    return found;
+#endif
+}
+
+/*
+ * Directory facts cache. Listing a directory is the only expensive step of
+ * analyze, so its facts are kept in $XDG_CACHE_HOME/squid/danger.cache: a
+ * fixed-size table mapped into memory and shared by every squid process. A
+ * record is keyed by device and inode and holds only while the directory's
+ * mtime and ctime are unchanged; creating, removing or renaming an entry bumps
+ * both. Those times have one-second resolution, so a directory touched in the
+ * last two seconds is never stored, and neither is one whose verdict looked
+ * inside a subdirectory (".aws/credentials"), since the key cannot see that
+ * change. The header carries a fingerprint of the classifier, so a build
+ * with different lists or rules starts from an empty table. Writers take an
+ * exclusive flock on the file and readers a shared one, so a lookup never
+ * sees a record another process is halfway through writing; each record
+ * still carries a checksum, so one torn by a crash or a build that does not
+ * lock reads as a miss. Windows has no inode key here and always lists. Only
+ * the flat analysis consults the table; a tree walk lists every directory
+ * for its sizes and times regardless.
+ */
+#define FOSSIL_IT_MAGIC_DCACHE_MAGIC 0x43445153u /* "SQDC" */
+#define FOSSIL_IT_MAGIC_DCACHE_VERSION 3u
+#define FOSSIL_IT_MAGIC_DCACHE_SLOTS 4096
+#define FOSSIL_IT_MAGIC_DCACHE_PROBE 8
+/* Bump when the facts a scan derives from the same lists change meaning */
+#define FOSSIL_IT_MAGIC_CLASSIFIER_REV 2u
+
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u32 slots;
+    u32 record;     // sizeof(fossil_it_magic_dcache_record_t)
+    u32 classifier; // fossil_it_magic_classifier_version()
+    u32 reserved;
+} fossil_it_magic_dcache_header_t;
+
+typedef struct
+{
+    u64 dev;
+    u64 ino;
+    i64 mtime;
+    i64 ctime;
+    u32 facts; // FOSSIL_IT_MAGIC_DCACHE_* bits
+    u32 check; // 0 marks an empty slot
+} fossil_it_magic_dcache_record_t;
+
+enum
+{
+    FOSSIL_IT_MAGIC_DCACHE_CODE = 1 << 0,
+    FOSSIL_IT_MAGIC_DCACHE_VCS = 1 << 1,
+    FOSSIL_IT_MAGIC_DCACHE_SECRETS = 1 << 2,
+    FOSSIL_IT_MAGIC_DCACHE_SUSPICIOUS = 1 << 3
+};
+
+static int fossil_it_magic_dcache_enabled = 1;
+
+void fossil_it_magic_danger_cache_enable(int enabled)
+{
+    fossil_it_magic_dcache_enabled = enabled != 0;
+}
+
+#ifndef _WIN32
+static fossil_it_magic_dcache_record_t *fossil_it_magic_dcache_slots = cnull;
+static int fossil_it_magic_dcache_fd = -1;
+static pthread_once_t fossil_it_magic_dcache_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t fossil_it_magic_dcache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// FNV-1a over every classifier list and the rules revision
+static u32 fossil_it_magic_classifier_version(void)
+{
+    static const struct
+    {
+        ccstring *list;
+        size_t count;
+    } lists[] = {
+        {fossil_it_magic_code_exts, sizeof(fossil_it_magic_code_exts) / sizeof(fossil_it_magic_code_exts[0])},
+        {fossil_it_magic_special_names, sizeof(fossil_it_magic_special_names) / sizeof(fossil_it_magic_special_names[0])},
+        {fossil_it_magic_secret_files, sizeof(fossil_it_magic_secret_files) / sizeof(fossil_it_magic_secret_files[0])},
+        {fossil_it_magic_danger_exts, sizeof(fossil_it_magic_danger_exts) / sizeof(fossil_it_magic_danger_exts[0])}};
+
+    u32 h = fossil_it_magic_class_hash("", 0) ^ FOSSIL_IT_MAGIC_CLASSIFIER_REV;
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
+    {
+        for (size_t j = 0; j < lists[i].count; j++)
+        {
+            // the terminator separates entries, so {"ab","c"} and {"a","bc"} differ
+            ccstring name = lists[i].list[j];
+            size_t len = strlen(name) + 1;
+            for (size_t k = 0; k < len; k++)
+                h = (h ^ (u8)name[k]) * 16777619u;
+        }
+        h = (h ^ 0xFFu) * 16777619u;
+    }
+    return h;
+}
+
+static bool fossil_it_magic_dcache_path(char *buf, size_t len)
+{
+    ccstring xdg = getenv("XDG_CACHE_HOME");
+    ccstring home = getenv("HOME");
+    int n;
+
+    if (xdg && xdg[0] == '/')
+        n = snprintf(buf, len, "%s/squid", xdg);
+    else if (home && home[0])
+        n = snprintf(buf, len, "%s/.cache/squid", home);
+    else
+        return false;
+    if (n < 0 || (size_t)n >= len)
+        return false;
+
+    // parent first; both may already exist
+    cstring slash = strrchr(buf, '/');
+    if (slash && slash != buf)
+    {
+        *slash = cterm;
+        mkdir(buf, 0700);
+        *slash = '/';
+    }
+    if (mkdir(buf, 0700) != 0 && errno != EEXIST)
+        return false;
+
+    size_t used = (size_t)n;
+    n = snprintf(buf + used, len - used, "/danger.cache");
+    return n > 0 && (size_t)n < len - used;
+}
+
+static void fossil_it_magic_dcache_open(void)
+{
+    char path[1024];
+    if (!fossil_it_magic_dcache_path(path, sizeof(path)))
+        return;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return;
+
+    const size_t size = sizeof(fossil_it_magic_dcache_header_t) +
+                        FOSSIL_IT_MAGIC_DCACHE_SLOTS * sizeof(fossil_it_magic_dcache_record_t);
+    // only trust a cache we own; a size from another layout is rebuilt
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_uid != geteuid() ||
+        ((size_t)st.st_size != size && ftruncate(fd, (off_t)size) != 0))
+    {
+        close(fd);
+        return;
+    }
+
+    void *map = mmap(cnull, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        return;
+    }
+
+    // a table from another layout or classifier is cleared under the writers' lock
+    u32 classifier = fossil_it_magic_classifier_version();
+    fossil_it_magic_dcache_header_t *hdr = (fossil_it_magic_dcache_header_t *)map;
+    flock(fd, LOCK_EX);
+    if (hdr->magic != FOSSIL_IT_MAGIC_DCACHE_MAGIC || hdr->version != FOSSIL_IT_MAGIC_DCACHE_VERSION ||
+        hdr->slots != FOSSIL_IT_MAGIC_DCACHE_SLOTS || hdr->record != sizeof(fossil_it_magic_dcache_record_t) ||
+        hdr->classifier != classifier)
+    {
+        memset(map, 0, size);
+        hdr->magic = FOSSIL_IT_MAGIC_DCACHE_MAGIC;
+        hdr->version = FOSSIL_IT_MAGIC_DCACHE_VERSION;
+        hdr->slots = FOSSIL_IT_MAGIC_DCACHE_SLOTS;
+        hdr->record = (u32)sizeof(fossil_it_magic_dcache_record_t);
+        hdr->classifier = classifier;
+    }
+    flock(fd, LOCK_UN);
+    fossil_it_magic_dcache_fd = fd;
+    fossil_it_magic_dcache_slots = (fossil_it_magic_dcache_record_t *)(hdr + 1);
+}
+
+static u32 fossil_it_magic_dcache_check(const fossil_it_magic_dcache_record_t *rec)
+{
+    u64 h = 14695981039346656037ULL; // FNV-1a over the fields before check
+    const u8 *p = (const u8 *)rec;
+    for (size_t i = 0; i < offsetof(fossil_it_magic_dcache_record_t, check); i++)
+        h = (h ^ p[i]) * 1099511628211ULL;
+    return (u32)(h ^ (h >> 32)) | 1u;
+}
+
+static size_t fossil_it_magic_dcache_home(u64 dev, u64 ino)
+{
+    u64 h = (ino ^ (dev << 32) ^ (dev >> 32)) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 32) & (FOSSIL_IT_MAGIC_DCACHE_SLOTS - 1);
+}
+
+static bool fossil_it_magic_dcache_get(const fossil_it_magic_dcache_record_t *key, u32 *facts)
+{
+    bool hit = false;
+    pthread_mutex_lock(&fossil_it_magic_dcache_lock);
+    // the mutex orders this process's threads, the shared flock other processes' writers
+    if (flock(fossil_it_magic_dcache_fd, LOCK_SH) != 0)
+    {
+        pthread_mutex_unlock(&fossil_it_magic_dcache_lock);
+        return false;
+    }
+    size_t home = fossil_it_magic_dcache_home(key->dev, key->ino);
+    for (size_t i = 0; i < FOSSIL_IT_MAGIC_DCACHE_PROBE && !hit; i++)
+    {
+        fossil_it_magic_dcache_record_t rec =
+            fossil_it_magic_dcache_slots[(home + i) & (FOSSIL_IT_MAGIC_DCACHE_SLOTS - 1)];
+        if (rec.check && rec.dev == key->dev && rec.ino == key->ino &&
+            rec.mtime == key->mtime && rec.ctime == key->ctime &&
+            rec.check == fossil_it_magic_dcache_check(&rec))
+        {
+            *facts = rec.facts;
+            hit = true;
+        }
+    }
+    flock(fossil_it_magic_dcache_fd, LOCK_UN);
+    pthread_mutex_unlock(&fossil_it_magic_dcache_lock);
+    return hit;
+}
+
+static void fossil_it_magic_dcache_put(fossil_it_magic_dcache_record_t rec)
+{
+    rec.check = fossil_it_magic_dcache_check(&rec);
+    pthread_mutex_lock(&fossil_it_magic_dcache_lock);
+    // the mutex orders this process's threads, the flock other processes
+    if (flock(fossil_it_magic_dcache_fd, LOCK_EX) != 0)
+    {
+        pthread_mutex_unlock(&fossil_it_magic_dcache_lock);
+        return;
+    }
+    size_t home = fossil_it_magic_dcache_home(rec.dev, rec.ino);
+    // reuse this directory's slot, else the first free one, else evict the home slot
+    size_t target = home;
+    for (size_t i = 0; i < FOSSIL_IT_MAGIC_DCACHE_PROBE; i++)
+    {
+        size_t at = (home + i) & (FOSSIL_IT_MAGIC_DCACHE_SLOTS - 1);
+        const fossil_it_magic_dcache_record_t *cur = &fossil_it_magic_dcache_slots[at];
+        if (cur->check && cur->dev == rec.dev && cur->ino == rec.ino)
+        {
+            target = at;
+            break;
+        }
+        if (!cur->check && target == home)
+            target = at;
+    }
+    fossil_it_magic_dcache_slots[target] = rec;
+    flock(fossil_it_magic_dcache_fd, LOCK_UN);
+    pthread_mutex_unlock(&fossil_it_magic_dcache_lock);
+}
+#endif
+
+// fossil_it_magic_scan_dir, answered from the facts cache when the directory is unchanged
+static void fossil_it_magic_scan_dir_cached(ccstring path, fossil_it_magic_dir_facts_t *facts)
+{
+#ifndef _WIN32
+    if (!fossil_it_magic_dcache_enabled)
+    {
+        fossil_it_magic_scan_dir(path, facts);
+        return;
+    }
+    pthread_once(&fossil_it_magic_dcache_once, fossil_it_magic_dcache_open);
+
+    // stat before listing: a change made during the scan gets a new key
+    struct stat st;
+    fossil_it_magic_dcache_record_t key;
+    memset(&key, 0, sizeof(key));
+    bool keyed = cnotnull(fossil_it_magic_dcache_slots) && stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+    if (keyed)
+    {
+        key.dev = (u64)st.st_dev;
+        key.ino = (u64)st.st_ino;
+        key.mtime = (i64)st.st_mtime;
+        key.ctime = (i64)st.st_ctime;
+
+        u32 bits;
+        if (fossil_it_magic_dcache_get(&key, &bits))
+        {
+            facts->contains_code = (bits & FOSSIL_IT_MAGIC_DCACHE_CODE) != 0;
+            facts->contains_vcs = (bits & FOSSIL_IT_MAGIC_DCACHE_VCS) != 0;
+            facts->contains_secrets = (bits & FOSSIL_IT_MAGIC_DCACHE_SECRETS) != 0;
+            facts->contains_suspicious_files = (bits & FOSSIL_IT_MAGIC_DCACHE_SUSPICIOUS) != 0;
+            return;
+        }
+    }
+#endif
+
+    fossil_it_magic_scan_dir(path, facts);
+
+#ifndef _WIN32
+    i64 now = (i64)time(cnull);
+    if (keyed && !facts->looked_inside && now - key.mtime >= 2 && now - key.ctime >= 2)
+    {
+        key.facts = (facts->contains_code ? FOSSIL_IT_MAGIC_DCACHE_CODE : 0) |
+                    (facts->contains_vcs ? FOSSIL_IT_MAGIC_DCACHE_VCS : 0) |
+                    (facts->contains_secrets ? FOSSIL_IT_MAGIC_DCACHE_SECRETS : 0) |
+                    (facts->contains_suspicious_files ? FOSSIL_IT_MAGIC_DCACHE_SUSPICIOUS : 0);
+        fossil_it_magic_dcache_put(key);
+    }
+#endif
+}
+
+void fossil_it_magic_danger_analyze(
+    ccstring path,
+    fossil_ti_danger_item_t *out)
+{
+    fossil_sys_memory_zero(out, sizeof(*out));
+    // Use safe copy for target_path
+    cstring safe_path = fossil_io_cstring_copy_safe(path, sizeof(out->target_path) - 1);
+    strncpy(out->target_path, safe_path ? safe_path : "", sizeof(out->target_path) - 1);
+    out->target_path[sizeof(out->target_path) - 1] = cterm;
+    if (safe_path)
+        fossil_io_cstring_free_safe(&safe_path);
+
+    fossil_io_filesys_obj_t obj;
+    int stat_ok = (fossil_io_filesys_stat(path, &obj) == 0);
+
+    out->is_directory = (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_DIR);
+    out->is_symlink = (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_LINK);
+
+    if (stat_ok) {
+        out->writable = obj.perms.write;
+        out->world_writable = (obj.mode & 0002) != 0;
+    } else {
+        out->writable = 0;
+        out->world_writable = 0;
+    }
+
+    // Code, VCS, secrets and suspicious entries all come from one listing pass
+    fossil_it_magic_dir_facts_t facts = {0};
+    if (out->is_directory)
+        fossil_it_magic_scan_dir_cached(path, &facts);
+    out->contains_code = out->is_directory ? facts.contains_code : (fossil_it_magic_classify(path) & FOSSIL_IT_MAGIC_CLASS_CODE) != 0;
+    out->contains_vcs = facts.contains_vcs;
+    out->contains_secrets = facts.contains_secrets;
+    out->contains_suspicious_files = facts.contains_suspicious_files;
+
     // Size
     u64 sz = 0;
     if (stat_ok) {
@@ -659,19 +2533,9 @@ void fossil_it_magic_danger_analyze(
     out->large_size = (sz > 10 * 1024 * 1024);
 
     // Suspicious extension
-    static ccstring danger_exts[] = {".exe", ".dll", ".bin", ".sh", ".bat", ".cmd", ".scr", ".pif", ".com", ".js", ".vbs", ".elf"};
     out->suspicious_extension = 0;
-    if (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_FILE) {
-        char ext[32] = {0};
-        if (fossil_io_filesys_extension(path, ext, sizeof(ext)) == 0 && ext[0]) {
-            for (i32 i = 0; i < (i32)(sizeof(danger_exts) / sizeof(danger_exts[0])); i++) {
-                if (fossil_io_cstring_case_compare(ext, danger_exts[i]) == 0) {
-                    out->suspicious_extension = 1;
-                    break;
-                }
-            }
-        }
-    }
+    if (stat_ok && obj.type == FOSSIL_FILESYS_TYPE_FILE)
+        out->suspicious_extension = (fossil_it_magic_classify(path) & FOSSIL_IT_MAGIC_CLASS_DANGER) != 0;
 
     // Recently modified
     out->recently_modified = 0;
@@ -682,58 +2546,631 @@ void fossil_it_magic_danger_analyze(
     if (mod_time && now && (now > mod_time) && ((now - mod_time) < 24 * 3600))
         out->recently_modified = 1;
 
-    // Contains suspicious files (use directory listing)
-    out->contains_suspicious_files = 0;
-    if (out->is_directory) {
-        fossil_io_filesys_obj_t entries[32];
-        size_t count = 0;
-        if (fossil_io_filesys_dir_list(path, entries, 32, &count) == 0) {
-            for (size_t i = 0; i < count; ++i) {
-                if (entries[i].type == FOSSIL_FILESYS_TYPE_FILE) {
-                    char ext[32] = {0};
-                    if (fossil_io_filesys_extension(entries[i].path, ext, sizeof(ext)) == 0 && ext[0]) {
-                        for (i32 j = 0; j < (i32)(sizeof(danger_exts) / sizeof(danger_exts[0])); j++) {
-                            if (fossil_io_cstring_case_compare(ext, danger_exts[j]) == 0) {
-                                out->contains_suspicious_files = 1;
-                                break;
-                            }
-                        }
-                    }
+    out->level = fossil_it_magic_danger_level(fossil_it_magic_danger_score(out));
+}
+
+/*
+ * Recursive walk. Each worker owns a deque of directories still to list: it
+ * pushes and pops at the bottom, so it runs depth-first through its own
+ * subtree, and idle workers steal from the top, where the oldest and usually
+ * largest subtrees sit. Counters are merged into the shared state every
+ * FOSSIL_IT_MAGIC_WALK_BATCH entries, which is also where budgets and the
+ * CRITICAL cutoff are checked. Symlinks are counted but never followed.
+ */
+#define FOSSIL_IT_MAGIC_WALK_THREADS 16
+#define FOSSIL_IT_MAGIC_WALK_BATCH 256
+
+typedef struct
+{
+    cstring path;
+    i32 depth;
+} fossil_it_magic_walk_task_t;
+
+typedef struct
+{
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
+    fossil_it_magic_walk_task_t *tasks;
+    size_t top;    // next task a thief takes
+    size_t bottom; // one past the owner's next task
+    size_t capacity;
+} fossil_it_magic_walk_deque_t;
+
+typedef struct
+{
+    u64 entries;
+    u64 bytes;
+    u64 files;
+    u64 dirs;
+    long long newest_mtime;
+    fossil_it_magic_dir_facts_t facts;
+    int truncated;
+} fossil_it_magic_walk_stats_t;
+
+typedef struct
+{
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    fossil_it_magic_walk_deque_t deques[FOSSIL_IT_MAGIC_WALK_THREADS];
+    // per-worker buffer for child paths
+    cstring scratch[FOSSIL_IT_MAGIC_WALK_THREADS];
+    size_t scratch_cap[FOSSIL_IT_MAGIC_WALK_THREADS];
+    i32 workers;
+    i32 max_depth;
+    u64 max_entries;
+    u64 deadline_ms;
+    u64 now;          // wall clock at start, for recently_modified
+    u64 pending;      // tasks pushed but not yet finished
+    bool stop;
+    bool scan_content;
+    long long content_bytes;
+    fossil_ti_danger_item_t root;
+    fossil_it_magic_walk_stats_t stats;
+} fossil_it_magic_walk_t;
+
+typedef struct
+{
+    fossil_it_magic_walk_t *walk;
+    i32 id;
+} fossil_it_magic_walk_worker_t;
+
+// Monotonic, so a clock step cannot stretch or cut the walk budget
+static u64 fossil_it_magic_now_ms(void)
+{
+#ifdef _WIN32
+    return (u64)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000ULL + (u64)ts.tv_nsec / 1000000ULL;
+#endif
+}
+
+static void fossil_it_magic_walk_lock(fossil_it_magic_walk_t *walk)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&walk->lock);
+#else
+    pthread_mutex_lock(&walk->lock);
+#endif
+}
+
+static void fossil_it_magic_walk_unlock(fossil_it_magic_walk_t *walk)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&walk->lock);
+#else
+    pthread_mutex_unlock(&walk->lock);
+#endif
+}
+
+static void fossil_it_magic_walk_wake(fossil_it_magic_walk_t *walk)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(&walk->cond);
+#else
+    pthread_cond_broadcast(&walk->cond);
+#endif
+}
+
+// Sleep until woken or a few milliseconds pass; caller holds the walk lock
+static void fossil_it_magic_walk_wait(fossil_it_magic_walk_t *walk)
+{
+#ifdef _WIN32
+    SleepConditionVariableCS(&walk->cond, &walk->lock, 2);
+#elif defined(__APPLE__)
+    // No monotonic condition clock here; a relative wait needs none
+    struct timespec ts = {0, 2000000L};
+    pthread_cond_timedwait_relative_np(&walk->cond, &walk->lock, &ts);
+#else
+    u64 deadline = fossil_it_magic_now_ms() + 2;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline / 1000ULL);
+    ts.tv_nsec = (long)((deadline % 1000ULL) * 1000000ULL);
+    pthread_cond_timedwait(&walk->cond, &walk->lock, &ts);
+#endif
+}
+
+static void fossil_it_magic_deque_lock(fossil_it_magic_walk_deque_t *dq)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&dq->lock);
+#else
+    pthread_mutex_lock(&dq->lock);
+#endif
+}
+
+static void fossil_it_magic_deque_unlock(fossil_it_magic_walk_deque_t *dq)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&dq->lock);
+#else
+    pthread_mutex_unlock(&dq->lock);
+#endif
+}
+
+static bool fossil_it_magic_deque_push(fossil_it_magic_walk_deque_t *dq, fossil_it_magic_walk_task_t task)
+{
+    bool ok = true;
+    fossil_it_magic_deque_lock(dq);
+    if (dq->bottom == dq->capacity)
+    {
+        if (dq->top > 0)
+        {
+            // Reclaim the slots thieves have emptied before growing
+            memmove(dq->tasks, dq->tasks + dq->top, (dq->bottom - dq->top) * sizeof(*dq->tasks));
+            dq->bottom -= dq->top;
+            dq->top = 0;
+        }
+        else
+        {
+            size_t cap = dq->capacity ? dq->capacity * 2 : 64;
+            fossil_it_magic_walk_task_t *grown = (fossil_it_magic_walk_task_t *)fossil_sys_memory_realloc(
+                dq->tasks, cap * sizeof(*grown));
+            if (cnotnull(grown))
+            {
+                dq->tasks = grown;
+                dq->capacity = cap;
+            }
+            else
+                ok = false;
+        }
+    }
+    if (ok)
+        dq->tasks[dq->bottom++] = task;
+    fossil_it_magic_deque_unlock(dq);
+    return ok;
+}
+
+static bool fossil_it_magic_deque_pop(fossil_it_magic_walk_deque_t *dq, fossil_it_magic_walk_task_t *task)
+{
+    bool ok = false;
+    fossil_it_magic_deque_lock(dq);
+    if (dq->bottom > dq->top)
+    {
+        *task = dq->tasks[--dq->bottom];
+        ok = true;
+    }
+    fossil_it_magic_deque_unlock(dq);
+    return ok;
+}
+
+static bool fossil_it_magic_deque_steal(fossil_it_magic_walk_deque_t *dq, fossil_it_magic_walk_task_t *task)
+{
+    bool ok = false;
+    fossil_it_magic_deque_lock(dq);
+    if (dq->bottom > dq->top)
+    {
+        *task = dq->tasks[dq->top++];
+        ok = true;
+    }
+    fossil_it_magic_deque_unlock(dq);
+    return ok;
+}
+
+// Apply the walk's findings on top of the root's own flags
+static void fossil_it_magic_walk_apply(
+    const fossil_it_magic_walk_t *walk,
+    const fossil_it_magic_walk_stats_t *stats,
+    fossil_ti_danger_item_t *item)
+{
+    *item = walk->root;
+    item->contains_code |= stats->facts.contains_code || stats->facts.contains_vcs;
+    item->contains_vcs |= stats->facts.contains_vcs;
+    item->contains_secrets |= stats->facts.contains_secrets;
+    item->contains_suspicious_files |= stats->facts.contains_suspicious_files;
+    item->large_size = (stats->bytes > 10 * 1024 * 1024);
+    if (stats->newest_mtime > 0 && walk->now >= (u64)stats->newest_mtime &&
+        walk->now - (u64)stats->newest_mtime < 24 * 3600)
+        item->recently_modified = 1;
+}
+
+// Fold a worker's counters into the shared state and decide whether to go on
+static bool fossil_it_magic_walk_merge(fossil_it_magic_walk_t *walk, fossil_it_magic_walk_stats_t *local)
+{
+    fossil_it_magic_walk_lock(walk);
+    fossil_it_magic_walk_stats_t *g = &walk->stats;
+    g->entries += local->entries;
+    g->bytes += local->bytes;
+    g->files += local->files;
+    g->dirs += local->dirs;
+    if (local->newest_mtime > g->newest_mtime)
+        g->newest_mtime = local->newest_mtime;
+    g->facts.contains_code |= local->facts.contains_code;
+    g->facts.contains_vcs |= local->facts.contains_vcs;
+    g->facts.contains_secrets |= local->facts.contains_secrets;
+    g->facts.contains_suspicious_files |= local->facts.contains_suspicious_files;
+    g->truncated |= local->truncated;
+    fossil_sys_memory_zero(local, sizeof(*local));
+
+    if (!walk->stop)
+    {
+        fossil_ti_danger_item_t probe;
+        fossil_it_magic_walk_apply(walk, g, &probe);
+        if (fossil_it_magic_danger_score(&probe) >= FOSSIL_IT_MAGIC_DANGER_CRITICAL ||
+            (walk->max_entries && g->entries >= walk->max_entries) ||
+            fossil_it_magic_now_ms() >= walk->deadline_ms)
+        {
+            walk->stop = true;
+            g->truncated = 1;
+        }
+    }
+    bool go_on = !walk->stop;
+    fossil_it_magic_walk_unlock(walk);
+    return go_on;
+}
+
+// Size, mtime and type of one listed entry, without following a symlink
+static bool fossil_it_magic_walk_stat(
+    fossil_it_magic_dir_iter_t *it, ccstring child, u64 *size, long long *mtime, i32 *type)
+{
+#ifdef _WIN32
+    (void)it;
+    fossil_io_filesys_obj_t obj;
+    if (fossil_io_filesys_stat(child, &obj) != 0)
+        return false;
+    *size = (u64)obj.size;
+    *mtime = (long long)obj.modified_at;
+    *type = obj.type;
+#else
+    // relative to the open directory, so the kernel does not walk the whole path again
+    (void)child;
+    struct stat st;
+    if (fstatat(dirfd(it->dir), it->name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return false;
+    *size = (u64)st.st_size;
+    *mtime = (long long)st.st_mtime;
+    *type = S_ISLNK(st.st_mode) ? FOSSIL_FILESYS_TYPE_LINK
+          : S_ISDIR(st.st_mode) ? FOSSIL_FILESYS_TYPE_DIR
+          : S_ISREG(st.st_mode) ? FOSSIL_FILESYS_TYPE_FILE
+                                : -1;
+#endif
+    return true;
+}
+
+static void fossil_it_magic_walk_dir(fossil_it_magic_walk_t *walk, i32 id, fossil_it_magic_walk_task_t task)
+{
+    fossil_it_magic_walk_stats_t local;
+    fossil_sys_memory_zero(&local, sizeof(local));
+
+    // A directory that cannot be listed leaves the walk incomplete, not clean
+    fossil_it_magic_dir_iter_t it;
+    if (!fossil_it_magic_dir_open(&it, task.path))
+    {
+        local.truncated = 1;
+        fossil_it_magic_walk_merge(walk, &local);
+        return;
+    }
+
+    // Children are spelled out in this worker's scratch buffer; only a
+    // directory queued for later gets its own copy
+    bool go_on = true;
+    size_t dir_len = strlen(task.path);
+    while (go_on && fossil_it_magic_dir_next(&it))
+    {
+        ccstring name = it.name;
+        size_t name_len = strlen(name);
+        size_t need = dir_len + name_len + 2;
+        if (need > walk->scratch_cap[id])
+        {
+            size_t cap = need < 256 ? 256 : need * 2;
+            cstring grown = (cstring)fossil_sys_memory_realloc(walk->scratch[id], cap);
+            if (!cnotnull(grown))
+            {
+                local.truncated = 1;
+                break;
+            }
+            walk->scratch[id] = grown;
+            walk->scratch_cap[id] = cap;
+        }
+        cstring child = walk->scratch[id];
+        memcpy(child, task.path, dir_len);
+        child[dir_len] = '/';
+        memcpy(child + dir_len + 1, name, name_len + 1);
+
+        // Symlinks the listing already names are counted without a stat
+        u64 size = 0;
+        long long mtime = 0;
+        i32 type = -1;
+        i32 is_dir = -1;
+        bool is_file = false;
+        if (it.is_link == 1)
+            is_dir = 0;
+        else if (fossil_it_magic_walk_stat(&it, child, &size, &mtime, &type))
+        {
+            is_dir = type == FOSSIL_FILESYS_TYPE_DIR;
+            is_file = type == FOSSIL_FILESYS_TYPE_FILE;
+            if (mtime > local.newest_mtime)
+                local.newest_mtime = mtime;
+        }
+
+        fossil_it_magic_note_entry(&local.facts, task.path, name, is_dir);
+        if (walk->scan_content && is_file && size > 0 && !local.facts.contains_secrets &&
+            fossil_it_magic_secret_scan(child, walk->content_bytes) == 1)
+            local.facts.contains_secrets = 1;
+
+        local.entries++;
+        if (is_file)
+        {
+            local.files++;
+            local.bytes += size;
+        }
+
+        if (is_dir == 1)
+        {
+            local.dirs++;
+            bool queued = false;
+            cstring sub_path = cnull;
+            if (walk->max_depth < 0 || task.depth < walk->max_depth)
+                sub_path = (cstring)fossil_sys_memory_calloc(need, 1);
+            if (cnotnull(sub_path))
+            {
+                memcpy(sub_path, child, need);
+                fossil_it_magic_walk_lock(walk);
+                walk->pending++;
+                fossil_it_magic_walk_unlock(walk);
+                fossil_it_magic_walk_task_t sub = {sub_path, task.depth + 1};
+                queued = fossil_it_magic_deque_push(&walk->deques[id], sub);
+                fossil_it_magic_walk_lock(walk);
+                if (queued)
+                    fossil_it_magic_walk_wake(walk);
+                else
+                    walk->pending--;
+                fossil_it_magic_walk_unlock(walk);
+                if (!queued)
+                    fossil_sys_memory_free(sub_path);
+            }
+            if (!queued)
+                local.truncated = 1;
+        }
+
+        if (local.entries == FOSSIL_IT_MAGIC_WALK_BATCH)
+            go_on = fossil_it_magic_walk_merge(walk, &local);
+    }
+    fossil_it_magic_dir_close(&it);
+    fossil_it_magic_walk_merge(walk, &local);
+}
+
+static void fossil_it_magic_walk_run(fossil_it_magic_walk_t *walk, i32 id)
+{
+    for (;;)
+    {
+        fossil_it_magic_walk_task_t task;
+        bool got = fossil_it_magic_deque_pop(&walk->deques[id], &task);
+        for (i32 i = 1; !got && i < walk->workers; i++)
+            got = fossil_it_magic_deque_steal(&walk->deques[(id + i) % walk->workers], &task);
+
+        if (got)
+        {
+            // Once stopped, queued directories are only drained and freed
+            fossil_it_magic_walk_lock(walk);
+            bool stopped = walk->stop;
+            fossil_it_magic_walk_unlock(walk);
+            if (!stopped)
+                fossil_it_magic_walk_dir(walk, id, task);
+            fossil_sys_memory_free(task.path);
+
+            fossil_it_magic_walk_lock(walk);
+            if (--walk->pending == 0)
+                fossil_it_magic_walk_wake(walk);
+            fossil_it_magic_walk_unlock(walk);
+            continue;
+        }
+
+        fossil_it_magic_walk_lock(walk);
+        bool done = (walk->pending == 0);
+        if (!done)
+            fossil_it_magic_walk_wait(walk);
+        fossil_it_magic_walk_unlock(walk);
+        if (done)
+            return;
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI fossil_it_magic_walk_thread(LPVOID arg)
+{
+    fossil_it_magic_walk_worker_t *worker = (fossil_it_magic_walk_worker_t *)arg;
+    fossil_it_magic_walk_run(worker->walk, worker->id);
+    return 0;
+}
+#else
+static void *fossil_it_magic_walk_thread(void *arg)
+{
+    fossil_it_magic_walk_worker_t *worker = (fossil_it_magic_walk_worker_t *)arg;
+    fossil_it_magic_walk_run(worker->walk, worker->id);
+    return NULL;
+}
+#endif
+
+static i32 fossil_it_magic_online_cpus(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (i32)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (i32)n : 1;
+#endif
+}
+
+void fossil_it_magic_danger_analyze_tree(
+    ccstring path,
+    const fossil_ti_danger_budget_t *budget,
+    fossil_ti_danger_item_t *out)
+{
+    u64 begin_ms = fossil_it_magic_now_ms();
+    fossil_it_magic_danger_analyze(path, out);
+    out->tree_walked = 1;
+
+    if (!out->is_directory)
+    {
+        fossil_io_filesys_obj_t obj;
+        if (fossil_io_filesys_stat(path, &obj) == 0)
+        {
+            out->newest_mtime = (long long)obj.modified_at;
+            if (obj.type == FOSSIL_FILESYS_TYPE_FILE)
+            {
+                out->tree_files = 1;
+                out->tree_bytes = (unsigned long long)obj.size;
+                if (budget && budget->scan_content && fossil_it_magic_secret_scan(path, budget->content_bytes) == 1)
+                {
+                    out->contains_secrets = 1;
+                    out->level = fossil_it_magic_danger_level(fossil_it_magic_danger_score(out));
                 }
-                if (out->contains_suspicious_files)
-                    break;
             }
         }
+        return;
+    }
+    out->tree_dirs = 1;
+    if (out->level >= FOSSIL_TI_DANGER_CRITICAL)
+    {
+        out->tree_truncated = 1;
+        return;
     }
 
-    i32 score = 0;
-    if (out->contains_code)
-        score += 3;
-    if (out->contains_secrets)
-        score += 5;
-    if (out->large_size)
-        score += 2;
-    if (out->world_writable)
-        score += 2;
-    if (out->is_symlink)
-        score += 1;
-    if (out->suspicious_extension)
-        score += 2;
-    if (out->recently_modified)
-        score += 1;
-    if (out->contains_suspicious_files)
-        score += 2;
+    fossil_it_magic_walk_t *walk = (fossil_it_magic_walk_t *)fossil_sys_memory_calloc(1, sizeof(*walk));
+    cstring root_path = (cstring)fossil_sys_memory_calloc(strlen(path) + 1, 1);
+    if (!cnotnull(walk) || !cnotnull(root_path))
+    {
+        if (cnotnull(walk))
+            fossil_sys_memory_free(walk);
+        if (cnotnull(root_path))
+            fossil_sys_memory_free(root_path);
+        out->tree_truncated = 1;
+        return;
+    }
+    memcpy(root_path, path, strlen(path) + 1);
+
+    i32 max_ms = (budget && budget->max_ms > 0) ? budget->max_ms : 2000;
+    i32 threads = (budget && budget->threads > 0) ? budget->threads : fossil_it_magic_online_cpus();
+    walk->workers = threads < 1 ? 1 : (threads > FOSSIL_IT_MAGIC_WALK_THREADS ? FOSSIL_IT_MAGIC_WALK_THREADS : threads);
+    walk->max_depth = budget ? budget->max_depth : 32;
+    walk->max_entries = (budget && budget->max_entries > 0) ? (u64)budget->max_entries : 1000000ULL;
+    walk->now = (u64)time(cnull);
+    walk->deadline_ms = begin_ms + (u64)max_ms;
+    walk->root = *out;
+    walk->scan_content = budget && budget->scan_content;
+    walk->content_bytes = budget ? budget->content_bytes : 0;
+
+#ifdef _WIN32
+    InitializeCriticalSection(&walk->lock);
+    InitializeConditionVariable(&walk->cond);
+    for (i32 i = 0; i < walk->workers; i++)
+        InitializeCriticalSection(&walk->deques[i].lock);
+#else
+    pthread_mutex_init(&walk->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    // The wait deadline is on the monotonic clock, so the condition must be too
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&walk->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    for (i32 i = 0; i < walk->workers; i++)
+        pthread_mutex_init(&walk->deques[i].lock, NULL);
+#endif
+
+    fossil_it_magic_walk_task_t root_task = {root_path, 0};
+    walk->pending = 1;
+    if (!fossil_it_magic_deque_push(&walk->deques[0], root_task))
+    {
+        walk->pending = 0;
+        fossil_sys_memory_free(root_path);
+        walk->stats.truncated = 1;
+    }
 
-    if (score >= 8)
-        out->level = FOSSIL_TI_DANGER_CRITICAL;
-    else if (score >= 5)
-        out->level = FOSSIL_TI_DANGER_HIGH;
-    else if (score >= 3)
-        out->level = FOSSIL_TI_DANGER_MEDIUM;
-    else if (score >= 1)
-        out->level = FOSSIL_TI_DANGER_LOW;
-    else
-        out->level = FOSSIL_TI_DANGER_NONE;
+    // The calling thread is worker 0; a worker that fails to start is simply absent
+    fossil_it_magic_walk_worker_t workers[FOSSIL_IT_MAGIC_WALK_THREADS];
+#ifdef _WIN32
+    HANDLE handles[FOSSIL_IT_MAGIC_WALK_THREADS];
+#else
+    pthread_t handles[FOSSIL_IT_MAGIC_WALK_THREADS];
+#endif
+    i32 started = 0;
+    for (i32 i = 1; i < walk->workers; i++)
+    {
+        workers[i].walk = walk;
+        workers[i].id = i;
+#ifdef _WIN32
+        handles[started] = CreateThread(NULL, 0, fossil_it_magic_walk_thread, &workers[i], 0, NULL);
+        if (handles[started])
+            started++;
+#else
+        if (pthread_create(&handles[started], NULL, fossil_it_magic_walk_thread, &workers[i]) == 0)
+            started++;
+#endif
+    }
+    fossil_it_magic_walk_run(walk, 0);
+    for (i32 i = 0; i < started; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+#else
+        pthread_join(handles[i], NULL);
+#endif
+    }
+
+    // Deques of workers that never started can still hold tasks
+    fossil_it_magic_walk_task_t task;
+    for (i32 i = 0; i < walk->workers; i++)
+        while (fossil_it_magic_deque_pop(&walk->deques[i], &task))
+            fossil_sys_memory_free(task.path);
+
+    fossil_it_magic_walk_apply(walk, &walk->stats, out);
+    out->tree_bytes = walk->stats.bytes;
+    out->tree_files = walk->stats.files;
+    out->tree_dirs = 1 + walk->stats.dirs;
+    out->newest_mtime = walk->stats.newest_mtime;
+    out->tree_truncated = walk->stats.truncated;
+    out->level = fossil_it_magic_danger_level(fossil_it_magic_danger_score(out));
+
+#ifdef _WIN32
+    for (i32 i = 0; i < walk->workers; i++)
+        DeleteCriticalSection(&walk->deques[i].lock);
+    DeleteCriticalSection(&walk->lock);
+#else
+    for (i32 i = 0; i < walk->workers; i++)
+        pthread_mutex_destroy(&walk->deques[i].lock);
+    pthread_cond_destroy(&walk->cond);
+    pthread_mutex_destroy(&walk->lock);
+#endif
+    for (i32 i = 0; i < walk->workers; i++)
+    {
+        fossil_sys_memory_free(walk->deques[i].tasks);
+        if (cnotnull(walk->scratch[i]))
+            fossil_sys_memory_free(walk->scratch[i]);
+    }
+    fossil_sys_memory_free(walk);
+}
+
+// Contribution of one item's level to a multi-target report's total score
+static i32 fossil_it_magic_danger_weight(fossil_ti_danger_level_t level)
+{
+    switch (level)
+    {
+    case FOSSIL_TI_DANGER_CRITICAL:
+        return 8;
+    case FOSSIL_TI_DANGER_HIGH:
+        return 5;
+    case FOSSIL_TI_DANGER_MEDIUM:
+        return 3;
+    case FOSSIL_TI_DANGER_LOW:
+        return 1;
+    default:
+        return 0;
+    }
 }
 
 void fossil_it_magic_danger_report(
@@ -751,26 +3188,462 @@ void fossil_it_magic_danger_report(
         report->item_count++;
         if (report->items[i].level > maxLevel)
             maxLevel = report->items[i].level;
-        switch (report->items[i].level)
-        {
-        case FOSSIL_TI_DANGER_CRITICAL:
-            total_score += 8;
-            break;
-        case FOSSIL_TI_DANGER_HIGH:
-            total_score += 5;
-            break;
-        case FOSSIL_TI_DANGER_MEDIUM:
-            total_score += 3;
-            break;
-        case FOSSIL_TI_DANGER_LOW:
-            total_score += 1;
-            break;
-        default:
-            break;
-        }
+        total_score += fossil_it_magic_danger_weight(report->items[i].level);
     }
 
     report->overall_level = maxLevel;
     report->warning_required = (maxLevel >= FOSSIL_TI_DANGER_MEDIUM || total_score >= 10);
     report->block_recommended = (maxLevel >= FOSSIL_TI_DANGER_CRITICAL || total_score >= 16);
 }
+
+/*
+ * Batch analysis. Paths are tidied lexically and sorted with '/' ordered
+ * before every other byte, which places each path's descendants directly
+ * after it; one pass then finds repeats and, for recursive batches, paths
+ * inside an earlier walk. The remaining work is a flat list of tasks that
+ * worker threads claim one at a time. Nested paths wait for a second round:
+ * one only gets the flat analysis if the enclosing walk finished untruncated,
+ * reached its depth and has no symlink on the way down; otherwise it is
+ * walked itself.
+ */
+enum
+{
+    FOSSIL_IT_MAGIC_BATCH_COPY,  // repeat of an earlier path, copied from its result
+    FOSSIL_IT_MAGIC_BATCH_FLAT,  // fossil_it_magic_danger_analyze
+    FOSSIL_IT_MAGIC_BATCH_WALK,  // fossil_it_magic_danger_analyze_tree
+    FOSSIL_IT_MAGIC_BATCH_NESTED // inside a walk; settled once that walk is done
+};
+
+typedef struct
+{
+    cstring tidy;
+    i32 index;
+} fossil_it_magic_batch_key_t;
+
+typedef struct
+{
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CRITICAL_SECTION emit;
+#else
+    pthread_mutex_t lock;
+    pthread_mutex_t emit;
+#endif
+    ccstring *paths;
+    i32 *tasks;     // input indices to analyze
+    u8 *mode;       // per input index, a FOSSIL_IT_MAGIC_BATCH_* value
+    i32 task_count;
+    i32 next;       // next unclaimed task
+    fossil_ti_danger_budget_t budget;
+    fossil_ti_danger_item_fn on_item;
+    void *user;
+    fossil_ti_danger_batch_t *batch;
+} fossil_it_magic_batch_run_t;
+
+static bool fossil_it_magic_is_sep(char c)
+{
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+// Drops "." segments and repeated or trailing separators; out holds strlen(in) + 2
+static void fossil_it_magic_path_tidy(ccstring in, cstring out)
+{
+    size_t o = 0;
+    bool absolute = fossil_it_magic_is_sep(in[0]);
+    if (absolute)
+        out[o++] = '/';
+    ccstring p = in;
+    while (*p)
+    {
+        while (fossil_it_magic_is_sep(*p))
+            p++;
+        ccstring seg = p;
+        while (*p && !fossil_it_magic_is_sep(*p))
+            p++;
+        size_t n = (size_t)(p - seg);
+        if (n == 0 || (n == 1 && seg[0] == '.'))
+            continue;
+        if (o > (absolute ? 1u : 0u))
+            out[o++] = '/';
+        memcpy(out + o, seg, n);
+        o += n;
+    }
+    if (o == 0)
+        out[o++] = '.';
+    out[o] = cterm;
+}
+
+static int fossil_it_magic_batch_key_cmp(const void *a, const void *b)
+{
+    const fossil_it_magic_batch_key_t *ka = (const fossil_it_magic_batch_key_t *)a;
+    const fossil_it_magic_batch_key_t *kb = (const fossil_it_magic_batch_key_t *)b;
+    const u8 *x = (const u8 *)ka->tidy;
+    const u8 *y = (const u8 *)kb->tidy;
+    for (;; x++, y++)
+    {
+        u32 cx = (*x == '/') ? 1u : *x;
+        u32 cy = (*y == '/') ? 1u : *y;
+        if (cx != cy)
+            return cx < cy ? -1 : 1;
+        if (!*x)
+            break;
+    }
+    return (ka->index > kb->index) - (ka->index < kb->index);
+}
+
+// True if tidy path inner lies strictly inside tidy path outer
+static bool fossil_it_magic_path_inside(ccstring outer, ccstring inner)
+{
+    ccstring rest;
+    if (strcmp(outer, ".") == 0)
+    {
+        if (inner[0] == '/' || strcmp(inner, ".") == 0)
+            return false;
+        rest = inner;
+    }
+    else if (strcmp(outer, "/") == 0)
+    {
+        if (inner[0] != '/' || inner[1] == cterm)
+            return false;
+        rest = inner + 1;
+    }
+    else
+    {
+        size_t n = strlen(outer);
+        if (strncmp(outer, inner, n) != 0 || inner[n] != '/')
+            return false;
+        rest = inner + n + 1;
+    }
+
+    // A ".." below the shared prefix may climb back out of it
+    for (ccstring seg = rest; cnotnull(seg);)
+    {
+        if (seg[0] == '.' && seg[1] == '.' && (seg[2] == '/' || seg[2] == cterm))
+            return false;
+        seg = strchr(seg, '/');
+        if (cnotnull(seg))
+            seg++;
+    }
+    return true;
+}
+
+// True if the finished walk of outer saw everything under inner (tidy paths, inner inside outer)
+static bool fossil_it_magic_walk_covers(
+    const fossil_ti_danger_item_t *walked, const fossil_ti_danger_budget_t *budget, ccstring outer, ccstring inner)
+{
+    if (!walked->tree_walked || walked->tree_truncated || !walked->is_directory)
+        return false;
+
+    size_t start = 0;
+    if (strcmp(outer, "/") == 0)
+        start = 1;
+    else if (strcmp(outer, ".") != 0)
+        start = strlen(outer) + 1;
+
+    // Every directory from outer down to inner must be one the walk entered
+    size_t len = strlen(inner);
+    cstring prefix = (cstring)fossil_sys_memory_calloc(len + 1, 1);
+    if (!cnotnull(prefix))
+        return false;
+    memcpy(prefix, inner, len + 1);
+
+    bool covered = true;
+    i32 depth = 0;
+    for (size_t i = start; covered && i <= len; i++)
+    {
+        if (inner[i] != '/' && inner[i] != cterm)
+            continue;
+        depth++;
+        prefix[i] = cterm;
+        fossil_io_filesys_obj_t obj;
+        if (fossil_io_filesys_stat(prefix, &obj) == 0 && obj.type == FOSSIL_FILESYS_TYPE_LINK)
+            covered = false;
+        prefix[i] = inner[i];
+    }
+    fossil_sys_memory_free(prefix);
+
+    // The walk lists directories down to max_depth levels below outer
+    return covered && (budget->max_depth < 0 || depth <= budget->max_depth);
+}
+
+static void fossil_it_magic_batch_lock(fossil_it_magic_batch_run_t *run)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&run->lock);
+#else
+    pthread_mutex_lock(&run->lock);
+#endif
+}
+
+static void fossil_it_magic_batch_unlock(fossil_it_magic_batch_run_t *run)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&run->lock);
+#else
+    pthread_mutex_unlock(&run->lock);
+#endif
+}
+
+static void fossil_it_magic_batch_emit(fossil_it_magic_batch_run_t *run, i32 index)
+{
+    if (!run->on_item)
+        return;
+#ifdef _WIN32
+    EnterCriticalSection(&run->emit);
+    run->on_item(&run->batch->items[index], (int)index, run->user);
+    LeaveCriticalSection(&run->emit);
+#else
+    pthread_mutex_lock(&run->emit);
+    run->on_item(&run->batch->items[index], (int)index, run->user);
+    pthread_mutex_unlock(&run->emit);
+#endif
+}
+
+static void fossil_it_magic_batch_work(fossil_it_magic_batch_run_t *run)
+{
+    for (;;)
+    {
+        fossil_it_magic_batch_lock(run);
+        i32 task = run->next < run->task_count ? run->tasks[run->next++] : -1;
+        fossil_it_magic_batch_unlock(run);
+        if (task < 0)
+            return;
+
+        ccstring path = run->paths[task] ? run->paths[task] : "";
+        if (run->mode[task] == FOSSIL_IT_MAGIC_BATCH_WALK)
+            fossil_it_magic_danger_analyze_tree(path, &run->budget, &run->batch->items[task]);
+        else
+            fossil_it_magic_danger_analyze(path, &run->batch->items[task]);
+        fossil_it_magic_batch_emit(run, task);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI fossil_it_magic_batch_thread(LPVOID arg)
+{
+    fossil_it_magic_batch_work((fossil_it_magic_batch_run_t *)arg);
+    return 0;
+}
+#else
+static void *fossil_it_magic_batch_thread(void *arg)
+{
+    fossil_it_magic_batch_work((fossil_it_magic_batch_run_t *)arg);
+    return NULL;
+}
+#endif
+
+// Runs every task in run on up to threads workers, the calling thread included
+static void fossil_it_magic_batch_pool(
+    fossil_it_magic_batch_run_t *run, const fossil_ti_danger_budget_t *budget, i32 threads)
+{
+    // Share the thread budget between concurrent paths and the walks inside them
+    i32 workers = threads < run->task_count ? threads : run->task_count;
+    if (workers > FOSSIL_IT_MAGIC_WALK_THREADS)
+        workers = FOSSIL_IT_MAGIC_WALK_THREADS;
+    if (workers < 1)
+        workers = 1;
+    if (budget)
+        run->budget = *budget;
+    run->budget.threads = threads / workers > 1 ? threads / workers : 1;
+    run->next = 0;
+
+#ifdef _WIN32
+    HANDLE handles[FOSSIL_IT_MAGIC_WALK_THREADS];
+#else
+    pthread_t handles[FOSSIL_IT_MAGIC_WALK_THREADS];
+#endif
+    // A worker that fails to start is simply absent
+    i32 started = 0;
+    for (i32 w = 1; w < workers; w++)
+    {
+#ifdef _WIN32
+        handles[started] = CreateThread(NULL, 0, fossil_it_magic_batch_thread, run, 0, NULL);
+        if (handles[started])
+            started++;
+#else
+        if (pthread_create(&handles[started], NULL, fossil_it_magic_batch_thread, run) == 0)
+            started++;
+#endif
+    }
+    fossil_it_magic_batch_work(run);
+    for (i32 w = 0; w < started; w++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(handles[w], INFINITE);
+        CloseHandle(handles[w]);
+#else
+        pthread_join(handles[w], NULL);
+#endif
+    }
+}
+
+int fossil_it_magic_danger_batch(
+    ccstring paths[],
+    i32 path_count,
+    const fossil_ti_danger_budget_t *budget,
+    fossil_ti_danger_item_fn on_item,
+    void *user,
+    fossil_ti_danger_batch_t *batch)
+{
+    fossil_sys_memory_zero(batch, sizeof(*batch));
+    if (path_count <= 0)
+        return 0;
+
+    size_t count = (size_t)path_count;
+    batch->items = (fossil_ti_danger_item_t *)fossil_sys_memory_calloc(count, sizeof(*batch->items));
+    batch->covered_by = (int *)fossil_sys_memory_calloc(count, sizeof(*batch->covered_by));
+    fossil_it_magic_batch_key_t *keys =
+        (fossil_it_magic_batch_key_t *)fossil_sys_memory_calloc(count, sizeof(*keys));
+    i32 *tasks = (i32 *)fossil_sys_memory_calloc(count, sizeof(*tasks));
+    u8 *mode = (u8 *)fossil_sys_memory_calloc(count, sizeof(*mode));
+    bool ok = batch->items && batch->covered_by && keys && tasks && mode;
+
+    for (i32 i = 0; ok && i < path_count; i++)
+    {
+        ccstring path = paths[i] ? paths[i] : "";
+        keys[i].index = i;
+        keys[i].tidy = (cstring)fossil_sys_memory_calloc(strlen(path) + 2, 1);
+        ok = cnotnull(keys[i].tidy);
+        if (ok)
+            fossil_it_magic_path_tidy(path, keys[i].tidy);
+    }
+
+    i32 task_count = 0;
+    if (ok)
+    {
+        qsort(keys, count, sizeof(*keys), fossil_it_magic_batch_key_cmp);
+        const fossil_it_magic_batch_key_t *first = cnull; // first of the current run of equal paths
+        const fossil_it_magic_batch_key_t *root = cnull;  // last path walked recursively
+        for (size_t k = 0; k < count; k++)
+        {
+            i32 i = keys[k].index;
+            batch->covered_by[i] = -1;
+            if (first && strcmp(first->tidy, keys[k].tidy) == 0)
+            {
+                batch->covered_by[i] = first->index; // copied once the original is done
+                continue;
+            }
+            first = &keys[k];
+            mode[i] = FOSSIL_IT_MAGIC_BATCH_FLAT;
+            if (budget && root && fossil_it_magic_path_inside(root->tidy, keys[k].tidy))
+            {
+                batch->covered_by[i] = root->index; // provisional, checked after the walk
+                mode[i] = FOSSIL_IT_MAGIC_BATCH_NESTED;
+                continue;
+            }
+            if (budget)
+            {
+                root = &keys[k];
+                mode[i] = FOSSIL_IT_MAGIC_BATCH_WALK;
+            }
+            tasks[task_count++] = i;
+        }
+    }
+
+    if (ok)
+    {
+        fossil_it_magic_batch_run_t run;
+        fossil_sys_memory_zero(&run, sizeof(run));
+        i32 threads = (budget && budget->threads > 0) ? budget->threads : fossil_it_magic_online_cpus();
+        run.paths = paths;
+        run.tasks = tasks;
+        run.mode = mode;
+        run.task_count = task_count;
+        run.on_item = on_item;
+        run.user = user;
+        run.batch = batch;
+
+#ifdef _WIN32
+        InitializeCriticalSection(&run.lock);
+        InitializeCriticalSection(&run.emit);
+#else
+        pthread_mutex_init(&run.lock, NULL);
+        pthread_mutex_init(&run.emit, NULL);
+#endif
+        fossil_it_magic_batch_pool(&run, budget, threads);
+
+        // Second round: nested paths the walk above them did not fully cover are walked too
+        run.task_count = 0;
+        const fossil_it_magic_batch_key_t *root = cnull;
+        for (size_t k = 0; k < count; k++)
+        {
+            // In sorted order each nested path follows the walk it was found under
+            i32 i = keys[k].index;
+            if (mode[i] == FOSSIL_IT_MAGIC_BATCH_WALK)
+                root = &keys[k];
+            if (mode[i] != FOSSIL_IT_MAGIC_BATCH_NESTED)
+                continue;
+            if (root && fossil_it_magic_walk_covers(&batch->items[root->index], budget, root->tidy, keys[k].tidy))
+                mode[i] = FOSSIL_IT_MAGIC_BATCH_FLAT;
+            else
+            {
+                mode[i] = FOSSIL_IT_MAGIC_BATCH_WALK;
+                batch->covered_by[i] = -1;
+            }
+            run.tasks[run.task_count++] = i;
+        }
+        if (run.task_count > 0)
+            fossil_it_magic_batch_pool(&run, budget, threads);
+
+        // Repeated paths share the result of their first occurrence
+        for (i32 i = 0; i < path_count; i++)
+        {
+            if (mode[i] != FOSSIL_IT_MAGIC_BATCH_COPY)
+                continue;
+            batch->items[i] = batch->items[batch->covered_by[i]];
+            fossil_it_magic_batch_emit(&run, i);
+        }
+#ifdef _WIN32
+        DeleteCriticalSection(&run.emit);
+        DeleteCriticalSection(&run.lock);
+#else
+        pthread_mutex_destroy(&run.emit);
+        pthread_mutex_destroy(&run.lock);
+#endif
+
+        // A repeat or a path inside a finished walk is already counted where it is covered.
+        // The flags follow the worst item alone: a sum over any number of targets would
+        // let enough harmless ones block, unlike the eight-path report's fixed thresholds.
+        batch->item_count = path_count;
+        for (i32 i = 0; i < path_count; i++)
+        {
+            if (batch->items[i].level > batch->overall_level)
+                batch->overall_level = batch->items[i].level;
+            if (batch->covered_by[i] < 0)
+                batch->total_score += fossil_it_magic_danger_weight(batch->items[i].level);
+        }
+        batch->warning_required = (batch->overall_level >= FOSSIL_TI_DANGER_MEDIUM);
+        batch->block_recommended = (batch->overall_level >= FOSSIL_TI_DANGER_CRITICAL);
+    }
+
+    if (cnotnull(keys))
+    {
+        for (size_t k = 0; k < count; k++)
+            if (cnotnull(keys[k].tidy))
+                fossil_sys_memory_free(keys[k].tidy);
+        fossil_sys_memory_free(keys);
+    }
+    if (cnotnull(tasks))
+        fossil_sys_memory_free(tasks);
+    if (cnotnull(mode))
+        fossil_sys_memory_free(mode);
+    if (!ok)
+    {
+        fossil_it_magic_danger_batch_dispose(batch);
+        return -1;
+    }
+    return 0;
+}
+
+void fossil_it_magic_danger_batch_dispose(fossil_ti_danger_batch_t *batch)
+{
+    if (cnotnull(batch->items))
+        fossil_sys_memory_free(batch->items);
+    if (cnotnull(batch->covered_by))
+        fossil_sys_memory_free(batch->covered_by);
+    fossil_sys_memory_zero(batch, sizeof(*batch));
+}
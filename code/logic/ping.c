@@ -23,6 +23,9 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/code/commands.h"
+#include "fossil/code/probe.h"
+#include "fossil/code/latency.h"
+#include "fossil/code/json.h"
 
 /*=============================================================================
 SQUID PING COMMAND (TCP-BASED FALLBACK)
@@ -32,20 +35,284 @@ SQUID PING COMMAND (TCP-BASED FALLBACK)
 #include <string.h>
 #include <time.h>
 
-/* simple timestamp helper (ms) */
-static uint64_t squid_time_ms(void)
-{
-    struct timespec ts;
-#if defined(_WIN32)
-    timespec_get(&ts, TIME_UTC);
+#ifdef _WIN32
+#include <ws2tcpip.h>
 #else
-    clock_gettime(CLOCK_REALTIME, &ts);
+#include <arpa/inet.h>
 #endif
-    return (uint64_t)ts.tv_sec * 1000ULL + (ts.tv_nsec / 1000000ULL);
+
+#define SQUID_PING_MAX_WINDOW 4096
+#define SQUID_PING_MIN_PREFIX 16
+
+/* one row of the fleet summary */
+typedef struct {
+    char name[256];
+    char ip[64];
+    int sent;
+    int received;
+    int timeouts;            /* no answer before the deadline */
+    int refused;             /* host answered with a reset; also counted as received */
+    int errors;              /* unreachable or local failure */
+    fossil_squid_latency_t rtt;
+} squid_ping_target_t;
+
+typedef struct {
+    squid_ping_target_t *items;
+    size_t count;
+    size_t capacity;
+} squid_ping_targets_t;
+
+typedef struct {
+    bool verbose;            /* per-reply lines (single host only) */
+} squid_ping_ctx_t;
+
+static squid_ping_target_t *squid_ping_add(squid_ping_targets_t *t, const char *name, const char *ip)
+{
+    if (t->count == t->capacity)
+    {
+        size_t cap = t->capacity ? t->capacity * 2 : 16;
+        squid_ping_target_t *grown = (squid_ping_target_t *)fossil_sys_memory_realloc(
+            t->items, cap * sizeof(squid_ping_target_t));
+        if (!grown)
+            return NULL;
+        t->items = grown;
+        t->capacity = cap;
+    }
+
+    squid_ping_target_t *row = &t->items[t->count++];
+    memset(row, 0, sizeof(*row));
+    snprintf(row->name, sizeof(row->name), "%s", name);
+    snprintf(row->ip, sizeof(row->ip), "%s", ip);
+    return row;
+}
+
+/* expand "a.b.c.d/n" or "x:y::/n" into host addresses; returns -1 if spec is not a CIDR */
+static int squid_ping_expand_cidr(squid_ping_targets_t *t, const char *spec, bool ipv4, bool ipv6)
+{
+    const char *slash = strchr(spec, '/');
+    if (!slash)
+        return -1;
+
+    char base[64];
+    size_t len = (size_t)(slash - spec);
+    if (len == 0 || len >= sizeof(base))
+        return -1;
+    memcpy(base, spec, len);
+    base[len] = '\0';
+
+    unsigned char addr[16];
+    int family = AF_INET;
+    int bits = 32;
+    if (inet_pton(AF_INET, base, addr) != 1)
+    {
+        if (inet_pton(AF_INET6, base, addr) != 1)
+            return -1;
+        family = AF_INET6;
+        bits = 128;
+    }
+
+    char *end = NULL;
+    long prefix = strtol(slash + 1, &end, 10);
+    if (!end || end == slash + 1 || *end != '\0' || prefix < 0 || prefix > bits)
+        return -1;
+
+    /* honor a forced family the same way resolved names do */
+    bool is_v6 = family == AF_INET6;
+    if ((ipv4 && !ipv6 && is_v6) || (ipv6 && !ipv4 && !is_v6))
+    {
+        fprintf(stderr, "ping: %s is not an %s range\n", spec, is_v6 ? "IPv4" : "IPv6");
+        return 0;
+    }
+
+    int host_bits = bits - (int)prefix;
+    if (host_bits > 32 - SQUID_PING_MIN_PREFIX)
+    {
+        fprintf(stderr, "ping: %s is too large, use /%d or smaller\n", spec, bits - (32 - SQUID_PING_MIN_PREFIX));
+        return 0;
+    }
+
+    /* the host part fits in the low 32 bits of either family */
+    size_t addr_len = is_v6 ? 16 : 4;
+    unsigned char *low = addr + addr_len - 4;
+    uint32_t mask = host_bits == 32 ? 0 : (0xFFFFFFFFu << host_bits);
+    uint32_t net = (((uint32_t)low[0] << 24) | ((uint32_t)low[1] << 16) |
+                    ((uint32_t)low[2] << 8) | (uint32_t)low[3]) & mask;
+    uint32_t size = (uint32_t)1 << host_bits;
+    uint32_t first = net, last = net + size - 1;
+
+    /* skip network and broadcast (IPv4) or subnet-router anycast (IPv6) addresses */
+    if (!is_v6 && host_bits >= 2)
+    {
+        first++;
+        last--;
+    }
+    else if (is_v6 && host_bits >= 2)
+    {
+        first++;
+    }
+
+    for (uint32_t a = first; a <= last; ++a)
+    {
+        char ip[INET6_ADDRSTRLEN];
+        low[0] = (unsigned char)(a >> 24);
+        low[1] = (unsigned char)(a >> 16);
+        low[2] = (unsigned char)(a >> 8);
+        low[3] = (unsigned char)a;
+        if (!inet_ntop(family, addr, ip, sizeof(ip)))
+            continue;
+        if (!squid_ping_add(t, ip, ip))
+            return 0;
+        if (a == last)
+            break;
+    }
+    return 0;
+}
+
+static void squid_ping_add_spec(squid_ping_targets_t *t, const char *spec, bool ipv4, bool ipv6)
+{
+    if (squid_ping_expand_cidr(t, spec, ipv4, ipv6) == 0)
+        return;
+
+    fossil_net_address_t addr;
+    memset(&addr, 0, sizeof(addr));
+
+    if (fossil_net_socket_resolve(spec, &addr) != 0)
+    {
+        fprintf(stderr, "ping: failed to resolve host %s\n", spec);
+        return;
+    }
+
+    /* honor a forced family by skipping addresses of the other one */
+    bool is_v6 = strchr(addr.ip, ':') != NULL;
+    if ((ipv4 && !ipv6 && is_v6) || (ipv6 && !ipv4 && !is_v6))
+    {
+        fprintf(stderr, "ping: %s has no %s address\n", spec, is_v6 ? "IPv4" : "IPv6");
+        return;
+    }
+
+    squid_ping_add(t, spec, addr.ip);
+}
+
+static void squid_ping_load_file(squid_ping_targets_t *t, const char *path, bool ipv4, bool ipv6)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+    {
+        fprintf(stderr, "ping: cannot open hosts file %s\n", path);
+        return;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), fp))
+    {
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+
+        char *e = p + strcspn(p, "#\r\n");
+        while (e > p && (e[-1] == ' ' || e[-1] == '\t'))
+            e--;
+        *e = '\0';
+
+        if (*p)
+            squid_ping_add_spec(t, p, ipv4, ipv6);
+    }
+    fclose(fp);
+}
+
+static void squid_ping_on_probe(fossil_squid_probe_t *probe, void *ctx)
+{
+    squid_ping_ctx_t *pc = (squid_ping_ctx_t *)ctx;
+    squid_ping_target_t *row = (squid_ping_target_t *)probe->user;
+
+    row->sent++;
+
+    /* a reset is still an answer: the host is up, only the port is closed */
+    if (probe->status == FOSSIL_SQUID_PROBE_OPEN || probe->status == FOSSIL_SQUID_PROBE_REFUSED)
+    {
+        row->received++;
+        if (probe->status == FOSSIL_SQUID_PROBE_REFUSED)
+            row->refused++;
+        fossil_squid_latency_record(&row->rtt, probe->rtt_ns);
+
+        if (pc->verbose)
+        {
+            printf("%s from %s: time=%.3fms\n",
+                   probe->status == FOSSIL_SQUID_PROBE_REFUSED ? "refused" : "reply",
+                   row->ip,
+                   (double)probe->rtt_ns / 1000000.0);
+        }
+    }
+    else
+    {
+        if (probe->status == FOSSIL_SQUID_PROBE_TIMEOUT)
+            row->timeouts++;
+        else
+            row->errors++;
+
+        if (pc->verbose)
+        {
+            printf("timeout/error from %s (%s)\n",
+                   row->ip,
+                   probe->status == FOSSIL_SQUID_PROBE_TIMEOUT ? "timed out" : strerror(probe->error));
+        }
+    }
+}
+
+static void squid_ping_summary(const squid_ping_target_t *row, fossil_squid_json_t *json, bool table)
+{
+    int loss = row->sent > 0 ? ((row->sent - row->received) * 100 / row->sent) : 0;
+    fossil_squid_latency_summary_t st;
+    fossil_squid_latency_summarize(&row->rtt, &st);
+
+    if (json)
+    {
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "host", row->name);
+        fossil_squid_json_field_string(json, "ip", row->ip);
+        fossil_squid_json_field_int(json, "sent", row->sent);
+        fossil_squid_json_field_int(json, "received", row->received);
+        fossil_squid_json_field_int(json, "loss", loss);
+        fossil_squid_json_field_int(json, "timeouts", row->timeouts);
+        fossil_squid_json_field_int(json, "refused", row->refused);
+        fossil_squid_json_field_int(json, "errors", row->errors);
+        fossil_squid_json_field_uint(json, "avg_ms", (unsigned long long)st.mean_ms);
+        fossil_squid_json_field_double(json, "min_ms", st.min_ms, 3);
+        fossil_squid_json_field_double(json, "max_ms", st.max_ms, 3);
+        fossil_squid_json_field_double(json, "mean_ms", st.mean_ms, 3);
+        fossil_squid_json_field_double(json, "stddev_ms", st.stddev_ms, 3);
+        fossil_squid_json_field_double(json, "jitter_ms", st.jitter_ms, 3);
+        fossil_squid_json_field_double(json, "p50_ms", st.p50_ms, 3);
+        fossil_squid_json_field_double(json, "p90_ms", st.p90_ms, 3);
+        fossil_squid_json_field_double(json, "p99_ms", st.p99_ms, 3);
+        fossil_squid_json_field_double(json, "p999_ms", st.p999_ms, 3);
+        fossil_squid_json_object_end(json);
+    }
+    else if (table)
+    {
+        printf("%-32s %-16s %5d %5d %5d %5d %5d %5d%% %9.3f %9.3f %9.3f %9.3f\n",
+               row->name, row->ip, row->sent, row->received, row->timeouts, row->refused, row->errors, loss,
+               st.mean_ms, st.p50_ms, st.p99_ms, st.max_ms);
+    }
+    else
+    {
+        printf("\n--- %s ping statistics ---\n", row->name);
+        printf("%d packets transmitted, %d received, %d timed out, %d refused, %d errors, %d%% packet loss\n",
+               row->sent, row->received, row->timeouts, row->refused, row->errors, loss);
+        if (row->received > 0)
+        {
+            printf("rtt min/mean/max/stddev = %.3f/%.3f/%.3f/%.3f ms, jitter = %.3f ms\n",
+                   st.min_ms, st.mean_ms, st.max_ms, st.stddev_ms, st.jitter_ms);
+            printf("rtt p50/p90/p99/p99.9 = %.3f/%.3f/%.3f/%.3f ms\n",
+                   st.p50_ms, st.p90_ms, st.p99_ms, st.p999_ms);
+        }
+    }
 }
 
 int fossil_squid_ping(
-    ccstring host,
+    ccstring const *hosts,
+    int host_count,
+    ccstring hosts_file,
     int count,
     int interval_ms,
     int timeout_ms,
@@ -56,7 +323,7 @@ int fossil_squid_ping(
     bool flood,
     bool json)
 {
-    if (!host)
+    if ((!hosts || host_count <= 0) && !hosts_file)
         return -1;
 
     if (count <= 0)
@@ -71,109 +338,105 @@ int fossil_squid_ping(
     if (tcp_port <= 0)
         tcp_port = 80;
 
-    fossil_net_address_t addr;
-    memset(&addr, 0, sizeof(addr));
+    squid_ping_targets_t targets;
+    memset(&targets, 0, sizeof(targets));
 
-    /* resolve host */
-    if (fossil_net_socket_resolve(host, &addr) != 0)
+    for (int i = 0; hosts && i < host_count; ++i)
     {
-        fprintf(stderr, "ping: failed to resolve host %s\n", host);
-        return -1;
+        if (hosts[i])
+            squid_ping_add_spec(&targets, hosts[i], ipv4, ipv6);
     }
+    if (hosts_file)
+        squid_ping_load_file(&targets, hosts_file, ipv4, ipv6);
 
-    addr.port = (uint16_t)tcp_port;
-
-    int sent = 0;
-    int received = 0;
-    uint64_t total_time = 0;
-
-    if (!stats_only)
-        printf("PING %s (%s:%d)\n", host, addr.ip, addr.port);
-
-    for (int i = 0; i < count; ++i)
+    if (targets.count == 0)
     {
-        fossil_net_socket_t sock;
-        memset(&sock, 0, sizeof(sock));
+        fossil_sys_memory_free(targets.items);
+        return -1;
+    }
 
-        /* select IP family based on flags */
-        const char *family = "ipv4"; // default
-        if (ipv6 && !ipv4)
-            family = "ipv6";
-        else if (ipv4 && !ipv6)
-            family = "ipv4";
-        else if (ipv4 && ipv6)
-            family = "ipv4"; // or implement preference logic here
+    /* one schedule per target, all driven from a single event loop */
+    size_t total = targets.count * (size_t)count;
+    fossil_squid_probe_t *probes =
+        (fossil_squid_probe_t *)fossil_sys_memory_calloc(total, sizeof(fossil_squid_probe_t));
+    if (!probes)
+    {
+        fossil_sys_memory_free(targets.items);
+        fprintf(stderr, "ping: out of memory\n");
+        return -1;
+    }
 
-        if (fossil_net_socket_create(&sock, "tcp", family) != 0)
+    uint64_t interval_ns = flood ? 0 : (uint64_t)interval_ms * 1000000ULL;
+    for (int round = 0; round < count; ++round)
+    {
+        for (size_t h = 0; h < targets.count; ++h)
         {
-            fprintf(stderr, "ping: socket create failed\n");
-            continue;
+            fossil_squid_probe_t *p = &probes[(size_t)round * targets.count + h];
+            p->ip = targets.items[h].ip;
+            p->port = (uint16_t)tcp_port;
+            p->start_ns = (uint64_t)round * interval_ns;
+            p->user = &targets.items[h];
         }
+    }
 
-        fossil_net_socket_set_blocking(&sock, true);
-
-        uint64_t start = squid_time_ms();
-
-        int rc = fossil_net_socket_connect(&sock, &addr);
+    bool single = targets.count == 1;
+    squid_ping_ctx_t pc;
+    pc.verbose = single && !stats_only && !json;
 
-        uint64_t end = squid_time_ms();
-        uint64_t elapsed = end - start;
+    if (pc.verbose)
+        printf("PING %s (%s:%d)\n", targets.items[0].name, targets.items[0].ip, tcp_port);
+    else if (!json)
+        printf("PING %zu hosts on port %d, %d probes each\n", targets.count, tcp_port, count);
 
-        sent++;
+    fossil_squid_probe_opts_t opts;
+    opts.concurrency = total < SQUID_PING_MAX_WINDOW ? (int)total : SQUID_PING_MAX_WINDOW;
+    opts.timeout_ms = timeout_ms;
+    opts.banner_ms = 0;
 
-        if (rc == 0)
-        {
-            received++;
-            total_time += elapsed;
-
-            if (!stats_only)
-            {
-                printf("reply from %s: time=%llums\n",
-                       addr.ip,
-                       (unsigned long long)elapsed);
-            }
-        }
-        else
-        {
-            if (!stats_only)
-            {
-                int err = fossil_net_socket_error_last();
-                printf("timeout/error from %s (%s)\n",
-                       addr.ip,
-                       fossil_net_socket_error_string(err));
-            }
-        }
-
-        fossil_net_socket_close(&sock);
-
-        if (!flood)
-            fossil_net_socket_sleep(interval_ms);
+    int rc = fossil_squid_probe_run(probes, total, &opts, squid_ping_on_probe, &pc);
+    fossil_sys_memory_free(probes);
+    if (rc != 0)
+    {
+        fossil_sys_memory_free(targets.items);
+        fprintf(stderr, "ping: probe engine failed to start\n");
+        return -1;
     }
 
     /* summary */
-    int loss = sent > 0 ? ((sent - received) * 100 / sent) : 0;
-    uint64_t avg = received > 0 ? total_time / received : 0;
+    if (!single && !json)
+        printf("\n%-32s %-16s %5s %5s %5s %5s %5s %6s %9s %9s %9s %9s\n",
+               "HOST", "IP", "SENT", "RECV", "TMO", "RST", "ERR", "LOSS", "MEAN(ms)", "P50(ms)", "P99(ms)", "MAX(ms)");
 
-    if (json)
+    /* one document covering every target */
+    fossil_squid_json_t doc;
+    fossil_squid_json_t *out = json ? &doc : NULL;
+    if (out)
     {
-        printf("{\"host\":\"%s\",\"sent\":%d,\"received\":%d,\"loss\":%d,\"avg_ms\":%llu}\n",
-               host,
-               sent,
-               received,
-               loss,
-               (unsigned long long)avg);
+        fossil_squid_json_init(out);
+        fossil_squid_json_object_begin(out);
+        fossil_squid_json_field_int(out, "port", tcp_port);
+        fossil_squid_json_field_int(out, "count", count);
+        fossil_squid_json_key(out, "hosts");
+        fossil_squid_json_array_begin(out);
     }
-    else
+
+    int reachable = 0;
+    for (size_t h = 0; h < targets.count; ++h)
     {
-        printf("\n--- %s ping statistics ---\n", host);
-        printf("%d packets transmitted, %d received, %d%% packet loss\n",
-               sent, received, loss);
-        if (received > 0)
-        {
-            printf("avg time = %llums\n",
-                   (unsigned long long)avg);
-        }
+        squid_ping_summary(&targets.items[h], out, !single);
+        if (targets.items[h].received > 0)
+            reachable++;
+    }
+
+    if (out)
+    {
+        fossil_squid_json_array_end(out);
+        fossil_squid_json_field_int(out, "reachable", reachable);
+        fossil_squid_json_object_end(out);
+        fossil_squid_json_flush(out);
+        fossil_squid_json_dispose(out);
     }
 
-    return (received > 0) ? 0 : -1;
+    fossil_sys_memory_free(targets.items);
+    return (reachable > 0) ? 0 : -1;
 }
@@ -0,0 +1,721 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/probe.h"
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+#endif
+
+/*=============================================================================
+SQUID CONNECT PROBE ENGINE
+=============================================================================*/
+
+#define SQUID_PROBE_DEFAULT_CONCURRENCY 1024
+#define SQUID_PROBE_DEFAULT_TIMEOUT_MS 1000
+#define SQUID_PROBE_FD_RESERVE 64
+#define SQUID_PROBE_EVENT_BATCH 256
+
+uint64_t fossil_squid_probe_now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((now.QuadPart / freq.QuadPart) * 1000000000ULL +
+                      ((now.QuadPart % freq.QuadPart) * 1000000000ULL) / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void squid_probe_defaults(const fossil_squid_probe_opts_t *in, fossil_squid_probe_opts_t *out)
+{
+    out->concurrency = (in && in->concurrency > 0) ? in->concurrency : SQUID_PROBE_DEFAULT_CONCURRENCY;
+    out->timeout_ms = (in && in->timeout_ms > 0) ? in->timeout_ms : SQUID_PROBE_DEFAULT_TIMEOUT_MS;
+    out->banner_ms = (in && in->banner_ms > 0) ? in->banner_ms : 0;
+}
+
+static int squid_probe_sockaddr(const char *ip, uint16_t port, struct sockaddr_storage *ss, socklen_t *len)
+{
+    memset(ss, 0, sizeof(*ss));
+    if (!ip)
+        return -1;
+
+    struct sockaddr_in *v4 = (struct sockaddr_in *)ss;
+    if (inet_pton(AF_INET, ip, &v4->sin_addr) == 1)
+    {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        *len = (socklen_t)sizeof(*v4);
+        return 0;
+    }
+
+    struct sockaddr_in6 *v6 = (struct sockaddr_in6 *)ss;
+    if (inet_pton(AF_INET6, ip, &v6->sin6_addr) == 1)
+    {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        *len = (socklen_t)sizeof(*v6);
+        return 0;
+    }
+    return -1;
+}
+
+/* whether an OPEN probe should linger for the service's first bytes */
+static bool squid_probe_wants_banner(const fossil_squid_probe_opts_t *o, const fossil_squid_probe_t *p)
+{
+    return o->banner_ms > 0 && p->banner && p->banner_cap > 1;
+}
+
+#if defined(_WIN32)
+
+/* Windows: no epoll; one non-blocking connect at a time, each bounded by select(). */
+static bool squid_probe_select(SOCKET s, bool for_read, int timeout_ms)
+{
+    fd_set ready, failed;
+    FD_ZERO(&ready);
+    FD_ZERO(&failed);
+    FD_SET(s, &ready);
+    FD_SET(s, &failed);
+
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    int n = for_read ? select(0, &ready, NULL, &failed, &tv) : select(0, NULL, &ready, &failed, &tv);
+    return n > 0;
+}
+
+static void squid_probe_connect_one(const fossil_squid_probe_opts_t *o, fossil_squid_probe_t *p)
+{
+    struct sockaddr_storage ss;
+    socklen_t len = 0;
+    if (squid_probe_sockaddr(p->ip, p->port, &ss, &len) != 0)
+    {
+        p->error = WSAEINVAL;
+        return;
+    }
+
+    SOCKET s = socket(ss.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET)
+    {
+        p->error = WSAGetLastError();
+        return;
+    }
+    p->fd = (int)s;
+
+    u_long nonblocking = 1;
+    ioctlsocket(s, FIONBIO, &nonblocking);
+
+    uint64_t start = fossil_squid_probe_now_ns();
+    int err = 0;
+    if (connect(s, (struct sockaddr *)&ss, len) != 0)
+    {
+        err = WSAGetLastError();
+        if (err == WSAEWOULDBLOCK)
+        {
+            err = WSAETIMEDOUT;
+            if (squid_probe_select(s, false, o->timeout_ms))
+            {
+                int elen = (int)sizeof(err);
+                if (getsockopt(s, SOL_SOCKET, SO_ERROR, (char *)&err, &elen) != 0)
+                    err = WSAGetLastError();
+            }
+        }
+    }
+    p->rtt_ns = fossil_squid_probe_now_ns() - start;
+    p->error = err;
+
+    switch (err)
+    {
+        case 0: p->status = FOSSIL_SQUID_PROBE_OPEN; break;
+        case WSAECONNREFUSED: p->status = FOSSIL_SQUID_PROBE_REFUSED; break;
+        case WSAETIMEDOUT: p->status = FOSSIL_SQUID_PROBE_TIMEOUT; break;
+        default: p->status = FOSSIL_SQUID_PROBE_ERROR; break;
+    }
+
+    if (p->status == FOSSIL_SQUID_PROBE_OPEN && squid_probe_wants_banner(o, p) &&
+        squid_probe_select(s, true, o->banner_ms))
+    {
+        int n = recv(s, p->banner, (int)(p->banner_cap - 1), 0);
+        if (n > 0)
+        {
+            p->banner_len = (size_t)n;
+            p->banner[n] = '\0';
+        }
+    }
+}
+
+int fossil_squid_probe_run(
+    fossil_squid_probe_t *probes,
+    size_t count,
+    const fossil_squid_probe_opts_t *opts,
+    fossil_squid_probe_cb cb,
+    void *ctx)
+{
+    if (!probes && count > 0)
+        return -1;
+    if (count == 0)
+        return 0;
+
+    fossil_squid_probe_opts_t o;
+    squid_probe_defaults(opts, &o);
+
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return -1;
+
+    uint64_t t0 = fossil_squid_probe_now_ns();
+    for (size_t i = 0; i < count; ++i)
+    {
+        fossil_squid_probe_t *p = &probes[i];
+
+        uint64_t elapsed = fossil_squid_probe_now_ns() - t0;
+        if (p->start_ns > elapsed)
+            fossil_net_socket_sleep((int)((p->start_ns - elapsed) / 1000000ULL));
+
+        p->fd = -1;
+        p->status = FOSSIL_SQUID_PROBE_ERROR;
+        p->error = 0;
+        p->rtt_ns = 0;
+        p->banner_len = 0;
+        if (p->banner && p->banner_cap > 0)
+            p->banner[0] = '\0';
+
+        squid_probe_connect_one(&o, p);
+        if (cb)
+            cb(p, ctx);
+        if (p->fd >= 0)
+            closesocket((SOCKET)p->fd);
+        p->fd = -1;
+    }
+
+    WSACleanup();
+    return 0;
+}
+
+#else
+
+typedef struct {
+    fossil_squid_probe_t *probes;
+    size_t count;
+    fossil_squid_probe_cb cb;
+    void *ctx;
+    fossil_squid_probe_opts_t opts;
+
+    uint64_t timeout_ns;
+    uint64_t banner_ns;
+    size_t concurrency;
+    size_t inflight;
+
+    uint64_t *launched_at;   /* per-probe launch time */
+    uint32_t *order;         /* launch order; deadlines are monotonic in it */
+    size_t order_head;
+    size_t order_tail;
+
+    uint8_t *reading;        /* 1 while an OPEN probe waits for its banner */
+    uint32_t *read_order;    /* banner waits in the order they began; deadlines are monotonic in it too */
+    size_t read_head;
+    size_t read_tail;
+
+    struct rlimit saved_limit;  /* soft fd limit to put back when the run ends */
+    bool limit_raised;
+
+#if defined(__linux__)
+    int epfd;
+#else
+    struct pollfd *pfds;     /* active sockets */
+    uint32_t *owner;         /* probe index per pollfd slot */
+    int32_t *slot;           /* pollfd slot per probe, -1 if none */
+    size_t active;
+#endif
+} squid_probe_engine_t;
+
+/*
+ * Lift the soft fd limit as far as allowed for the length of the run, then
+ * clamp the window to it. The old limit is put back by squid_probe_restore
+ * so the rest of the process keeps the limit it started with.
+ */
+static size_t squid_probe_fd_budget(squid_probe_engine_t *eng, size_t wanted)
+{
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+        return wanted < 256 ? wanted : 256;
+
+    if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < rl.rlim_max)
+    {
+        struct rlimit raised = rl;
+        raised.rlim_cur = rl.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &raised) == 0)
+        {
+            eng->saved_limit = rl;
+            eng->limit_raised = true;
+            rl = raised;
+        }
+    }
+
+    if (rl.rlim_cur == RLIM_INFINITY)
+        return wanted;
+    if (rl.rlim_cur <= SQUID_PROBE_FD_RESERVE)
+        return 1;
+
+    size_t budget = (size_t)(rl.rlim_cur - SQUID_PROBE_FD_RESERVE);
+    return wanted < budget ? wanted : budget;
+}
+
+static void squid_probe_restore(squid_probe_engine_t *eng)
+{
+    if (eng->limit_raised)
+        setrlimit(RLIMIT_NOFILE, &eng->saved_limit);
+    eng->limit_raised = false;
+}
+
+static int squid_probe_watch(squid_probe_engine_t *eng, uint32_t idx, bool for_read)
+{
+    int fd = eng->probes[idx].fd;
+#if defined(__linux__)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = (for_read ? EPOLLIN : EPOLLOUT) | EPOLLERR | EPOLLHUP;
+    ev.data.u32 = idx;
+    return epoll_ctl(eng->epfd, EPOLL_CTL_ADD, fd, &ev);
+#else
+    eng->pfds[eng->active].fd = fd;
+    eng->pfds[eng->active].events = for_read ? POLLIN : POLLOUT;
+    eng->pfds[eng->active].revents = 0;
+    eng->owner[eng->active] = idx;
+    eng->slot[idx] = (int32_t)eng->active;
+    eng->active++;
+    return 0;
+#endif
+}
+
+/* switch a watched socket from waiting for the connect to waiting for data */
+static int squid_probe_rewatch(squid_probe_engine_t *eng, uint32_t idx)
+{
+#if defined(__linux__)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLERR | EPOLLHUP;
+    ev.data.u32 = idx;
+    return epoll_ctl(eng->epfd, EPOLL_CTL_MOD, eng->probes[idx].fd, &ev);
+#else
+    int32_t s = eng->slot[idx];
+    if (s < 0)
+        return -1;
+    eng->pfds[s].events = POLLIN;
+    eng->pfds[s].revents = 0;
+    return 0;
+#endif
+}
+
+static void squid_probe_unwatch(squid_probe_engine_t *eng, uint32_t idx)
+{
+#if defined(__linux__)
+    /* close() drops the registration; nothing to do. */
+    (void)eng;
+    (void)idx;
+#else
+    int32_t s = eng->slot[idx];
+    if (s < 0)
+        return;
+    size_t last = eng->active - 1;
+    if ((size_t)s != last)
+    {
+        eng->pfds[s] = eng->pfds[last];
+        eng->owner[s] = eng->owner[last];
+        eng->slot[eng->owner[s]] = s;
+    }
+    eng->slot[idx] = -1;
+    eng->active--;
+#endif
+}
+
+static void squid_probe_finish(squid_probe_engine_t *eng, uint32_t idx,
+                               fossil_squid_probe_status_t status, int err, bool watched)
+{
+    fossil_squid_probe_t *p = &eng->probes[idx];
+
+    if (watched)
+    {
+        squid_probe_unwatch(eng, idx);
+        eng->inflight--;
+    }
+
+    /* a banner wait already timed the handshake */
+    if (eng->reading[idx])
+        eng->reading[idx] = 0;
+    else
+        p->rtt_ns = fossil_squid_probe_now_ns() - eng->launched_at[idx];
+    p->status = status;
+    p->error = err;
+
+    if (eng->cb)
+        eng->cb(p, eng->ctx);
+
+    if (p->fd >= 0)
+        close(p->fd);
+    p->fd = -1;
+}
+
+/*
+ * The handshake is done; keep the socket in the event loop until the
+ * service sends something or banner_ms passes. Nothing blocks here, so other
+ * connects keep completing while a slow service makes up its mind.
+ */
+static void squid_probe_begin_read(squid_probe_engine_t *eng, uint32_t idx, bool watched)
+{
+    fossil_squid_probe_t *p = &eng->probes[idx];
+    int rc = watched ? squid_probe_rewatch(eng, idx) : squid_probe_watch(eng, idx, true);
+    if (rc != 0)
+    {
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_OPEN, 0, watched);
+        return;
+    }
+    if (!watched)
+        eng->inflight++;
+
+    p->status = FOSSIL_SQUID_PROBE_OPEN;
+    p->rtt_ns = fossil_squid_probe_now_ns() - eng->launched_at[idx];
+    eng->reading[idx] = 1;
+    eng->read_order[eng->read_tail++] = idx;
+}
+
+static fossil_squid_probe_status_t squid_probe_classify(int err)
+{
+    switch (err)
+    {
+        case 0: return FOSSIL_SQUID_PROBE_OPEN;
+        case ECONNREFUSED: return FOSSIL_SQUID_PROBE_REFUSED;
+        case ETIMEDOUT: return FOSSIL_SQUID_PROBE_TIMEOUT;
+        default: return FOSSIL_SQUID_PROBE_ERROR;
+    }
+}
+
+static void squid_probe_launch(squid_probe_engine_t *eng, uint32_t idx)
+{
+    fossil_squid_probe_t *p = &eng->probes[idx];
+    struct sockaddr_storage ss;
+    socklen_t len = 0;
+
+    p->fd = -1;
+    p->status = FOSSIL_SQUID_PROBE_PENDING;
+    p->error = 0;
+    p->rtt_ns = 0;
+    p->banner_len = 0;
+    if (p->banner && p->banner_cap > 0)
+        p->banner[0] = '\0';
+    eng->launched_at[idx] = fossil_squid_probe_now_ns();
+
+    if (squid_probe_sockaddr(p->ip, p->port, &ss, &len) != 0)
+    {
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_ERROR, EINVAL, false);
+        return;
+    }
+
+    int fd = socket(ss.ss_family, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_ERROR, errno, false);
+        return;
+    }
+    p->fd = fd;
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+    {
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_ERROR, errno, false);
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    if (connect(fd, (struct sockaddr *)&ss, len) == 0)
+    {
+        /* Loopback can complete synchronously. */
+        if (squid_probe_wants_banner(&eng->opts, p))
+            squid_probe_begin_read(eng, idx, false);
+        else
+            squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_OPEN, 0, false);
+        return;
+    }
+
+    if (errno != EINPROGRESS)
+    {
+        int err = errno;
+        squid_probe_finish(eng, idx, squid_probe_classify(err), err, false);
+        return;
+    }
+
+    if (squid_probe_watch(eng, idx, false) != 0)
+    {
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_ERROR, errno, false);
+        return;
+    }
+
+    eng->inflight++;
+    eng->order[eng->order_tail++] = idx;
+}
+
+/* first bytes of an open socket; a spurious wakeup keeps waiting */
+static void squid_probe_read_banner(squid_probe_engine_t *eng, uint32_t idx)
+{
+    fossil_squid_probe_t *p = &eng->probes[idx];
+    ssize_t n = recv(p->fd, p->banner, p->banner_cap - 1, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+    if (n > 0)
+    {
+        p->banner_len = (size_t)n;
+        p->banner[n] = '\0';
+    }
+    squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_OPEN, 0, true);
+}
+
+static void squid_probe_ready(squid_probe_engine_t *eng, uint32_t idx)
+{
+    fossil_squid_probe_t *p = &eng->probes[idx];
+    if (p->fd < 0)
+        return;
+    if (eng->reading[idx])
+    {
+        squid_probe_read_banner(eng, idx);
+        return;
+    }
+    if (p->status != FOSSIL_SQUID_PROBE_PENDING)
+        return;
+
+    int err = 0;
+    socklen_t elen = (socklen_t)sizeof(err);
+    if (getsockopt(p->fd, SOL_SOCKET, SO_ERROR, &err, &elen) != 0)
+        err = errno;
+
+    if (err == 0 && squid_probe_wants_banner(&eng->opts, p))
+        squid_probe_begin_read(eng, idx, true);
+    else
+        squid_probe_finish(eng, idx, squid_probe_classify(err), err, true);
+}
+
+/* ms until the deadline, rounded up, or 0 once it has passed */
+static int squid_probe_until(uint64_t deadline, uint64_t now)
+{
+    return deadline > now ? (int)((deadline - now + 999999ULL) / 1000000ULL) : 0;
+}
+
+/*
+ * Time out everything whose deadline had passed at now; returns ms until
+ * the next deadline, or -1 if nothing is waiting. now is taken before the
+ * zero-timeout drain, so a socket that connected while a callback held the
+ * engine thread is reported from its event, not as a timeout.
+ */
+static int squid_probe_expire(squid_probe_engine_t *eng, uint64_t now)
+{
+    int next = -1;
+
+    while (eng->order_head < eng->order_tail)
+    {
+        uint32_t idx = eng->order[eng->order_head];
+        fossil_squid_probe_t *p = &eng->probes[idx];
+
+        if (p->status != FOSSIL_SQUID_PROBE_PENDING)
+        {
+            eng->order_head++;
+            continue;
+        }
+
+        uint64_t deadline = eng->launched_at[idx] + eng->timeout_ns;
+        if (deadline > now)
+        {
+            next = squid_probe_until(deadline, now);
+            break;
+        }
+
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_TIMEOUT, ETIMEDOUT, true);
+        eng->order_head++;
+    }
+
+    /* a silent service is still open, it just has no banner */
+    while (eng->read_head < eng->read_tail)
+    {
+        uint32_t idx = eng->read_order[eng->read_head];
+        if (!eng->reading[idx])
+        {
+            eng->read_head++;
+            continue;
+        }
+
+        uint64_t deadline = eng->launched_at[idx] + eng->probes[idx].rtt_ns + eng->banner_ns;
+        if (deadline > now)
+        {
+            int ms = squid_probe_until(deadline, now);
+            if (next < 0 || ms < next)
+                next = ms;
+            break;
+        }
+
+        squid_probe_finish(eng, idx, FOSSIL_SQUID_PROBE_OPEN, 0, true);
+        eng->read_head++;
+    }
+    return next;
+}
+
+static void squid_probe_wait(squid_probe_engine_t *eng, int wait_ms)
+{
+#if defined(__linux__)
+    struct epoll_event events[SQUID_PROBE_EVENT_BATCH];
+    int n = epoll_wait(eng->epfd, events, SQUID_PROBE_EVENT_BATCH, wait_ms);
+    for (int i = 0; i < n; ++i)
+        squid_probe_ready(eng, events[i].data.u32);
+#else
+    int n = poll(eng->pfds, (nfds_t)eng->active, wait_ms);
+    if (n <= 0)
+        return;
+
+    /* Walk backwards so swap-removal never skips an unvisited slot. */
+    for (size_t s = eng->active; s-- > 0;)
+    {
+        if (s >= eng->active || eng->pfds[s].revents == 0)
+            continue;
+        squid_probe_ready(eng, eng->owner[s]);
+    }
+#endif
+}
+
+static void squid_probe_release(squid_probe_engine_t *eng)
+{
+#if defined(__linux__)
+    if (eng->epfd >= 0)
+        close(eng->epfd);
+#else
+    fossil_sys_memory_free(eng->pfds);
+    fossil_sys_memory_free(eng->owner);
+    fossil_sys_memory_free(eng->slot);
+#endif
+    fossil_sys_memory_free(eng->launched_at);
+    fossil_sys_memory_free(eng->order);
+    fossil_sys_memory_free(eng->reading);
+    fossil_sys_memory_free(eng->read_order);
+    squid_probe_restore(eng);
+}
+
+int fossil_squid_probe_run(
+    fossil_squid_probe_t *probes,
+    size_t count,
+    const fossil_squid_probe_opts_t *opts,
+    fossil_squid_probe_cb cb,
+    void *ctx)
+{
+    if (!probes && count > 0)
+        return -1;
+    if (count == 0)
+        return 0;
+    if (count > UINT32_MAX)
+        return -1;
+
+    squid_probe_engine_t eng;
+    memset(&eng, 0, sizeof(eng));
+    squid_probe_defaults(opts, &eng.opts);
+    eng.probes = probes;
+    eng.count = count;
+    eng.cb = cb;
+    eng.ctx = ctx;
+    eng.timeout_ns = (uint64_t)eng.opts.timeout_ms * 1000000ULL;
+    eng.banner_ns = (uint64_t)eng.opts.banner_ms * 1000000ULL;
+    eng.concurrency = squid_probe_fd_budget(&eng, (size_t)eng.opts.concurrency);
+    if (eng.concurrency > count)
+        eng.concurrency = count;
+
+    eng.launched_at = (uint64_t *)fossil_sys_memory_calloc(count, sizeof(uint64_t));
+    eng.order = (uint32_t *)fossil_sys_memory_calloc(count, sizeof(uint32_t));
+    eng.reading = (uint8_t *)fossil_sys_memory_calloc(count, sizeof(uint8_t));
+    eng.read_order = (uint32_t *)fossil_sys_memory_calloc(count, sizeof(uint32_t));
+#if defined(__linux__)
+    eng.epfd = epoll_create1(EPOLL_CLOEXEC);
+    bool ready = eng.epfd >= 0;
+#else
+    eng.pfds = (struct pollfd *)fossil_sys_memory_calloc(eng.concurrency, sizeof(struct pollfd));
+    eng.owner = (uint32_t *)fossil_sys_memory_calloc(eng.concurrency, sizeof(uint32_t));
+    eng.slot = (int32_t *)fossil_sys_memory_calloc(count, sizeof(int32_t));
+    bool ready = eng.pfds && eng.owner && eng.slot;
+    if (ready)
+    {
+        for (size_t i = 0; i < count; ++i)
+            eng.slot[i] = -1;
+    }
+#endif
+    if (!ready || !eng.launched_at || !eng.order || !eng.reading || !eng.read_order)
+    {
+        squid_probe_release(&eng);
+        return -1;
+    }
+
+    size_t next = 0;
+    uint64_t t0 = fossil_squid_probe_now_ns();
+    while (next < count || eng.inflight > 0)
+    {
+        uint64_t elapsed = fossil_squid_probe_now_ns() - t0;
+        while (eng.inflight < eng.concurrency && next < count && probes[next].start_ns <= elapsed)
+            squid_probe_launch(&eng, (uint32_t)next++);
+
+        /* collect whatever completed while callbacks held the thread before judging deadlines */
+        int wait_ms = -1;
+        if (eng.inflight > 0)
+        {
+            uint64_t now = fossil_squid_probe_now_ns();
+            squid_probe_wait(&eng, 0);
+            wait_ms = squid_probe_expire(&eng, now);
+        }
+
+        /* Wake up for the next scheduled launch if the window has room. */
+        if (next < count && eng.inflight < eng.concurrency)
+        {
+            elapsed = fossil_squid_probe_now_ns() - t0;
+            int due_ms = 0;
+            if (probes[next].start_ns > elapsed)
+                due_ms = (int)((probes[next].start_ns - elapsed + 999999ULL) / 1000000ULL);
+            if (wait_ms < 0 || due_ms < wait_ms)
+                wait_ms = due_ms;
+        }
+
+        /* expiry may have drained the last socket; never block with nothing to wake us */
+        if (eng.inflight > 0 || wait_ms > 0)
+            squid_probe_wait(&eng, wait_ms);
+    }
+
+    squid_probe_release(&eng);
+    return 0;
+}
+
+#endif
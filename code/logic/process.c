@@ -23,10 +23,764 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/code/commands.h"
+#include "fossil/code/json.h"
+#include "fossil/code/proctab.h"
+#include "fossil/code/procmatch.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <signal.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#ifndef STDOUT_FILENO
+#define STDOUT_FILENO _fileno(stdout)
+#endif
+#else
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#endif
+
+static void squid_process_json_info(fossil_squid_json_t *json, const fossil_sys_process_info_t *p)
+{
+    fossil_squid_json_object_begin(json);
+    fossil_squid_json_field_uint(json, "pid", p->pid);
+    fossil_squid_json_field_uint(json, "ppid", p->ppid);
+    fossil_squid_json_field_string(json, "name", p->name);
+    fossil_squid_json_field_uint(json, "memory_kb", (unsigned long long)(p->memory_bytes / 1024));
+    fossil_squid_json_field_uint(json, "virtual_memory_kb", (unsigned long long)(p->virtual_memory_bytes / 1024));
+    fossil_squid_json_field_double(json, "cpu_percent", p->cpu_percent, 2);
+    fossil_squid_json_field_uint(json, "threads", p->thread_count);
+    fossil_squid_json_object_end(json);
+}
+
+/* CPU% of a one-pass listing was never measured, so it is null rather than a made-up 0 */
+static void squid_process_json_cpu(fossil_squid_json_t *json, double percent, bool measured)
+{
+    fossil_squid_json_key(json, "cpu_percent");
+    if (measured)
+        fossil_squid_json_double(json, percent, 2);
+    else
+        fossil_squid_json_null(json);
+}
+
+static const char *squid_process_cpu_text(double percent, bool measured, char *buf, size_t size)
+{
+    if (!measured)
+        return "n/a";
+    snprintf(buf, size, "%.2f%%", percent);
+    return buf;
+}
+
+static void squid_process_json_proc(fossil_squid_json_t *json, const fossil_squid_proc_t *p, bool measured)
+{
+    fossil_squid_json_object_begin(json);
+    fossil_squid_json_field_uint(json, "pid", p->pid);
+    fossil_squid_json_field_uint(json, "ppid", p->ppid);
+    fossil_squid_json_field_string(json, "name", p->name);
+    fossil_squid_json_field_uint(json, "memory_kb", (unsigned long long)(p->rss_bytes / 1024));
+    fossil_squid_json_field_uint(json, "virtual_memory_kb", (unsigned long long)(p->vsize_bytes / 1024));
+    squid_process_json_cpu(json, p->cpu_percent, measured);
+    fossil_squid_json_field_uint(json, "threads", p->threads);
+    fossil_squid_json_object_end(json);
+}
+
+/* print a finished {"key": value} style document and release it */
+static int squid_process_json_done(fossil_squid_json_t *json)
+{
+    fossil_squid_json_object_end(json);
+    int rc = fossil_squid_json_flush(json);
+    fossil_squid_json_dispose(json);
+    return rc;
+}
+
+/*=============================================================================
+TOP MODE
+=============================================================================*/
+
+#define SQUID_PROCESS_TOP_DEFAULT_MS 2000
+#define SQUID_PROCESS_CPU_WINDOW_MS 250     /* a listing sorted by CPU% measures it over this long, like one top frame */
+#define SQUID_PROCESS_TOP_HEADER_ROWS 2
+
+static volatile sig_atomic_t squid_process_top_stop = 0;
+
+static void squid_process_top_signal(int sig)
+{
+    (void)sig;
+    squid_process_top_stop = 1;
+}
+
+/* growable output buffer, written to the terminal in one call per frame */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} squid_process_out_t;
+
+static void squid_process_out_append(squid_process_out_t *out, const char *text, size_t n)
+{
+    if (out->failed)
+        return;
+    if (out->len + n > out->cap)
+    {
+        size_t cap = out->cap ? out->cap : 4096;
+        while (cap < out->len + n)
+            cap *= 2;
+        char *data = (char *)fossil_sys_memory_realloc(out->data, cap);
+        if (!data)
+        {
+            out->failed = true;
+            return;
+        }
+        out->data = data;
+        out->cap = cap;
+    }
+    memcpy(out->data + out->len, text, n);
+    out->len += n;
+}
+
+static void squid_process_out_text(squid_process_out_t *out, const char *text)
+{
+    squid_process_out_append(out, text, strlen(text));
+}
+
+static void squid_process_out_flush(squid_process_out_t *out)
+{
+    if (!out->failed && out->len > 0)
+        fwrite(out->data, 1, out->len, stdout);
+    fflush(stdout);
+    out->len = 0;
+}
+
+/* terminal rows and columns; false when stdout is not a terminal we can redraw */
+static bool squid_process_term_size(int *rows, int *cols)
+{
+    *rows = 24;
+    *cols = 80;
+    if (!isatty(STDOUT_FILENO))
+        return false;
+#if defined(_WIN32)
+    HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleMode(h, &mode) ||
+        !SetConsoleMode(h, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) ||
+        !GetConsoleScreenBufferInfo(h, &info))
+        return false;
+    *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    *cols = info.srWindow.Right - info.srWindow.Left + 1;
+#else
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0)
+    {
+        *rows = ws.ws_row;
+        *cols = ws.ws_col;
+    }
+#endif
+    if (*rows < SQUID_PROCESS_TOP_HEADER_ROWS + 1)
+        *rows = SQUID_PROCESS_TOP_HEADER_ROWS + 1;
+    if (*cols < 20)
+        *cols = 20;
+    return true;
+}
+
+static void squid_process_top_sleep(int ms)
+{
+    /* short naps so an interrupt is noticed promptly on every platform */
+    while (ms > 0 && !squid_process_top_stop)
+    {
+        int step = ms < 100 ? ms : 100;
+        fossil_net_socket_sleep(step);
+        ms -= step;
+    }
+}
+
+static void squid_process_top_summary(const fossil_squid_proc_sampler_t *s, int interval_ms, char *line, size_t size)
+{
+    snprintf(line, size, "squid top - %zu processes, cpu %.1f%% of %u, self %.2f%%, every %d ms",
+             s->count, s->cpu_total_percent, s->cpu_count, s->self_cpu_percent, interval_ms);
+}
+
+static const char *squid_process_top_columns =
+    "    PID    PPID S   CPU%     RSS KB   DELTA KB    VMEM KB  THR NAME";
+
+static void squid_process_top_row(const fossil_squid_proc_t *p, char *line, size_t size)
+{
+    snprintf(line, size, "%7u %7u %c %6.1f %10llu %+10lld %10llu %4u %s",
+             p->pid, p->ppid, p->state, p->cpu_percent,
+             (unsigned long long)(p->rss_bytes / 1024),
+             (long long)(p->rss_delta_bytes / 1024),
+             (unsigned long long)(p->vsize_bytes / 1024),
+             p->threads, p->name);
+}
+
+static int squid_process_top_json(const fossil_squid_proc_sampler_t *s, const uint32_t *order, size_t shown, int interval_ms)
+{
+    fossil_squid_json_t doc;
+    fossil_squid_json_init(&doc);
+    fossil_squid_json_object_begin(&doc);
+    fossil_squid_json_field_uint(&doc, "sample", s->samples - 1);
+    fossil_squid_json_field_int(&doc, "interval_ms", interval_ms);
+    fossil_squid_json_field_double(&doc, "cpu_percent", s->cpu_total_percent, 2);
+    fossil_squid_json_field_double(&doc, "self_cpu_percent", s->self_cpu_percent, 2);
+    fossil_squid_json_key(&doc, "processes");
+    fossil_squid_json_array_begin(&doc);
+    for (size_t i = 0; i < shown; ++i)
+    {
+        const fossil_squid_proc_t *p = &s->procs[order[i]];
+        fossil_squid_json_object_begin(&doc);
+        fossil_squid_json_field_uint(&doc, "pid", p->pid);
+        fossil_squid_json_field_uint(&doc, "ppid", p->ppid);
+        fossil_squid_json_field_string(&doc, "name", p->name);
+        fossil_squid_json_key(&doc, "state");
+        fossil_squid_json_string_n(&doc, &p->state, 1);
+        fossil_squid_json_field_double(&doc, "cpu_percent", p->cpu_percent, 2);
+        fossil_squid_json_field_uint(&doc, "memory_kb", (unsigned long long)(p->rss_bytes / 1024));
+        fossil_squid_json_field_int(&doc, "memory_delta_kb", (long long)(p->rss_delta_bytes / 1024));
+        fossil_squid_json_field_uint(&doc, "virtual_memory_kb", (unsigned long long)(p->vsize_bytes / 1024));
+        fossil_squid_json_field_uint(&doc, "threads", p->threads);
+        fossil_squid_json_object_end(&doc);
+    }
+    fossil_squid_json_array_end(&doc);
+    return squid_process_json_done(&doc);
+}
+
+/*
+ * Refreshing view. The table is sampled once before the first frame so CPU
+ * can be shown as a delta. On a terminal each frame is laid out as fixed
+ * rows and compared with the one on screen; only rows that changed are
+ * rewritten, in a single write. Otherwise every frame is printed in full.
+ * Only the rows that fit (or the --limit best) are ranked and formatted.
+ */
+static int squid_process_top(int interval_ms, int count, fossil_squid_proc_sort_t key, int limit, bool json)
+{
+    if (interval_ms <= 0)
+        interval_ms = SQUID_PROCESS_TOP_DEFAULT_MS;
+
+#ifndef _WIN32
+    /* Let the sampler keep a descriptor per process while top runs; put the limit back after. */
+    struct rlimit saved_nofile;
+    bool raised_nofile = false;
+    if (getrlimit(RLIMIT_NOFILE, &saved_nofile) == 0 && saved_nofile.rlim_cur < saved_nofile.rlim_max)
+    {
+        struct rlimit raised = saved_nofile;
+        raised.rlim_cur = raised.rlim_max;
+        raised_nofile = setrlimit(RLIMIT_NOFILE, &raised) == 0;
+    }
+#endif
+
+    fossil_squid_proc_sampler_t sampler;
+    fossil_squid_proc_sampler_init(&sampler);
+    if (fossil_squid_proc_sample(&sampler) != 0)
+    {
+        fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
+        fossil_squid_proc_sampler_dispose(&sampler);
+#ifndef _WIN32
+        if (raised_nofile)
+            setrlimit(RLIMIT_NOFILE, &saved_nofile);
+#endif
+        return -1;
+    }
+
+    squid_process_top_stop = 0;
+    void (*old_int)(int) = signal(SIGINT, squid_process_top_signal);
+    void (*old_term)(int) = signal(SIGTERM, squid_process_top_signal);
+
+    int rows = 0, cols = 0;
+    bool redraw = !json && squid_process_term_size(&rows, &cols);
+    int shown_rows = 0, shown_cols = 0;
+    char *frame = NULL, *shown = NULL;
+    uint32_t *order = NULL;
+    size_t order_cap = 0;
+    squid_process_out_t out = {0};
+    int rc = 0;
+
+    if (redraw)
+        squid_process_out_text(&out, "\033[?1049h\033[?25l");
+
+    for (int frames = 0; !squid_process_top_stop && (count <= 0 || frames < count); ++frames)
+    {
+        squid_process_top_sleep(interval_ms);
+        if (squid_process_top_stop)
+            break;
+        if (fossil_squid_proc_sample(&sampler) != 0)
+        {
+            rc = -1;
+            break;
+        }
+
+        if (sampler.count > order_cap)
+        {
+            size_t cap = sampler.count * 2;
+            uint32_t *grown = (uint32_t *)fossil_sys_memory_realloc(order, cap * sizeof(*order));
+            if (!grown)
+            {
+                rc = -1;
+                break;
+            }
+            order = grown;
+            order_cap = cap;
+        }
+
+        // a terminal only has room for so many rows
+        size_t want = limit > 0 ? (size_t)limit : 0;
+        if (redraw)
+        {
+            squid_process_term_size(&rows, &cols);
+            size_t room = rows > SQUID_PROCESS_TOP_HEADER_ROWS ? (size_t)rows - SQUID_PROCESS_TOP_HEADER_ROWS : 1;
+            if (want == 0 || want > room)
+                want = room;
+        }
+        size_t shown_count = fossil_squid_proc_select(sampler.procs, sampler.count, key, want, NULL, NULL, order);
+
+        if (json)
+        {
+            if (squid_process_top_json(&sampler, order, shown_count, interval_ms) != 0)
+                rc = -1;
+            continue;
+        }
+
+        char line[512];
+        if (!redraw)
+        {
+            squid_process_top_summary(&sampler, interval_ms, line, sizeof(line));
+            squid_process_out_text(&out, line);
+            squid_process_out_text(&out, "\n");
+            squid_process_out_text(&out, squid_process_top_columns);
+            squid_process_out_text(&out, "\n");
+            for (size_t i = 0; i < shown_count; ++i)
+            {
+                squid_process_top_row(&sampler.procs[order[i]], line, sizeof(line));
+                squid_process_out_text(&out, line);
+                squid_process_out_text(&out, "\n");
+            }
+            squid_process_out_text(&out, "\n");
+            squid_process_out_flush(&out);
+            continue;
+        }
+
+        /* a resize invalidates what is on screen */
+        size_t stride = (size_t)cols + 1;
+        if (rows != shown_rows || cols != shown_cols)
+        {
+            if (frame)
+                fossil_sys_memory_free(frame);
+            if (shown)
+                fossil_sys_memory_free(shown);
+            frame = (char *)fossil_sys_memory_calloc((size_t)rows, stride);
+            shown = (char *)fossil_sys_memory_calloc((size_t)rows, stride);
+            if (!frame || !shown)
+            {
+                rc = -1;
+                break;
+            }
+            shown_rows = rows;
+            shown_cols = cols;
+            squid_process_out_text(&out, "\033[H\033[2J");
+        }
+
+        for (int r = 0; r < rows; ++r)
+        {
+            char *dst = frame + (size_t)r * stride;
+            size_t slot = (size_t)r;
+            if (r == 0)
+                squid_process_top_summary(&sampler, interval_ms, line, sizeof(line));
+            else if (r == 1)
+                snprintf(line, sizeof(line), "%s", squid_process_top_columns);
+            else if (slot - SQUID_PROCESS_TOP_HEADER_ROWS < shown_count)
+                squid_process_top_row(&sampler.procs[order[slot - SQUID_PROCESS_TOP_HEADER_ROWS]], line, sizeof(line));
+            else
+                line[0] = '\0';
+            snprintf(dst, stride, "%s", line);
+        }
+
+        for (int r = 0; r < rows; ++r)
+        {
+            char *now = frame + (size_t)r * stride;
+            char *was = shown + (size_t)r * stride;
+            if (strcmp(now, was) == 0)
+                continue;
+
+            char move[32];
+            snprintf(move, sizeof(move), "\033[%d;1H", r + 1);
+            squid_process_out_text(&out, move);
+            if (r == 1)
+                squid_process_out_text(&out, "\033[7m");
+            squid_process_out_text(&out, now);
+            squid_process_out_text(&out, r == 1 ? "\033[0m\033[K" : "\033[K");
+            memcpy(was, now, stride);
+        }
+        squid_process_out_flush(&out);
+        if (out.failed)
+        {
+            rc = -1;
+            break;
+        }
+    }
+
+    if (redraw)
+    {
+        squid_process_out_text(&out, "\033[?25h\033[?1049l");
+        squid_process_out_flush(&out);
+    }
+    signal(SIGINT, old_int == SIG_ERR ? SIG_DFL : old_int);
+    signal(SIGTERM, old_term == SIG_ERR ? SIG_DFL : old_term);
+
+    if (out.data)
+        fossil_sys_memory_free(out.data);
+    if (frame)
+        fossil_sys_memory_free(frame);
+    if (shown)
+        fossil_sys_memory_free(shown);
+    if (order)
+        fossil_sys_memory_free(order);
+    fossil_squid_proc_sampler_dispose(&sampler);
+#ifndef _WIN32
+    if (raised_nofile)
+        setrlimit(RLIMIT_NOFILE, &saved_nofile);
+#endif
+
+    if (rc != 0)
+        fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
+    return rc;
+}
+
+/*=============================================================================
+TREE VIEW
+=============================================================================*/
+
+/* last sibling at its depth: the run after its subtree starts shallower or ends the listing */
+static bool squid_process_tree_last(const fossil_squid_proc_tree_t *tree, uint32_t e, size_t end)
+{
+    size_t next = (size_t)tree->pos[e] + tree->totals[e].processes;
+    return next >= end || tree->depth[tree->order[next]] < tree->depth[e];
+}
+
+static void squid_process_tree_json(const fossil_squid_proc_table_t *table, const fossil_squid_proc_tree_t *tree,
+                                    size_t begin, size_t end, uint32_t base)
+{
+    fossil_squid_json_t doc;
+    fossil_squid_json_init(&doc);
+    fossil_squid_json_object_begin(&doc);
+    fossil_squid_json_key(&doc, "processes");
+    fossil_squid_json_array_begin(&doc);
+    for (size_t k = begin; k < end; ++k)
+    {
+        uint32_t e = tree->order[k];
+        const fossil_squid_proc_t *p = &table->procs[e];
+        const fossil_squid_proc_totals_t *sum = &tree->totals[e];
+        fossil_squid_json_object_begin(&doc);
+        fossil_squid_json_field_uint(&doc, "pid", p->pid);
+        fossil_squid_json_field_uint(&doc, "ppid", p->ppid);
+        fossil_squid_json_field_string(&doc, "name", p->name);
+        fossil_squid_json_field_uint(&doc, "depth", tree->depth[e] - base);
+        fossil_squid_json_field_uint(&doc, "memory_kb", (unsigned long long)(p->rss_bytes / 1024));
+        squid_process_json_cpu(&doc, p->cpu_percent, false);
+        fossil_squid_json_field_uint(&doc, "threads", p->threads);
+        fossil_squid_json_key(&doc, "subtree");
+        fossil_squid_json_object_begin(&doc);
+        fossil_squid_json_field_uint(&doc, "processes", sum->processes);
+        fossil_squid_json_field_uint(&doc, "memory_kb", (unsigned long long)(sum->rss_bytes / 1024));
+        squid_process_json_cpu(&doc, sum->cpu_percent, false);
+        fossil_squid_json_field_uint(&doc, "threads", sum->threads);
+        fossil_squid_json_object_end(&doc);
+        fossil_squid_json_object_end(&doc);
+    }
+    fossil_squid_json_array_end(&doc);
+    squid_process_json_done(&doc);
+}
+
+/*
+ * One collection, or with measure_cpu two a short window apart, so CPU% is
+ * current use rather than an average over each process's lifetime. Only a
+ * listing ranked by CPU% pays for the window; the others show it as n/a.
+ */
+static int squid_process_collect(fossil_squid_proc_table_t *table, bool measure_cpu)
+{
+    if (!measure_cpu)
+        return fossil_squid_proc_collect(table, 0);
+
+    fossil_squid_proc_table_t first;
+    fossil_squid_proc_table_init(&first);
+    int rc = fossil_squid_proc_collect(&first, 0);
+    if (rc == 0)
+    {
+        fossil_net_socket_sleep(SQUID_PROCESS_CPU_WINDOW_MS);
+        rc = fossil_squid_proc_collect(table, 0);
+    }
+    if (rc == 0)
+        rc = fossil_squid_proc_table_rate(table, &first);
+    fossil_squid_proc_table_dispose(&first);
+    return rc;
+}
+
+/*
+ * Hierarchy from one snapshot. The index keeps each subtree as a contiguous
+ * run of its preorder, so a subtree view is a slice of the full one and each
+ * row's connector is decided by looking just past its own subtree.
+ */
+static int squid_process_tree(int subtree_pid, bool json)
+{
+    fossil_squid_proc_table_t table;
+    fossil_squid_proc_tree_t tree;
+    fossil_squid_proc_table_init(&table);
+    memset(&tree, 0, sizeof(tree));
+
+    if (squid_process_collect(&table, false) != 0 || fossil_squid_proc_tree_build(&tree, &table) != 0)
+    {
+        fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
+        fossil_squid_proc_tree_dispose(&tree);
+        fossil_squid_proc_table_dispose(&table);
+        return -1;
+    }
+
+    size_t begin = 0, end = table.count;
+    uint32_t base = 0;
+    if (subtree_pid > 0)
+    {
+        int32_t e = fossil_squid_proc_tree_find(&tree, &table, (uint32_t)subtree_pid);
+        if (e < 0)
+        {
+            fossil_io_error("[process.exit] %s", fossil_io_what("process.exit"));
+            fossil_squid_proc_tree_dispose(&tree);
+            fossil_squid_proc_table_dispose(&table);
+            return -1;
+        }
+        begin = tree.pos[e];
+        end = begin + tree.totals[e].processes;
+        base = tree.depth[e];
+    }
+
+    if (json)
+    {
+        squid_process_tree_json(&table, &tree, begin, end, base);
+    }
+    else
+    {
+        /* last[d]: whether the open ancestor at relative depth d was the last of its siblings */
+        bool last[256] = {0};
+        char prefix[3 * 256 + 1];
+        for (size_t k = begin; k < end; ++k)
+        {
+            uint32_t e = tree.order[k];
+            const fossil_squid_proc_t *p = &table.procs[e];
+            const fossil_squid_proc_totals_t *sum = &tree.totals[e];
+            uint32_t d = tree.depth[e] - base;
+            bool is_last = squid_process_tree_last(&tree, e, end);
+            if (d < 256)
+                last[d] = is_last;
+
+            size_t len = 0;
+            for (uint32_t j = 1; j < d && j < 255; ++j)
+            {
+                memcpy(prefix + len, last[j] ? "   " : "|  ", 3);
+                len += 3;
+            }
+            if (d > 0)
+            {
+                memcpy(prefix + len, is_last ? "`- " : "|- ", 3);
+                len += 3;
+            }
+            prefix[len] = '\0';
+
+            if (sum->processes > 1)
+            {
+                fossil_io_printf(
+                    "{bright_black}%s{reset}{green}%s{reset} {cyan}%u{reset} "
+                    "{magenta}Mem: {yellow}%llu KB {reset}{blue}CPU: {yellow}n/a {reset}{red}Threads: {yellow}%u{reset} "
+                    "{bright_black}[tree: %u procs, %llu KB, %llu threads]{reset}\n",
+                    prefix, p->name, p->pid,
+                    (unsigned long long)(p->rss_bytes / 1024), p->threads,
+                    sum->processes, (unsigned long long)(sum->rss_bytes / 1024),
+                    (unsigned long long)sum->threads);
+            }
+            else
+            {
+                fossil_io_printf(
+                    "{bright_black}%s{reset}{green}%s{reset} {cyan}%u{reset} "
+                    "{magenta}Mem: {yellow}%llu KB {reset}{blue}CPU: {yellow}n/a {reset}{red}Threads: {yellow}%u{reset}\n",
+                    prefix, p->name, p->pid,
+                    (unsigned long long)(p->rss_bytes / 1024), p->threads);
+            }
+        }
+    }
+
+    fossil_squid_proc_tree_dispose(&tree);
+    fossil_squid_proc_table_dispose(&table);
+    return 0;
+}
+
+/*=============================================================================
+LISTING
+=============================================================================*/
+
+typedef struct {
+    ccstring name_pattern;
+    fossil_squid_proc_matcher_t *matcher;
+} squid_process_filter_t;
+
+/* the name substring is free to test, so it runs first and spares the matcher's reads */
+static bool squid_process_keep(const fossil_squid_proc_t *p, void *ctx)
+{
+    squid_process_filter_t *f = (squid_process_filter_t *)ctx;
+    if (f->name_pattern && strstr(p->name, f->name_pattern) == NULL)
+        return false;
+    return !f->matcher || fossil_squid_proc_matcher_test(f->matcher, p);
+}
+
+/* NULL means the default for the view; anything unrecognised is reported */
+static int squid_process_sort_key(ccstring sort_key, fossil_squid_proc_sort_t fallback, fossil_squid_proc_sort_t *key)
+{
+    *key = fallback;
+    if (sort_key == NULL || sort_key[0] == '\0')
+        return 0;
+    if (fossil_squid_proc_sort_parse(sort_key, key) != 0)
+    {
+        fossil_io_error("[%s] %s: --sort %s (expected cpu, mem, vmem, threads or pid)",
+                        "user.input", fossil_io_what("user.input"), sort_key);
+        return -1;
+    }
+    return 0;
+}
+
+/* --sort and --limit only order listings; anywhere else they would be dropped without a word */
+static int squid_process_unranked(ccstring sort_key, int limit, ccstring view)
+{
+    if ((sort_key == NULL || sort_key[0] == '\0') && limit == 0)
+        return 0;
+    fossil_io_error("[%s] %s: --sort and --limit apply to --all, --name, --match and --top, not %s",
+                    "user.input", fossil_io_what("user.input"), view);
+    return -1;
+}
+
+/* --name and --match filter listings; --top and the hierarchy would otherwise show everything regardless */
+static int squid_process_unfiltered(ccstring name_pattern, ccstring match_pattern, ccstring view)
+{
+    if ((name_pattern == NULL || name_pattern[0] == '\0') && (match_pattern == NULL || match_pattern[0] == '\0'))
+        return 0;
+    fossil_io_error("[%s] %s: --name and --match filter listings, not %s",
+                    "user.input", fossil_io_what("user.input"), view);
+    return -1;
+}
+
+/*
+ * One snapshot, filtered by name and pattern when given. Rows are chosen
+ * and ordered by index before anything is formatted, so --limit pays only
+ * for the rows it prints.
+ */
+static int squid_process_list(ccstring name_pattern, fossil_squid_proc_matcher_t *matcher, ccstring sort_key,
+                              int limit, bool json)
+{
+    fossil_squid_proc_sort_t key;
+    if (squid_process_sort_key(sort_key, FOSSIL_SQUID_PROC_SORT_PID, &key) != 0)
+        return -1;
+
+    bool measured = key == FOSSIL_SQUID_PROC_SORT_CPU;
+    fossil_squid_proc_table_t table;
+    fossil_squid_proc_table_init(&table);
+    if (squid_process_collect(&table, measured) != 0)
+    {
+        fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
+        fossil_squid_proc_table_dispose(&table);
+        return -1;
+    }
+
+    size_t want = limit > 0 && (size_t)limit < table.count ? (size_t)limit : table.count;
+    uint32_t *order = NULL;
+    if (want > 0)
+    {
+        order = (uint32_t *)fossil_sys_memory_calloc(want, sizeof(*order));
+        if (!order)
+        {
+            fossil_io_error("[%s] %s", "memory.alloc", fossil_io_what("memory.alloc"));
+            fossil_squid_proc_table_dispose(&table);
+            return -1;
+        }
+    }
+    squid_process_filter_t filter = {name_pattern, matcher};
+    bool filtered = name_pattern != NULL || matcher != NULL;
+    size_t n = fossil_squid_proc_select(table.procs, table.count, key, want,
+                                        filtered ? squid_process_keep : NULL, &filter, order);
+
+    int rc = 0;
+    if (json)
+    {
+        fossil_squid_json_t doc;
+        fossil_squid_json_init(&doc);
+        fossil_squid_json_object_begin(&doc);
+        fossil_squid_json_key(&doc, "processes");
+        fossil_squid_json_array_begin(&doc);
+        for (size_t i = 0; i < n; ++i)
+            squid_process_json_proc(&doc, &table.procs[order[i]], measured);
+        fossil_squid_json_array_end(&doc);
+        rc = squid_process_json_done(&doc);
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const fossil_squid_proc_t *p = &table.procs[order[i]];
+            char cpu_buf[32];
+            const char *cpu = squid_process_cpu_text(p->cpu_percent, measured, cpu_buf, sizeof(cpu_buf));
+            if (filtered)
+            {
+                fossil_io_printf(
+                    "{blue}PID: {cyan}%u {reset}{blue}PPID: {cyan}%u {reset}{blue}Name: {cyan}%s{reset} "
+                    "{blue}Mem: {cyan}%llu KB {reset}{blue}VMem: {cyan}%llu KB {reset}"
+                    "{blue}CPU: {cyan}%s {reset}{blue}Threads: {cyan}%u{reset}\n",
+                    p->pid, p->ppid, p->name,
+                    (unsigned long long)(p->rss_bytes / 1024),
+                    (unsigned long long)(p->vsize_bytes / 1024),
+                    cpu, p->threads
+                );
+            }
+            else
+            {
+                fossil_io_printf(
+                    "{blue}PID: {cyan}%u {reset}{blue}PPID: {cyan}%u {reset}{green}Name: {bold}%s{reset} "
+                    "{magenta}Mem: {yellow}%llu KB {reset}{magenta}VMem: {yellow}%llu KB {reset}"
+                    "{blue}CPU: {yellow}%s {reset}{red}Threads: {yellow}%u{reset}\n",
+                    p->pid, p->ppid, p->name,
+                    (unsigned long long)(p->rss_bytes / 1024),
+                    (unsigned long long)(p->vsize_bytes / 1024),
+                    cpu, p->threads
+                );
+            }
+        }
+    }
+
+    if (order)
+        fossil_sys_memory_free(order);
+    fossil_squid_proc_table_dispose(&table);
+    return rc;
+}
+
+/* compile --match once, then list what it accepts */
+static int squid_process_match(ccstring name_pattern, ccstring match_pattern, ccstring match_field, bool match_regex,
+                               bool match_icase, ccstring sort_key, int limit, bool json)
+{
+    fossil_squid_proc_field_t field = FOSSIL_SQUID_PROC_FIELD_ANY;
+    if (match_field != NULL && match_field[0] != '\0' && fossil_squid_proc_field_parse(match_field, &field) != 0)
+    {
+        fossil_io_error("[%s] %s: --match-on %s (expected any, name, exe or cmdline)",
+                        "user.input", fossil_io_what("user.input"), match_field);
+        return -1;
+    }
+
+    unsigned flags = (match_regex ? FOSSIL_SQUID_PROC_MATCH_REGEX : 0u) | (match_icase ? FOSSIL_SQUID_PROC_MATCH_ICASE : 0u);
+    fossil_squid_proc_matcher_t matcher;
+    if (fossil_squid_proc_matcher_compile(&matcher, match_pattern, field, flags) != 0)
+    {
+        fossil_io_error("[%s] %s: %s", "parse.syntax", fossil_io_what("parse.syntax"), match_pattern);
+        return -1;
+    }
+    int rc = squid_process_list(name_pattern, &matcher, sort_key, limit, json);
+    fossil_squid_proc_matcher_dispose(&matcher);
+    return rc;
+}
 
 int fossil_squid_process(
     bool show_all,
@@ -49,36 +803,66 @@ int fossil_squid_process(
     int wait_pid,
     int wait_timeout_ms,
     ccstring spawn_exe,
-    ccstring const *spawn_args)
+    ccstring const *spawn_args,
+    bool top,
+    int top_interval_ms,
+    int top_count,
+    bool tree,
+    int subtree_pid,
+    ccstring sort_key,
+    int limit,
+    ccstring match_pattern,
+    ccstring match_field,
+    bool match_regex,
+    bool match_icase,
+    bool json)
 {
-    // Show all processes
-    if (show_all)
+    if (limit < 0)
     {
-        fossil_sys_process_list_t plist;
-        int rc = fossil_sys_process_list(&plist);
-        if (rc == 0)
-        {
-            for (size_t i = 0; i < plist.count; ++i)
-            {
-                fossil_sys_process_info_t *p = &plist.list[i];
-                fossil_io_printf(
-                    "{blue}PID: {cyan}%u {reset}{blue}PPID: {cyan}%u {reset}{green}Name: {bold}%s{reset} "
-                    "{magenta}Mem: {yellow}%llu KB {reset}{magenta}VMem: {yellow}%llu KB {reset}"
-                    "{blue}CPU: {yellow}%.2f%% {reset}{red}Threads: {yellow}%u{reset}\n",
-                    p->pid, p->ppid, p->name,
-                    (unsigned long long)(p->memory_bytes / 1024),
-                    (unsigned long long)(p->virtual_memory_bytes / 1024),
-                    p->cpu_percent, p->thread_count
-                );
-            }
-        }
-        else
-        {
-            fossil_io_error("[process.spawn] %s", fossil_io_what("process.spawn"));
-        }
-        return rc;
+        fossil_io_error("[%s] %s: --limit %d (expected a positive count)", "user.input", fossil_io_what("user.input"), limit);
+        return -1;
+    }
+
+    // Refreshing view
+    if (top)
+    {
+        if (squid_process_unfiltered(name_pattern, match_pattern, "--top") != 0)
+            return -1;
+        fossil_squid_proc_sort_t key;
+        if (squid_process_sort_key(sort_key, FOSSIL_SQUID_PROC_SORT_CPU, &key) != 0)
+            return -1;
+        return squid_process_top(top_interval_ms, top_count, key, limit, json);
     }
 
+    // Process hierarchy
+    if (tree || subtree_pid > 0)
+    {
+        ccstring view = tree ? "--tree" : "--subtree";
+        if (squid_process_unranked(sort_key, limit, view) != 0 ||
+            squid_process_unfiltered(name_pattern, match_pattern, view) != 0)
+            return -1;
+        return squid_process_tree(subtree_pid, json);
+    }
+
+    // Filter by compiled pattern, with --name as a prefilter
+    if (match_pattern != NULL && match_pattern[0] != '\0')
+        return squid_process_match(name_pattern, match_pattern, match_field, match_regex, match_icase,
+                                   sort_key, limit, json);
+
+    // Show all processes
+    if (show_all)
+        return squid_process_list(NULL, NULL, sort_key, limit, json);
+
+    // Everything from here acts on a single process, except a bare --name listing
+    bool acts = exists_pid > 0 || info_pid > 0 || env_pid > 0 || exe_pid > 0 || ppid_pid > 0 ||
+                priority_pid > 0 || set_priority_pid > 0 || suspend_pid > 0 || resume_pid > 0 ||
+                terminate_pid > 0 || kill_pid > 0 || (signal_pid > 0 && signal_value > 0) || wait_pid > 0 ||
+                (spawn_exe != NULL && spawn_exe[0] != '\0');
+    bool named = name_pattern != NULL && name_pattern[0] != '\0';
+    ccstring view = acts ? "a single-process action" : "a command without --all or --name";
+    if ((acts || !named) && squid_process_unranked(sort_key, limit, view) != 0)
+        return -1;
+
     // Check if process exists
     if (exists_pid > 0)
     {
@@ -95,7 +879,15 @@ int fossil_squid_process(
     {
         fossil_sys_process_info_t info;
         int rc = fossil_sys_process_get_info((uint32_t)info_pid, &info);
-        if (rc == 0)
+        if (rc == 0 && json)
+        {
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            squid_process_json_info(&doc, &info);
+            rc = fossil_squid_json_flush(&doc);
+            fossil_squid_json_dispose(&doc);
+        }
+        else if (rc == 0)
         {
             fossil_io_printf(
                 "{blue}PID: {cyan}%u{reset}\n"
@@ -123,7 +915,28 @@ int fossil_squid_process(
     {
         char buffer[4096];
         int rc = fossil_sys_process_get_environment((uint32_t)env_pid, buffer, sizeof(buffer));
-        if (rc >= 0)
+        if (rc >= 0 && json)
+        {
+            /* entries are NUL separated */
+            size_t len = (size_t)rc < sizeof(buffer) ? (size_t)rc : sizeof(buffer);
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_int(&doc, "pid", env_pid);
+            fossil_squid_json_key(&doc, "environment");
+            fossil_squid_json_array_begin(&doc);
+            for (size_t off = 0; off < len; )
+            {
+                size_t n = strnlen(buffer + off, len - off);
+                if (n > 0)
+                    fossil_squid_json_string_n(&doc, buffer + off, n);
+                off += n + 1;
+            }
+            fossil_squid_json_array_end(&doc);
+            if (squid_process_json_done(&doc) != 0)
+                rc = -1;
+        }
+        else if (rc >= 0)
         {
             fossil_io_printf("{blue}%.*s{reset}\n", rc, buffer);
         }
@@ -139,7 +952,16 @@ int fossil_squid_process(
     {
         char buffer[1024];
         int rc = fossil_sys_process_get_exe_path((uint32_t)exe_pid, buffer, sizeof(buffer));
-        if (rc == 0)
+        if (rc == 0 && json)
+        {
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_int(&doc, "pid", exe_pid);
+            fossil_squid_json_field_string(&doc, "exe", buffer);
+            rc = squid_process_json_done(&doc);
+        }
+        else if (rc == 0)
         {
             fossil_io_printf("{blue}%s{reset}\n", buffer);
         }
@@ -154,7 +976,16 @@ int fossil_squid_process(
     if (ppid_pid > 0)
     {
         int ppid = fossil_sys_process_get_ppid((uint32_t)ppid_pid);
-        if (ppid >= 0)
+        if (ppid >= 0 && json)
+        {
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_int(&doc, "pid", ppid_pid);
+            fossil_squid_json_field_int(&doc, "ppid", ppid);
+            squid_process_json_done(&doc);
+        }
+        else if (ppid >= 0)
             fossil_io_printf("{blue}%d{reset}\n", ppid);
         else
             fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
@@ -166,7 +997,16 @@ int fossil_squid_process(
     {
         int priority = 0;
         int rc = fossil_sys_process_get_priority((uint32_t)priority_pid, &priority);
-        if (rc == 0)
+        if (rc == 0 && json)
+        {
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_int(&doc, "pid", priority_pid);
+            fossil_squid_json_field_int(&doc, "priority", priority);
+            rc = squid_process_json_done(&doc);
+        }
+        else if (rc == 0)
         {
             fossil_io_printf("{blue}%d{reset}\n", priority);
         }
@@ -272,7 +1112,16 @@ int fossil_squid_process(
     {
         char name[FOSSIL_SYS_PROCESS_NAME_MAX];
         int rc = fossil_sys_process_get_name((uint32_t)pid, name, sizeof(name));
-        if (rc == 0)
+        if (rc == 0 && json)
+        {
+            fossil_squid_json_t doc;
+            fossil_squid_json_init(&doc);
+            fossil_squid_json_object_begin(&doc);
+            fossil_squid_json_field_int(&doc, "pid", pid);
+            fossil_squid_json_field_string(&doc, "name", name);
+            rc = squid_process_json_done(&doc);
+        }
+        else if (rc == 0)
         {
             fossil_io_printf("{blue}%s{reset}\n", name);
         }
@@ -285,34 +1134,7 @@ int fossil_squid_process(
 
     // Filter by process name
     if (name_pattern != NULL && name_pattern[0] != '\0')
-    {
-        fossil_sys_process_list_t plist;
-        int rc = fossil_sys_process_list(&plist);
-        if (rc == 0)
-        {
-            for (size_t i = 0; i < plist.count; ++i)
-            {
-                fossil_sys_process_info_t *p = &plist.list[i];
-                if (strstr(p->name, name_pattern) != NULL)
-                {
-                    fossil_io_printf(
-                        "{blue}PID: {cyan}%u {reset}{blue}PPID: {cyan}%u {reset}{blue}Name: {cyan}%s{reset} "
-                        "{blue}Mem: {cyan}%llu KB {reset}{blue}VMem: {cyan}%llu KB {reset}"
-                        "{blue}CPU: {cyan}%.2f%% {reset}{blue}Threads: {cyan}%u{reset}\n",
-                        p->pid, p->ppid, p->name,
-                        (unsigned long long)(p->memory_bytes / 1024),
-                        (unsigned long long)(p->virtual_memory_bytes / 1024),
-                        p->cpu_percent, p->thread_count
-                    );
-                }
-            }
-        }
-        else
-        {
-            fossil_io_error("[process.exec] %s", fossil_io_what("process.exec"));
-        }
-        return rc;
-    }
+        return squid_process_list(name_pattern, NULL, sort_key, limit, json);
 
     return 0;
 }
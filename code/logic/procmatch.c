@@ -0,0 +1,661 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/procmatch.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#ifndef _WIN32
+#include <regex.h>
+#endif
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define SQUID_MATCH_SSE2 1
+#endif
+
+/*=============================================================================
+SQUID PROCESS MATCHER
+=============================================================================*/
+
+#define SQUID_MATCH_BUF_INITIAL 4096
+#define SQUID_MATCH_CMDLINE_MAX (128 * 1024)    /* longer command lines are tested on their start */
+
+static unsigned char squid_match_fold(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+static bool squid_match_same(const char *a, const char *b, size_t n, bool icase)
+{
+    if (!icase)
+        return memcmp(a, b, n) == 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (squid_match_fold((unsigned char)a[i]) != squid_match_fold((unsigned char)b[i]))
+            return false;
+    }
+    return true;
+}
+
+#if defined(SQUID_MATCH_SSE2)
+static unsigned squid_match_ctz(unsigned v)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, v);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(v);
+#endif
+}
+#endif
+
+/*
+ * Substring search. With SSE2 sixteen start positions are tried per step by
+ * comparing the literal's first and last bytes against two overlapping
+ * loads; only positions where both agree are compared in full. Ignoring
+ * case ORs 0x20 into the loaded bytes wherever the literal has a letter,
+ * which can only turn an upper case letter into its lower case form.
+ */
+static bool squid_match_contains(const char *hay, size_t n, const char *lit, size_t m, bool icase)
+{
+    if (m == 0)
+        return true;
+    if (m > n)
+        return false;
+
+    unsigned char first = (unsigned char)lit[0];
+    unsigned char last = (unsigned char)lit[m - 1];
+    if (icase)
+    {
+        first = squid_match_fold(first);
+        last = squid_match_fold(last);
+    }
+    size_t i = 0;
+
+#if defined(SQUID_MATCH_SSE2)
+    const __m128i want_first = _mm_set1_epi8((char)first);
+    const __m128i want_last = _mm_set1_epi8((char)last);
+    const __m128i fold_first = _mm_set1_epi8((char)(icase && first >= 'a' && first <= 'z' ? 0x20 : 0));
+    const __m128i fold_last = _mm_set1_epi8((char)(icase && last >= 'a' && last <= 'z' ? 0x20 : 0));
+    for (; i + m - 1 + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_or_si128(_mm_loadu_si128((const __m128i *)(const void *)(hay + i)), fold_first);
+        __m128i b = _mm_or_si128(_mm_loadu_si128((const __m128i *)(const void *)(hay + i + m - 1)), fold_last);
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, want_first), _mm_cmpeq_epi8(b, want_last)));
+        while (mask != 0)
+        {
+            size_t at = i + squid_match_ctz(mask);
+            if (m <= 2 || squid_match_same(hay + at + 1, lit + 1, m - 2, icase))
+                return true;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i + m <= n; ++i)
+    {
+        unsigned char c = (unsigned char)hay[i];
+        if ((icase ? squid_match_fold(c) : c) == first && squid_match_same(hay + i, lit, m, icase))
+            return true;
+    }
+    return false;
+}
+
+/*
+ * A [:class:], [=c=] or [.c.] term inside a set, starting at its '['.
+ * Returns the ':', '=' or '.' that closes it, or NULL if p is not one.
+ */
+static const char *squid_match_set_term(const char *p)
+{
+    if (p[0] != '[' || (p[1] != ':' && p[1] != '=' && p[1] != '.'))
+        return NULL;
+    for (const char *q = p + 2; *q != '\0'; ++q)
+    {
+        if (q[0] == p[1] && q[1] == ']')
+            return q;
+    }
+    return NULL;
+}
+
+/* c against a named class; ASCII only, as in the C locale, and unknown names match nothing */
+static bool squid_match_named_class(const char *name, size_t len, unsigned char c, bool icase)
+{
+    static const struct {
+        const char *name;
+        int (*test)(int);
+    } classes[] = {
+        {"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank}, {"cntrl", iscntrl},
+        {"digit", isdigit}, {"graph", isgraph}, {"lower", islower}, {"print", isprint},
+        {"punct", ispunct}, {"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit},
+    };
+    if (c >= 0x80)
+        return false;
+    for (size_t i = 0; i < sizeof(classes) / sizeof(classes[0]); ++i)
+    {
+        if (strlen(classes[i].name) != len || memcmp(classes[i].name, name, len) != 0)
+            continue;
+        if (classes[i].test(c))
+            return true;
+        // ignoring case, [:upper:] and [:lower:] take either form of a letter
+        return icase && isalpha(c) && (classes[i].test(tolower(c)) || classes[i].test(toupper(c)));
+    }
+    return false;
+}
+
+/* one range endpoint: a character, an escaped one, or [=c=] / [.c.]; NULL for a multi-character element */
+static const char *squid_match_set_char(const char *p, unsigned char *out)
+{
+    const char *close = squid_match_set_term(p);
+    if (close != NULL && p[1] != ':')
+    {
+        if (close != p + 3)
+            return NULL;
+        *out = (unsigned char)p[2];
+        return close + 2;
+    }
+    if (*p == '\\' && p[1] != '\0')
+        ++p;
+    *out = (unsigned char)*p;
+    return p + 1;
+}
+
+/*
+ * One [set] starting just past its '['. Returns the pattern after the
+ * closing ']' and whether c is in the set, or NULL if the set is not closed
+ * or holds a collating element longer than one character (the '[' is then
+ * an ordinary character).
+ */
+static const char *squid_match_class(const char *p, unsigned char c, bool icase, bool *hit)
+{
+    bool negate = false;
+    if (*p == '!' || *p == '^')
+    {
+        negate = true;
+        ++p;
+    }
+
+    bool found = false;
+    const char *start = p;
+    while (*p != '\0' && (*p != ']' || p == start))
+    {
+        const char *close = squid_match_set_term(p);
+        if (close != NULL && p[1] == ':')
+        {
+            if (squid_match_named_class(p + 2, (size_t)(close - p - 2), c, icase))
+                found = true;
+            p = close + 2;
+            continue;
+        }
+
+        unsigned char lo, hi;
+        if ((p = squid_match_set_char(p, &lo)) == NULL)
+            return NULL;
+        hi = lo;
+        if (*p == '-' && p[1] != '\0' && p[1] != ']')
+        {
+            if ((p = squid_match_set_char(p + 1, &hi)) == NULL)
+                return NULL;
+        }
+        if (c >= lo && c <= hi)
+            found = true;
+        else if (icase && squid_match_fold(c) >= squid_match_fold(lo) && squid_match_fold(c) <= squid_match_fold(hi))
+            found = true;
+    }
+    if (*p != ']')
+        return NULL;
+    *hit = found != negate;
+    return p + 1;
+}
+
+/* whole-string glob match; the last '*' is retried one character later on a mismatch, so this never backtracks further */
+static bool squid_match_glob(const char *p, const char *s, const char *end, bool icase)
+{
+    const char *star_p = NULL, *star_s = NULL;
+    while (s < end)
+    {
+        if (*p == '*')
+        {
+            while (*p == '*')
+                ++p;
+            if (*p == '\0')
+                return true;
+            star_p = p;
+            star_s = s;
+            continue;
+        }
+        if (*p != '\0')
+        {
+            unsigned char c = (unsigned char)*s;
+            const char *next = NULL;
+            bool hit = false;
+            if (*p == '?')
+            {
+                hit = true;
+                next = p + 1;
+            }
+            else if (*p != '[' || (next = squid_match_class(p + 1, c, icase, &hit)) == NULL)
+            {
+                const char *q = (*p == '\\' && p[1] != '\0') ? p + 1 : p;
+                hit = icase ? squid_match_fold((unsigned char)*q) == squid_match_fold(c) : (unsigned char)*q == c;
+                next = q + 1;
+            }
+            if (hit)
+            {
+                p = next;
+                ++s;
+                continue;
+            }
+        }
+        if (!star_p)
+            return false;
+        p = star_p;
+        s = ++star_s;
+    }
+    while (*p == '*')
+        ++p;
+    return *p == '\0';
+}
+
+/* keep the longer of the best literal so far and the run just ended */
+static void squid_match_commit(char *best, size_t *best_len, const char *run, size_t *run_len)
+{
+    if (*run_len > *best_len)
+    {
+        memcpy(best, run, *run_len);
+        *best_len = *run_len;
+    }
+    *run_len = 0;
+}
+
+/* longest run of ordinary characters in a glob; every match contains it */
+static size_t squid_match_glob_literal(const char *p, char *best, char *run)
+{
+    size_t best_len = 0, run_len = 0;
+    while (*p != '\0')
+    {
+        bool hit;
+        const char *next;
+        if (*p == '*' || *p == '?')
+        {
+            squid_match_commit(best, &best_len, run, &run_len);
+            ++p;
+        }
+        else if (*p == '[' && (next = squid_match_class(p + 1, 0, false, &hit)) != NULL)
+        {
+            squid_match_commit(best, &best_len, run, &run_len);
+            p = next;
+        }
+        else
+        {
+            if (*p == '\\' && p[1] != '\0')
+                ++p;
+            run[run_len++] = *p++;
+        }
+    }
+    squid_match_commit(best, &best_len, run, &run_len);
+    return best_len;
+}
+
+/* past a bracket expression starting at its '[' */
+static const char *squid_match_skip_bracket(const char *p)
+{
+    ++p;
+    if (*p == '^')
+        ++p;
+    if (*p == ']')
+        ++p;
+    while (*p != '\0' && *p != ']')
+    {
+        const char *close = squid_match_set_term(p);
+        p = close != NULL ? close + 2 : p + 1;
+    }
+    return *p == ']' ? p + 1 : p;
+}
+
+/*
+ * Longest literal every match of an extended regular expression contains.
+ * Deliberately conservative: any alternation gives up, groups and bracket
+ * expressions end a run, and a character followed by *, ? or {} is dropped
+ * because it may not appear.
+ */
+static size_t squid_match_regex_literal(const char *p, char *best, char *run)
+{
+    size_t best_len = 0, run_len = 0;
+    bool atom_in_run = false;
+    if (strchr(p, '|') != NULL)
+        return 0;
+
+    while (*p != '\0')
+    {
+        char c = *p;
+        if (c == '*' || c == '?' || c == '{')
+        {
+            if (atom_in_run)
+                --run_len;
+            squid_match_commit(best, &best_len, run, &run_len);
+            if (c == '{')
+            {
+                const char *close = strchr(p, '}');
+                p = close ? close + 1 : p + 1;
+            }
+            else
+                ++p;
+            atom_in_run = false;
+        }
+        else if (c == '+')
+        {
+            // the atom is there at least once, but what follows may not be adjacent,
+            // and a quantifier stacked on top ("a+*") can still make it optional
+            const char *q = p;
+            while (*q == '+')
+                ++q;
+            if (atom_in_run && (*q == '*' || *q == '?' || *q == '{'))
+                --run_len;
+            squid_match_commit(best, &best_len, run, &run_len);
+            p = q;
+            atom_in_run = false;
+        }
+        else if (c == '\\' && p[1] != '\0' && !isalnum((unsigned char)p[1]))
+        {
+            run[run_len++] = p[1];
+            p += 2;
+            atom_in_run = true;
+        }
+        else if (c == '[')
+        {
+            squid_match_commit(best, &best_len, run, &run_len);
+            p = squid_match_skip_bracket(p);
+            atom_in_run = false;
+        }
+        else if (c == '(')
+        {
+            int depth = 0;
+            do
+            {
+                if (*p == '[')
+                    p = squid_match_skip_bracket(p);
+                else
+                {
+                    if (*p == '\\' && p[1] != '\0')
+                        ++p;
+                    else if (*p == '(')
+                        ++depth;
+                    else if (*p == ')')
+                        --depth;
+                    ++p;
+                }
+            } while (*p != '\0' && depth > 0);
+            squid_match_commit(best, &best_len, run, &run_len);
+            atom_in_run = false;
+        }
+        else if (c == '.' || c == '^' || c == '$' || c == '\\' || c == ')')
+        {
+            squid_match_commit(best, &best_len, run, &run_len);
+            p += (c == '\\' && p[1] != '\0') ? 2 : 1;
+            atom_in_run = false;
+        }
+        else
+        {
+            run[run_len++] = c;
+            ++p;
+            atom_in_run = true;
+        }
+    }
+    squid_match_commit(best, &best_len, run, &run_len);
+    return best_len;
+}
+
+static bool squid_match_reserve(fossil_squid_proc_matcher_t *m, size_t need)
+{
+    if (need <= m->buf_capacity)
+        return true;
+    char *grown = (char *)fossil_sys_memory_realloc(m->buf, need);
+    if (!grown)
+        return false;
+    m->buf = grown;
+    m->buf_capacity = need;
+    return true;
+}
+
+/* the pattern against one field value; s[n] is its terminator */
+static bool squid_match_text(const fossil_squid_proc_matcher_t *m, const char *s, size_t n)
+{
+    bool icase = (m->flags & FOSSIL_SQUID_PROC_MATCH_ICASE) != 0;
+    if (!squid_match_contains(s, n, m->literal, m->literal_len, icase))
+        return false;
+#ifndef _WIN32
+    if (m->regex)
+        return regexec((const regex_t *)m->regex, s, 0, NULL, 0) == 0;
+#endif
+    return squid_match_glob(m->pattern, s, s + n, icase);
+}
+
+/* executable path into buf; its length, or -1 if it cannot be read */
+static long squid_match_read_exe(fossil_squid_proc_matcher_t *m, uint32_t pid)
+{
+    m->reads++;
+#if defined(__linux__)
+    if (m->proc_fd >= 0)
+    {
+        char rel[24];
+        snprintf(rel, sizeof(rel), "%u/exe", pid);
+        ssize_t n = readlinkat(m->proc_fd, rel, m->buf, m->buf_capacity - 1);
+        if (n < 0)
+            return -1;
+        m->buf[n] = '\0';
+        return (long)n;
+    }
+#endif
+    if (fossil_sys_process_get_exe_path(pid, m->buf, m->buf_capacity) != 0)
+        return -1;
+    m->buf[m->buf_capacity - 1] = '\0';
+    return (long)strlen(m->buf);
+}
+
+/* arguments joined by spaces into buf; its length, or -1 if it cannot be read */
+static long squid_match_read_cmdline(fossil_squid_proc_matcher_t *m, uint32_t pid)
+{
+#if defined(__linux__)
+    if (m->proc_fd < 0)
+        return squid_match_read_exe(m, pid);
+
+    char rel[24];
+    snprintf(rel, sizeof(rel), "%u/cmdline", pid);
+    m->reads++;
+    int f = openat(m->proc_fd, rel, O_RDONLY | O_CLOEXEC);
+    if (f < 0)
+        return -1;
+
+    size_t n = 0;
+    for (;;)
+    {
+        if (n + 1 >= m->buf_capacity)
+        {
+            size_t cap = m->buf_capacity * 2;
+            if (m->buf_capacity >= SQUID_MATCH_CMDLINE_MAX || !squid_match_reserve(m, cap < SQUID_MATCH_CMDLINE_MAX ? cap : SQUID_MATCH_CMDLINE_MAX))
+                break;
+        }
+        ssize_t got = read(f, m->buf + n, m->buf_capacity - 1 - n);
+        if (got <= 0)
+            break;
+        n += (size_t)got;
+    }
+    close(f);
+
+    while (n > 0 && m->buf[n - 1] == '\0')
+        --n;
+    for (char *z = m->buf; (z = (char *)memchr(z, '\0', (size_t)(m->buf + n - z))) != NULL; ++z)
+        *z = ' ';
+    m->buf[n] = '\0';
+    return (long)n;
+#else
+    return squid_match_read_exe(m, pid);
+#endif
+}
+
+void fossil_squid_proc_matcher_dispose(fossil_squid_proc_matcher_t *m)
+{
+    if (!m)
+        return;
+#ifndef _WIN32
+    if (m->regex)
+    {
+        regfree((regex_t *)m->regex);
+        fossil_sys_memory_free(m->regex);
+    }
+#endif
+#if defined(__linux__)
+    if (m->proc_fd >= 0)
+        close(m->proc_fd);
+#endif
+    if (m->literal)
+        fossil_sys_memory_free(m->literal);
+    if (m->pattern)
+        fossil_sys_memory_free(m->pattern);
+    if (m->buf)
+        fossil_sys_memory_free(m->buf);
+    memset(m, 0, sizeof(*m));
+    m->proc_fd = -1;
+}
+
+int fossil_squid_proc_matcher_compile(fossil_squid_proc_matcher_t *m, const char *pattern,
+                                      fossil_squid_proc_field_t field, unsigned flags)
+{
+    if (!m)
+        return -1;
+    memset(m, 0, sizeof(*m));
+    m->proc_fd = -1;
+    if (!pattern)
+        return -1;
+    m->field = field;
+    m->flags = flags;
+
+    size_t len = strlen(pattern);
+    char *run = (char *)fossil_sys_memory_calloc(len + 1, 1);
+    m->literal = (char *)fossil_sys_memory_calloc(len + 1, 1);
+    m->pattern = (char *)fossil_sys_memory_calloc(len + 1, 1);
+    bool ok = run && m->literal && m->pattern && squid_match_reserve(m, SQUID_MATCH_BUF_INITIAL);
+    if (ok)
+        memcpy(m->pattern, pattern, len);
+
+    if (ok && (flags & FOSSIL_SQUID_PROC_MATCH_REGEX))
+    {
+#ifdef _WIN32
+        ok = false;
+#else
+        regex_t *re = (regex_t *)fossil_sys_memory_calloc(1, sizeof(*re));
+        int cflags = REG_EXTENDED | REG_NOSUB | ((flags & FOSSIL_SQUID_PROC_MATCH_ICASE) ? REG_ICASE : 0);
+        if (re && regcomp(re, pattern, cflags) == 0)
+        {
+            m->regex = re;
+            m->literal_len = squid_match_regex_literal(pattern, m->literal, run);
+        }
+        else
+        {
+            if (re)
+                fossil_sys_memory_free(re);
+            ok = false;
+        }
+#endif
+    }
+    else if (ok)
+    {
+        m->literal_len = squid_match_glob_literal(pattern, m->literal, run);
+    }
+    if (run)
+        fossil_sys_memory_free(run);
+
+#if defined(__linux__)
+    if (ok && field != FOSSIL_SQUID_PROC_FIELD_NAME)
+        m->proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+    if (!ok)
+    {
+        fossil_squid_proc_matcher_dispose(m);
+        return -1;
+    }
+    return 0;
+}
+
+bool fossil_squid_proc_matcher_test(fossil_squid_proc_matcher_t *m, const fossil_squid_proc_t *p)
+{
+    if (!m || !p || !m->pattern)
+        return false;
+
+    // the name is already in hand; only look further when it is inconclusive
+    if (m->field == FOSSIL_SQUID_PROC_FIELD_NAME || m->field == FOSSIL_SQUID_PROC_FIELD_ANY)
+    {
+        if (squid_match_text(m, p->name, strlen(p->name)))
+            return true;
+        if (m->field == FOSSIL_SQUID_PROC_FIELD_NAME)
+            return false;
+    }
+
+    long n = m->field == FOSSIL_SQUID_PROC_FIELD_EXE ? squid_match_read_exe(m, p->pid)
+                                                     : squid_match_read_cmdline(m, p->pid);
+    if (n < 0)
+        return false;
+    if (n == 0)
+    {
+        // kernel threads and zombies have no command line; ps shows their name instead
+        return m->field == FOSSIL_SQUID_PROC_FIELD_CMDLINE && squid_match_text(m, p->name, strlen(p->name));
+    }
+    return squid_match_text(m, m->buf, (size_t)n);
+}
+
+int fossil_squid_proc_field_parse(const char *name, fossil_squid_proc_field_t *field)
+{
+    static const struct {
+        const char *name;
+        fossil_squid_proc_field_t field;
+    } fields[] = {
+        {"any", FOSSIL_SQUID_PROC_FIELD_ANY},
+        {"name", FOSSIL_SQUID_PROC_FIELD_NAME},
+        {"exe", FOSSIL_SQUID_PROC_FIELD_EXE},
+        {"cmdline", FOSSIL_SQUID_PROC_FIELD_CMDLINE},
+    };
+    if (!name || !field)
+        return -1;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+    {
+        if (strcmp(name, fields[i].name) == 0)
+        {
+            *field = fields[i].field;
+            return 0;
+        }
+    }
+    return -1;
+}
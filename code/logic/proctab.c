@@ -0,0 +1,1078 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/proctab.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#endif
+
+/*=============================================================================
+SQUID PROCESS TABLE
+=============================================================================*/
+
+#define SQUID_PROC_FD_RESERVE 64
+#define SQUID_PROC_STAT_MAX 1024
+#define SQUID_PROC_MAX_THREADS 16
+#define SQUID_PROC_CHUNK 256            /* pids claimed per turn by a collector thread */
+#define SQUID_PROC_PER_THREAD 1024      /* fewer pids than this per thread is not worth a thread */
+
+static uint64_t squid_proc_now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((now.QuadPart / freq.QuadPart) * 1000000000ULL +
+                      ((now.QuadPart % freq.QuadPart) * 1000000000ULL) / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* CPU time this process has used so far, in nanoseconds */
+static uint64_t squid_proc_self_ns(void)
+{
+#if defined(_WIN32)
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (k + u) * 100ULL;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+    return ((uint64_t)ru.ru_utime.tv_sec + (uint64_t)ru.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)ru.ru_utime.tv_usec + (uint64_t)ru.ru_stime.tv_usec) * 1000ULL;
+#endif
+}
+
+static uint32_t squid_proc_cpu_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+#endif
+}
+
+/*
+ * Names come from whoever started the process, so control bytes (an escape
+ * sequence, a newline) are replaced before anything can print them.
+ */
+static void squid_proc_set_name(fossil_squid_proc_t *p, const char *name, size_t len)
+{
+    if (len >= sizeof(p->name))
+        len = sizeof(p->name) - 1;
+    for (size_t i = 0; i < len; ++i)
+    {
+        unsigned char c = (unsigned char)name[i];
+        p->name[i] = (c < 0x20 || c == 0x7f) ? '?' : (char)c;
+    }
+    p->name[len] = '\0';
+}
+
+static int squid_proc_cmp_pid(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* grow every per-entry buffer to hold at least need entries */
+static int squid_proc_reserve(fossil_squid_proc_sampler_t *s, size_t need)
+{
+    if (need <= s->capacity)
+        return 0;
+
+    size_t cap = s->capacity ? s->capacity : 256;
+    while (cap < need)
+        cap *= 2;
+
+    fossil_squid_proc_t *procs = (fossil_squid_proc_t *)fossil_sys_memory_realloc(s->procs, cap * sizeof(*procs));
+    if (procs)
+        s->procs = procs;
+    fossil_squid_proc_t *spare = (fossil_squid_proc_t *)fossil_sys_memory_realloc(s->spare, cap * sizeof(*spare));
+    if (spare)
+        s->spare = spare;
+    int *fds = (int *)fossil_sys_memory_realloc(s->fds, cap * sizeof(*fds));
+    if (fds)
+        s->fds = fds;
+    int *spare_fds = (int *)fossil_sys_memory_realloc(s->spare_fds, cap * sizeof(*spare_fds));
+    if (spare_fds)
+        s->spare_fds = spare_fds;
+
+    if (!procs || !spare || !fds || !spare_fds)
+        return -1;
+    s->capacity = cap;
+    return 0;
+}
+
+static int squid_proc_table_reserve(fossil_squid_proc_table_t *t, size_t need)
+{
+    if (need <= t->capacity)
+        return 0;
+
+    size_t cap = t->capacity ? t->capacity : 256;
+    while (cap < need)
+        cap *= 2;
+    fossil_squid_proc_t *procs = (fossil_squid_proc_t *)fossil_sys_memory_realloc(t->procs, cap * sizeof(*procs));
+    if (!procs)
+        return -1;
+    t->procs = procs;
+    t->capacity = cap;
+    return 0;
+}
+
+int fossil_squid_proc_table_init(fossil_squid_proc_table_t *t)
+{
+    if (!t)
+        return -1;
+    memset(t, 0, sizeof(*t));
+    return 0;
+}
+
+void fossil_squid_proc_table_dispose(fossil_squid_proc_table_t *t)
+{
+    if (!t)
+        return;
+    if (t->procs)
+        fossil_sys_memory_free(t->procs);
+    if (t->pids)
+        fossil_sys_memory_free(t->pids);
+    memset(t, 0, sizeof(*t));
+}
+
+/*
+ * Both tables are sorted by pid, so matching is one merge pass. A pid only
+ * names the same process in both if its start time agrees as well.
+ */
+int fossil_squid_proc_table_rate(fossil_squid_proc_table_t *t, const fossil_squid_proc_table_t *prev)
+{
+    if (!t || !prev)
+        return -1;
+
+    double dt = t->taken_ns > prev->taken_ns ? (double)(t->taken_ns - prev->taken_ns) / 1e9 : 0.0;
+    if (dt <= 0.0)
+        return 0;
+#if defined(__linux__)
+    long hz = sysconf(_SC_CLK_TCK);
+    double tick_scale = hz > 0 ? 100.0 / ((double)hz * dt) : 0.0;
+#endif
+
+    for (size_t i = 0, j = 0; i < t->count; ++i)
+    {
+        fossil_squid_proc_t *p = &t->procs[i];
+        while (j < prev->count && prev->procs[j].pid < p->pid)
+            ++j;
+        if (j >= prev->count || prev->procs[j].pid != p->pid || prev->procs[j].start_ticks != p->start_ticks)
+            continue;
+#if defined(__linux__)
+        if (p->cpu_ticks >= prev->procs[j].cpu_ticks)
+            p->cpu_percent = (double)(p->cpu_ticks - prev->procs[j].cpu_ticks) * tick_scale;
+#endif
+        p->rss_delta_bytes = (int64_t)p->rss_bytes - (int64_t)prev->procs[j].rss_bytes;
+    }
+    return 0;
+}
+
+/*=============================================================================
+SQUID PROCESS TREE
+=============================================================================*/
+
+#define SQUID_PROC_UNSEEN UINT32_MAX
+
+static size_t squid_proc_slot(uint32_t pid, size_t mask)
+{
+    return (size_t)(pid * 2654435761u) & mask;
+}
+
+void fossil_squid_proc_tree_dispose(fossil_squid_proc_tree_t *tree)
+{
+    if (!tree)
+        return;
+    if (tree->parent)
+        fossil_sys_memory_free(tree->parent);
+    if (tree->first_child)
+        fossil_sys_memory_free(tree->first_child);
+    if (tree->children)
+        fossil_sys_memory_free(tree->children);
+    if (tree->order)
+        fossil_sys_memory_free(tree->order);
+    if (tree->depth)
+        fossil_sys_memory_free(tree->depth);
+    if (tree->pos)
+        fossil_sys_memory_free(tree->pos);
+    if (tree->totals)
+        fossil_sys_memory_free(tree->totals);
+    if (tree->slots)
+        fossil_sys_memory_free(tree->slots);
+    memset(tree, 0, sizeof(*tree));
+}
+
+int32_t fossil_squid_proc_tree_find(const fossil_squid_proc_tree_t *tree, const fossil_squid_proc_table_t *t, uint32_t pid)
+{
+    if (!tree || !t || !tree->slots)
+        return -1;
+    for (size_t h = squid_proc_slot(pid, tree->slot_mask);; h = (h + 1) & tree->slot_mask)
+    {
+        int32_t e = tree->slots[h];
+        if (e < 0 || t->procs[e].pid == pid)
+            return e;
+    }
+}
+
+/* append the subtree under root to the preorder; children are pushed in reverse so they pop in pid order */
+static size_t squid_proc_tree_walk(fossil_squid_proc_tree_t *tree, uint32_t root, uint32_t *stack, size_t k)
+{
+    size_t top = 0;
+    tree->depth[root] = 0;
+    stack[top++] = root;
+    while (top > 0)
+    {
+        uint32_t e = stack[--top];
+        tree->pos[e] = (uint32_t)k;
+        tree->order[k++] = e;
+        for (uint32_t c = tree->first_child[e + 1]; c > tree->first_child[e]; --c)
+        {
+            uint32_t child = tree->children[c - 1];
+            if (tree->depth[child] != SQUID_PROC_UNSEEN)
+                continue;
+            tree->depth[child] = tree->depth[e] + 1;
+            stack[top++] = child;
+        }
+    }
+    return k;
+}
+
+int fossil_squid_proc_tree_build(fossil_squid_proc_tree_t *tree, const fossil_squid_proc_table_t *t)
+{
+    if (!tree || !t)
+        return -1;
+    fossil_squid_proc_tree_dispose(tree);
+
+    size_t n = t->count;
+    if (n >= (size_t)INT32_MAX)
+        return -1;
+    size_t slots = 16;
+    while (slots < n * 2)
+        slots <<= 1;
+    size_t alloc = n > 0 ? n : 1;
+
+    tree->count = n;
+    tree->parent = (int32_t *)fossil_sys_memory_calloc(alloc, sizeof(int32_t));
+    tree->first_child = (uint32_t *)fossil_sys_memory_calloc(n + 1, sizeof(uint32_t));
+    tree->children = (uint32_t *)fossil_sys_memory_calloc(alloc, sizeof(uint32_t));
+    tree->order = (uint32_t *)fossil_sys_memory_calloc(alloc, sizeof(uint32_t));
+    tree->depth = (uint32_t *)fossil_sys_memory_calloc(alloc, sizeof(uint32_t));
+    tree->pos = (uint32_t *)fossil_sys_memory_calloc(alloc, sizeof(uint32_t));
+    tree->totals = (fossil_squid_proc_totals_t *)fossil_sys_memory_calloc(alloc, sizeof(fossil_squid_proc_totals_t));
+    tree->slots = (int32_t *)fossil_sys_memory_calloc(slots, sizeof(int32_t));
+    uint32_t *scratch = (uint32_t *)fossil_sys_memory_calloc(alloc * 2, sizeof(uint32_t));
+    if (!tree->parent || !tree->first_child || !tree->children || !tree->order || !tree->depth ||
+        !tree->pos || !tree->totals || !tree->slots || !scratch)
+    {
+        if (scratch)
+            fossil_sys_memory_free(scratch);
+        fossil_squid_proc_tree_dispose(tree);
+        return -1;
+    }
+    tree->slot_mask = slots - 1;
+
+    for (size_t h = 0; h < slots; ++h)
+        tree->slots[h] = -1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t h = squid_proc_slot(t->procs[i].pid, tree->slot_mask);
+        while (tree->slots[h] >= 0)
+            h = (h + 1) & tree->slot_mask;
+        tree->slots[h] = (int32_t)i;
+    }
+
+    /* count children per parent, prefix-sum into offsets, then place them; scratch is the fill cursor */
+    for (size_t i = 0; i < n; ++i)
+    {
+        const fossil_squid_proc_t *p = &t->procs[i];
+        int32_t parent = p->ppid != p->pid ? fossil_squid_proc_tree_find(tree, t, p->ppid) : -1;
+        tree->parent[i] = parent;
+        if (parent >= 0)
+            tree->first_child[parent + 1]++;
+    }
+    for (size_t i = 0; i < n; ++i)
+        tree->first_child[i + 1] += tree->first_child[i];
+    memcpy(scratch, tree->first_child, n * sizeof(uint32_t));
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (tree->parent[i] >= 0)
+            tree->children[scratch[tree->parent[i]]++] = (uint32_t)i;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        tree->depth[i] = SQUID_PROC_UNSEEN;
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (tree->parent[i] < 0)
+            k = squid_proc_tree_walk(tree, (uint32_t)i, scratch, k);
+    }
+
+    /*
+     * Whatever is left hangs off a parent cycle. Climb from it until the
+     * climb meets itself, cut the cycle there and walk from that point; the
+     * climb only crosses unvisited entries, so this stays linear.
+     */
+    uint32_t *mark = scratch + alloc;
+    memset(mark, 0, alloc * sizeof(uint32_t));
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (tree->depth[i] != SQUID_PROC_UNSEEN)
+            continue;
+        uint32_t stamp = (uint32_t)i + 1;
+        uint32_t e = (uint32_t)i;
+        while (mark[e] != stamp)
+        {
+            mark[e] = stamp;
+            e = (uint32_t)tree->parent[e];
+        }
+        tree->parent[e] = -1;
+        k = squid_proc_tree_walk(tree, e, scratch, k);
+    }
+    fossil_sys_memory_free(scratch);
+
+    /* a parent precedes its children in preorder, so a reverse sweep sums bottom-up */
+    for (size_t i = 0; i < n; ++i)
+    {
+        fossil_squid_proc_totals_t *sum = &tree->totals[i];
+        sum->processes = 1;
+        sum->threads = t->procs[i].threads;
+        sum->rss_bytes = t->procs[i].rss_bytes;
+        sum->cpu_percent = t->procs[i].cpu_percent;
+    }
+    for (size_t j = n; j > 0; --j)
+    {
+        uint32_t e = tree->order[j - 1];
+        int32_t parent = tree->parent[e];
+        if (parent < 0)
+            continue;
+        fossil_squid_proc_totals_t *up = &tree->totals[parent];
+        up->processes += tree->totals[e].processes;
+        up->threads += tree->totals[e].threads;
+        up->rss_bytes += tree->totals[e].rss_bytes;
+        up->cpu_percent += tree->totals[e].cpu_percent;
+    }
+    return 0;
+}
+
+/*=============================================================================
+SQUID ROW SELECTION
+=============================================================================*/
+
+/* whether a ranks ahead of b under key */
+static bool squid_proc_ahead(const fossil_squid_proc_t *a, const fossil_squid_proc_t *b, fossil_squid_proc_sort_t key)
+{
+    switch (key)
+    {
+    case FOSSIL_SQUID_PROC_SORT_CPU:
+        if (a->cpu_percent != b->cpu_percent)
+            return a->cpu_percent > b->cpu_percent;
+        if (a->rss_bytes != b->rss_bytes)
+            return a->rss_bytes > b->rss_bytes;
+        break;
+    case FOSSIL_SQUID_PROC_SORT_MEM:
+        if (a->rss_bytes != b->rss_bytes)
+            return a->rss_bytes > b->rss_bytes;
+        break;
+    case FOSSIL_SQUID_PROC_SORT_VMEM:
+        if (a->vsize_bytes != b->vsize_bytes)
+            return a->vsize_bytes > b->vsize_bytes;
+        break;
+    case FOSSIL_SQUID_PROC_SORT_THREADS:
+        if (a->threads != b->threads)
+            return a->threads > b->threads;
+        break;
+    case FOSSIL_SQUID_PROC_SORT_PID:
+    default:
+        break;
+    }
+    return a->pid < b->pid;
+}
+
+/* restore the heap below i; the root of every subtree is its worst entry */
+static void squid_proc_heap_down(const fossil_squid_proc_t *procs, fossil_squid_proc_sort_t key,
+                                 uint32_t *heap, size_t n, size_t i)
+{
+    uint32_t e = heap[i];
+    for (;;)
+    {
+        size_t c = 2 * i + 1;
+        if (c >= n)
+            break;
+        if (c + 1 < n && squid_proc_ahead(&procs[heap[c]], &procs[heap[c + 1]], key))
+            ++c;
+        if (!squid_proc_ahead(&procs[e], &procs[heap[c]], key))
+            break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = e;
+}
+
+size_t fossil_squid_proc_select(const fossil_squid_proc_t *procs, size_t count, fossil_squid_proc_sort_t key,
+                                size_t limit, fossil_squid_proc_keep_fn keep, void *ctx, uint32_t *out)
+{
+    if (!procs || !out || count == 0)
+        return 0;
+    if (limit == 0 || limit > count)
+        limit = count;
+
+    size_t n = 0;
+    if (key == FOSSIL_SQUID_PROC_SORT_PID)
+    {
+        for (size_t i = 0; i < count && n < limit; ++i)
+        {
+            if (!keep || keep(&procs[i], ctx))
+                out[n++] = (uint32_t)i;
+        }
+        return n;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (keep && !keep(&procs[i], ctx))
+            continue;
+        if (n < limit)
+        {
+            // sift up from the new leaf
+            size_t j = n++;
+            while (j > 0)
+            {
+                size_t up = (j - 1) / 2;
+                if (!squid_proc_ahead(&procs[out[up]], &procs[i], key))
+                    break;
+                out[j] = out[up];
+                j = up;
+            }
+            out[j] = (uint32_t)i;
+        }
+        else if (squid_proc_ahead(&procs[i], &procs[out[0]], key))
+        {
+            out[0] = (uint32_t)i;
+            squid_proc_heap_down(procs, key, out, n, 0);
+        }
+    }
+
+    // pop the worst to the back until the heap is empty, leaving out best first
+    for (size_t m = n; m > 1; --m)
+    {
+        uint32_t worst = out[0];
+        out[0] = out[m - 1];
+        out[m - 1] = worst;
+        squid_proc_heap_down(procs, key, out, m - 1, 0);
+    }
+    return n;
+}
+
+int fossil_squid_proc_sort_parse(const char *name, fossil_squid_proc_sort_t *key)
+{
+    static const struct {
+        const char *name;
+        fossil_squid_proc_sort_t key;
+    } keys[] = {
+        {"pid", FOSSIL_SQUID_PROC_SORT_PID},
+        {"cpu", FOSSIL_SQUID_PROC_SORT_CPU},
+        {"mem", FOSSIL_SQUID_PROC_SORT_MEM},
+        {"vmem", FOSSIL_SQUID_PROC_SORT_VMEM},
+        {"threads", FOSSIL_SQUID_PROC_SORT_THREADS},
+    };
+    if (!name || !key)
+        return -1;
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i)
+    {
+        if (strcmp(name, keys[i].name) == 0)
+        {
+            *key = keys[i].key;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int fossil_squid_proc_sampler_init(fossil_squid_proc_sampler_t *s)
+{
+    if (!s)
+        return -1;
+    memset(s, 0, sizeof(*s));
+    s->cpu_count = squid_proc_cpu_count();
+
+#ifndef _WIN32
+    /*
+     * Hold at most half the soft descriptor limit as it stands, so the rest
+     * of the process keeps room; raising the limit is left to the caller.
+     */
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0)
+    {
+        if (rl.rlim_cur == RLIM_INFINITY)
+            s->fd_budget = 1u << 20;
+        else if (rl.rlim_cur / 2 > SQUID_PROC_FD_RESERVE)
+            s->fd_budget = (size_t)(rl.rlim_cur / 2);
+    }
+#endif
+    return 0;
+}
+
+void fossil_squid_proc_sampler_dispose(fossil_squid_proc_sampler_t *s)
+{
+    if (!s)
+        return;
+#if defined(__linux__)
+    for (size_t i = 0; i < s->count; ++i)
+    {
+        if (s->fds[i] >= 0)
+            close(s->fds[i]);
+    }
+#endif
+    if (s->procs)
+        fossil_sys_memory_free(s->procs);
+    if (s->spare)
+        fossil_sys_memory_free(s->spare);
+    if (s->fds)
+        fossil_sys_memory_free(s->fds);
+    if (s->spare_fds)
+        fossil_sys_memory_free(s->spare_fds);
+    if (s->pids)
+        fossil_sys_memory_free(s->pids);
+    memset(s, 0, sizeof(*s));
+}
+
+#if defined(__linux__)
+
+/*
+ * /proc/<pid>/stat is one line: "pid (comm) state ppid ..." where comm may
+ * itself hold spaces and parentheses, so the fields are counted from the
+ * last ')'. Field numbers follow proc(5).
+ */
+static bool squid_proc_parse_stat(const char *buf, uint64_t page_size, fossil_squid_proc_t *p)
+{
+    const char *open = strchr(buf, '(');
+    const char *shut = strrchr(buf, ')');
+    if (!open || !shut || shut < open || shut[1] != ' ')
+        return false;
+
+    squid_proc_set_name(p, open + 1, (size_t)(shut - open - 1));
+
+    const char *q = shut + 2;
+    p->state = *q ? *q++ : '?';
+
+    uint64_t utime = 0, stime = 0;
+    for (int field = 4; field <= 24; ++field)
+    {
+        char *end = NULL;
+        uint64_t v = strtoull(q, &end, 10);
+        if (end == q)
+            return false;
+        q = end;
+
+        switch (field)
+        {
+            case 4: p->ppid = (uint32_t)v; break;
+            case 14: utime = v; break;
+            case 15: stime = v; break;
+            case 20: p->threads = (uint32_t)v; break;
+            case 22: p->start_ticks = v; break;
+            case 23: p->vsize_bytes = v; break;
+            case 24: p->rss_bytes = v * page_size; break;
+            default: break;
+        }
+    }
+    p->cpu_ticks = utime + stime;
+    return true;
+}
+
+/*
+ * Read /proc/<pid>/stat through *fd when one is held, else open it and keep
+ * the descriptor if the budget allows. A held descriptor that fails belongs
+ * to a process that has exited, possibly with its pid reused, so the file is
+ * opened again once before giving up.
+ */
+static ssize_t squid_proc_read_stat(fossil_squid_proc_sampler_t *s, uint32_t pid, int *fd, char *buf, size_t len)
+{
+    if (*fd >= 0)
+    {
+        ssize_t n = pread(*fd, buf, len - 1, 0);
+        if (n > 0)
+        {
+            buf[n] = '\0';
+            return n;
+        }
+        close(*fd);
+        *fd = -1;
+        s->fds_open--;
+    }
+
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+    int f = open(path, O_RDONLY | O_CLOEXEC);
+    if (f < 0)
+        return -1;
+
+    ssize_t n = read(f, buf, len - 1);
+    if (n <= 0)
+    {
+        close(f);
+        return -1;
+    }
+    buf[n] = '\0';
+
+    if (s->fds_open < s->fd_budget)
+    {
+        *fd = f;
+        s->fds_open++;
+    }
+    else
+    {
+        close(f);
+    }
+    return n;
+}
+
+/* machine-wide busy and total ticks from the first line of /proc/stat */
+static bool squid_proc_read_cpu(uint64_t *busy, uint64_t *all)
+{
+    char buf[256];
+    int f = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    if (f < 0)
+        return false;
+    ssize_t n = read(f, buf, sizeof(buf) - 1);
+    close(f);
+    if (n <= 4 || strncmp(buf, "cpu ", 4) != 0)
+        return false;
+    buf[n] = '\0';
+
+    /* user nice system idle iowait irq softirq steal; guest time is already in user */
+    const char *q = buf + 4;
+    uint64_t total = 0, idle = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        char *end = NULL;
+        uint64_t v = strtoull(q, &end, 10);
+        if (end == q)
+            break;
+        q = end;
+        total += v;
+        if (i == 3 || i == 4)
+            idle += v;
+    }
+    *all = total;
+    *busy = total - idle;
+    return total > 0;
+}
+
+/* numeric entries of /proc, in ascending order, into a buffer grown as needed */
+static int squid_proc_list_pids(uint32_t **pids, size_t *capacity, size_t *count)
+{
+    DIR *dir = opendir("/proc");
+    if (!dir)
+        return -1;
+
+    size_t n = 0;
+    bool sorted = true;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        const char *d = ent->d_name;
+        if (*d < '1' || *d > '9')
+            continue;
+        uint32_t pid = 0;
+        while (*d >= '0' && *d <= '9')
+            pid = pid * 10u + (uint32_t)(*d++ - '0');
+        if (*d != '\0')
+            continue;
+
+        if (n == *capacity)
+        {
+            size_t cap = *capacity ? *capacity * 2 : 1024;
+            uint32_t *grown = (uint32_t *)fossil_sys_memory_realloc(*pids, cap * sizeof(*grown));
+            if (!grown)
+            {
+                closedir(dir);
+                return -1;
+            }
+            *pids = grown;
+            *capacity = cap;
+        }
+        if (n > 0 && pid < (*pids)[n - 1])
+            sorted = false;
+        (*pids)[n++] = pid;
+    }
+    closedir(dir);
+
+    /* the kernel lists pids in order, but nothing promises it */
+    if (!sorted)
+        qsort(*pids, n, sizeof(**pids), squid_proc_cmp_pid);
+    *count = n;
+    return 0;
+}
+
+int fossil_squid_proc_sample(fossil_squid_proc_sampler_t *s)
+{
+    if (!s)
+        return -1;
+
+    size_t listed = 0;
+    if (squid_proc_list_pids(&s->pids, &s->pid_capacity, &listed) != 0)
+        return -1;
+    /* the previous sample may be larger than this listing */
+    if (squid_proc_reserve(s, s->count > listed ? s->count : listed) != 0)
+        return -1;
+
+    uint64_t now = squid_proc_now_ns();
+    double dt = s->samples > 0 ? (double)(now - s->last_ns) / 1e9 : 0.0;
+    long hz = sysconf(_SC_CLK_TCK);
+    long page = sysconf(_SC_PAGESIZE);
+    double tick_scale = (dt > 0.0 && hz > 0) ? 100.0 / ((double)hz * dt) : 0.0;
+
+    const fossil_squid_proc_t *old = s->procs;
+    int *old_fds = s->fds;
+    size_t old_count = s->count;
+    fossil_squid_proc_t *cur = s->spare;
+    int *cur_fds = s->spare_fds;
+    size_t j = 0, k = 0;
+    char buf[SQUID_PROC_STAT_MAX];
+
+    /* both lists are pid-sorted, so matching against the previous sample is a merge */
+    for (size_t i = 0; i < listed; ++i)
+    {
+        uint32_t pid = s->pids[i];
+        for (; j < old_count && old[j].pid < pid; ++j)
+        {
+            if (old_fds[j] >= 0)
+            {
+                close(old_fds[j]);
+                s->fds_open--;
+            }
+        }
+
+        int fd = -1;
+        const fossil_squid_proc_t *prev = NULL;
+        if (j < old_count && old[j].pid == pid)
+        {
+            fd = old_fds[j];
+            prev = &old[j++];
+        }
+
+        if (squid_proc_read_stat(s, pid, &fd, buf, sizeof(buf)) < 0)
+            continue;
+
+        fossil_squid_proc_t *p = &cur[k];
+        memset(p, 0, sizeof(*p));
+        p->pid = pid;
+        if (!squid_proc_parse_stat(buf, page > 0 ? (uint64_t)page : 4096u, p))
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+                s->fds_open--;
+            }
+            continue;
+        }
+
+        if (prev && prev->start_ticks == p->start_ticks)
+        {
+            if (p->cpu_ticks >= prev->cpu_ticks)
+                p->cpu_percent = (double)(p->cpu_ticks - prev->cpu_ticks) * tick_scale;
+            if (dt > 0.0)
+                p->rss_delta_bytes = (int64_t)p->rss_bytes - (int64_t)prev->rss_bytes;
+        }
+        cur_fds[k++] = fd;
+    }
+    for (; j < old_count; ++j)
+    {
+        if (old_fds[j] >= 0)
+        {
+            close(old_fds[j]);
+            s->fds_open--;
+        }
+    }
+
+    s->spare = s->procs;
+    s->spare_fds = s->fds;
+    s->procs = cur;
+    s->fds = cur_fds;
+    s->count = k;
+
+    uint64_t busy = 0, all = 0;
+    s->cpu_total_percent = 0.0;
+    if (squid_proc_read_cpu(&busy, &all))
+    {
+        if (s->samples > 0 && all > s->cpu_all && busy >= s->cpu_busy)
+            s->cpu_total_percent = (double)(busy - s->cpu_busy) * 100.0 / (double)(all - s->cpu_all);
+        s->cpu_busy = busy;
+        s->cpu_all = all;
+    }
+
+    uint64_t self = squid_proc_self_ns();
+    s->self_cpu_percent = (s->samples > 0 && now > s->last_ns && self >= s->self_ns)
+                              ? (double)(self - s->self_ns) * 100.0 / (double)(now - s->last_ns)
+                              : 0.0;
+    s->self_ns = self;
+    s->interval_s = dt;
+    s->last_ns = now;
+    s->samples++;
+    return 0;
+}
+
+/*
+ * One-shot collection. The pid list is shared read-only and workers claim
+ * SQUID_PROC_CHUNK entries at a time under a lock, which stays cold since a
+ * chunk is hundreds of syscalls. Entry i of the pid list always lands in
+ * procs[i]; a process that exits before it is read leaves pid 0 behind and
+ * is squeezed out afterwards.
+ */
+typedef struct {
+    fossil_squid_proc_table_t *table;
+    size_t count;             /* pids to read */
+    size_t next;              /* first unclaimed pid, under lock */
+    pthread_mutex_t lock;
+    int proc_fd;              /* /proc, so each open resolves one short path */
+    uint64_t page_size;
+} squid_proc_collect_t;
+
+static void squid_proc_collect_one(squid_proc_collect_t *c, size_t i, char *buf, size_t len)
+{
+    fossil_squid_proc_t *p = &c->table->procs[i];
+    uint32_t pid = c->table->pids[i];
+    memset(p, 0, sizeof(*p));
+
+    char rel[24];
+    snprintf(rel, sizeof(rel), "%u/stat", pid);
+    int f = openat(c->proc_fd, rel, O_RDONLY | O_CLOEXEC);
+    if (f < 0)
+        return;
+    ssize_t n = read(f, buf, len - 1);
+    close(f);
+    if (n <= 0)
+        return;
+    buf[n] = '\0';
+
+    if (!squid_proc_parse_stat(buf, c->page_size, p))
+        return;
+    p->pid = pid;
+}
+
+static void *squid_proc_collect_thread(void *arg)
+{
+    squid_proc_collect_t *c = (squid_proc_collect_t *)arg;
+    char buf[SQUID_PROC_STAT_MAX];
+
+    for (;;)
+    {
+        pthread_mutex_lock(&c->lock);
+        size_t begin = c->next;
+        size_t end = c->count - begin > SQUID_PROC_CHUNK ? begin + SQUID_PROC_CHUNK : c->count;
+        c->next = end;
+        pthread_mutex_unlock(&c->lock);
+
+        if (begin >= end)
+            break;
+        for (size_t i = begin; i < end; ++i)
+            squid_proc_collect_one(c, i, buf, sizeof(buf));
+    }
+    return NULL;
+}
+
+int fossil_squid_proc_collect(fossil_squid_proc_table_t *t, int threads)
+{
+    if (!t)
+        return -1;
+
+    t->taken_ns = squid_proc_now_ns();
+    size_t listed = 0;
+    if (squid_proc_list_pids(&t->pids, &t->pid_capacity, &listed) != 0 ||
+        squid_proc_table_reserve(t, listed) != 0)
+        return -1;
+
+    squid_proc_collect_t c;
+    memset(&c, 0, sizeof(c));
+    c.table = t;
+    c.count = listed;
+    c.proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (c.proc_fd < 0)
+        return -1;
+
+    long page = sysconf(_SC_PAGESIZE);
+    c.page_size = page > 0 ? (uint64_t)page : 4096u;
+
+    size_t workers = threads > 0 ? (size_t)threads : (size_t)squid_proc_cpu_count();
+    if (workers > SQUID_PROC_MAX_THREADS)
+        workers = SQUID_PROC_MAX_THREADS;
+    if (workers > listed / SQUID_PROC_PER_THREAD)
+        workers = listed / SQUID_PROC_PER_THREAD;
+    if (workers < 1)
+        workers = 1;
+
+    pthread_mutex_init(&c.lock, NULL);
+    pthread_t handles[SQUID_PROC_MAX_THREADS];
+    size_t started = 0;
+    for (size_t i = 1; i < workers; ++i)
+    {
+        if (pthread_create(&handles[started], NULL, squid_proc_collect_thread, &c) == 0)
+            started++;
+    }
+    /* the calling thread works too, so a failed create only costs speed */
+    squid_proc_collect_thread(&c);
+    for (size_t i = 0; i < started; ++i)
+        pthread_join(handles[i], NULL);
+    pthread_mutex_destroy(&c.lock);
+    close(c.proc_fd);
+
+    size_t k = 0;
+    for (size_t i = 0; i < listed; ++i)
+    {
+        if (t->procs[i].pid == 0)
+            continue;
+        if (k != i)
+            t->procs[k] = t->procs[i];
+        k++;
+    }
+    t->count = k;
+    return 0;
+}
+
+#else
+
+static int squid_proc_cmp_entry(const void *a, const void *b)
+{
+    return squid_proc_cmp_pid(&((const fossil_squid_proc_t *)a)->pid, &((const fossil_squid_proc_t *)b)->pid);
+}
+
+static void squid_proc_from_info(const fossil_sys_process_info_t *info, fossil_squid_proc_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->pid = info->pid;
+    p->ppid = info->ppid;
+    squid_proc_set_name(p, info->name, strnlen(info->name, sizeof(p->name) - 1));
+    p->state = '?';
+    p->threads = info->thread_count;
+    p->rss_bytes = info->memory_bytes;
+    p->vsize_bytes = info->virtual_memory_bytes;
+    p->cpu_percent = info->cpu_percent;
+}
+
+/* No /proc: take the platform list as it is and sort it by pid. */
+int fossil_squid_proc_collect(fossil_squid_proc_table_t *t, int threads)
+{
+    (void)threads;
+    if (!t)
+        return -1;
+    t->taken_ns = squid_proc_now_ns();
+
+    fossil_sys_process_list_t *plist = (fossil_sys_process_list_t *)fossil_sys_memory_calloc(1, sizeof(*plist));
+    if (!plist)
+        return -1;
+    if (fossil_sys_process_list(plist) != 0 || squid_proc_table_reserve(t, plist->count) != 0)
+    {
+        fossil_sys_memory_free(plist);
+        return -1;
+    }
+    for (size_t i = 0; i < plist->count; ++i)
+        squid_proc_from_info(&plist->list[i], &t->procs[i]);
+    t->count = plist->count;
+    fossil_sys_memory_free(plist);
+    qsort(t->procs, t->count, sizeof(*t->procs), squid_proc_cmp_entry);
+    return 0;
+}
+
+/* No /proc: take the platform list as it is and derive the memory deltas. */
+int fossil_squid_proc_sample(fossil_squid_proc_sampler_t *s)
+{
+    if (!s)
+        return -1;
+
+    fossil_sys_process_list_t *plist = (fossil_sys_process_list_t *)fossil_sys_memory_calloc(1, sizeof(*plist));
+    if (!plist)
+        return -1;
+    if (fossil_sys_process_list(plist) != 0 || squid_proc_reserve(s, plist->count) != 0)
+    {
+        fossil_sys_memory_free(plist);
+        return -1;
+    }
+
+    uint64_t now = squid_proc_now_ns();
+    double dt = s->samples > 0 ? (double)(now - s->last_ns) / 1e9 : 0.0;
+    fossil_squid_proc_t *cur = s->spare;
+    for (size_t i = 0; i < plist->count; ++i)
+    {
+        squid_proc_from_info(&plist->list[i], &cur[i]);
+        s->spare_fds[i] = -1;
+    }
+    size_t count = plist->count;
+    fossil_sys_memory_free(plist);
+    qsort(cur, count, sizeof(*cur), squid_proc_cmp_entry);
+
+    for (size_t i = 0, j = 0; i < count && dt > 0.0; ++i)
+    {
+        while (j < s->count && s->procs[j].pid < cur[i].pid)
+            ++j;
+        if (j < s->count && s->procs[j].pid == cur[i].pid)
+            cur[i].rss_delta_bytes = (int64_t)cur[i].rss_bytes - (int64_t)s->procs[j].rss_bytes;
+    }
+
+    int *cur_fds = s->spare_fds;
+    s->spare = s->procs;
+    s->spare_fds = s->fds;
+    s->procs = cur;
+    s->fds = cur_fds;
+    s->count = count;
+
+    uint64_t self = squid_proc_self_ns();
+    s->self_cpu_percent = (s->samples > 0 && now > s->last_ns && self >= s->self_ns)
+                              ? (double)(self - s->self_ns) * 100.0 / (double)(now - s->last_ns)
+                              : 0.0;
+    s->self_ns = self;
+    s->interval_s = dt;
+    s->last_ns = now;
+    s->samples++;
+    return 0;
+}
+
+#endif
@@ -23,6 +23,8 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/code/commands.h"
+#include "fossil/code/probe.h"
+#include "fossil/code/json.h"
 
 /* simple port range parser: "start-end" */
 static void squid_parse_ports(const char *range, int *start, int *end)
@@ -54,11 +56,99 @@ static const char *squid_service_name(int port)
     }
 }
 
+/* the engine reads banners without blocking, but a silent port still holds its slot this long */
+#define SQUID_SCAN_BANNER_MAX_MS 250
+#define SQUID_SCAN_BANNER_BYTES 256
+
+/*
+ * Banner text safe for a terminal: the trailing line break is dropped and any
+ * other control byte becomes '?', so a service cannot send escape sequences.
+ */
+static void squid_scan_printable(const char *banner, char *out, size_t cap)
+{
+    size_t n = strnlen(banner, cap - 1);
+    while (n > 0 && (banner[n - 1] == '\n' || banner[n - 1] == '\r'))
+        --n;
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned char c = (unsigned char)banner[i];
+        out[i] = (c < 0x20 || c == 0x7f) ? '?' : (char)c;
+    }
+    out[n] = '\0';
+}
+
+/* one port result, as a text line or an element of the "ports" array */
+static void squid_scan_report(fossil_squid_json_t *json, int port, const char *state,
+                              bool service, const char *banner)
+{
+    bool open = strcmp(state, "open") == 0;
+
+    if (json)
+    {
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_int(json, "port", port);
+        fossil_squid_json_field_string(json, "state", state);
+        if (open && service)
+            fossil_squid_json_field_string(json, "service", squid_service_name(port));
+        if (open && banner)
+            fossil_squid_json_field_string(json, "banner", banner);
+        fossil_squid_json_object_end(json);
+        return;
+    }
+
+    printf("%s %d\n", state, port);
+    if (open && service)
+        printf("  service: %s\n", squid_service_name(port));
+    if (open && banner)
+    {
+        char text[SQUID_SCAN_BANNER_BYTES];
+        squid_scan_printable(banner, text, sizeof(text));
+        printf("  banner: %s\n", text);
+    }
+}
+
+/* UDP "scan": attempt send, one port at a time */
+static int squid_scan_udp(const fossil_net_address_t *base_addr, int start, int end,
+                          bool service, bool open_only, fossil_squid_json_t *json, int *closed_count)
+{
+    int open_count = 0;
+
+    for (int port = start; port <= end; ++port)
+    {
+        fossil_net_socket_t sock;
+        memset(&sock, 0, sizeof(sock));
+
+        if (fossil_net_socket_create(&sock, "udp", base_addr->family) != 0)
+            continue;
+
+        uint32_t sent = 0;
+        char dummy = 0;
+        int rc = fossil_net_socket_send(&sock, &dummy, 1, &sent);
+
+        if (rc == 0)
+        {
+            open_count++;
+            squid_scan_report(json, port, "open", service, NULL);
+        }
+        else
+        {
+            (*closed_count)++;
+            if (!open_only)
+                squid_scan_report(json, port, "closed", false, NULL);
+        }
+
+        fossil_net_socket_close(&sock);
+    }
+
+    return open_count;
+}
+
 int fossil_squid_scan(
     ccstring host,
     ccstring ports,
     int top_n,
     int timeout_ms,
+    int concurrency,
     bool tcp,
     bool udp,
     bool service,
@@ -75,6 +165,9 @@ int fossil_squid_scan(
     if (timeout_ms <= 0)
         timeout_ms = 1000;
 
+    if (concurrency <= 0)
+        concurrency = 1024;
+
     fossil_net_address_t base_addr;
     memset(&base_addr, 0, sizeof(base_addr));
 
@@ -89,89 +182,130 @@ int fossil_squid_scan(
     if (top_n > 0)
     {
         start = 1;
-        end = top_n;
+        end = top_n > 65535 ? 65535 : top_n;
     }
     else
     {
         squid_parse_ports(ports, &start, &end);
     }
 
-    if (!json)
+    if (end < start)
+    {
+        fprintf(stderr, "scan: empty port range %d-%d\n", start, end);
+        return -1;
+    }
+
+    fossil_squid_json_t doc;
+    fossil_squid_json_t *out = json ? &doc : NULL;
+    if (out)
+    {
+        fossil_squid_json_init(out);
+        fossil_squid_json_object_begin(out);
+        fossil_squid_json_field_string(out, "host", host);
+        fossil_squid_json_field_string(out, "ip", base_addr.ip);
+        fossil_squid_json_field_string(out, "protocol", tcp ? "tcp" : "udp");
+        fossil_squid_json_key(out, "ports");
+        fossil_squid_json_array_begin(out);
+    }
+    else
+    {
         printf("SCAN %s (%s)\n", host, base_addr.ip);
+    }
 
     int open_count = 0;
+    int closed_count = 0;
+    int filtered_count = 0;
 
-    for (int port = start; port <= end; ++port)
+    if (!tcp)
     {
-        fossil_net_socket_t sock;
-        memset(&sock, 0, sizeof(sock));
-
-        fossil_net_address_t addr = base_addr;
-        addr.port = (uint16_t)port;
-
-        int rc = -1;
+        open_count = squid_scan_udp(&base_addr, start, end, service, open_only, out, &closed_count);
+    }
+    else
+    {
+        size_t count = (size_t)(end - start + 1);
+        fossil_squid_probe_t *probes =
+            (fossil_squid_probe_t *)fossil_sys_memory_calloc(count, sizeof(fossil_squid_probe_t));
+        char *banners = banner ? (char *)fossil_sys_memory_calloc(count, SQUID_SCAN_BANNER_BYTES) : NULL;
 
-        if (tcp)
+        if (!probes || (banner && !banners))
         {
-            if (fossil_net_socket_create(&sock, "tcp", base_addr.family) != 0)
-                continue;
-
-            fossil_net_socket_set_blocking(&sock, true);
-
-            rc = fossil_net_socket_connect(&sock, &addr);
+            fossil_sys_memory_free(probes);
+            fossil_sys_memory_free(banners);
+            if (out)
+                fossil_squid_json_dispose(out);
+            fprintf(stderr, "scan: out of memory\n");
+            return -1;
         }
-        else if (udp)
+
+        for (size_t i = 0; i < count; ++i)
         {
-            if (fossil_net_socket_create(&sock, "udp", base_addr.family) != 0)
-                continue;
+            probes[i].ip = base_addr.ip;
+            probes[i].port = (uint16_t)(start + (int)i);
+            if (banners)
+            {
+                probes[i].banner = banners + i * SQUID_SCAN_BANNER_BYTES;
+                probes[i].banner_cap = SQUID_SCAN_BANNER_BYTES;
+            }
+        }
 
-            /* UDP "scan": attempt send */
-            uint32_t sent = 0;
-            char dummy = 0;
+        fossil_squid_probe_opts_t opts;
+        opts.concurrency = concurrency;
+        opts.timeout_ms = timeout_ms;
+        opts.banner_ms = timeout_ms < SQUID_SCAN_BANNER_MAX_MS ? timeout_ms : SQUID_SCAN_BANNER_MAX_MS;
 
-            rc = fossil_net_socket_send(&sock, &dummy, 1, &sent);
+        if (fossil_squid_probe_run(probes, count, &opts, NULL, NULL) != 0)
+        {
+            fossil_sys_memory_free(probes);
+            fossil_sys_memory_free(banners);
+            if (out)
+                fossil_squid_json_dispose(out);
+            fprintf(stderr, "scan: probe engine failed to start\n");
+            return -1;
         }
 
-        if (rc == 0)
+        /* report in port order regardless of completion order */
+        for (size_t i = 0; i < count; ++i)
         {
-            open_count++;
-
-            if (!open_only && !json)
-                printf("open %d\n", port);
-
-            if (service && !json)
-                printf("  service: %s\n", squid_service_name(port));
+            int port = probes[i].port;
 
-            if (banner && tcp)
+            if (probes[i].status == FOSSIL_SQUID_PROBE_OPEN)
             {
-                char buf[256];
-                uint32_t recvd = 0;
-
-                if (fossil_net_socket_receive(&sock, buf, sizeof(buf) - 1, &recvd) == 0 && recvd > 0)
-                {
-                    buf[recvd] = '\0';
-                    if (!json)
-                        printf("  banner: %s\n", buf);
-                }
+                open_count++;
+                squid_scan_report(out, port, "open", service, probes[i].banner_len > 0 ? probes[i].banner : NULL);
+            }
+            else if (probes[i].status == FOSSIL_SQUID_PROBE_TIMEOUT)
+            {
+                /* no answer before the deadline: dropped, not refused */
+                filtered_count++;
+                if (!open_only)
+                    squid_scan_report(out, port, "filtered", false, NULL);
+            }
+            else
+            {
+                closed_count++;
+                if (!open_only)
+                    squid_scan_report(out, port, "closed", false, NULL);
             }
-        }
-        else
-        {
-            if (!open_only && !json)
-                printf("closed %d\n", port);
         }
 
-        fossil_net_socket_close(&sock);
+        fossil_sys_memory_free(probes);
+        fossil_sys_memory_free(banners);
     }
 
-    if (json)
+    if (out)
     {
-        printf("{\"host\":\"%s\",\"open_ports\":%d}\n",
-               host, open_count);
+        fossil_squid_json_array_end(out);
+        fossil_squid_json_field_int(out, "open_ports", open_count);
+        fossil_squid_json_field_int(out, "closed_ports", closed_count);
+        fossil_squid_json_field_int(out, "filtered_ports", filtered_count);
+        fossil_squid_json_object_end(out);
+        fossil_squid_json_flush(out);
+        fossil_squid_json_dispose(out);
     }
     else
     {
-        printf("\nscan complete: %d open ports\n", open_count);
+        printf("\nscan complete: %d open, %d closed, %d filtered\n",
+               open_count, closed_count, filtered_count);
     }
 
     return 0;
@@ -0,0 +1,264 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/code/task.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+/*=============================================================================
+SQUID DEADLINE TASKS
+=============================================================================*/
+
+typedef struct {
+    fossil_squid_tasks_t *tasks;
+    fossil_squid_task_fn fn;
+    void *data;
+    int rc;
+    bool done;
+} squid_task_t;
+
+struct fossil_squid_tasks_s {
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE cond;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+    int refs;
+    size_t count;
+    size_t capacity;
+    squid_task_t *items;
+};
+
+uint64_t fossil_squid_tasks_now_ms(void)
+{
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+#endif
+}
+
+static void squid_tasks_lock(fossil_squid_tasks_t *tasks)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_lock(&tasks->lock);
+#endif
+}
+
+static void squid_tasks_unlock(fossil_squid_tasks_t *tasks)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_unlock(&tasks->lock);
+#endif
+}
+
+/* wait for a state change or the absolute deadline; caller holds the lock */
+static void squid_tasks_wait_until(fossil_squid_tasks_t *tasks, uint64_t deadline_ms)
+{
+    uint64_t now = fossil_squid_tasks_now_ms();
+    if (now >= deadline_ms)
+        return;
+#ifdef _WIN32
+    SleepConditionVariableCS(&tasks->cond, &tasks->lock, (DWORD)(deadline_ms - now));
+#elif defined(__APPLE__)
+    /* no monotonic condition clock here; wait relative to now, the caller re-checks */
+    struct timespec ts;
+    ts.tv_sec = (time_t)((deadline_ms - now) / 1000ULL);
+    ts.tv_nsec = (long)(((deadline_ms - now) % 1000ULL) * 1000000ULL);
+    pthread_cond_timedwait_relative_np(&tasks->cond, &tasks->lock, &ts);
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline_ms / 1000ULL);
+    ts.tv_nsec = (long)((deadline_ms % 1000ULL) * 1000000ULL);
+    pthread_cond_timedwait(&tasks->cond, &tasks->lock, &ts);
+#endif
+}
+
+static void squid_tasks_free(fossil_squid_tasks_t *tasks)
+{
+    for (size_t i = 0; i < tasks->count; ++i)
+        fossil_sys_memory_free(tasks->items[i].data);
+#ifdef _WIN32
+    DeleteCriticalSection(&tasks->lock);
+#else
+    pthread_cond_destroy(&tasks->cond);
+    pthread_mutex_destroy(&tasks->lock);
+#endif
+    fossil_sys_memory_free(tasks->items);
+    fossil_sys_memory_free(tasks);
+}
+
+fossil_squid_tasks_t *fossil_squid_tasks_create(size_t capacity)
+{
+    fossil_squid_tasks_t *tasks = (fossil_squid_tasks_t *)fossil_sys_memory_calloc(1, sizeof(fossil_squid_tasks_t));
+    if (!tasks)
+        return NULL;
+
+    tasks->items = (squid_task_t *)fossil_sys_memory_calloc(capacity ? capacity : 1, sizeof(squid_task_t));
+    if (!tasks->items) {
+        fossil_sys_memory_free(tasks);
+        return NULL;
+    }
+
+#ifdef _WIN32
+    InitializeCriticalSection(&tasks->lock);
+    InitializeConditionVariable(&tasks->cond);
+#else
+    pthread_mutex_init(&tasks->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    /* deadlines are on the monotonic clock, so the condition must be too */
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&tasks->cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+    tasks->refs = 1;
+    tasks->capacity = capacity;
+    return tasks;
+}
+
+void *fossil_squid_tasks_add(fossil_squid_tasks_t *tasks, fossil_squid_task_fn fn, size_t size)
+{
+    if (!tasks || !fn || tasks->count >= tasks->capacity)
+        return NULL;
+
+    void *data = fossil_sys_memory_calloc(1, size ? size : 1);
+    if (!data)
+        return NULL;
+
+    squid_task_t *task = &tasks->items[tasks->count++];
+    task->tasks = tasks;
+    task->fn = fn;
+    task->data = data;
+    return data;
+}
+
+size_t fossil_squid_tasks_count(const fossil_squid_tasks_t *tasks)
+{
+    return tasks ? tasks->count : 0;
+}
+
+void fossil_squid_tasks_release(fossil_squid_tasks_t *tasks)
+{
+    if (!tasks)
+        return;
+
+    squid_tasks_lock(tasks);
+    bool last = --tasks->refs == 0;
+    squid_tasks_unlock(tasks);
+
+    if (last)
+        squid_tasks_free(tasks);
+}
+
+static void squid_tasks_run(squid_task_t *task)
+{
+    int rc = task->fn(task->data);
+    fossil_squid_tasks_t *tasks = task->tasks;
+
+    squid_tasks_lock(tasks);
+    task->rc = rc;
+    task->done = true;
+#ifdef _WIN32
+    WakeAllConditionVariable(&tasks->cond);
+#else
+    pthread_cond_broadcast(&tasks->cond);
+#endif
+    squid_tasks_unlock(tasks);
+
+    fossil_squid_tasks_release(tasks);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI squid_tasks_worker(LPVOID arg)
+{
+    squid_tasks_run((squid_task_t *)arg);
+    return 0;
+}
+#else
+static void *squid_tasks_worker(void *arg)
+{
+    squid_tasks_run((squid_task_t *)arg);
+    return NULL;
+}
+#endif
+
+void fossil_squid_tasks_start(fossil_squid_tasks_t *tasks, size_t index)
+{
+    if (!tasks || index >= tasks->count)
+        return;
+
+    squid_task_t *task = &tasks->items[index];
+    squid_tasks_lock(tasks);
+    tasks->refs++;
+    squid_tasks_unlock(tasks);
+
+#ifdef _WIN32
+    HANDLE thread = CreateThread(NULL, 0, squid_tasks_worker, task, 0, NULL);
+    if (thread) {
+        CloseHandle(thread);
+        return;
+    }
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, squid_tasks_worker, task) == 0) {
+        pthread_detach(thread);
+        return;
+    }
+#endif
+
+    /* no thread available: run inline rather than drop the task */
+    squid_tasks_run(task);
+}
+
+bool fossil_squid_tasks_wait(fossil_squid_tasks_t *tasks, size_t index, uint64_t deadline_ms, int *rc)
+{
+    if (!tasks || index >= tasks->count)
+        return false;
+
+    squid_task_t *task = &tasks->items[index];
+    squid_tasks_lock(tasks);
+    while (!task->done && fossil_squid_tasks_now_ms() < deadline_ms)
+        squid_tasks_wait_until(tasks, deadline_ms);
+    bool done = task->done;
+    if (done && rc)
+        *rc = task->rc;
+    squid_tasks_unlock(tasks);
+    return done;
+}
@@ -23,6 +23,735 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/code/commands.h"
+#include "fossil/code/json.h"
+#include "fossil/code/task.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
+
+/*=============================================================================
+SQUID THIS: SECTION PRINTERS
+=============================================================================*/
+
+static void squid_this_print_system(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_system_t *sysinfo = (const fossil_sys_hostinfo_system_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "system");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "os_name", sysinfo->os_name);
+        fossil_squid_json_field_string(json, "os_version", sysinfo->os_version);
+        fossil_squid_json_field_string(json, "kernel_version", sysinfo->kernel_version);
+        fossil_squid_json_field_string(json, "hostname", sysinfo->hostname);
+        fossil_squid_json_field_string(json, "username", sysinfo->username);
+        fossil_squid_json_field_string(json, "domain_name", sysinfo->domain_name);
+        fossil_squid_json_field_string(json, "machine_type", sysinfo->machine_type);
+        fossil_squid_json_field_string(json, "platform", sysinfo->platform);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}System:{reset}\n  OS: {green}%s %s{reset}\n  Kernel: {yellow}%s{reset}\n  Hostname: {magenta}%s{reset}\n  User: {blue}%s{reset}\n  Domain: {cyan}%s{reset}\n  Machine: {yellow}%s{reset}\n  Platform: {green}%s{reset}\n",
+            sysinfo->os_name, sysinfo->os_version, sysinfo->kernel_version, sysinfo->hostname,
+            sysinfo->username, sysinfo->domain_name, sysinfo->machine_type, sysinfo->platform);
+    }
+}
+
+static void squid_this_print_architecture(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_architecture_t *archinfo = (const fossil_sys_hostinfo_architecture_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "architecture");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "architecture", archinfo->architecture);
+        fossil_squid_json_field_string(json, "cpu", archinfo->cpu);
+        fossil_squid_json_field_string(json, "cpu_cores", archinfo->cpu_cores);
+        fossil_squid_json_field_string(json, "cpu_threads", archinfo->cpu_threads);
+        fossil_squid_json_field_string(json, "cpu_frequency", archinfo->cpu_frequency);
+        fossil_squid_json_field_string(json, "cpu_architecture", archinfo->cpu_architecture);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Architecture:{reset}\n  Arch: {green}%s{reset}\n  CPU: {yellow}%s{reset}\n  Cores: {magenta}%s{reset}\n  Threads: {blue}%s{reset}\n  Frequency: {cyan}%s{reset}\n  CPU Arch: {green}%s{reset}\n",
+            archinfo->architecture, archinfo->cpu, archinfo->cpu_cores, archinfo->cpu_threads,
+            archinfo->cpu_frequency, archinfo->cpu_architecture);
+    }
+}
+
+static void squid_this_print_memory(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_memory_t *meminfo = (const fossil_sys_hostinfo_memory_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "memory");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_uint(json, "total", meminfo->total_memory);
+        fossil_squid_json_field_uint(json, "free", meminfo->free_memory);
+        fossil_squid_json_field_uint(json, "used", meminfo->used_memory);
+        fossil_squid_json_field_uint(json, "available", meminfo->available_memory);
+        fossil_squid_json_field_uint(json, "swap_total", meminfo->total_swap);
+        fossil_squid_json_field_uint(json, "swap_free", meminfo->free_swap);
+        fossil_squid_json_field_uint(json, "swap_used", meminfo->used_swap);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Memory:{reset}\n  Total: {green}%llu{reset}\n  Free: {yellow}%llu{reset}\n  Used: {red}%llu{reset}\n  Available: {blue}%llu{reset}\n  Swap Total: {magenta}%llu{reset}\n  Swap Free: {cyan}%llu{reset}\n  Swap Used: {red}%llu{reset}\n",
+            (unsigned long long)meminfo->total_memory, (unsigned long long)meminfo->free_memory,
+            (unsigned long long)meminfo->used_memory, (unsigned long long)meminfo->available_memory,
+            (unsigned long long)meminfo->total_swap, (unsigned long long)meminfo->free_swap,
+            (unsigned long long)meminfo->used_swap);
+    }
+}
+
+static void squid_this_print_endianness(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_endianness_t *endianinfo = (const fossil_sys_hostinfo_endianness_t *)in;
+
+    if (json) {
+        fossil_squid_json_field_string(json, "endianness", endianinfo->is_little_endian ? "little" : "big");
+    } else {
+        fossil_io_printf("{bold,cyan}Endianness:{reset} {yellow}%s-endian{reset}\n", endianinfo->is_little_endian ? "Little" : "Big");
+    }
+}
+
+static void squid_this_print_power(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_power_t *powerinfo = (const fossil_sys_hostinfo_power_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "power");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_int(json, "on_ac", powerinfo->on_ac_power);
+        fossil_squid_json_field_int(json, "battery_present", powerinfo->battery_present);
+        fossil_squid_json_field_int(json, "charging", powerinfo->battery_charging);
+        fossil_squid_json_field_int(json, "percent", powerinfo->battery_percentage);
+        fossil_squid_json_field_int(json, "seconds_left", powerinfo->battery_seconds_left);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Power:{reset}\n  AC Power: {green}%s{reset}\n  Battery Present: {yellow}%s{reset}\n  Charging: {blue}%s{reset}\n  Battery %%: {magenta}%d{reset}\n  Time Left: {cyan}%d sec{reset}\n",
+            powerinfo->on_ac_power ? "Yes" : "No",
+            powerinfo->battery_present ? "Yes" : "No",
+            powerinfo->battery_charging ? "Yes" : "No",
+            powerinfo->battery_percentage,
+            powerinfo->battery_seconds_left);
+    }
+}
+
+static void squid_this_print_cpu(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_cpu_t *cpuinfo = (const fossil_sys_hostinfo_cpu_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "cpu");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "model", cpuinfo->model);
+        fossil_squid_json_field_string(json, "vendor", cpuinfo->vendor);
+        fossil_squid_json_field_int(json, "cores", cpuinfo->cores);
+        fossil_squid_json_field_int(json, "threads", cpuinfo->threads);
+        fossil_squid_json_field_double(json, "frequency_ghz", cpuinfo->frequency_ghz, 2);
+        fossil_squid_json_field_string(json, "features", cpuinfo->features);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}CPU:{reset}\n  Model: {green}%s{reset}\n  Vendor: {yellow}%s{reset}\n  Cores: {magenta}%d{reset}\n  Threads: {blue}%d{reset}\n  Frequency: {cyan}%.2f GHz{reset}\n  Features: {red}%s{reset}\n",
+            cpuinfo->model, cpuinfo->vendor, cpuinfo->cores, cpuinfo->threads, cpuinfo->frequency_ghz, cpuinfo->features);
+    }
+}
+
+static void squid_this_print_gpu(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_gpu_t *gpuinfo = (const fossil_sys_hostinfo_gpu_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "gpu");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "name", gpuinfo->name);
+        fossil_squid_json_field_string(json, "vendor", gpuinfo->vendor);
+        fossil_squid_json_field_string(json, "driver_version", gpuinfo->driver_version);
+        fossil_squid_json_field_uint(json, "memory_total", gpuinfo->memory_total);
+        fossil_squid_json_field_uint(json, "memory_free", gpuinfo->memory_free);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}GPU:{reset}\n  Name: {green}%s{reset}\n  Vendor: {yellow}%s{reset}\n  Driver: {blue}%s{reset}\n  Memory Total: {magenta}%llu{reset}\n  Memory Free: {cyan}%llu{reset}\n",
+            gpuinfo->name, gpuinfo->vendor, gpuinfo->driver_version,
+            (unsigned long long)gpuinfo->memory_total, (unsigned long long)gpuinfo->memory_free);
+    }
+}
+
+static void squid_this_print_storage(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_storage_t *storageinfo = (const fossil_sys_hostinfo_storage_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "storage");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "device", storageinfo->device_name);
+        fossil_squid_json_field_string(json, "mount", storageinfo->mount_point);
+        fossil_squid_json_field_uint(json, "total", storageinfo->total_space);
+        fossil_squid_json_field_uint(json, "free", storageinfo->free_space);
+        fossil_squid_json_field_uint(json, "used", storageinfo->used_space);
+        fossil_squid_json_field_string(json, "fs_type", storageinfo->filesystem_type);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Storage:{reset}\n  Device: {green}%s{reset}\n  Mount: {yellow}%s{reset}\n  Total: {magenta}%llu{reset}\n  Free: {blue}%llu{reset}\n  Used: {red}%llu{reset}\n  FS: {cyan}%s{reset}\n",
+            storageinfo->device_name, storageinfo->mount_point,
+            (unsigned long long)storageinfo->total_space, (unsigned long long)storageinfo->free_space,
+            (unsigned long long)storageinfo->used_space, storageinfo->filesystem_type);
+    }
+}
+
+static void squid_this_print_environment(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_environment_t *envinfo = (const fossil_sys_hostinfo_environment_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "environment");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "shell", envinfo->shell);
+        fossil_squid_json_field_string(json, "home", envinfo->home_dir);
+        fossil_squid_json_field_string(json, "lang", envinfo->lang);
+        fossil_squid_json_field_string(json, "path", envinfo->path);
+        fossil_squid_json_field_string(json, "term", envinfo->_term);
+        fossil_squid_json_field_string(json, "user", envinfo->user);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Environment:{reset}\n  Shell: {green}%s{reset}\n  Home: {yellow}%s{reset}\n  Lang: {magenta}%s{reset}\n  Path: {blue}%s{reset}\n  Term: {cyan}%s{reset}\n  User: {red}%s{reset}\n",
+            envinfo->shell, envinfo->home_dir, envinfo->lang, envinfo->path, envinfo->_term, envinfo->user);
+    }
+}
+
+static void squid_this_print_virtualization(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_virtualization_t *virtinfo = (const fossil_sys_hostinfo_virtualization_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "virtualization");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_int(json, "is_vm", virtinfo->is_virtual_machine);
+        fossil_squid_json_field_int(json, "is_container", virtinfo->is_container);
+        fossil_squid_json_field_string(json, "hypervisor", virtinfo->hypervisor);
+        fossil_squid_json_field_string(json, "container_type", virtinfo->container_type);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Virtualization:{reset}\n  VM: {green}%s{reset}\n  Container: {yellow}%s{reset}\n  Hypervisor: {magenta}%s{reset}\n  Container Type: {blue}%s{reset}\n",
+            virtinfo->is_virtual_machine ? "Yes" : "No",
+            virtinfo->is_container ? "Yes" : "No",
+            virtinfo->hypervisor, virtinfo->container_type);
+    }
+}
+
+static void squid_this_print_uptime(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_uptime_t *uptimeinfo = (const fossil_sys_hostinfo_uptime_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "uptime");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_uint(json, "seconds", uptimeinfo->uptime_seconds);
+        fossil_squid_json_field_uint(json, "boot_time", uptimeinfo->boot_time_epoch);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Uptime:{reset}\n  Seconds: {green}%llu{reset}\n  Boot Time (epoch): {yellow}%llu{reset}\n",
+            (unsigned long long)uptimeinfo->uptime_seconds, (unsigned long long)uptimeinfo->boot_time_epoch);
+    }
+}
+
+static void squid_this_print_network(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_network_t *netinfo = (const fossil_sys_hostinfo_network_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "network");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "hostname", netinfo->hostname);
+        fossil_squid_json_field_string(json, "ip", netinfo->primary_ip);
+        fossil_squid_json_field_string(json, "mac", netinfo->mac_address);
+        fossil_squid_json_field_string(json, "interface", netinfo->interface_name);
+        fossil_squid_json_field_int(json, "up", netinfo->is_up);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Network:{reset}\n  Hostname: {green}%s{reset}\n  IP: {yellow}%s{reset}\n  MAC: {magenta}%s{reset}\n  Interface: {blue}%s{reset}\n  Up: {cyan}%s{reset}\n",
+            netinfo->hostname, netinfo->primary_ip, netinfo->mac_address, netinfo->interface_name,
+            netinfo->is_up ? "Yes" : "No");
+    }
+}
+
+static void squid_this_print_process(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_process_t *procinfo = (const fossil_sys_hostinfo_process_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "process");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_int(json, "pid", procinfo->pid);
+        fossil_squid_json_field_int(json, "ppid", procinfo->ppid);
+        fossil_squid_json_field_string(json, "exe", procinfo->executable_path);
+        fossil_squid_json_field_string(json, "cwd", procinfo->current_working_dir);
+        fossil_squid_json_field_string(json, "name", procinfo->process_name);
+        fossil_squid_json_field_int(json, "elevated", procinfo->is_elevated);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Process:{reset}\n  PID: {green}%d{reset}\n  PPID: {yellow}%d{reset}\n  Executable: {magenta}%s{reset}\n  CWD: {blue}%s{reset}\n  Name: {cyan}%s{reset}\n  Elevated: {red}%s{reset}\n",
+            procinfo->pid, procinfo->ppid, procinfo->executable_path, procinfo->current_working_dir,
+            procinfo->process_name, procinfo->is_elevated ? "Yes" : "No");
+    }
+}
+
+static void squid_this_print_limits(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_limits_t *liminfo = (const fossil_sys_hostinfo_limits_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "limits");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_uint(json, "max_open_files", liminfo->max_open_files);
+        fossil_squid_json_field_uint(json, "max_processes", liminfo->max_processes);
+        fossil_squid_json_field_uint(json, "page_size", liminfo->page_size);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Limits:{reset}\n  Max Open Files: {green}%llu{reset}\n  Max Processes: {yellow}%llu{reset}\n  Page Size: {magenta}%llu{reset}\n",
+            (unsigned long long)liminfo->max_open_files, (unsigned long long)liminfo->max_processes, (unsigned long long)liminfo->page_size);
+    }
+}
+
+static void squid_this_print_time(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_time_t *timeinfo = (const fossil_sys_hostinfo_time_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "time");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "timezone", timeinfo->timezone);
+        fossil_squid_json_field_int(json, "utc_offset", timeinfo->utc_offset_seconds);
+        fossil_squid_json_field_string(json, "locale", timeinfo->locale);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Time:{reset}\n  Timezone: {green}%s{reset}\n  UTC Offset: {yellow}%d{reset}\n  Locale: {magenta}%s{reset}\n",
+            timeinfo->timezone, timeinfo->utc_offset_seconds, timeinfo->locale);
+    }
+}
+
+static void squid_this_print_hardware(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_hardware_t *hwinfo = (const fossil_sys_hostinfo_hardware_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "hardware");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_string(json, "manufacturer", hwinfo->manufacturer);
+        fossil_squid_json_field_string(json, "product", hwinfo->product_name);
+        fossil_squid_json_field_string(json, "serial", hwinfo->serial_number);
+        fossil_squid_json_field_string(json, "bios", hwinfo->bios_version);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Hardware:{reset}\n  Manufacturer: {green}%s{reset}\n  Product: {yellow}%s{reset}\n  Serial: {magenta}%s{reset}\n  BIOS: {blue}%s{reset}\n",
+            hwinfo->manufacturer, hwinfo->product_name, hwinfo->serial_number, hwinfo->bios_version);
+    }
+}
+
+static void squid_this_print_display(const void *in, fossil_squid_json_t *json)
+{
+    const fossil_sys_hostinfo_display_t *dispinfo = (const fossil_sys_hostinfo_display_t *)in;
+
+    if (json) {
+        fossil_squid_json_key(json, "display");
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_int(json, "count", dispinfo->display_count);
+        fossil_squid_json_field_int(json, "width", dispinfo->primary_width);
+        fossil_squid_json_field_int(json, "height", dispinfo->primary_height);
+        fossil_squid_json_field_int(json, "refresh", dispinfo->primary_refresh_rate);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}Display:{reset}\n  Count: {green}%d{reset}\n  Primary: {yellow}%dx%d{reset} @ {magenta}%dHz{reset}\n",
+            dispinfo->display_count, dispinfo->primary_width, dispinfo->primary_height, dispinfo->primary_refresh_rate);
+    }
+}
+
+/*=============================================================================
+SQUID THIS: SECTION TABLE
+=============================================================================*/
+
+/* hostinfo getters all share one shape; adapt them to a common signature */
+#define SQUID_THIS_COLLECTOR(kind) \
+    static int squid_this_get_##kind(void *out) \
+    { \
+        return fossil_sys_hostinfo_get_##kind((fossil_sys_hostinfo_##kind##_t *)out); \
+    }
+
+SQUID_THIS_COLLECTOR(system)
+SQUID_THIS_COLLECTOR(architecture)
+SQUID_THIS_COLLECTOR(memory)
+SQUID_THIS_COLLECTOR(endianness)
+SQUID_THIS_COLLECTOR(power)
+SQUID_THIS_COLLECTOR(cpu)
+SQUID_THIS_COLLECTOR(gpu)
+SQUID_THIS_COLLECTOR(storage)
+SQUID_THIS_COLLECTOR(environment)
+SQUID_THIS_COLLECTOR(virtualization)
+SQUID_THIS_COLLECTOR(uptime)
+SQUID_THIS_COLLECTOR(network)
+SQUID_THIS_COLLECTOR(process)
+SQUID_THIS_COLLECTOR(limits)
+SQUID_THIS_COLLECTOR(time)
+SQUID_THIS_COLLECTOR(hardware)
+SQUID_THIS_COLLECTOR(display)
+
+static size_t squid_this_read_small(const char *path, char *buf, size_t len)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+    size_t n = fread(buf, 1, len - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+    return n;
+}
+
+/*
+ * Current clock speed of the first CPU in MHz, from cpufreq or else the
+ * first "cpu MHz" line of /proc/cpuinfo. It is the one fact in the cpu and
+ * architecture sections that moves, so a cache hit re-reads only this.
+ */
+static bool squid_this_cpu_mhz(double *mhz)
+{
+#if defined(__linux__)
+    char buf[4096];
+    if (squid_this_read_small("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", buf, sizeof(buf)) > 0) {
+        double khz = strtod(buf, NULL);
+        if (khz > 0.0) {
+            *mhz = khz / 1000.0;
+            return true;
+        }
+    }
+    if (squid_this_read_small("/proc/cpuinfo", buf, sizeof(buf)) > 0) {
+        const char *line = strstr(buf, "cpu MHz");
+        const char *colon = line ? strchr(line, ':') : NULL;
+        if (colon) {
+            double value = strtod(colon + 1, NULL);
+            if (value > 0.0) {
+                *mhz = value;
+                return true;
+            }
+        }
+    }
+#else
+    (void)mhz;
+#endif
+    return false;
+}
+
+static bool squid_this_refresh_cpu(void *data)
+{
+    double mhz;
+    if (!squid_this_cpu_mhz(&mhz))
+        return false;
+    ((fossil_sys_hostinfo_cpu_t *)data)->frequency_ghz = mhz / 1000.0;
+    return true;
+}
+
+static bool squid_this_refresh_architecture(void *data)
+{
+    double mhz;
+    if (!squid_this_cpu_mhz(&mhz))
+        return false;
+    fossil_sys_hostinfo_architecture_t *archinfo = (fossil_sys_hostinfo_architecture_t *)data;
+    snprintf(archinfo->cpu_frequency, sizeof(archinfo->cpu_frequency), "%.0f MHz", mhz);
+    return true;
+}
+
+/* cheap probes read a few files; slow ones walk devices or talk to drivers */
+#define SQUID_THIS_FAST_MS 2000
+#define SQUID_THIS_SLOW_MS 5000
+
+typedef struct {
+    const char *name;                 /* JSON key */
+    const char *title;                /* text heading */
+    size_t size;                      /* hostinfo struct size */
+    int deadline_ms;                  /* budget measured from run start */
+    const char *error_id;             /* reported when the getter fails */
+    bool cacheable;                   /* fixed for the life of a boot, apart from what refresh re-reads */
+    bool (*refresh)(void *data);      /* re-read the moving fields of a cached copy; false means probe again */
+    int (*collect)(void *out);
+    void (*print)(const void *in, fossil_squid_json_t *json);
+} squid_this_section_t;
+
+#define SQUID_THIS_SECTION(kind, key, title, deadline, error_id, cacheable, refresh) \
+    { key, title, sizeof(fossil_sys_hostinfo_##kind##_t), deadline, error_id, cacheable, refresh, \
+      squid_this_get_##kind, squid_this_print_##kind }
+
+/* canonical output order; cpu and architecture are cached with their clock speed read fresh each run */
+static const squid_this_section_t squid_this_sections[] = {
+    SQUID_THIS_SECTION(system, "system", "System", SQUID_THIS_FAST_MS, "system.internal", false, NULL),
+    SQUID_THIS_SECTION(architecture, "architecture", "Architecture", SQUID_THIS_FAST_MS, "system.internal", true, squid_this_refresh_architecture),
+    SQUID_THIS_SECTION(memory, "memory", "Memory", SQUID_THIS_FAST_MS, "memory.alloc", false, NULL),
+    SQUID_THIS_SECTION(endianness, "endianness", "Endianness", SQUID_THIS_FAST_MS, "encoding.endianness", true, NULL),
+    SQUID_THIS_SECTION(power, "power", "Power", SQUID_THIS_FAST_MS, "resource.exhausted", false, NULL),
+    SQUID_THIS_SECTION(cpu, "cpu", "CPU", SQUID_THIS_FAST_MS, "cpu.overflow", true, squid_this_refresh_cpu),
+    SQUID_THIS_SECTION(gpu, "gpu", "GPU", SQUID_THIS_SLOW_MS, "resource.exhausted", false, NULL),
+    SQUID_THIS_SECTION(storage, "storage", "Storage", SQUID_THIS_SLOW_MS, "fs.not_found", false, NULL),
+    SQUID_THIS_SECTION(environment, "environment", "Environment", SQUID_THIS_FAST_MS, "config.env", false, NULL),
+    SQUID_THIS_SECTION(virtualization, "virtualization", "Virtualization", SQUID_THIS_SLOW_MS, "system.unsupported", false, NULL),
+    SQUID_THIS_SECTION(uptime, "uptime", "Uptime", SQUID_THIS_FAST_MS, "time.clock", false, NULL),
+    SQUID_THIS_SECTION(network, "network", "Network", SQUID_THIS_SLOW_MS, "network.unreachable", false, NULL),
+    SQUID_THIS_SECTION(process, "process", "Process", SQUID_THIS_FAST_MS, "process.spawn", false, NULL),
+    SQUID_THIS_SECTION(limits, "limits", "Limits", SQUID_THIS_FAST_MS, "resource.limit", false, NULL),
+    SQUID_THIS_SECTION(time, "time", "Time", SQUID_THIS_FAST_MS, "time.clock", false, NULL),
+    SQUID_THIS_SECTION(hardware, "hardware", "Hardware", SQUID_THIS_SLOW_MS, "hardware.unsupported", true, NULL),
+    SQUID_THIS_SECTION(display, "display", "Display", SQUID_THIS_SLOW_MS, "ui.render", false, NULL)
+};
+
+#define SQUID_THIS_SECTION_COUNT (sizeof(squid_this_sections) / sizeof(squid_this_sections[0]))
+
+/*=============================================================================
+SQUID THIS: STATIC FACT CACHE
+=============================================================================*/
+
+/*
+ * Cacheable sections are written to $XDG_CACHE_HOME/squid/this.cache as raw
+ * hostinfo structs. The header pins the kernel boot id and a hash of the DMI
+ * and CPU modaliases, so a reboot or hardware swap invalidates it; the struct
+ * sizes pin the library layout. Only Linux has a boot id, elsewhere the cache
+ * is simply never used.
+ */
+#define SQUID_THIS_CACHE_MAGIC 0x43545153u /* "SQTC" */
+#define SQUID_THIS_CACHE_VERSION 3u
+#define SQUID_THIS_CACHE_MAX_BYTES 65536
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;        /* hash of cacheable struct sizes */
+    uint32_t count;         /* records that follow */
+    char boot_id[40];
+    uint64_t hardware;      /* hash of DMI and CPU modaliases */
+} squid_this_cache_header_t;
+
+typedef struct {
+    uint32_t index;         /* position in squid_this_sections */
+    uint32_t size;
+} squid_this_cache_record_t;
+
+static uint64_t squid_this_fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static bool squid_this_cache_key(squid_this_cache_header_t *key)
+{
+    memset(key, 0, sizeof(*key));
+#if defined(__linux__)
+    char buf[1024];
+    size_t n = squid_this_read_small("/proc/sys/kernel/random/boot_id", buf, sizeof(buf));
+    if (n < 32)
+        return false;
+    memcpy(key->boot_id, buf, n < sizeof(key->boot_id) - 1 ? n : sizeof(key->boot_id) - 1);
+
+    uint64_t h = 14695981039346656037ULL;
+    n = squid_this_read_small("/sys/class/dmi/id/modalias", buf, sizeof(buf));
+    h = squid_this_fnv1a(h, buf, n);
+    n = squid_this_read_small("/sys/devices/system/cpu/modalias", buf, sizeof(buf));
+    h = squid_this_fnv1a(h, buf, n);
+    key->hardware = h;
+
+    uint64_t layout = 14695981039346656037ULL;
+    for (size_t i = 0; i < SQUID_THIS_SECTION_COUNT; ++i) {
+        if (!squid_this_sections[i].cacheable)
+            continue;
+        uint32_t size = (uint32_t)squid_this_sections[i].size;
+        layout = squid_this_fnv1a(layout, &i, sizeof(i));
+        layout = squid_this_fnv1a(layout, &size, sizeof(size));
+    }
+    key->layout = (uint32_t)(layout ^ (layout >> 32));
+    key->magic = SQUID_THIS_CACHE_MAGIC;
+    key->version = SQUID_THIS_CACHE_VERSION;
+    return true;
+#else
+    return false;
+#endif
+}
+
+static bool squid_this_cache_path(char *buf, size_t len, bool create)
+{
+#ifdef _WIN32
+    (void)buf;
+    (void)len;
+    (void)create;
+    return false;
+#else
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+
+    if (xdg && xdg[0] == '/')
+        n = snprintf(buf, len, "%s/squid", xdg);
+    else if (home && home[0])
+        n = snprintf(buf, len, "%s/.cache/squid", home);
+    else
+        return false;
+    if (n < 0 || (size_t)n >= len)
+        return false;
+
+    if (create) {
+        /* parent first; both may already exist */
+        char *slash = strrchr(buf, '/');
+        if (slash && slash != buf) {
+            *slash = '\0';
+            mkdir(buf, 0700);
+            *slash = '/';
+        }
+        if (mkdir(buf, 0700) != 0 && errno != EEXIST)
+            return false;
+    }
+
+    size_t used = (size_t)n;
+    n = snprintf(buf + used, len - used, "/this.cache");
+    return n > 0 && (size_t)n < len - used;
+#endif
+}
+
+/*
+ * Read the cache file and point records[i] at each valid section payload.
+ * Returns the backing buffer (caller frees) or NULL when nothing usable.
+ */
+static char *squid_this_cache_read(const squid_this_cache_header_t *key,
+                                   const void *records[SQUID_THIS_SECTION_COUNT])
+{
+    char path[1024];
+    if (!squid_this_cache_path(path, sizeof(path), false))
+        return NULL;
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+
+#ifndef _WIN32
+    /* only trust a cache we wrote ourselves */
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || st.st_uid != geteuid() ||
+        st.st_size <= 0 || st.st_size > SQUID_THIS_CACHE_MAX_BYTES) {
+        fclose(fp);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+#else
+    size_t size = SQUID_THIS_CACHE_MAX_BYTES;
+#endif
+
+    char *blob = (char *)fossil_sys_memory_calloc(1, size);
+    size_t got = blob ? fread(blob, 1, size, fp) : 0;
+    fclose(fp);
+
+    squid_this_cache_header_t hdr;
+    if (got < sizeof(hdr)) {
+        fossil_sys_memory_free(blob);
+        return NULL;
+    }
+    memcpy(&hdr, blob, sizeof(hdr));
+    if (hdr.magic != key->magic || hdr.version != key->version || hdr.layout != key->layout ||
+        hdr.hardware != key->hardware || memcmp(hdr.boot_id, key->boot_id, sizeof(hdr.boot_id)) != 0) {
+        fossil_sys_memory_free(blob);
+        return NULL;
+    }
+
+    size_t off = sizeof(hdr);
+    for (uint32_t r = 0; r < hdr.count; ++r) {
+        squid_this_cache_record_t rec;
+        if (got - off < sizeof(rec))
+            break;
+        memcpy(&rec, blob + off, sizeof(rec));
+        off += sizeof(rec);
+        if (got - off < rec.size)
+            break;
+        if (rec.index < SQUID_THIS_SECTION_COUNT &&
+            squid_this_sections[rec.index].cacheable &&
+            squid_this_sections[rec.index].size == rec.size)
+            records[rec.index] = blob + off;
+        off += rec.size;
+    }
+    return blob;
+}
+
+static void squid_this_cache_write(const squid_this_cache_header_t *key,
+                                   const void *records[SQUID_THIS_SECTION_COUNT])
+{
+#ifdef _WIN32
+    (void)key;
+    (void)records;
+#else
+    char path[1024];
+    char tmp[1100];
+    if (!squid_this_cache_path(path, sizeof(path), true))
+        return;
+    snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long)getpid());
+
+    /* a leftover from a crashed run with our pid, or a planted link; unlink never follows it */
+    unlink(tmp);
+    FILE *fp = NULL;
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd >= 0)
+        fp = fdopen(fd, "wb");
+    if (!fp) {
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    squid_this_cache_header_t hdr = *key;
+    hdr.count = 0;
+    for (size_t i = 0; i < SQUID_THIS_SECTION_COUNT; ++i)
+        if (records[i])
+            hdr.count++;
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    for (size_t i = 0; ok && i < SQUID_THIS_SECTION_COUNT; ++i) {
+        if (!records[i])
+            continue;
+        squid_this_cache_record_t rec;
+        rec.index = (uint32_t)i;
+        rec.size = (uint32_t)squid_this_sections[i].size;
+        ok = fwrite(&rec, sizeof(rec), 1, fp) == 1 &&
+             fwrite(records[i], rec.size, 1, fp) == 1;
+    }
+
+    /* atomic replace so concurrent readers never see a torn file */
+    if (fclose(fp) != 0 || !ok || rename(tmp, path) != 0)
+        unlink(tmp);
+#endif
+}
+
+/*=============================================================================
+SQUID THIS: CONCURRENT COLLECTION
+=============================================================================*/
+
+/*
+ * Every selected section runs as its own deadline task, so a worker stuck in
+ * a hung probe is abandoned rather than holding up the profile.
+ */
+typedef struct {
+    const squid_this_section_t *section;
+    void *data;
+    bool cached;            /* served from the static fact cache */
+    bool ok;                /* printed successfully */
+} squid_this_job_t;
+
+static void squid_this_print_timeout(const squid_this_section_t *section, fossil_squid_json_t *json)
+{
+    if (json) {
+        fossil_squid_json_key(json, section->name);
+        fossil_squid_json_object_begin(json);
+        fossil_squid_json_field_bool(json, "timed_out", true);
+        fossil_squid_json_field_int(json, "deadline_ms", section->deadline_ms);
+        fossil_squid_json_object_end(json);
+    } else {
+        fossil_io_printf("{bold,cyan}%s:{reset} {red}timed out after %d ms{reset}\n",
+            section->title, section->deadline_ms);
+    }
+}
 
 int fossil_squid_this(bool system,
                          bool arch,
@@ -42,305 +771,113 @@ int fossil_squid_this(bool system,
                          bool hardware,
                          bool display,
                          bool all,
+                         bool no_cache,
                          bool json)
 {
-    int rc = 0;
+    const bool selected[SQUID_THIS_SECTION_COUNT] = {
+        system, arch, memory, endianness, power, cpu, gpu, storage, env,
+        virtualization, uptime, network, process, limits, time, hardware, display
+    };
 
-    if (all || system) {
-        fossil_sys_hostinfo_system_t sysinfo;
-        if (fossil_sys_hostinfo_get_system(&sysinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"system\":{\"os_name\":\"%s\",\"os_version\":\"%s\",\"kernel_version\":\"%s\",\"hostname\":\"%s\",\"username\":\"%s\",\"domain_name\":\"%s\",\"machine_type\":\"%s\",\"platform\":\"%s\"}}\n",
-                    sysinfo.os_name, sysinfo.os_version, sysinfo.kernel_version, sysinfo.hostname,
-                    sysinfo.username, sysinfo.domain_name, sysinfo.machine_type, sysinfo.platform);
-            } else {
-                fossil_io_printf("{bold,cyan}System:{reset}\n  OS: {green}%s %s{reset}\n  Kernel: {yellow}%s{reset}\n  Hostname: {magenta}%s{reset}\n  User: {blue}%s{reset}\n  Domain: {cyan}%s{reset}\n  Machine: {yellow}%s{reset}\n  Platform: {green}%s{reset}\n",
-                    sysinfo.os_name, sysinfo.os_version, sysinfo.kernel_version, sysinfo.hostname,
-                    sysinfo.username, sysinfo.domain_name, sysinfo.machine_type, sysinfo.platform);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "system.internal", fossil_io_what("system.internal"));
-        }
+    fossil_squid_tasks_t *tasks = fossil_squid_tasks_create(SQUID_THIS_SECTION_COUNT);
+    if (!tasks) {
+        fossil_io_error("[%s] %s", "memory.alloc", fossil_io_what("memory.alloc"));
+        return 1;
     }
 
-    if (all || arch) {
-        fossil_sys_hostinfo_architecture_t archinfo;
-        if (fossil_sys_hostinfo_get_architecture(&archinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"architecture\":{\"architecture\":\"%s\",\"cpu\":\"%s\",\"cpu_cores\":\"%s\",\"cpu_threads\":\"%s\",\"cpu_frequency\":\"%s\",\"cpu_architecture\":\"%s\"}}\n",
-                    archinfo.architecture, archinfo.cpu, archinfo.cpu_cores, archinfo.cpu_threads,
-                    archinfo.cpu_frequency, archinfo.cpu_architecture);
-            } else {
-                fossil_io_printf("{bold,cyan}Architecture:{reset}\n  Arch: {green}%s{reset}\n  CPU: {yellow}%s{reset}\n  Cores: {magenta}%s{reset}\n  Threads: {blue}%s{reset}\n  Frequency: {cyan}%s{reset}\n  CPU Arch: {green}%s{reset}\n",
-                    archinfo.architecture, archinfo.cpu, archinfo.cpu_cores, archinfo.cpu_threads,
-                    archinfo.cpu_frequency, archinfo.cpu_architecture);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "system.internal", fossil_io_what("system.internal"));
-        }
-    }
+    /* task i is jobs[i] */
+    squid_this_job_t jobs[SQUID_THIS_SECTION_COUNT];
+    size_t count = 0;
+    for (size_t i = 0; i < SQUID_THIS_SECTION_COUNT; ++i) {
+        if (!all && !selected[i])
+            continue;
 
-    if (all || memory) {
-        fossil_sys_hostinfo_memory_t meminfo;
-        if (fossil_sys_hostinfo_get_memory(&meminfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"memory\":{\"total\":%llu,\"free\":%llu,\"used\":%llu,\"available\":%llu,\"swap_total\":%llu,\"swap_free\":%llu,\"swap_used\":%llu}}\n",
-                    (unsigned long long)meminfo.total_memory, (unsigned long long)meminfo.free_memory,
-                    (unsigned long long)meminfo.used_memory, (unsigned long long)meminfo.available_memory,
-                    (unsigned long long)meminfo.total_swap, (unsigned long long)meminfo.free_swap,
-                    (unsigned long long)meminfo.used_swap);
-            } else {
-                fossil_io_printf("{bold,cyan}Memory:{reset}\n  Total: {green}%llu{reset}\n  Free: {yellow}%llu{reset}\n  Used: {red}%llu{reset}\n  Available: {blue}%llu{reset}\n  Swap Total: {magenta}%llu{reset}\n  Swap Free: {cyan}%llu{reset}\n  Swap Used: {red}%llu{reset}\n",
-                    (unsigned long long)meminfo.total_memory, (unsigned long long)meminfo.free_memory,
-                    (unsigned long long)meminfo.used_memory, (unsigned long long)meminfo.available_memory,
-                    (unsigned long long)meminfo.total_swap, (unsigned long long)meminfo.free_swap,
-                    (unsigned long long)meminfo.used_swap);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "memory.alloc", fossil_io_what("memory.alloc"));
-        }
+        squid_this_job_t *job = &jobs[count];
+        job->section = &squid_this_sections[i];
+        job->data = fossil_squid_tasks_add(tasks, job->section->collect, job->section->size);
+        if (!job->data)
+            continue;
+        job->cached = false;
+        job->ok = false;
+        count++;
     }
 
-    if (all || endianness) {
-        fossil_sys_hostinfo_endianness_t endianinfo;
-        if (fossil_sys_hostinfo_get_endianness(&endianinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"endianness\":\"%s\"}\n", endianinfo.is_little_endian ? "little" : "big");
-            } else {
-                fossil_io_printf("{bold,cyan}Endianness:{reset} {yellow}%s-endian{reset}\n", endianinfo.is_little_endian ? "Little" : "Big");
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "encoding.endianness", fossil_io_what("encoding.endianness"));
-        }
-    }
-
-    if (all || power) {
-        fossil_sys_hostinfo_power_t powerinfo;
-        if (fossil_sys_hostinfo_get_power(&powerinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"power\":{\"on_ac\":%d,\"battery_present\":%d,\"charging\":%d,\"percent\":%d,\"seconds_left\":%d}}\n",
-                    powerinfo.on_ac_power, powerinfo.battery_present, powerinfo.battery_charging,
-                    powerinfo.battery_percentage, powerinfo.battery_seconds_left);
-            } else {
-                fossil_io_printf("{bold,cyan}Power:{reset}\n  AC Power: {green}%s{reset}\n  Battery Present: {yellow}%s{reset}\n  Charging: {blue}%s{reset}\n  Battery %%: {magenta}%d{reset}\n  Time Left: {cyan}%d sec{reset}\n",
-                    powerinfo.on_ac_power ? "Yes" : "No",
-                    powerinfo.battery_present ? "Yes" : "No",
-                    powerinfo.battery_charging ? "Yes" : "No",
-                    powerinfo.battery_percentage,
-                    powerinfo.battery_seconds_left);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "resource.exhausted", fossil_io_what("resource.exhausted"));
-        }
-    }
-
-    if (all || cpu) {
-        fossil_sys_hostinfo_cpu_t cpuinfo;
-        if (fossil_sys_hostinfo_get_cpu(&cpuinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"cpu\":{\"model\":\"%s\",\"vendor\":\"%s\",\"cores\":%d,\"threads\":%d,\"frequency_ghz\":%.2f,\"features\":\"%s\"}}\n",
-                    cpuinfo.model, cpuinfo.vendor, cpuinfo.cores, cpuinfo.threads, cpuinfo.frequency_ghz, cpuinfo.features);
-            } else {
-                fossil_io_printf("{bold,cyan}CPU:{reset}\n  Model: {green}%s{reset}\n  Vendor: {yellow}%s{reset}\n  Cores: {magenta}%d{reset}\n  Threads: {blue}%d{reset}\n  Frequency: {cyan}%.2f GHz{reset}\n  Features: {red}%s{reset}\n",
-                    cpuinfo.model, cpuinfo.vendor, cpuinfo.cores, cpuinfo.threads, cpuinfo.frequency_ghz, cpuinfo.features);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "cpu.overflow", fossil_io_what("cpu.overflow"));
-        }
-    }
+    /* static facts come from the boot-scoped cache when it is valid; --no-cache re-probes and refreshes it */
+    squid_this_cache_header_t key;
+    const void *records[SQUID_THIS_SECTION_COUNT] = {0};
+    bool cache = squid_this_cache_key(&key);
+    char *blob = (cache && !no_cache) ? squid_this_cache_read(&key, records) : NULL;
 
-    if (all || gpu) {
-        fossil_sys_hostinfo_gpu_t gpuinfo;
-        if (fossil_sys_hostinfo_get_gpu(&gpuinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"gpu\":{\"name\":\"%s\",\"vendor\":\"%s\",\"driver_version\":\"%s\",\"memory_total\":%llu,\"memory_free\":%llu}}\n",
-                    gpuinfo.name, gpuinfo.vendor, gpuinfo.driver_version,
-                    (unsigned long long)gpuinfo.memory_total, (unsigned long long)gpuinfo.memory_free);
-            } else {
-                fossil_io_printf("{bold,cyan}GPU:{reset}\n  Name: {green}%s{reset}\n  Vendor: {yellow}%s{reset}\n  Driver: {blue}%s{reset}\n  Memory Total: {magenta}%llu{reset}\n  Memory Free: {cyan}%llu{reset}\n",
-                    gpuinfo.name, gpuinfo.vendor, gpuinfo.driver_version,
-                    (unsigned long long)gpuinfo.memory_total, (unsigned long long)gpuinfo.memory_free);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "resource.exhausted", fossil_io_what("resource.exhausted"));
-        }
-    }
+    uint64_t started = fossil_squid_tasks_now_ms();
+    for (size_t i = 0; i < count; ++i) {
+        squid_this_job_t *job = &jobs[i];
+        size_t index = (size_t)(job->section - squid_this_sections);
 
-    if (all || storage) {
-        fossil_sys_hostinfo_storage_t storageinfo;
-        if (fossil_sys_hostinfo_get_storage(&storageinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"storage\":{\"device\":\"%s\",\"mount\":\"%s\",\"total\":%llu,\"free\":%llu,\"used\":%llu,\"fs_type\":\"%s\"}}\n",
-                    storageinfo.device_name, storageinfo.mount_point,
-                    (unsigned long long)storageinfo.total_space, (unsigned long long)storageinfo.free_space,
-                    (unsigned long long)storageinfo.used_space, storageinfo.filesystem_type);
-            } else {
-                fossil_io_printf("{bold,cyan}Storage:{reset}\n  Device: {green}%s{reset}\n  Mount: {yellow}%s{reset}\n  Total: {magenta}%llu{reset}\n  Free: {blue}%llu{reset}\n  Used: {red}%llu{reset}\n  FS: {cyan}%s{reset}\n",
-                    storageinfo.device_name, storageinfo.mount_point,
-                    (unsigned long long)storageinfo.total_space, (unsigned long long)storageinfo.free_space,
-                    (unsigned long long)storageinfo.used_space, storageinfo.filesystem_type);
+        if (records[index]) {
+            memcpy(job->data, records[index], job->section->size);
+            if (!job->section->refresh || job->section->refresh(job->data)) {
+                job->cached = true;
+                continue;
             }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "fs.not_found", fossil_io_what("fs.not_found"));
         }
+        fossil_squid_tasks_start(tasks, i);
     }
 
-    if (all || env) {
-        fossil_sys_hostinfo_environment_t envinfo;
-        if (fossil_sys_hostinfo_get_environment(&envinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"environment\":{\"shell\":\"%s\",\"home\":\"%s\",\"lang\":\"%s\",\"path\":\"%s\",\"term\":\"%s\",\"user\":\"%s\"}}\n",
-                    envinfo.shell, envinfo.home_dir, envinfo.lang, envinfo.path, envinfo._term, envinfo.user);
-            } else {
-                fossil_io_printf("{bold,cyan}Environment:{reset}\n  Shell: {green}%s{reset}\n  Home: {yellow}%s{reset}\n  Lang: {magenta}%s{reset}\n  Path: {blue}%s{reset}\n  Term: {cyan}%s{reset}\n  User: {red}%s{reset}\n",
-                    envinfo.shell, envinfo.home_dir, envinfo.lang, envinfo.path, envinfo._term, envinfo.user);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "config.env", fossil_io_what("config.env"));
-        }
-    }
-
-    if (all || virtualization) {
-        fossil_sys_hostinfo_virtualization_t virtinfo;
-        if (fossil_sys_hostinfo_get_virtualization(&virtinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"virtualization\":{\"is_vm\":%d,\"is_container\":%d,\"hypervisor\":\"%s\",\"container_type\":\"%s\"}}\n",
-                    virtinfo.is_virtual_machine, virtinfo.is_container, virtinfo.hypervisor, virtinfo.container_type);
-            } else {
-                fossil_io_printf("{bold,cyan}Virtualization:{reset}\n  VM: {green}%s{reset}\n  Container: {yellow}%s{reset}\n  Hypervisor: {magenta}%s{reset}\n  Container Type: {blue}%s{reset}\n",
-                    virtinfo.is_virtual_machine ? "Yes" : "No",
-                    virtinfo.is_container ? "Yes" : "No",
-                    virtinfo.hypervisor, virtinfo.container_type);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "system.unsupported", fossil_io_what("system.unsupported"));
-        }
+    /* one document for the whole profile */
+    fossil_squid_json_t doc;
+    fossil_squid_json_t *out = json ? &doc : NULL;
+    if (out) {
+        fossil_squid_json_init(out);
+        fossil_squid_json_object_begin(out);
     }
 
-    if (all || uptime) {
-        fossil_sys_hostinfo_uptime_t uptimeinfo;
-        if (fossil_sys_hostinfo_get_uptime(&uptimeinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"uptime\":{\"seconds\":%llu,\"boot_time\":%llu}}\n",
-                    (unsigned long long)uptimeinfo.uptime_seconds, (unsigned long long)uptimeinfo.boot_time_epoch);
-            } else {
-                fossil_io_printf("{bold,cyan}Uptime:{reset}\n  Seconds: {green}%llu{reset}\n  Boot Time (epoch): {yellow}%llu{reset}\n",
-                    (unsigned long long)uptimeinfo.uptime_seconds, (unsigned long long)uptimeinfo.boot_time_epoch);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "time.clock", fossil_io_what("time.clock"));
-        }
-    }
+    /* print in canonical order; each wait ends at its section's deadline on the tasks' monotonic clock */
+    int rc = 0;
+    for (size_t i = 0; i < count; ++i) {
+        squid_this_job_t *job = &jobs[i];
+        uint64_t deadline = started + (uint64_t)job->section->deadline_ms;
 
-    if (all || network) {
-        fossil_sys_hostinfo_network_t netinfo;
-        if (fossil_sys_hostinfo_get_network(&netinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"network\":{\"hostname\":\"%s\",\"ip\":\"%s\",\"mac\":\"%s\",\"interface\":\"%s\",\"up\":%d}}\n",
-                    netinfo.hostname, netinfo.primary_ip, netinfo.mac_address, netinfo.interface_name, netinfo.is_up);
-            } else {
-                fossil_io_printf("{bold,cyan}Network:{reset}\n  Hostname: {green}%s{reset}\n  IP: {yellow}%s{reset}\n  MAC: {magenta}%s{reset}\n  Interface: {blue}%s{reset}\n  Up: {cyan}%s{reset}\n",
-                    netinfo.hostname, netinfo.primary_ip, netinfo.mac_address, netinfo.interface_name,
-                    netinfo.is_up ? "Yes" : "No");
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "network.unreachable", fossil_io_what("network.unreachable"));
-        }
-    }
+        int job_rc = 0;
+        bool done = job->cached || fossil_squid_tasks_wait(tasks, i, deadline, &job_rc);
 
-    if (all || process) {
-        fossil_sys_hostinfo_process_t procinfo;
-        if (fossil_sys_hostinfo_get_process(&procinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"process\":{\"pid\":%d,\"ppid\":%d,\"exe\":\"%s\",\"cwd\":\"%s\",\"name\":\"%s\",\"elevated\":%d}}\n",
-                    procinfo.pid, procinfo.ppid, procinfo.executable_path, procinfo.current_working_dir,
-                    procinfo.process_name, procinfo.is_elevated);
-            } else {
-                fossil_io_printf("{bold,cyan}Process:{reset}\n  PID: {green}%d{reset}\n  PPID: {yellow}%d{reset}\n  Executable: {magenta}%s{reset}\n  CWD: {blue}%s{reset}\n  Name: {cyan}%s{reset}\n  Elevated: {red}%s{reset}\n",
-                    procinfo.pid, procinfo.ppid, procinfo.executable_path, procinfo.current_working_dir,
-                    procinfo.process_name, procinfo.is_elevated ? "Yes" : "No");
-            }
-        } else {
+        if (!done) {
             rc = 1;
-            fossil_io_error("[%s] %s", "process.spawn", fossil_io_what("process.spawn"));
-        }
-    }
-
-    if (all || limits) {
-        fossil_sys_hostinfo_limits_t liminfo;
-        if (fossil_sys_hostinfo_get_limits(&liminfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"limits\":{\"max_open_files\":%llu,\"max_processes\":%llu,\"page_size\":%llu}}\n",
-                    (unsigned long long)liminfo.max_open_files, (unsigned long long)liminfo.max_processes, (unsigned long long)liminfo.page_size);
-            } else {
-                fossil_io_printf("{bold,cyan}Limits:{reset}\n  Max Open Files: {green}%llu{reset}\n  Max Processes: {yellow}%llu{reset}\n  Page Size: {magenta}%llu{reset}\n",
-                    (unsigned long long)liminfo.max_open_files, (unsigned long long)liminfo.max_processes, (unsigned long long)liminfo.page_size);
-            }
+            squid_this_print_timeout(job->section, out);
+        } else if (job_rc == 0) {
+            job->ok = true;
+            job->section->print(job->data, out);
         } else {
             rc = 1;
-            fossil_io_error("[%s] %s", "resource.limit", fossil_io_what("resource.limit"));
-        }
-    }
-
-    if (all || time) {
-        fossil_sys_hostinfo_time_t timeinfo;
-        if (fossil_sys_hostinfo_get_time(&timeinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"time\":{\"timezone\":\"%s\",\"utc_offset\":%d,\"locale\":\"%s\"}}\n",
-                    timeinfo.timezone, timeinfo.utc_offset_seconds, timeinfo.locale);
-            } else {
-                fossil_io_printf("{bold,cyan}Time:{reset}\n  Timezone: {green}%s{reset}\n  UTC Offset: {yellow}%d{reset}\n  Locale: {magenta}%s{reset}\n",
-                    timeinfo.timezone, timeinfo.utc_offset_seconds, timeinfo.locale);
+            fossil_io_error("[%s] %s", job->section->error_id, fossil_io_what(job->section->error_id));
+            if (out) {
+                fossil_squid_json_key(out, job->section->name);
+                fossil_squid_json_object_begin(out);
+                fossil_squid_json_field_string(out, "error", job->section->error_id);
+                fossil_squid_json_object_end(out);
             }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "time.clock", fossil_io_what("time.clock"));
         }
     }
 
-    if (all || hardware) {
-        fossil_sys_hostinfo_hardware_t hwinfo;
-        if (fossil_sys_hostinfo_get_hardware(&hwinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"hardware\":{\"manufacturer\":\"%s\",\"product\":\"%s\",\"serial\":\"%s\",\"bios\":\"%s\"}}\n",
-                    hwinfo.manufacturer, hwinfo.product_name, hwinfo.serial_number, hwinfo.bios_version);
-            } else {
-                fossil_io_printf("{bold,cyan}Hardware:{reset}\n  Manufacturer: {green}%s{reset}\n  Product: {yellow}%s{reset}\n  Serial: {magenta}%s{reset}\n  BIOS: {blue}%s{reset}\n",
-                    hwinfo.manufacturer, hwinfo.product_name, hwinfo.serial_number, hwinfo.bios_version);
-            }
-        } else {
+    if (out) {
+        fossil_squid_json_object_end(out);
+        if (fossil_squid_json_flush(out) != 0)
             rc = 1;
-            fossil_io_error("[%s] %s", "hardware.unsupported", fossil_io_what("hardware.unsupported"));
-        }
+        fossil_squid_json_dispose(out);
     }
 
-    if (all || display) {
-        fossil_sys_hostinfo_display_t dispinfo;
-        if (fossil_sys_hostinfo_get_display(&dispinfo) == 0) {
-            if (json) {
-                fossil_io_printf("{\"display\":{\"count\":%d,\"width\":%d,\"height\":%d,\"refresh\":%d}}\n",
-                    dispinfo.display_count, dispinfo.primary_width, dispinfo.primary_height, dispinfo.primary_refresh_rate);
-            } else {
-                fossil_io_printf("{bold,cyan}Display:{reset}\n  Count: {green}%d{reset}\n  Primary: {yellow}%dx%d{reset} @ {magenta}%dHz{reset}\n",
-                    dispinfo.display_count, dispinfo.primary_width, dispinfo.primary_height, dispinfo.primary_refresh_rate);
-            }
-        } else {
-            rc = 1;
-            fossil_io_error("[%s] %s", "ui.render", fossil_io_what("ui.render"));
+    /* refresh the cache if anything static was probed, keeping other entries */
+    bool refresh = false;
+    for (size_t i = 0; cache && i < count; ++i) {
+        squid_this_job_t *job = &jobs[i];
+        if (job->section->cacheable && job->ok && !job->cached) {
+            records[job->section - squid_this_sections] = job->data;
+            refresh = true;
         }
     }
+    if (refresh)
+        squid_this_cache_write(&key, records);
+    fossil_sys_memory_free(blob);
 
+    fossil_squid_tasks_release(tasks);
     return rc;
 }
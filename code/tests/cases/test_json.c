@@ -0,0 +1,117 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static fossil_squid_json_t json_doc;
+
+// Compare the writer buffer against an expected document
+static bool json_equals(const char *expected)
+{
+    size_t n = strlen(expected);
+    return json_doc.len == n && memcmp(json_doc.buf, expected, n) == 0;
+}
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_json_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_json_suite)
+{
+    fossil_squid_json_init(&json_doc);
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_json_suite)
+{
+    fossil_squid_json_dispose(&json_doc);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: Members and elements are comma separated at every level
+FOSSIL_TEST(c_test_json_nesting)
+{
+    fossil_squid_json_object_begin(&json_doc);
+    fossil_squid_json_field_int(&json_doc, "a", -1);
+    fossil_squid_json_key(&json_doc, "b");
+    fossil_squid_json_array_begin(&json_doc);
+    fossil_squid_json_uint(&json_doc, 1);
+    fossil_squid_json_bool(&json_doc, true);
+    fossil_squid_json_null(&json_doc);
+    fossil_squid_json_object_begin(&json_doc);
+    fossil_squid_json_object_end(&json_doc);
+    fossil_squid_json_array_end(&json_doc);
+    fossil_squid_json_field_double(&json_doc, "c", 1.5, 2);
+    fossil_squid_json_object_end(&json_doc);
+
+    ASSUME_ITS_TRUE(json_equals("{\"a\":-1,\"b\":[1,true,null,{}],\"c\":1.50}"));
+}
+
+// Test: Quotes, backslashes and control bytes are escaped
+FOSSIL_TEST(c_test_json_escaping)
+{
+    fossil_squid_json_object_begin(&json_doc);
+    fossil_squid_json_field_string(&json_doc, "path", "C:\\tmp\\\"x\"\n\t\x01");
+    fossil_squid_json_object_end(&json_doc);
+
+    ASSUME_ITS_TRUE(json_equals("{\"path\":\"C:\\\\tmp\\\\\\\"x\\\"\\n\\t\\u0001\"}"));
+}
+
+// Test: Valid UTF-8 passes through, malformed bytes are replaced
+FOSSIL_TEST(c_test_json_utf8)
+{
+    fossil_squid_json_array_begin(&json_doc);
+    fossil_squid_json_string(&json_doc, "caf\xc3\xa9");
+    fossil_squid_json_string(&json_doc, "bad\xff");
+    fossil_squid_json_array_end(&json_doc);
+
+    ASSUME_ITS_TRUE(json_equals("[\"caf\xc3\xa9\",\"bad\\ufffd\"]"));
+}
+
+// Test: An unbalanced document is refused at flush time
+FOSSIL_TEST(c_test_json_unbalanced)
+{
+    fossil_squid_json_object_begin(&json_doc);
+    fossil_squid_json_key(&json_doc, "open");
+    ASSUME_NOT_EQUAL_I32(0, fossil_squid_json_flush(&json_doc));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_json_tests)
+{
+    FOSSIL_TEST_ADD(c_json_suite, c_test_json_nesting);
+    FOSSIL_TEST_ADD(c_json_suite, c_test_json_escaping);
+    FOSSIL_TEST_ADD(c_json_suite, c_test_json_utf8);
+    FOSSIL_TEST_ADD(c_json_suite, c_test_json_unbalanced);
+
+    FOSSIL_TEST_REGISTER(c_json_suite);
+}
@@ -0,0 +1,106 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static fossil_squid_latency_t latency_hist;
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_latency_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_latency_suite)
+{
+    fossil_squid_latency_reset(&latency_hist);
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_latency_suite)
+{
+    // Teardown code here
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: Empty histogram summarizes to zero
+FOSSIL_TEST(c_test_latency_empty)
+{
+    fossil_squid_latency_summary_t st;
+    fossil_squid_latency_summarize(&latency_hist, &st);
+    ASSUME_ITS_TRUE(st.count == 0);
+    ASSUME_ITS_TRUE(fossil_squid_latency_percentile(&latency_hist, 99.0) == 0);
+}
+
+// Test: Percentiles stay within bucket precision of the exact value
+FOSSIL_TEST(c_test_latency_percentiles)
+{
+    // 1ms .. 1000ms in 1ms steps
+    for (uint64_t i = 1; i <= 1000; ++i)
+        fossil_squid_latency_record(&latency_hist, i * 1000000ULL);
+
+    fossil_squid_latency_summary_t st;
+    fossil_squid_latency_summarize(&latency_hist, &st);
+    ASSUME_ITS_TRUE(st.count == 1000);
+    ASSUME_ITS_TRUE(st.min_ms == 1.0);
+    ASSUME_ITS_TRUE(st.max_ms == 1000.0);
+    ASSUME_ITS_TRUE(fabs(st.mean_ms - 500.5) < 0.001);
+    ASSUME_ITS_TRUE(fabs(st.jitter_ms - 1.0) < 0.001);
+    ASSUME_ITS_TRUE(fabs(st.p50_ms - 500.0) < 500.0 * 0.04);
+    ASSUME_ITS_TRUE(fabs(st.p90_ms - 900.0) < 900.0 * 0.04);
+    ASSUME_ITS_TRUE(fabs(st.p99_ms - 990.0) < 990.0 * 0.04);
+    ASSUME_ITS_TRUE(st.p999_ms <= st.max_ms);
+}
+
+// Test: A single slow outlier shows up in the tail, not the median
+FOSSIL_TEST(c_test_latency_tail)
+{
+    for (int i = 0; i < 499; ++i)
+        fossil_squid_latency_record(&latency_hist, 2000000ULL);
+    fossil_squid_latency_record(&latency_hist, 3000000000ULL);
+
+    fossil_squid_latency_summary_t st;
+    fossil_squid_latency_summarize(&latency_hist, &st);
+    ASSUME_ITS_TRUE(fabs(st.p50_ms - 2.0) < 0.1);
+    ASSUME_ITS_TRUE(fabs(st.p99_ms - 2.0) < 0.1);
+    ASSUME_ITS_TRUE(st.p999_ms > 2.0);
+    ASSUME_ITS_TRUE(st.max_ms == 3000.0);
+    ASSUME_ITS_TRUE(st.stddev_ms > 0.0);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_latency_tests)
+{
+    FOSSIL_TEST_ADD(c_latency_suite, c_test_latency_empty);
+    FOSSIL_TEST_ADD(c_latency_suite, c_test_latency_percentiles);
+    FOSSIL_TEST_ADD(c_latency_suite, c_test_latency_tail);
+
+    FOSSIL_TEST_REGISTER(c_latency_suite);
+}
@@ -0,0 +1,241 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+#define PING_HOSTS_FILE "squid_ping_hosts.txt"
+
+static int ping_v4_fd = -1;
+static int ping_v6_fd = -1;
+static int ping_port = 0;
+
+// Listen on 127.0.0.1 and, where available, ::1 on the same port
+static void ping_listen(void)
+{
+#ifndef _WIN32
+    ping_v4_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (ping_v4_fd < 0)
+        return;
+
+    struct sockaddr_in v4;
+    memset(&v4, 0, sizeof(v4));
+    v4.sin_family = AF_INET;
+    v4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = (socklen_t)sizeof(v4);
+    if (bind(ping_v4_fd, (struct sockaddr *)&v4, len) != 0 || listen(ping_v4_fd, 16) != 0 ||
+        getsockname(ping_v4_fd, (struct sockaddr *)&v4, &len) != 0)
+    {
+        close(ping_v4_fd);
+        ping_v4_fd = -1;
+        return;
+    }
+    ping_port = ntohs(v4.sin_port);
+
+    ping_v6_fd = socket(AF_INET6, SOCK_STREAM, 0);
+    if (ping_v6_fd < 0)
+        return;
+
+    struct sockaddr_in6 v6;
+    memset(&v6, 0, sizeof(v6));
+    v6.sin6_family = AF_INET6;
+    v6.sin6_addr = in6addr_loopback;
+    v6.sin6_port = htons((uint16_t)ping_port);
+    if (bind(ping_v6_fd, (struct sockaddr *)&v6, (socklen_t)sizeof(v6)) != 0 || listen(ping_v6_fd, 16) != 0)
+    {
+        close(ping_v6_fd);
+        ping_v6_fd = -1;
+    }
+#endif
+}
+
+static int ping_run(ccstring const *hosts, int host_count, ccstring hosts_file, bool ipv4, bool ipv6)
+{
+    return fossil_squid_ping(hosts, host_count, hosts_file, 1, 1, 500, ipv4, ipv6, ping_port, true, false, false);
+}
+
+// A loopback port with nothing listening on it, or 0 if none could be found
+static int ping_closed_port(void)
+{
+#ifndef _WIN32
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return 0;
+    struct sockaddr_in v4;
+    memset(&v4, 0, sizeof(v4));
+    v4.sin_family = AF_INET;
+    v4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = (socklen_t)sizeof(v4);
+    int port = 0;
+    if (bind(fd, (struct sockaddr *)&v4, len) == 0 && getsockname(fd, (struct sockaddr *)&v4, &len) == 0)
+        port = ntohs(v4.sin_port);
+    close(fd);
+    return port;
+#else
+    return 0;
+#endif
+}
+
+static void ping_write_hosts(const char *text)
+{
+    FILE *fp = fopen(PING_HOSTS_FILE, "w");
+    if (fp)
+    {
+        fputs(text, fp);
+        fclose(fp);
+    }
+}
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_ping_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_ping_suite)
+{
+    ping_listen();
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_ping_suite)
+{
+#ifndef _WIN32
+    if (ping_v4_fd >= 0)
+        close(ping_v4_fd);
+    if (ping_v6_fd >= 0)
+        close(ping_v6_fd);
+#endif
+    ping_v4_fd = -1;
+    ping_v6_fd = -1;
+    ping_port = 0;
+    remove(PING_HOSTS_FILE);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: Several hosts are probed in one run and the listener answers
+FOSSIL_TEST(c_test_ping_multi_host)
+{
+    if (ping_v4_fd < 0)
+        return;
+
+    ccstring hosts[] = {"127.0.0.1", "127.0.0.1", "127.0.0.1"};
+    ASSUME_ITS_EQUAL_I32(0, ping_run(hosts, 3, NULL, false, false));
+}
+
+// Test: An IPv4 block expands to its hosts, one of which is the listener
+FOSSIL_TEST(c_test_ping_cidr_v4)
+{
+    if (ping_v4_fd < 0)
+        return;
+
+    ccstring hosts[] = {"127.0.0.0/30"};
+    ASSUME_ITS_EQUAL_I32(0, ping_run(hosts, 1, NULL, false, false));
+    ASSUME_ITS_EQUAL_I32(0, ping_run(hosts, 1, NULL, true, false));
+}
+
+// Test: An IPv6 block expands to its hosts, skipping the subnet-router address
+FOSSIL_TEST(c_test_ping_cidr_v6)
+{
+    if (ping_v6_fd < 0)
+        return;
+
+    ccstring hosts[] = {"::/126"};
+    ASSUME_ITS_EQUAL_I32(0, ping_run(hosts, 1, NULL, false, true));
+}
+
+// Test: A refused connection proves the host is up and is not counted as loss
+FOSSIL_TEST(c_test_ping_refused_reachable)
+{
+    int port = ping_closed_port();
+    if (port == 0)
+        return;
+
+    ccstring hosts[] = {"127.0.0.1"};
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_ping(hosts, 1, NULL, 2, 1, 500, false, false, port, true, false, false));
+}
+
+// Test: A forced family drops blocks of the other family
+FOSSIL_TEST(c_test_ping_cidr_family)
+{
+    ccstring v4[] = {"127.0.0.0/30"};
+    ccstring v6[] = {"::/126"};
+    ASSUME_NOT_EQUAL_I32(0, ping_run(v4, 1, NULL, false, true));
+    ASSUME_NOT_EQUAL_I32(0, ping_run(v6, 1, NULL, true, false));
+}
+
+// Test: Blocks larger than the limit and malformed prefixes yield no targets
+FOSSIL_TEST(c_test_ping_cidr_invalid)
+{
+    ccstring too_large[] = {"10.0.0.0/8"};
+    ccstring too_large_v6[] = {"fd00::/64"};
+    ASSUME_NOT_EQUAL_I32(0, ping_run(too_large, 1, NULL, false, false));
+    ASSUME_NOT_EQUAL_I32(0, ping_run(too_large_v6, 1, NULL, false, false));
+}
+
+// Test: A hosts file with comments, blanks and blocks is read line by line
+FOSSIL_TEST(c_test_ping_hosts_file)
+{
+    if (ping_v4_fd < 0)
+        return;
+
+    ping_write_hosts("# fleet\n\n   127.0.0.1   # loopback\n127.0.0.0/31\n");
+    ASSUME_ITS_EQUAL_I32(0, ping_run(NULL, 0, PING_HOSTS_FILE, false, false));
+
+    ping_write_hosts("# nothing but comments\n\n   \n");
+    ASSUME_NOT_EQUAL_I32(0, ping_run(NULL, 0, PING_HOSTS_FILE, false, false));
+}
+
+// Test: A missing hosts file and no hosts is rejected
+FOSSIL_TEST(c_test_ping_hosts_file_missing)
+{
+    ASSUME_NOT_EQUAL_I32(0, ping_run(NULL, 0, "squid_ping_no_such_file.txt", false, false));
+    ASSUME_NOT_EQUAL_I32(0, ping_run(NULL, 0, NULL, false, false));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_ping_tests)
+{
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_multi_host);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_cidr_v4);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_cidr_v6);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_refused_reachable);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_cidr_family);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_cidr_invalid);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_hosts_file);
+    FOSSIL_TEST_ADD(c_ping_suite, c_test_ping_hosts_file_missing);
+
+    FOSSIL_TEST_REGISTER(c_ping_suite);
+}
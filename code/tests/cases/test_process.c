@@ -0,0 +1,105 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Run the process command with only the listing options set
+static int process_run(bool show_all, ccstring name, int ppid_pid, bool tree, int subtree_pid,
+                       ccstring sort_key, int limit)
+{
+    return fossil_squid_process(show_all, 0, name, 0, 0, 0, 0, ppid_pid, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                NULL, NULL, false, 0, 0, tree, subtree_pid, sort_key, limit,
+                                NULL, NULL, false, false, true);
+}
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_process_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_process_suite)
+{
+    // Setup code here
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_process_suite)
+{
+    // Teardown code here
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: --sort and --limit are refused by views that cannot honour them
+FOSSIL_TEST(c_test_process_sort_limit_rejected)
+{
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, NULL, 0, true, 0, "mem", 0));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, NULL, 0, true, 0, NULL, 5));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, NULL, 0, false, 1, "cpu", 0));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, NULL, 0, false, 0, "mem", 0));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, NULL, 0, false, 0, NULL, 3));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, "squid", 1, false, 0, "mem", 0));
+    ASSUME_NOT_EQUAL_I32(0, process_run(true, NULL, 0, false, 0, NULL, -2));
+    ASSUME_NOT_EQUAL_I32(0, process_run(true, NULL, 0, false, 0, "size", 0));
+}
+
+// Test: --name and --match are refused by --top and the hierarchy views instead of being ignored
+FOSSIL_TEST(c_test_process_filter_rejected)
+{
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, "squid", 0, true, 0, NULL, 0));
+    ASSUME_NOT_EQUAL_I32(0, process_run(false, "squid", 0, false, 1, NULL, 0));
+    ASSUME_NOT_EQUAL_I32(0, fossil_squid_process(false, 0, "squid", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 NULL, NULL, true, 10, 1, false, 0, NULL, 0,
+                                                 NULL, NULL, false, false, true));
+    ASSUME_NOT_EQUAL_I32(0, fossil_squid_process(false, 0, NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 NULL, NULL, true, 10, 1, false, 0, NULL, 0,
+                                                 "squid*", NULL, false, false, true));
+    ASSUME_NOT_EQUAL_I32(0, fossil_squid_process(false, 0, NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 NULL, NULL, false, 0, 0, true, 0, NULL, 0,
+                                                 "squid*", NULL, false, false, true));
+}
+
+// Test: Listings still take --sort and --limit
+FOSSIL_TEST(c_test_process_sort_limit_listings)
+{
+    ASSUME_ITS_EQUAL_I32(0, process_run(true, NULL, 0, false, 0, "mem", 3));
+    ASSUME_ITS_EQUAL_I32(0, process_run(false, "squid", 0, false, 0, "cpu", 2));
+    ASSUME_ITS_EQUAL_I32(0, process_run(false, NULL, 0, true, 0, NULL, 0));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_process_tests)
+{
+    FOSSIL_TEST_ADD(c_process_suite, c_test_process_sort_limit_rejected);
+    FOSSIL_TEST_ADD(c_process_suite, c_test_process_filter_rejected);
+    FOSSIL_TEST_ADD(c_process_suite, c_test_process_sort_limit_listings);
+
+    FOSSIL_TEST_REGISTER(c_process_suite);
+}
@@ -0,0 +1,223 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+#include <ctype.h>
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Compile a pattern against the name field and test one name with it
+static int procmatch_name(const char *pattern, unsigned flags, const char *name)
+{
+    fossil_squid_proc_matcher_t m;
+    if (fossil_squid_proc_matcher_compile(&m, pattern, FOSSIL_SQUID_PROC_FIELD_NAME, flags) != 0)
+        return -1;
+    fossil_squid_proc_t p;
+    memset(&p, 0, sizeof(p));
+    p.pid = 1;
+    snprintf(p.name, sizeof(p.name), "%s", name);
+    int hit = fossil_squid_proc_matcher_test(&m, &p) ? 1 : 0;
+    fossil_squid_proc_matcher_dispose(&m);
+    return hit;
+}
+
+// Literal the matcher extracted for a pattern, or "" when it has none
+static bool procmatch_literal(const char *pattern, unsigned flags, const char *want)
+{
+    fossil_squid_proc_matcher_t m;
+    if (fossil_squid_proc_matcher_compile(&m, pattern, FOSSIL_SQUID_PROC_FIELD_NAME, flags) != 0)
+        return false;
+    bool same = m.literal_len == strlen(want) && memcmp(m.literal, want, m.literal_len) == 0;
+    fossil_squid_proc_matcher_dispose(&m);
+    return same;
+}
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_procmatch_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_procmatch_suite)
+{
+    // Setup code here
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_procmatch_suite)
+{
+    // Teardown code here
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: Globs match the whole name with *, ?, sets, ranges and escapes
+FOSSIL_TEST(c_test_procmatch_glob)
+{
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("nginx", 0, "nginx"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("nginx", 0, "nginx-worker"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("ngin*", 0, "nginx-worker"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("*work*", 0, "nginx-worker"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("ng?nx", 0, "nginx"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("ng?nx", 0, "ngnx"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("kworker/[0-9]*", 0, "kworker/3:1"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("kworker/[!0-9]*", 0, "kworker/3:1"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[]x]y", 0, "]y"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("a\\*b", 0, "a*b"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("a\\*b", 0, "axb"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("a[b", 0, "a[b"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("NGINX", FOSSIL_SQUID_PROC_MATCH_ICASE, "nginx"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[A-C]x", FOSSIL_SQUID_PROC_MATCH_ICASE, "bx"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("NGINX", 0, "nginx"));
+}
+
+// Test: POSIX classes, equivalence classes and collating symbols inside glob sets
+FOSSIL_TEST(c_test_procmatch_glob_posix_class)
+{
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[:alpha:]]x", 0, "ax"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("[[:alpha:]]x", 0, "7x"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[:digit:][:space:]]x", 0, " x"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[![:digit:]]x", 0, "ax"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("[![:digit:]]x", 0, "7x"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("*[[:upper:]]", FOSSIL_SQUID_PROC_MATCH_ICASE, "abc"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("*[[:upper:]]", 0, "abc"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[:xdigit:]_]*", 0, "_run"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("[[:nosuch:]]", 0, "a"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[=a=]]b", 0, "ab"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[.-.]a]b", 0, "-b"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[.a.]-c]x", 0, "bx"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[:alpha:]-]x", 0, "-x"));
+}
+
+// Test: Regular expressions with bracket classes are accepted where they match
+FOSSIL_TEST(c_test_procmatch_regex)
+{
+#ifndef _WIN32
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("[[:digit:]]x", FOSSIL_SQUID_PROC_MATCH_REGEX, "7x"));
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name("[[:digit:]]x", FOSSIL_SQUID_PROC_MATCH_REGEX, "ax"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("^ng(in|x)+$", FOSSIL_SQUID_PROC_MATCH_REGEX, "nginx"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("([[:alpha:]])worker", FOSSIL_SQUID_PROC_MATCH_REGEX, "x-aworker"));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("WORK", FOSSIL_SQUID_PROC_MATCH_REGEX | FOSSIL_SQUID_PROC_MATCH_ICASE, "worker"));
+    ASSUME_ITS_EQUAL_I32(-1, procmatch_name("(", FOSSIL_SQUID_PROC_MATCH_REGEX, "x"));
+#endif
+}
+
+// Test: The required literal is one every match contains, and never too much
+FOSSIL_TEST(c_test_procmatch_literal)
+{
+    ASSUME_ITS_TRUE(procmatch_literal("nginx", 0, "nginx"));
+    ASSUME_ITS_TRUE(procmatch_literal("*ng?worker*", 0, "worker"));
+    ASSUME_ITS_TRUE(procmatch_literal("[[:alpha:]]x", 0, "x"));
+    ASSUME_ITS_TRUE(procmatch_literal("ab[[=c=]]de", 0, "ab"));
+    ASSUME_ITS_TRUE(procmatch_literal("a\\*bc", 0, "a*bc"));
+    ASSUME_ITS_TRUE(procmatch_literal("a[b", 0, "a[b"));
+    ASSUME_ITS_TRUE(procmatch_literal("*", 0, ""));
+#ifndef _WIN32
+    ASSUME_ITS_TRUE(procmatch_literal("[[:digit:]]x", FOSSIL_SQUID_PROC_MATCH_REGEX, "x"));
+    ASSUME_ITS_TRUE(procmatch_literal("[]:]]x", FOSSIL_SQUID_PROC_MATCH_REGEX, "]x"));
+    ASSUME_ITS_TRUE(procmatch_literal("nginx-w?orker", FOSSIL_SQUID_PROC_MATCH_REGEX, "nginx-"));
+    ASSUME_ITS_TRUE(procmatch_literal("ab+cd", FOSSIL_SQUID_PROC_MATCH_REGEX, "ab"));
+    ASSUME_ITS_TRUE(procmatch_literal("(x[[:alpha:])]y)zz", FOSSIL_SQUID_PROC_MATCH_REGEX, "zz"));
+    ASSUME_ITS_TRUE(procmatch_literal("foo|bar", FOSSIL_SQUID_PROC_MATCH_REGEX, ""));
+#endif
+}
+
+// Test: The literal prefilter finds its text at every offset, on the vector path and the byte tail
+FOSSIL_TEST(c_test_procmatch_contains_offsets)
+{
+    // every byte distinct and no upper case, so a literal is only found where it was taken from
+    const char *name = "abcdefghijklmnopqrstuvwxyz0123456789!\"$%&'()+,-./:;<=>@^_`{|}~ ";
+    size_t n = strlen(name);
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_NAME_MAX - 1, (int)n);
+
+    static const size_t lengths[] = {1, 2, 3, 5, 16, 17, 33};
+    char pattern[FOSSIL_SQUID_PROC_NAME_MAX + 4];
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+    {
+        size_t m = lengths[l];
+        for (size_t at = 0; at + m <= n; ++at)
+        {
+            snprintf(pattern, sizeof(pattern), "*%.*s*", (int)m, name + at);
+            ASSUME_ITS_EQUAL_I32(1, procmatch_name(pattern, 0, name));
+
+            // same literal with its case flipped: found only when ignoring case
+            for (size_t i = 1; i <= m; ++i)
+            {
+                char c = pattern[i];
+                if (c >= 'a' && c <= 'z')
+                    pattern[i] = (char)(c - 32);
+                else if (c >= 'A' && c <= 'Z')
+                    pattern[i] = (char)(c + 32);
+            }
+            bool letters = false;
+            for (size_t i = 1; i <= m; ++i)
+                letters = letters || isalpha((unsigned char)pattern[i]);
+            ASSUME_ITS_EQUAL_I32(1, procmatch_name(pattern, FOSSIL_SQUID_PROC_MATCH_ICASE, name));
+            if (letters)
+                ASSUME_ITS_EQUAL_I32(0, procmatch_name(pattern, 0, name));
+
+            // first and last byte right, middle wrong: rejected by the full compare
+            if (m >= 3)
+            {
+                snprintf(pattern, sizeof(pattern), "*%.*s*", (int)m, name + at);
+                pattern[1 + m / 2] = '#';
+                ASSUME_ITS_EQUAL_I32(0, procmatch_name(pattern, 0, name));
+                ASSUME_ITS_EQUAL_I32(0, procmatch_name(pattern, FOSSIL_SQUID_PROC_MATCH_ICASE, name));
+            }
+        }
+    }
+
+    // a literal longer than the name, and one at the very end
+    snprintf(pattern, sizeof(pattern), "*%s#*", name);
+    ASSUME_ITS_EQUAL_I32(0, procmatch_name(pattern, 0, name));
+    ASSUME_ITS_EQUAL_I32(1, procmatch_name("*}~ ", 0, name));
+}
+
+// Test: Field names parse and unknown ones are refused
+FOSSIL_TEST(c_test_procmatch_field_parse)
+{
+    fossil_squid_proc_field_t field;
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_field_parse("any", &field));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_FIELD_ANY, field);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_field_parse("cmdline", &field));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_FIELD_CMDLINE, field);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_field_parse("argv", &field));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_procmatch_tests)
+{
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_glob);
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_glob_posix_class);
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_regex);
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_literal);
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_contains_offsets);
+    FOSSIL_TEST_ADD(c_procmatch_suite, c_test_procmatch_field_parse);
+
+    FOSSIL_TEST_REGISTER(c_procmatch_suite);
+}
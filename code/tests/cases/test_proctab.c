@@ -0,0 +1,601 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#endif
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+static const fossil_squid_proc_t *proctab_find(const fossil_squid_proc_t *procs, size_t count, uint32_t pid)
+{
+    for (size_t i = 0; i < count; ++i)
+        if (procs[i].pid == pid)
+            return &procs[i];
+    return NULL;
+}
+
+// Lay out a synthetic table: pid, ppid, and counters that make totals easy to check
+static void proctab_fake(fossil_squid_proc_t *procs, const uint32_t (*links)[2], size_t count)
+{
+    memset(procs, 0, count * sizeof(*procs));
+    for (size_t i = 0; i < count; ++i)
+    {
+        procs[i].pid = links[i][0];
+        procs[i].ppid = links[i][1];
+        procs[i].threads = links[i][0];
+        procs[i].rss_bytes = (uint64_t)links[i][0] * 100u;
+        procs[i].cpu_percent = (double)links[i][0];
+    }
+}
+
+// Reference ranking for the select tests, written out plainly for qsort
+static const fossil_squid_proc_t *proctab_ref_procs;
+static fossil_squid_proc_sort_t proctab_ref_key;
+
+static int proctab_ref_cmp_u64(uint64_t a, uint64_t b)
+{
+    return a > b ? -1 : a < b ? 1 : 0;
+}
+
+static int proctab_ref_cmp(const void *pa, const void *pb)
+{
+    const fossil_squid_proc_t *a = &proctab_ref_procs[*(const uint32_t *)pa];
+    const fossil_squid_proc_t *b = &proctab_ref_procs[*(const uint32_t *)pb];
+    int c = 0;
+    switch (proctab_ref_key)
+    {
+    case FOSSIL_SQUID_PROC_SORT_CPU:
+        c = a->cpu_percent > b->cpu_percent ? -1 : a->cpu_percent < b->cpu_percent ? 1 : 0;
+        if (c == 0)
+            c = proctab_ref_cmp_u64(a->rss_bytes, b->rss_bytes);
+        break;
+    case FOSSIL_SQUID_PROC_SORT_MEM:
+        c = proctab_ref_cmp_u64(a->rss_bytes, b->rss_bytes);
+        break;
+    case FOSSIL_SQUID_PROC_SORT_VMEM:
+        c = proctab_ref_cmp_u64(a->vsize_bytes, b->vsize_bytes);
+        break;
+    case FOSSIL_SQUID_PROC_SORT_THREADS:
+        c = proctab_ref_cmp_u64(a->threads, b->threads);
+        break;
+    default:
+        break;
+    }
+    return c != 0 ? c : (a->pid < b->pid ? -1 : a->pid > b->pid ? 1 : 0);
+}
+
+static bool proctab_keep_even(const fossil_squid_proc_t *p, void *ctx)
+{
+    (void)ctx;
+    return (p->pid & 1u) == 0;
+}
+
+static uint32_t proctab_pid_at(const fossil_squid_proc_tree_t *tree, const fossil_squid_proc_table_t *t, size_t k)
+{
+    return t->procs[tree->order[k]].pid;
+}
+
+#if defined(__linux__)
+static void proctab_nap(long ms)
+{
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+// Read /proc/self/stat the plain way: name, state, ppid, ticks, threads, start
+static bool proctab_read_self(fossil_squid_proc_t *p)
+{
+    char buf[1024];
+    FILE *fp = fopen("/proc/self/stat", "r");
+    if (!fp)
+        return false;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    char *open = strchr(buf, '(');
+    char *shut = strrchr(buf, ')');
+    if (!open || !shut || shut < open)
+        return false;
+    memset(p, 0, sizeof(*p));
+    p->pid = (uint32_t)strtoul(buf, NULL, 10);
+    size_t len = (size_t)(shut - open - 1);
+    if (len >= sizeof(p->name))
+        len = sizeof(p->name) - 1;
+    memcpy(p->name, open + 1, len);
+
+    unsigned long long utime, stime, start;
+    unsigned ppid;
+    long threads;
+    if (sscanf(shut + 2, "%c %u %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %ld %*d %llu",
+               &p->state, &ppid, &utime, &stime, &threads, &start) != 6)
+        return false;
+    p->ppid = ppid;
+    p->cpu_ticks = utime + stime;
+    p->threads = (uint32_t)threads;
+    p->start_ticks = start;
+    return true;
+}
+
+static void proctab_burn(long ms)
+{
+    struct timespec begin, now;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    volatile unsigned long spin = 0;
+    do
+    {
+        for (int i = 0; i < 100000; ++i)
+            spin += (unsigned long)i;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - begin.tv_sec) * 1000L + (now.tv_nsec - begin.tv_nsec) / 1000000L < ms);
+}
+
+// Fork a child that renames itself to a string full of terminal escapes
+static pid_t proctab_spawn_named(const char *name)
+{
+    int ready[2];
+    if (pipe(ready) != 0)
+        return -1;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(ready[0]);
+        prctl(PR_SET_NAME, name, 0, 0, 0);
+        if (write(ready[1], "x", 1) != 1)
+            _exit(1);
+        for (;;)
+            pause();
+    }
+    close(ready[1]);
+    char c;
+    if (pid > 0 && read(ready[0], &c, 1) != 1)
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        pid = -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+#endif
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_proctab_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_proctab_suite)
+{
+    // Setup code here
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_proctab_suite)
+{
+    // Teardown code here
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: The sampler leaves the descriptor limit alone and stays within its budget
+FOSSIL_TEST(c_test_proctab_sampler_rlimit)
+{
+#if defined(__linux__)
+    struct rlimit before, after;
+    ASSUME_ITS_EQUAL_I32(0, getrlimit(RLIMIT_NOFILE, &before));
+
+    fossil_squid_proc_sampler_t s;
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sampler_init(&s));
+    ASSUME_ITS_EQUAL_I32(0, getrlimit(RLIMIT_NOFILE, &after));
+    ASSUME_ITS_TRUE(before.rlim_cur == after.rlim_cur);
+    ASSUME_ITS_TRUE(before.rlim_cur == RLIM_INFINITY || s.fd_budget <= before.rlim_cur / 2);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sample(&s));
+    ASSUME_ITS_TRUE(proctab_find(s.procs, s.count, (uint32_t)getpid()) != NULL);
+    ASSUME_ITS_TRUE(s.interval_s == 0.0);
+
+    proctab_nap(20);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sample(&s));
+    ASSUME_ITS_TRUE(s.interval_s > 0.0);
+    ASSUME_ITS_TRUE(s.fds_open <= s.fd_budget);
+    ASSUME_ITS_TRUE(proctab_find(s.procs, s.count, (uint32_t)getpid()) != NULL);
+
+    ASSUME_ITS_EQUAL_I32(0, getrlimit(RLIMIT_NOFILE, &after));
+    ASSUME_ITS_TRUE(before.rlim_cur == after.rlim_cur);
+    fossil_squid_proc_sampler_dispose(&s);
+#endif
+}
+
+// Test: Control bytes in a process name never reach the sample
+FOSSIL_TEST(c_test_proctab_name_control_bytes)
+{
+#if defined(__linux__)
+    pid_t child = proctab_spawn_named("sq\x1b[2Jid\x07");
+    if (child < 0)
+        return;
+
+    fossil_squid_proc_sampler_t s;
+    fossil_squid_proc_sampler_init(&s);
+    int rc = fossil_squid_proc_sample(&s);
+    const fossil_squid_proc_t *p = rc == 0 ? proctab_find(s.procs, s.count, (uint32_t)child) : NULL;
+
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    ASSUME_ITS_TRUE(p != NULL);
+    if (p)
+    {
+        ASSUME_ITS_TRUE(strcmp(p->name, "sq?[2Jid?") == 0);
+        for (const char *c = p->name; *c; ++c)
+            ASSUME_ITS_TRUE((unsigned char)*c >= 0x20 && (unsigned char)*c != 0x7f);
+    }
+
+    fossil_squid_proc_sampler_dispose(&s);
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+#endif
+}
+
+// Test: The collector agrees with a serial read of /proc/self and comes out sorted
+FOSSIL_TEST(c_test_proctab_collect_self)
+{
+#if defined(__linux__)
+    fossil_squid_proc_table_t t;
+    fossil_squid_proc_table_init(&t);
+
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        fossil_squid_proc_t before, after;
+        ASSUME_ITS_TRUE(proctab_read_self(&before));
+        ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_collect(&t, threads));
+        ASSUME_ITS_TRUE(proctab_read_self(&after));
+
+        ASSUME_ITS_TRUE(t.count > 0);
+        for (size_t i = 1; i < t.count; ++i)
+            ASSUME_ITS_TRUE(t.procs[i - 1].pid < t.procs[i].pid);
+
+        const fossil_squid_proc_t *p = proctab_find(t.procs, t.count, (uint32_t)getpid());
+        ASSUME_ITS_TRUE(p != NULL);
+        if (!p)
+            continue;
+        ASSUME_ITS_EQUAL_I32((int)before.pid, (int)p->pid);
+        ASSUME_ITS_EQUAL_I32((int)before.ppid, (int)p->ppid);
+        ASSUME_ITS_TRUE(strcmp(p->name, before.name) == 0);
+        ASSUME_ITS_TRUE(before.start_ticks == p->start_ticks);
+        ASSUME_ITS_TRUE(before.cpu_ticks <= p->cpu_ticks && p->cpu_ticks <= after.cpu_ticks);
+        ASSUME_ITS_TRUE(p->rss_bytes > 0 && p->vsize_bytes >= p->rss_bytes);
+        if (threads == 1)
+            ASSUME_ITS_EQUAL_I32((int)before.threads, (int)p->threads);
+        ASSUME_ITS_TRUE(p->cpu_percent == 0.0);
+        ASSUME_ITS_TRUE(proctab_find(t.procs, t.count, (uint32_t)getppid()) != NULL);
+    }
+
+    fossil_squid_proc_table_dispose(&t);
+#endif
+}
+
+// Test: CPU use is measured between two collections, not over a lifetime
+FOSSIL_TEST(c_test_proctab_collect_rate)
+{
+#if defined(__linux__)
+    fossil_squid_proc_table_t first, second;
+    fossil_squid_proc_table_init(&first);
+    fossil_squid_proc_table_init(&second);
+
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_collect(&first, 0));
+    proctab_burn(300);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_collect(&second, 0));
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_table_rate(&second, &first));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_table_rate(NULL, &first));
+
+    const fossil_squid_proc_t *p = proctab_find(second.procs, second.count, (uint32_t)getpid());
+    ASSUME_ITS_TRUE(p != NULL);
+    if (p)
+    {
+        // busy for the whole window, so well above idle and at most one core
+        ASSUME_ITS_TRUE(p->cpu_percent > 30.0);
+        ASSUME_ITS_TRUE(p->cpu_percent < 150.0);
+    }
+
+    fossil_squid_proc_table_dispose(&first);
+    fossil_squid_proc_table_dispose(&second);
+#endif
+}
+
+// Test: Roots, orphans, self-parents and pid order shape the preorder
+FOSSIL_TEST(c_test_proctab_tree_preorder)
+{
+    static const uint32_t links[][2] = {
+        {1, 0}, {2, 1}, {3, 1}, {4, 2}, {5, 99}, {9, 9}, {10, 11}, {11, 1},
+    };
+    fossil_squid_proc_t procs[8];
+    proctab_fake(procs, links, 8);
+    fossil_squid_proc_table_t t;
+    fossil_squid_proc_table_init(&t);
+    t.procs = procs;
+    t.count = 8;
+
+    fossil_squid_proc_tree_t tree;
+    memset(&tree, 0, sizeof(tree));
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_tree_build(&tree, &t));
+    ASSUME_ITS_EQUAL_I32(8, (int)tree.count);
+
+    static const uint32_t want_pid[] = {1, 2, 4, 3, 11, 10, 5, 9};
+    static const uint32_t want_depth[] = {0, 1, 2, 1, 1, 2, 0, 0};
+    for (size_t k = 0; k < 8; ++k)
+    {
+        ASSUME_ITS_EQUAL_I32((int)want_pid[k], (int)proctab_pid_at(&tree, &t, k));
+        ASSUME_ITS_EQUAL_I32((int)want_depth[k], (int)tree.depth[tree.order[k]]);
+        ASSUME_ITS_EQUAL_I32((int)k, (int)tree.pos[tree.order[k]]);
+    }
+
+    // the orphan and the process that names itself as parent are roots
+    ASSUME_ITS_EQUAL_I32(-1, tree.parent[fossil_squid_proc_tree_find(&tree, &t, 5)]);
+    ASSUME_ITS_EQUAL_I32(-1, tree.parent[fossil_squid_proc_tree_find(&tree, &t, 9)]);
+    ASSUME_ITS_EQUAL_I32(fossil_squid_proc_tree_find(&tree, &t, 11), tree.parent[fossil_squid_proc_tree_find(&tree, &t, 10)]);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_tree_find(&tree, &t, 99));
+    for (size_t i = 0; i < 8; ++i)
+        ASSUME_ITS_EQUAL_I32((int)i, fossil_squid_proc_tree_find(&tree, &t, procs[i].pid));
+
+    // children of pid 1 are grouped in pid order
+    int32_t one = fossil_squid_proc_tree_find(&tree, &t, 1);
+    ASSUME_ITS_EQUAL_I32(3, (int)(tree.first_child[one + 1] - tree.first_child[one]));
+    ASSUME_ITS_EQUAL_I32(2, (int)procs[tree.children[tree.first_child[one]]].pid);
+    ASSUME_ITS_EQUAL_I32(11, (int)procs[tree.children[tree.first_child[one] + 2]].pid);
+
+    fossil_squid_proc_tree_dispose(&tree);
+}
+
+// Test: A parent cycle is cut once and everything hanging off it is still listed
+FOSSIL_TEST(c_test_proctab_tree_cycle)
+{
+    static const uint32_t links[][2] = {
+        {3, 0}, {6, 7}, {7, 6}, {8, 7}, {20, 22}, {21, 20}, {22, 21},
+    };
+    fossil_squid_proc_t procs[7];
+    proctab_fake(procs, links, 7);
+    fossil_squid_proc_table_t t;
+    fossil_squid_proc_table_init(&t);
+    t.procs = procs;
+    t.count = 7;
+
+    fossil_squid_proc_tree_t tree;
+    memset(&tree, 0, sizeof(tree));
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_tree_build(&tree, &t));
+
+    // here each cycle is cut at its lowest pid, which becomes a root
+    static const uint32_t want_pid[] = {3, 6, 7, 8, 20, 21, 22};
+    static const uint32_t want_depth[] = {0, 0, 1, 2, 0, 1, 2};
+    for (size_t k = 0; k < 7; ++k)
+    {
+        ASSUME_ITS_EQUAL_I32((int)want_pid[k], (int)proctab_pid_at(&tree, &t, k));
+        ASSUME_ITS_EQUAL_I32((int)want_depth[k], (int)tree.depth[tree.order[k]]);
+    }
+    ASSUME_ITS_EQUAL_I32(-1, tree.parent[fossil_squid_proc_tree_find(&tree, &t, 6)]);
+    ASSUME_ITS_EQUAL_I32(-1, tree.parent[fossil_squid_proc_tree_find(&tree, &t, 20)]);
+
+    int32_t six = fossil_squid_proc_tree_find(&tree, &t, 6);
+    ASSUME_ITS_EQUAL_I32(3, (int)tree.totals[six].processes);
+    ASSUME_ITS_EQUAL_I32(21, (int)tree.totals[six].threads);
+    int32_t twenty = fossil_squid_proc_tree_find(&tree, &t, 20);
+    ASSUME_ITS_EQUAL_I32(3, (int)tree.totals[twenty].processes);
+    ASSUME_ITS_TRUE(tree.totals[twenty].rss_bytes == 6300u);
+
+    fossil_squid_proc_tree_dispose(&tree);
+}
+
+// Test: Subtree totals add up and each subtree is one run of the preorder
+FOSSIL_TEST(c_test_proctab_tree_totals)
+{
+    static const uint32_t links[][2] = {
+        {1, 0}, {2, 1}, {3, 1}, {4, 2}, {5, 99}, {10, 11}, {11, 1},
+    };
+    fossil_squid_proc_t procs[7];
+    proctab_fake(procs, links, 7);
+    fossil_squid_proc_table_t t;
+    fossil_squid_proc_table_init(&t);
+    t.procs = procs;
+    t.count = 7;
+
+    fossil_squid_proc_tree_t tree;
+    memset(&tree, 0, sizeof(tree));
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_tree_build(&tree, &t));
+
+    const fossil_squid_proc_totals_t *root = &tree.totals[fossil_squid_proc_tree_find(&tree, &t, 1)];
+    ASSUME_ITS_EQUAL_I32(6, (int)root->processes);
+    ASSUME_ITS_EQUAL_I32(31, (int)root->threads);
+    ASSUME_ITS_TRUE(root->rss_bytes == 3100u);
+    ASSUME_ITS_TRUE(root->cpu_percent > 30.99 && root->cpu_percent < 31.01);
+
+    const fossil_squid_proc_totals_t *two = &tree.totals[fossil_squid_proc_tree_find(&tree, &t, 2)];
+    ASSUME_ITS_EQUAL_I32(2, (int)two->processes);
+    ASSUME_ITS_EQUAL_I32(6, (int)two->threads);
+    const fossil_squid_proc_totals_t *leaf = &tree.totals[fossil_squid_proc_tree_find(&tree, &t, 4)];
+    ASSUME_ITS_EQUAL_I32(1, (int)leaf->processes);
+    ASSUME_ITS_TRUE(leaf->rss_bytes == 400u);
+
+    // every entry's descendants are exactly the entries that follow it deeper in the preorder
+    for (size_t i = 0; i < t.count; ++i)
+    {
+        uint32_t begin = tree.pos[i];
+        uint32_t end = begin + tree.totals[i].processes;
+        ASSUME_ITS_TRUE(end <= tree.count);
+        for (uint32_t k = begin + 1; k < end; ++k)
+            ASSUME_ITS_TRUE(tree.depth[tree.order[k]] > tree.depth[i]);
+        if (end < tree.count)
+            ASSUME_ITS_TRUE(tree.depth[tree.order[end]] <= tree.depth[i]);
+    }
+
+    fossil_squid_proc_tree_dispose(&tree);
+}
+
+// Test: A long parent chain and an empty table are both indexed without trouble
+FOSSIL_TEST(c_test_proctab_tree_chain)
+{
+    enum { CHAIN = 50000 };
+    fossil_squid_proc_t *procs = (fossil_squid_proc_t *)calloc(CHAIN, sizeof(*procs));
+    ASSUME_ITS_TRUE(procs != NULL);
+    if (!procs)
+        return;
+    for (uint32_t i = 0; i < CHAIN; ++i)
+    {
+        procs[i].pid = i + 1;
+        procs[i].ppid = i;
+        procs[i].threads = 1;
+    }
+    fossil_squid_proc_table_t t;
+    fossil_squid_proc_table_init(&t);
+    t.procs = procs;
+    t.count = CHAIN;
+
+    fossil_squid_proc_tree_t tree;
+    memset(&tree, 0, sizeof(tree));
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_tree_build(&tree, &t));
+    ASSUME_ITS_EQUAL_I32(CHAIN - 1, (int)tree.depth[CHAIN - 1]);
+    ASSUME_ITS_EQUAL_I32(CHAIN, (int)tree.totals[0].processes);
+    ASSUME_ITS_TRUE(tree.totals[0].threads == CHAIN);
+    fossil_squid_proc_tree_dispose(&tree);
+    free(procs);
+
+    t.procs = NULL;
+    t.count = 0;
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_tree_build(&tree, &t));
+    ASSUME_ITS_EQUAL_I32(0, (int)tree.count);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_tree_find(&tree, &t, 1));
+    fossil_squid_proc_tree_dispose(&tree);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_tree_build(NULL, &t));
+}
+
+// Test: Heap selection returns exactly the head of a full qsort under every key and limit
+FOSSIL_TEST(c_test_proctab_select_reference)
+{
+    enum { ROWS = 3000 };
+    fossil_squid_proc_t *procs = (fossil_squid_proc_t *)calloc(ROWS, sizeof(*procs));
+    uint32_t *out = (uint32_t *)calloc(ROWS, sizeof(uint32_t));
+    uint32_t *ref = (uint32_t *)calloc(ROWS, sizeof(uint32_t));
+    ASSUME_ITS_TRUE(procs && out && ref);
+    if (!procs || !out || !ref)
+    {
+        free(procs);
+        free(out);
+        free(ref);
+        return;
+    }
+
+    // small value ranges so every key sees plenty of ties
+    uint32_t seed = 12345u, pid = 1;
+    for (size_t i = 0; i < ROWS; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        pid += 1 + (seed >> 28);
+        procs[i].pid = pid;
+        procs[i].threads = (seed >> 8) % 5;
+        procs[i].rss_bytes = ((seed >> 12) % 7) * 4096u;
+        procs[i].vsize_bytes = ((seed >> 16) % 3) * 65536u;
+        procs[i].cpu_percent = (double)((seed >> 20) % 4) * 0.5;
+    }
+
+    static const fossil_squid_proc_sort_t keys[] = {
+        FOSSIL_SQUID_PROC_SORT_PID, FOSSIL_SQUID_PROC_SORT_CPU, FOSSIL_SQUID_PROC_SORT_MEM,
+        FOSSIL_SQUID_PROC_SORT_VMEM, FOSSIL_SQUID_PROC_SORT_THREADS,
+    };
+    static const size_t limits[] = {0, 1, 2, 7, 100, ROWS - 1, ROWS, ROWS + 5};
+    proctab_ref_procs = procs;
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); ++k)
+    {
+        for (int filtered = 0; filtered < 2; ++filtered)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < ROWS; ++i)
+                if (!filtered || proctab_keep_even(&procs[i], NULL))
+                    ref[kept++] = (uint32_t)i;
+            proctab_ref_key = keys[k];
+            qsort(ref, kept, sizeof(uint32_t), proctab_ref_cmp);
+
+            for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); ++l)
+            {
+                size_t want = limits[l] == 0 || limits[l] > kept ? kept : limits[l];
+                size_t got = fossil_squid_proc_select(procs, ROWS, keys[k], limits[l],
+                                                      filtered ? proctab_keep_even : NULL, NULL, out);
+                ASSUME_ITS_EQUAL_I32((int)want, (int)got);
+                ASSUME_ITS_TRUE(memcmp(out, ref, got * sizeof(uint32_t)) == 0);
+            }
+        }
+    }
+
+    ASSUME_ITS_EQUAL_I32(0, (int)fossil_squid_proc_select(procs, 0, FOSSIL_SQUID_PROC_SORT_CPU, 5, NULL, NULL, out));
+    free(procs);
+    free(out);
+    free(ref);
+}
+
+// Test: Sort keys parse by name and unknown ones are refused
+FOSSIL_TEST(c_test_proctab_sort_parse)
+{
+    fossil_squid_proc_sort_t key;
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sort_parse("cpu", &key));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_SORT_CPU, key);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sort_parse("mem", &key));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_SORT_MEM, key);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sort_parse("vmem", &key));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_SORT_VMEM, key);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sort_parse("threads", &key));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_SORT_THREADS, key);
+    ASSUME_ITS_EQUAL_I32(0, fossil_squid_proc_sort_parse("pid", &key));
+    ASSUME_ITS_EQUAL_I32(FOSSIL_SQUID_PROC_SORT_PID, key);
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_sort_parse("size", &key));
+    ASSUME_ITS_EQUAL_I32(-1, fossil_squid_proc_sort_parse("", &key));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_proctab_tests)
+{
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_sampler_rlimit);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_name_control_bytes);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_collect_self);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_collect_rate);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_tree_preorder);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_tree_cycle);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_tree_totals);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_tree_chain);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_select_reference);
+    FOSSIL_TEST_ADD(c_proctab_suite, c_test_proctab_sort_parse);
+
+    FOSSIL_TEST_REGISTER(c_proctab_suite);
+}
@@ -0,0 +1,262 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/wait.h>
+#endif
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+#define SCAN_FARM_SIZE 64
+#define SCAN_STALL_ROUNDS 5
+
+static int scan_farm_fds[SCAN_FARM_SIZE];
+static uint16_t scan_farm_ports[SCAN_FARM_SIZE];
+static int scan_farm_count = 0;
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_scan_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_scan_suite)
+{
+    // Open a farm of loopback listeners on ephemeral ports
+    scan_farm_count = 0;
+#ifndef _WIN32
+    for (int i = 0; i < SCAN_FARM_SIZE; ++i)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            break;
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = (socklen_t)sizeof(addr);
+
+        if (bind(fd, (struct sockaddr *)&addr, len) != 0 || listen(fd, 16) != 0 ||
+            getsockname(fd, (struct sockaddr *)&addr, &len) != 0)
+        {
+            close(fd);
+            break;
+        }
+
+        scan_farm_fds[scan_farm_count] = fd;
+        scan_farm_ports[scan_farm_count] = ntohs(addr.sin_port);
+        scan_farm_count++;
+    }
+#endif
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_scan_suite)
+{
+#ifndef _WIN32
+    for (int i = 0; i < scan_farm_count; ++i)
+        close(scan_farm_fds[i]);
+#endif
+    scan_farm_count = 0;
+}
+
+static int scan_stall_calls = 0;
+
+// Hold the engine thread on the first completion, longer than the probe timeout
+static void scan_stall_cb(fossil_squid_probe_t *probe, void *ctx)
+{
+    (void)probe;
+    (void)ctx;
+    if (scan_stall_calls++ == 0)
+        fossil_net_socket_sleep(300);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: Every listener in the farm is reported open
+FOSSIL_TEST(c_test_scan_probe_listener_farm)
+{
+    fossil_squid_probe_t probes[SCAN_FARM_SIZE];
+    memset(probes, 0, sizeof(probes));
+    for (int i = 0; i < scan_farm_count; ++i)
+    {
+        probes[i].ip = "127.0.0.1";
+        probes[i].port = scan_farm_ports[i];
+    }
+
+    fossil_squid_probe_opts_t opts = {16, 1000, 0};
+    int rc = fossil_squid_probe_run(probes, (size_t)scan_farm_count, &opts, NULL, NULL);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+
+    int open = 0;
+    for (int i = 0; i < scan_farm_count; ++i)
+    {
+        if (probes[i].status == FOSSIL_SQUID_PROBE_OPEN)
+            open++;
+    }
+    ASSUME_ITS_EQUAL_I32(scan_farm_count, open);
+}
+
+// Test: A port nobody listens on is refused, not timed out
+FOSSIL_TEST(c_test_scan_probe_refused)
+{
+    fossil_squid_probe_t probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.ip = "127.0.0.1";
+    probe.port = 1;
+
+    fossil_squid_probe_opts_t opts = {1, 1000, 0};
+    int rc = fossil_squid_probe_run(&probe, 1, &opts, NULL, NULL);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    ASSUME_ITS_TRUE(probe.status != FOSSIL_SQUID_PROBE_OPEN);
+    ASSUME_ITS_TRUE(probe.status != FOSSIL_SQUID_PROBE_PENDING);
+}
+
+// Test: Invalid addresses fail fast instead of hanging
+FOSSIL_TEST(c_test_scan_probe_invalid_ip)
+{
+    fossil_squid_probe_t probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.ip = "not-an-ip";
+    probe.port = 80;
+
+    int rc = fossil_squid_probe_run(&probe, 1, NULL, NULL, NULL);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    ASSUME_ITS_TRUE(probe.status == FOSSIL_SQUID_PROBE_ERROR);
+}
+
+// Test: Sockets that connect while a callback stalls are still reported open
+FOSSIL_TEST(c_test_scan_probe_stalled_callback)
+{
+    // More completions than one event batch holds, so some are still queued when the callback stalls
+    static fossil_squid_probe_t probes[SCAN_FARM_SIZE * SCAN_STALL_ROUNDS];
+    memset(probes, 0, sizeof(probes));
+    int count = scan_farm_count * SCAN_STALL_ROUNDS;
+    for (int i = 0; i < count; ++i)
+    {
+        probes[i].ip = "127.0.0.1";
+        probes[i].port = scan_farm_ports[i % scan_farm_count];
+    }
+
+    scan_stall_calls = 0;
+    fossil_squid_probe_opts_t opts = {count, 100, 0};
+    int rc = fossil_squid_probe_run(probes, (size_t)count, &opts, scan_stall_cb, NULL);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+
+    int open = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (probes[i].status == FOSSIL_SQUID_PROBE_OPEN)
+            open++;
+    }
+    ASSUME_ITS_EQUAL_I32(count, open);
+    ASSUME_ITS_EQUAL_I32(count, scan_stall_calls);
+}
+
+// Test: The engine reads a greeting without the callback touching the socket
+FOSSIL_TEST(c_test_scan_probe_banner)
+{
+#ifndef _WIN32
+    ASSUME_ITS_TRUE(scan_farm_count > 1);
+
+    pid_t child = fork();
+    ASSUME_ITS_TRUE(child >= 0);
+    if (child == 0)
+    {
+        int conn = accept(scan_farm_fds[0], NULL, NULL);
+        if (conn >= 0)
+        {
+            const char greeting[] = "SSH-2.0-squid\r\n";
+            if (send(conn, greeting, sizeof(greeting) - 1, 0) < 0)
+                _exit(1);
+            fossil_net_socket_sleep(200);
+            close(conn);
+        }
+        _exit(0);
+    }
+
+    char greeting[64];
+    char silent[64];
+    fossil_squid_probe_t probes[2];
+    memset(probes, 0, sizeof(probes));
+    probes[0].ip = "127.0.0.1";
+    probes[0].port = scan_farm_ports[0];
+    probes[0].banner = greeting;
+    probes[0].banner_cap = sizeof(greeting);
+    probes[1].ip = "127.0.0.1";
+    probes[1].port = scan_farm_ports[1];
+    probes[1].banner = silent;
+    probes[1].banner_cap = sizeof(silent);
+
+    fossil_squid_probe_opts_t opts = {2, 1000, 500};
+    int rc = fossil_squid_probe_run(probes, 2, &opts, NULL, NULL);
+    waitpid(child, NULL, 0);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+
+    // A greeting arrives; a listener that never speaks is still open
+    ASSUME_ITS_TRUE(probes[0].status == FOSSIL_SQUID_PROBE_OPEN);
+    ASSUME_ITS_TRUE(probes[0].banner_len > 0);
+    ASSUME_ITS_TRUE(strncmp(greeting, "SSH-2.0-squid", 13) == 0);
+    ASSUME_ITS_TRUE(probes[1].status == FOSSIL_SQUID_PROBE_OPEN);
+    ASSUME_ITS_TRUE(probes[1].banner_len == 0);
+    ASSUME_ITS_TRUE(probes[1].fd == -1);
+#endif
+}
+
+// Test: Full command over a small loopback range
+FOSSIL_TEST(c_test_scan_loopback_range)
+{
+    int rc = fossil_squid_scan("127.0.0.1", "1-128", 0, 200, 64, true, false, false, false, true, false);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+}
+
+// Test: Missing host is rejected
+FOSSIL_TEST(c_test_scan_null_host)
+{
+    int rc = fossil_squid_scan(NULL, "1-10", 0, 200, 64, true, false, false, false, false, false);
+    ASSUME_NOT_EQUAL_I32(0, rc);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_scan_tests)
+{
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_probe_listener_farm);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_probe_refused);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_probe_invalid_ip);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_probe_stalled_callback);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_probe_banner);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_loopback_range);
+    FOSSIL_TEST_ADD(c_scan_suite, c_test_scan_null_host);
+
+    FOSSIL_TEST_REGISTER(c_scan_suite);
+}
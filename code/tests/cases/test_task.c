@@ -0,0 +1,167 @@
+/*
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop high-
+ * performance, cross-platform applications and libraries. The code contained
+ * herein is subject to the terms and conditions defined in the project license.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ *
+ * Copyright (C) 2024 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include <fossil/pizza/framework.h>
+
+#include "fossil/code/app.h"
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+typedef struct {
+    int value;
+} task_data_t;
+
+static int task_quick(void *data)
+{
+    task_data_t *d = (task_data_t *)data;
+    d->value = 42;
+    return 7;
+}
+
+// Blocks far past any deadline the tests use, like a hung hostinfo probe
+static int task_hung(void *data)
+{
+    task_data_t *d = (task_data_t *)data;
+    fossil_net_socket_sleep(400);
+    d->value = 1;
+    return 0;
+}
+
+static fossil_squid_tasks_t *task_set = NULL;
+
+// Define the test suite and add test cases
+FOSSIL_SUITE(c_task_suite);
+
+// Setup function for the test suite
+FOSSIL_SETUP(c_task_suite)
+{
+    task_set = fossil_squid_tasks_create(4);
+}
+
+// Teardown function for the test suite
+FOSSIL_TEARDOWN(c_task_suite)
+{
+    fossil_squid_tasks_release(task_set);
+    task_set = NULL;
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// Test: A task that finishes in time hands back its data and return value
+FOSSIL_TEST(c_test_task_finishes)
+{
+    task_data_t *d = (task_data_t *)fossil_squid_tasks_add(task_set, task_quick, sizeof(task_data_t));
+    ASSUME_ITS_TRUE(d != NULL);
+    ASSUME_ITS_TRUE(d->value == 0);
+
+    fossil_squid_tasks_start(task_set, 0);
+    int rc = -1;
+    ASSUME_ITS_TRUE(fossil_squid_tasks_wait(task_set, 0, fossil_squid_tasks_now_ms() + 5000, &rc));
+    ASSUME_ITS_EQUAL_I32(7, rc);
+    ASSUME_ITS_EQUAL_I32(42, d->value);
+}
+
+// Test: A hung task times out at its deadline instead of blocking the caller
+FOSSIL_TEST(c_test_task_times_out)
+{
+    ASSUME_ITS_TRUE(fossil_squid_tasks_add(task_set, task_hung, sizeof(task_data_t)) != NULL);
+    ASSUME_ITS_TRUE(fossil_squid_tasks_add(task_set, task_quick, sizeof(task_data_t)) != NULL);
+    fossil_squid_tasks_start(task_set, 0);
+    fossil_squid_tasks_start(task_set, 1);
+
+    uint64_t started = fossil_squid_tasks_now_ms();
+    int rc = -1;
+    ASSUME_ITS_TRUE(!fossil_squid_tasks_wait(task_set, 0, started + 50, &rc));
+    uint64_t waited = fossil_squid_tasks_now_ms() - started;
+    ASSUME_ITS_TRUE(waited >= 50);
+    ASSUME_ITS_TRUE(waited < 300);
+    ASSUME_ITS_EQUAL_I32(-1, rc);
+
+    // The next task is judged on its own, not held up by the hung one
+    ASSUME_ITS_TRUE(fossil_squid_tasks_wait(task_set, 1, started + 5000, &rc));
+    ASSUME_ITS_EQUAL_I32(7, rc);
+}
+
+// Test: A deadline already passed returns at once for an unfinished task
+FOSSIL_TEST(c_test_task_past_deadline)
+{
+    ASSUME_ITS_TRUE(fossil_squid_tasks_add(task_set, task_hung, sizeof(task_data_t)) != NULL);
+    fossil_squid_tasks_start(task_set, 0);
+
+    uint64_t started = fossil_squid_tasks_now_ms();
+    ASSUME_ITS_TRUE(!fossil_squid_tasks_wait(task_set, 0, started, NULL));
+    ASSUME_ITS_TRUE(fossil_squid_tasks_now_ms() - started < 50);
+}
+
+// Test: Releasing the set while a task still runs leaves the task its data
+FOSSIL_TEST(c_test_task_abandoned)
+{
+    fossil_squid_tasks_t *set = fossil_squid_tasks_create(1);
+    ASSUME_ITS_TRUE(set != NULL);
+    ASSUME_ITS_TRUE(fossil_squid_tasks_add(set, task_hung, sizeof(task_data_t)) != NULL);
+    fossil_squid_tasks_start(set, 0);
+    ASSUME_ITS_TRUE(!fossil_squid_tasks_wait(set, 0, fossil_squid_tasks_now_ms() + 10, NULL));
+
+    // The worker holds the last reference and frees the set when it returns
+    fossil_squid_tasks_release(set);
+    fossil_net_socket_sleep(600);
+}
+
+// Test: Adding past capacity fails instead of overrunning the set
+FOSSIL_TEST(c_test_task_capacity)
+{
+    for (int i = 0; i < 4; ++i)
+        ASSUME_ITS_TRUE(fossil_squid_tasks_add(task_set, task_quick, sizeof(task_data_t)) != NULL);
+    ASSUME_ITS_TRUE(fossil_squid_tasks_add(task_set, task_quick, sizeof(task_data_t)) == NULL);
+    ASSUME_ITS_TRUE(fossil_squid_tasks_count(task_set) == 4);
+    ASSUME_ITS_TRUE(!fossil_squid_tasks_wait(task_set, 9, fossil_squid_tasks_now_ms(), NULL));
+}
+
+// Test: The task clock never runs backwards
+FOSSIL_TEST(c_test_task_clock_monotonic)
+{
+    uint64_t last = fossil_squid_tasks_now_ms();
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint64_t now = fossil_squid_tasks_now_ms();
+        ASSUME_ITS_TRUE(now >= last);
+        last = now;
+    }
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST_GROUP(c_task_tests)
+{
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_finishes);
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_times_out);
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_past_deadline);
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_abandoned);
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_capacity);
+    FOSSIL_TEST_ADD(c_task_suite, c_test_task_clock_monotonic);
+
+    FOSSIL_TEST_REGISTER(c_task_suite);
+}
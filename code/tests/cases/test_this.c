@@ -15,6 +15,10 @@
 
 #include "fossil/code/app.h"
 
+#if defined(__linux__)
+#include <stdlib.h>
+#endif
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Utilites
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -25,16 +29,77 @@
 // Define the test suite and add test cases
 FOSSIL_SUITE(c_this_suite);
 
+#if defined(__linux__)
+// The per-boot cache only exists on Linux; tests point it at a scratch directory
+static char this_cache_home[512];
+static char this_cache_dir[600];
+static char this_cache_file[700];
+static char this_cache_tmp[720];
+static char this_cache_victim[700];
+
+static bool this_cache_exists(const char *path)
+{
+    struct stat st;
+    return lstat(path, &st) == 0;
+}
+
+// Last byte of the file, the tail of the hardware record's zero padding
+static int this_cache_last_byte(void)
+{
+    FILE *fp = fopen(this_cache_file, "rb");
+    if (!fp)
+        return -1;
+    int c = -1;
+    if (fseek(fp, -1, SEEK_END) == 0)
+        c = fgetc(fp);
+    fclose(fp);
+    return c;
+}
+
+static void this_cache_set_last_byte(int c)
+{
+    FILE *fp = fopen(this_cache_file, "r+b");
+    if (!fp)
+        return;
+    if (fseek(fp, -1, SEEK_END) == 0)
+        fputc(c, fp);
+    fclose(fp);
+}
+
+static int this_hardware(bool no_cache)
+{
+    return fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, no_cache, true);
+}
+#endif
+
 // Setup function for the test suite
 FOSSIL_SETUP(c_this_suite)
 {
-    // Setup code here
+#if defined(__linux__)
+    char cwd[256];
+    if (!getcwd(cwd, sizeof(cwd)))
+        strcpy(cwd, "/tmp");
+    snprintf(this_cache_home, sizeof(this_cache_home), "%s/squid_this_cache_%ld", cwd, (long)getpid());
+    snprintf(this_cache_dir, sizeof(this_cache_dir), "%s/squid", this_cache_home);
+    snprintf(this_cache_file, sizeof(this_cache_file), "%s/this.cache", this_cache_dir);
+    snprintf(this_cache_tmp, sizeof(this_cache_tmp), "%s.%ld", this_cache_file, (long)getpid());
+    snprintf(this_cache_victim, sizeof(this_cache_victim), "%s/victim", this_cache_home);
+    mkdir(this_cache_home, 0700);
+    setenv("XDG_CACHE_HOME", this_cache_home, 1);
+#endif
 }
 
 // Teardown function for the test suite
 FOSSIL_TEARDOWN(c_this_suite)
 {
-    // Teardown code here
+#if defined(__linux__)
+    unlink(this_cache_tmp);
+    unlink(this_cache_file);
+    unlink(this_cache_victim);
+    rmdir(this_cache_dir);
+    rmdir(this_cache_home);
+    unsetenv("XDG_CACHE_HOME");
+#endif
 }
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -48,136 +113,220 @@ FOSSIL_TEARDOWN(c_this_suite)
 // Test: Only system info
 FOSSIL_TEST(c_test_this_system)
 {
-    int rc = fossil_squid_this(true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only architecture info
 FOSSIL_TEST(c_test_this_arch)
 {
-    int rc = fossil_squid_this(false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only memory info
 FOSSIL_TEST(c_test_this_memory)
 {
-    int rc = fossil_squid_this(false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only endianness info
 FOSSIL_TEST(c_test_this_endianness)
 {
-    int rc = fossil_squid_this(false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only power info
 FOSSIL_TEST(c_test_this_power)
 {
-    int rc = fossil_squid_this(false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only cpu info
 FOSSIL_TEST(c_test_this_cpu)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only gpu info
 FOSSIL_TEST(c_test_this_gpu)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only storage info
 FOSSIL_TEST(c_test_this_storage)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only environment info
 FOSSIL_TEST(c_test_this_env)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only virtualization info
 FOSSIL_TEST(c_test_this_virtualization)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only uptime info
 FOSSIL_TEST(c_test_this_uptime)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only network info
 FOSSIL_TEST(c_test_this_network)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only process info
 FOSSIL_TEST(c_test_this_process)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only limits info
 FOSSIL_TEST(c_test_this_limits)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only time info
 FOSSIL_TEST(c_test_this_time)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only hardware info
 FOSSIL_TEST(c_test_this_hardware)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: Only display info
 FOSSIL_TEST(c_test_this_display)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: All info (all = true)
 FOSSIL_TEST(c_test_this_all)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
 // Test: All info in JSON format
 FOSSIL_TEST(c_test_this_all_json)
 {
-    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, true);
+    int rc = fossil_squid_this(false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, true);
     ASSUME_ITS_EQUAL_I32(0, rc);
 }
 
+// Test: Static facts are cached atomically, leaving no temporary file behind
+FOSSIL_TEST(c_test_this_cache_written)
+{
+#if defined(__linux__)
+    ASSUME_ITS_EQUAL_I32(0, this_hardware(false));
+    if (!this_cache_exists(this_cache_file))
+        return; // no boot id here, the cache is never used
+    ASSUME_ITS_TRUE(!this_cache_exists(this_cache_tmp));
+#endif
+}
+
+// Test: A cached record is served until --no-cache rebuilds the cache without reading it
+FOSSIL_TEST(c_test_this_no_cache_skips_read)
+{
+#if defined(__linux__)
+    // Cache endianness and hardware
+    int rc = fossil_squid_this(false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, true);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    if (!this_cache_exists(this_cache_file))
+        return; // no boot id here, the cache is never used
+    ASSUME_ITS_EQUAL_I32(0, this_cache_last_byte());
+
+    struct stat both;
+    ASSUME_ITS_EQUAL_I32(0, stat(this_cache_file, &both));
+
+    // A cache hit leaves the stale record alone
+    this_cache_set_last_byte('X');
+    ASSUME_ITS_EQUAL_I32(0, this_hardware(false));
+    ASSUME_ITS_EQUAL_I32('X', this_cache_last_byte());
+
+    // --no-cache never reads the file: the rewrite holds only what this run probed
+    ASSUME_ITS_EQUAL_I32(0, this_hardware(true));
+    ASSUME_ITS_EQUAL_I32(0, this_cache_last_byte());
+
+    struct stat hardware_only;
+    ASSUME_ITS_EQUAL_I32(0, stat(this_cache_file, &hardware_only));
+    ASSUME_ITS_TRUE(hardware_only.st_size < both.st_size);
+#endif
+}
+
+// Test: CPU and architecture are cached with only the clock speed re-read; memory never is
+FOSSIL_TEST(c_test_this_cache_cpu_static)
+{
+#if defined(__linux__)
+    int rc = fossil_squid_this(false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    ASSUME_ITS_TRUE(!this_cache_exists(this_cache_file));
+
+    rc = fossil_squid_this(false, true, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, true);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    if (!this_cache_exists(this_cache_file))
+        return; // no boot id here, the cache is never used
+
+    // A hit serves the cached model and features without probing or rewriting them
+    this_cache_set_last_byte('X');
+    rc = fossil_squid_this(false, true, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, true);
+    ASSUME_ITS_EQUAL_I32(0, rc);
+    ASSUME_ITS_EQUAL_I32('X', this_cache_last_byte());
+#endif
+}
+
+// Test: A link planted at the temporary path is replaced, never written through
+FOSSIL_TEST(c_test_this_cache_tmp_symlink)
+{
+#if defined(__linux__)
+    FILE *fp = fopen(this_cache_victim, "w");
+    ASSUME_ITS_TRUE(fp != NULL);
+    fputs("keep", fp);
+    fclose(fp);
+
+    mkdir(this_cache_dir, 0700);
+    ASSUME_ITS_EQUAL_I32(0, symlink(this_cache_victim, this_cache_tmp));
+    ASSUME_ITS_EQUAL_I32(0, this_hardware(true));
+
+    char buf[16] = {0};
+    fp = fopen(this_cache_victim, "r");
+    ASSUME_ITS_TRUE(fp != NULL);
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    ASSUME_ITS_TRUE(n == 4 && strcmp(buf, "keep") == 0);
+    ASSUME_ITS_TRUE(!this_cache_exists(this_cache_tmp));
+#endif
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -204,5 +353,10 @@ FOSSIL_TEST_GROUP(c_this_tests)
     FOSSIL_TEST_ADD(c_this_suite, c_test_this_all);
     FOSSIL_TEST_ADD(c_this_suite, c_test_this_all_json);
 
+    FOSSIL_TEST_ADD(c_this_suite, c_test_this_cache_written);
+    FOSSIL_TEST_ADD(c_this_suite, c_test_this_no_cache_skips_read);
+    FOSSIL_TEST_ADD(c_this_suite, c_test_this_cache_cpu_static);
+    FOSSIL_TEST_ADD(c_this_suite, c_test_this_cache_tmp_symlink);
+
     FOSSIL_TEST_REGISTER(c_this_suite);
 }